@@ -35,6 +35,9 @@
 #define _PATTERN_GENERATOR_INTERFACE_H_
 
 #include <deque>
+#include <string>
+#include <vector>
+#include <sstream>
 #include <abstract-robot-dynamics/humanoid-dynamic-robot.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -174,6 +177,17 @@ namespace PatternGeneratorJRL
 					      FootAbsolutePosition &RightFootPosition,
 					      ZMPPosition &ZMPRefPos,
 					      COMPosition &COMRefPos)=0;
+
+      /*! \brief Run \a N steps of the global control loop, and store
+	the results of each step in buffers owned by the caller.
+	The state of the robot is kept between two calls.
+	@param[in] N: Number of steps.
+	@param[out] aBuffers: Arrays of at least \a N values.
+	@return The number of steps done, less than \a N if
+	there was no more data to send.
+      */
+      virtual unsigned int RunNStepsOfTheControlLoop(unsigned int N,
+						     ControlLoopBuffers &aBuffers)=0;
       /*! @} */
 
       /*! Set the current joint values of the robot.
@@ -268,6 +282,26 @@ namespace PatternGeneratorJRL
 
       /*! \brief Parse a command (to be used out of a plugin) and call all objects which registered the method. */
       virtual int ParseCmd(std::istringstream &strm)=0;
+
+      /*! \brief Returns the handle of a command, -1 if the command is unknown.
+	The handle is meant to be resolved once, and used with
+	CallCommand() or ParseCmd(CommandHandle,...) on the control loop. */
+      virtual CommandHandle ResolveCommand(const std::string &aCmd)=0;
+
+      /*! \brief Same as ParseCmd(), the name of the command being
+	already resolved. \a strm holds only the arguments. */
+      virtual int ParseCmd(CommandHandle aCmd, std::istringstream &strm)=0;
+
+      /*! \brief Call a command without parsing its arguments.
+	Commands without arguments: :StopOnLineStepSequencing, :HerdtOnline.
+	Commands with a scalar: :samplingperiod.
+	\return false if the command does not take this type of arguments. */
+      virtual bool CallCommand(CommandHandle aCmd)=0;
+      virtual bool CallCommand(CommandHandle aCmd, double aValue)=0;
+      virtual bool CallCommand(CommandHandle aCmd,
+			       const VelocityReferenceArguments &anArg)=0;
+      virtual bool CallCommand(CommandHandle aCmd,
+			       const PerturbationForceArguments &anArg)=0;
     
 
       /*! @} */
@@ -300,6 +334,43 @@ namespace PatternGeneratorJRL
        */
       virtual void setCoMPerturbationForce(double x, double y)=0;
 
+      /*! \name Commands from another thread than the control loop.
+	They are queued without lock, and applied at the beginning of the
+	next call to RunOneStepOfTheControlLoop().
+	@{
+      */
+      /*! \brief Post a velocity reference, only the latest one
+	posted before a step of the control loop is applied. */
+      virtual void PostVelocityReference(double x, double y, double yaw)=0;
+
+      /*! \brief Post a perturbation force on the CoM.
+	\return false if the queue is full. */
+      virtual bool PostCoMPerturbationForce(double x, double y)=0;
+
+      /*! \brief Post a change of the next step (Morisawa 2007 only).
+	\return false if the queue is full. */
+      virtual bool PostOnLineStepChange(double x, double y, double theta)=0;
+      /*! @} */
+
+      /*! \name Latencies of the stages of the control loop.
+	They are measured inside RunOneStepOfTheControlLoop() on a
+	monotonic clock, and kept in histograms of fixed size.
+	@{
+      */
+      /*! \brief Get the latencies of every stage, measured since
+	the creation of the object or the last reset. A stage
+	which is not computed by the current algorithm has no sample.
+	This can be called from another thread than the control loop. */
+      virtual void GetStageLatencies(std::vector<StageLatency> &aLatencies) const=0;
+
+      /*! \brief Forget the latencies measured so far. */
+      virtual void ResetStageLatencies()=0;
+      /*! @} */
+
+      /*! \brief Get the number of samples in the buffers of ZMP, CoM
+	and feet positions. When walking on-line they should stay bounded. */
+      virtual void GetBufferSizes(BufferSizes &aSizes) const=0;
+
     };
 
   /*! Factory of Pattern generator interface. */
@@ -42,6 +42,7 @@
 #endif
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <jrl/mal/matrixabstractlayer.hh>
 
 namespace PatternGeneratorJRL
@@ -221,5 +222,76 @@ namespace PatternGeneratorJRL
     return os;
   }
 
+  /*! \brief Buffers owned by the caller of
+    PatternGeneratorInterface::RunNStepsOfTheControlLoop(),
+    one array per quantity and one value per tick.
+    A null pointer means that the quantity is not stored. */
+  struct WALK_GEN_JRL_EXPORT ControlLoopBuffers_s
+  {
+    /*! Size of a configuration, velocity or acceleration. */
+    unsigned int NbDofs;
+
+    /*! N*NbDofs values, one row per tick. */
+    double *Configurations, *Velocities, *Accelerations;
+
+    /*! ZMP in the waist frame: x, y, z. */
+    double *ZMP[3];
+
+    /*! CoM position: x, y, z, yaw, pitch, roll. */
+    double *CoM[6];
+
+    /*! Feet: x, y, z, theta, omega. */
+    double *LeftFoot[5], *RightFoot[5];
+
+    /*! Set all the pointers to 0. */
+    ControlLoopBuffers_s();
+  };
+  typedef struct ControlLoopBuffers_s ControlLoopBuffers;
+
+  /*! Latency of one stage of the control loop, in seconds. */
+  struct StageLatency_s
+  {
+    /*! Name of the stage, e.g. QPSolve. */
+    std::string Name;
+
+    /*! Number of times the stage has been measured. */
+    unsigned long int NbOfSamples;
+
+    /*! Percentiles are the upper bounds of buckets
+      whose relative width is below 6.25%. */
+    double Median, Percentile99, Maximum;
+  };
+  typedef struct StageLatency_s StageLatency;
+
+  /*! Number of samples kept in the buffers of the pattern generator. */
+  struct BufferSizes_s
+  {
+    unsigned long int ZMPPositions;
+    unsigned long int COMBuffer;
+    unsigned long int LeftFootPositions, RightFootPositions;
+    unsigned long int FootAbsolutePositions;
+  };
+  typedef struct BufferSizes_s BufferSizes;
+
+  /*! \brief Handle of a command, given once by
+    PatternGeneratorInterface::ResolveCommand(). */
+  typedef int CommandHandle;
+
+  /*! Arguments of :setVelReference */
+  struct VelocityReferenceArguments_s
+  {
+    /*! m/sec and rad/sec in the frame of the robot. */
+    double x,y,yaw;
+  };
+  typedef struct VelocityReferenceArguments_s VelocityReferenceArguments;
+
+  /*! Arguments of :setCoMPerturbationForce */
+  struct PerturbationForceArguments_s
+  {
+    /*! Force along the saggital and the lateral planes. */
+    double x,y;
+  };
+  typedef struct PerturbationForceArguments_s PerturbationForceArguments;
+
 }
 #endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file synthetichumanoid.hh
+  \brief Humanoid robot model built without any robot file.
+
+  The kinematic tree is built through a robot dynamics object factory
+  (for instance the one of jrl-dynamics) from a few lengths and a total
+  mass. Its legs follow the structure expected by the pattern generator
+  (hip yaw, roll, pitch, knee, ankle pitch and roll), the default
+  parameters give a robot of the size of HRP-2 with 30 actuated joints.
+  The number of joints of the chest, of the neck and of the arms
+  can be changed to scale the number of degrees of freedom.
+*/
+
+#ifndef _PATTERN_GENERATOR_SYNTHETIC_HUMANOID_H_
+#define _PATTERN_GENERATOR_SYNTHETIC_HUMANOID_H_
+
+#include <abstract-robot-dynamics/humanoid-dynamic-robot.hh>
+#include <abstract-robot-dynamics/robot-dynamics-object-constructor.hh>
+#include <jrl/walkgen/pgtypes.hh>
+
+namespace PatternGeneratorJRL
+{
+  /*! Dimensions (m), masses (kg) and number of joints
+    of the synthetic humanoid. */
+  struct WALK_GEN_JRL_EXPORT SyntheticHumanoidParameters_s
+  {
+    /*! Total mass of the robot. */
+    double Mass;
+
+    /*! \name Legs
+      @{ */
+    /*! Distance between the two hips. */
+    double HipWidth;
+    /*! Distance from the hip to the knee. */
+    double ThighLength;
+    /*! Distance from the knee to the ankle. */
+    double TibiaLength;
+    /*! Height of the ankle above the sole. */
+    double AnkleHeight;
+    /*! Size of the sole, the ankle is above its center. */
+    double FootLength, FootWidth;
+    /*! @} */
+
+    /*! \name Upper body
+      @{ */
+    /*! Height of the chest joints above the waist. */
+    double ChestHeight;
+    /*! Height of the shoulders above the chest joints. */
+    double ShoulderHeight;
+    /*! Distance between the two shoulders. */
+    double ShoulderWidth;
+    /*! Distance from the shoulder to the elbow. */
+    double UpperArmLength;
+    /*! Distance from the elbow to the wrist. */
+    double ForearmLength;
+    /*! Height of the neck joints above the shoulders. */
+    double NeckHeight;
+    /*! @} */
+
+    /*! \name Number of joints
+      The chest and the arms have at least one and five joints.
+      @{ */
+    unsigned int NbOfChestJoints;
+    unsigned int NbOfNeckJoints;
+    unsigned int NbOfArmJoints;
+    /*! @} */
+
+    /*! Parameters of a robot of the size of HRP-2. */
+    SyntheticHumanoidParameters_s();
+
+    /*! Number of actuated joints of the robot. */
+    unsigned int NbOfActuatedJoints() const;
+  };
+  typedef struct SyntheticHumanoidParameters_s SyntheticHumanoidParameters;
+
+  /*! \brief Build a humanoid robot with the factory \a aFactory.
+    The actuated joints are ordered as the ones of HRP-2: right leg,
+    left leg, chest, neck, right arm, left arm. The robot is initialized,
+    at the zero configuration the legs are straight and the soles are
+    on the ground.
+    \return 0 if the factory failed to create one of the objects. */
+  WALK_GEN_JRL_EXPORT CjrlHumanoidDynamicRobot *
+  createSyntheticHumanoid(CjrlRobotDynamicsObjectFactory & aFactory,
+			  const SyntheticHumanoidParameters & aParameters);
+
+  /*! \brief Half-sitting posture of the synthetic humanoid,
+    in radians, one value per actuated joint. */
+  WALK_GEN_JRL_EXPORT void
+  syntheticHumanoidHalfSitting(const SyntheticHumanoidParameters & aParameters,
+			       MAL_VECTOR_TYPE(double) & aHalfSitting);
+}
+#endif /* _PATTERN_GENERATOR_SYNTHETIC_HUMANOID_H_ */
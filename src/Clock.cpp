@@ -81,9 +81,10 @@ void Clock::StopTiming()
   m_MaximumTime = m_MaximumTime < ltime ? ltime : m_MaximumTime;
   m_TotalTime += ltime;
 
-  m_DataBuffer[(m_NbOfIterations*2)%3000000]=m_BeginTimeStamp.tv_sec +
+  unsigned long int lIndex = (m_NbOfIterations*2)%m_DataBuffer.size();
+  m_DataBuffer[lIndex]=m_BeginTimeStamp.tv_sec +
     0.000001 * m_BeginTimeStamp.tv_usec - m_StartingTime;
-  m_DataBuffer[(m_NbOfIterations*2+1)%3000000]=ltime;
+  m_DataBuffer[lIndex+1]=ltime;
 }
 
 void Clock::IncIteration(int lNbOfIts)
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! Bounded queue of commands for the control loop, after
+  D. Vyukov's bounded MPMC queue. */
+
+#include <CommandInbox.hh>
+#include <portability/thread.hh>
+
+using namespace PatternGeneratorJRL;
+
+CommandInbox::CommandInbox(unsigned int aCapacity):
+  m_EnqueuePosition(0),
+  m_DequeuePosition(0),
+  m_VelocitySequence(0),
+  m_LastVelocitySequence(0)
+{
+  unsigned long lSize = 2;
+  while (lSize<aCapacity)
+    lSize*=2;
+  m_Mask = lSize-1;
+
+  m_Cells.resize(lSize);
+  for(unsigned long i=0;i<lSize;i++)
+    m_Cells[i].Sequence = i;
+
+  for(unsigned int i=0;i<3;i++)
+    m_Velocity[i] = 0.0;
+}
+
+bool CommandInbox::Push(const Command_s & aCommand)
+{
+  unsigned long lPosition = AtomicLoad(m_EnqueuePosition);
+  Cell_s * aCell;
+  for(;;)
+    {
+      aCell = &m_Cells[lPosition & m_Mask];
+      long lDiff = (long)(AtomicLoad(aCell->Sequence) - lPosition);
+      if (lDiff==0)
+	{
+	  // The cell is free, try to reserve it.
+	  if (AtomicCompareAndSwap(m_EnqueuePosition,
+				   lPosition,lPosition+1))
+	    break;
+	  lPosition = AtomicLoad(m_EnqueuePosition);
+	}
+      else if (lDiff<0)
+	// The consumer did not read this cell yet: the queue is full.
+	return false;
+      else
+	// Another producer took the cell.
+	lPosition = AtomicLoad(m_EnqueuePosition);
+    }
+
+  aCell->Command = aCommand;
+  AtomicStore(aCell->Sequence,lPosition+1);
+  return true;
+}
+
+bool CommandInbox::Pop(Command_s & aCommand)
+{
+  Cell_s & aCell = m_Cells[m_DequeuePosition & m_Mask];
+  long lDiff = (long)(AtomicLoad(aCell.Sequence) - (m_DequeuePosition+1));
+  if (lDiff<0)
+    return false;
+
+  aCommand = aCell.Command;
+  // Free the cell for the producers of the next round.
+  AtomicStore(aCell.Sequence,m_DequeuePosition+m_Mask+1);
+  m_DequeuePosition++;
+  return true;
+}
+
+void CommandInbox::PostVelocityReference(double x, double y, double yaw)
+{
+  // Only the producers wait here, while another producer is writing.
+  long lSequence;
+  for(;;)
+    {
+      lSequence = AtomicLoad(m_VelocitySequence);
+      if (((lSequence & 1)==0) &&
+	  (AtomicCompareAndSwap(m_VelocitySequence,lSequence,lSequence+1)))
+	break;
+      Thread::YieldCpu();
+    }
+  m_Velocity[0] = x;
+  m_Velocity[1] = y;
+  m_Velocity[2] = yaw;
+  AtomicStore(m_VelocitySequence,lSequence+2);
+}
+
+bool CommandInbox::PopVelocityReference(double & x, double & y, double & yaw)
+{
+  long lSequence = AtomicLoad(m_VelocitySequence);
+  if ((lSequence==m_LastVelocitySequence) || ((lSequence & 1)!=0))
+    return false;
+
+  x = m_Velocity[0];
+  y = m_Velocity[1];
+  yaw = m_Velocity[2];
+
+  // The values have been overwritten while reading them.
+  AtomicBarrier();
+  if (AtomicLoad(m_VelocitySequence)!=lSequence)
+    return false;
+
+  m_LastVelocitySequence = lSequence;
+  return true;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file CommandInbox.hh
+  \brief Bounded queue of commands sent to the pattern generator
+  by other threads than the control loop.
+*/
+
+#ifndef _COMMAND_INBOX_H_
+#define _COMMAND_INBOX_H_
+
+#include <vector>
+
+#include <portability/atomic.hh>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Lock-free queue with many producers and one consumer.
+
+    The producers never block the consumer: a producer reserves
+    a cell with a compare and swap, and publishes it by updating
+    the sequence number of the cell. The consumer is the control loop,
+    it never waits for a producer either.
+
+    The velocity references are not queued, only the latest one is kept
+    in a slot protected by a sequence lock, so a fast planner can not
+    fill the queue.
+  */
+  class CommandInbox
+  {
+  public:
+    /*! \brief Types of the queued commands. */
+    enum CommandType_e
+      {
+	PERTURBATION_FORCE,
+	ONLINE_STEP_CHANGE
+      };
+
+    /*! \brief A queued command and its arguments. */
+    struct Command_s
+    {
+      int Type;
+      double Values[3];
+    };
+
+    /*! \brief Constructor.
+      @param aCapacity Maximal number of queued commands,
+      rounded to the next power of two. */
+    explicit CommandInbox(unsigned int aCapacity=64);
+
+    /*! \name Producers side, any thread.
+      @{ */
+    /*! \brief Queue a command.
+      \return false if the queue is full. */
+    bool Push(const Command_s & aCommand);
+
+    /*! \brief Replace the pending velocity reference. */
+    void PostVelocityReference(double x, double y, double yaw);
+    /*! @} */
+
+    /*! \name Consumer side, only one thread.
+      @{ */
+    /*! \brief Get the oldest command.
+      \return false if the queue is empty. */
+    bool Pop(Command_s & aCommand);
+
+    /*! \brief Get the velocity reference posted since the last call.
+      \return false if there is none, or if a producer is writing it,
+      in which case it will be read at the next call. */
+    bool PopVelocityReference(double & x, double & y, double & yaw);
+    /*! @} */
+
+  private:
+    struct Cell_s
+    {
+      AtomicCounter Sequence;
+      Command_s Command;
+    };
+
+    std::vector<Cell_s> m_Cells;
+    unsigned long m_Mask;
+
+    /*! Next cell to be reserved by a producer. */
+    AtomicCounter m_EnqueuePosition;
+    /*! Next cell to be read by the consumer. */
+    unsigned long m_DequeuePosition;
+
+    /*! Sequence lock of the velocity reference,
+      odd while a producer writes it. */
+    AtomicCounter m_VelocitySequence;
+    volatile double m_Velocity[3];
+    /*! Last sequence read by the consumer. */
+    long m_LastVelocitySequence;
+
+    /* Not copyable. */
+    CommandInbox(const CommandInbox &);
+    CommandInbox & operator=(const CommandInbox &);
+  };
+}
+#endif /* _COMMAND_INBOX_H_ */
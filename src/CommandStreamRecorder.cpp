@@ -0,0 +1,197 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! Command stream file. It starts with COMMAND_STREAM_MAGIC, followed
+  by records made of the type (char), the step of the control loop
+  (unsigned int), the size of the data in bytes (unsigned int) and
+  the data: the characters of the command line for RECORD_PARSE_CMD,
+  doubles otherwise. The numbers are in the byte order of the robot. */
+
+#include <stdlib.h>
+
+#include <iostream>
+#include <sstream>
+
+#include "portability/atomic.hh"
+#include "CommandStreamRecorder.hh"
+
+using namespace PatternGeneratorJRL;
+
+static const char COMMAND_STREAM_MAGIC[8] = {'J','R','L','C','M','D','0','1'};
+
+CommandStreamRecorder::CommandStreamRecorder():
+  m_Tick(0),
+  m_Depth(0),
+  m_Running(0)
+{
+}
+
+CommandStreamRecorder::~CommandStreamRecorder()
+{
+  Close();
+}
+
+bool CommandStreamRecorder::Open(const std::string & aFileName,
+				 const std::vector<double> & aJointValues)
+{
+  Close();
+  m_File.open(aFileName.c_str(),std::ofstream::out | std::ofstream::binary);
+  if (!m_File.is_open())
+    {
+      std::cerr << "Unable to open " << aFileName << std::endl;
+      return false;
+    }
+  m_File.write(COMMAND_STREAM_MAGIC,sizeof(COMMAND_STREAM_MAGIC));
+  m_Tick = 0;
+  m_Pending.clear();
+
+  AtomicStore(m_Running,1);
+  if (m_Writer.Start(Run,this)<0)
+    {
+      AtomicStore(m_Running,0);
+      m_File.close();
+      return false;
+    }
+
+  if (aJointValues.size()>0)
+    WriteRecord(RECORD_JOINT_VALUES,(const char *)&aJointValues[0],
+		aJointValues.size()*sizeof(double));
+  return true;
+}
+
+void CommandStreamRecorder::Close()
+{
+  if (!m_Writer.Joinable())
+    return;
+  WriteRecord(RECORD_END,0,0);
+  AtomicStore(m_Running,0);
+  m_Writer.Join();
+  m_File.close();
+}
+
+void CommandStreamRecorder::RecordCommand(const std::string & aCommand)
+{
+  if (Recording())
+    WriteRecord(RECORD_PARSE_CMD,aCommand.data(),aCommand.size());
+}
+
+void CommandStreamRecorder::RecordValues(CommandStreamRecordType aType,
+					 const double * aValues,
+					 unsigned int aNbOfValues)
+{
+  if (Recording())
+    WriteRecord(aType,(const char *)aValues,aNbOfValues*sizeof(double));
+}
+
+void CommandStreamRecorder::WriteRecord(char aType,
+					const char * aData,
+					unsigned int aSize)
+{
+  ScopedLock aLock(m_PendingMutex);
+  m_Pending.push_back(aType);
+  m_Pending.append((const char *)&m_Tick,sizeof(m_Tick));
+  m_Pending.append((const char *)&aSize,sizeof(aSize));
+  if (aSize>0)
+    m_Pending.append(aData,aSize);
+}
+
+bool CommandStreamRecorder::WriteRecords()
+{
+  {
+    ScopedLock aLock(m_PendingMutex);
+    if (m_Pending.empty())
+      return false;
+    m_Writing.swap(m_Pending);
+  }
+  m_File.write(m_Writing.data(),m_Writing.size());
+  m_File.flush();
+  m_Writing.clear();
+  return true;
+}
+
+void CommandStreamRecorder::Run(void * aRecorder)
+{
+  CommandStreamRecorder * aCSR = (CommandStreamRecorder *)aRecorder;
+  while (AtomicLoad(aCSR->m_Running)!=0)
+    {
+      if (!aCSR->WriteRecords())
+	Thread::Pause(10);
+    }
+  aCSR->WriteRecords();
+}
+
+std::string CommandStreamRecorder::FileNameFromEnvironment()
+{
+  static AtomicCounter lNbOfInstances = 0;
+
+  const char * lEnvFileName = getenv("JRL_WALKGEN_RECORD_COMMANDS");
+  if ((lEnvFileName==0) || (lEnvFileName[0]==0))
+    return std::string();
+
+  long lInstance = AtomicIncrement(lNbOfInstances)-1;
+  std::ostringstream oss;
+  oss << lEnvFileName;
+  if (lInstance>0)
+    oss << "." << lInstance;
+  return oss.str();
+}
+
+bool CommandStreamReader::Open(const std::string & aFileName)
+{
+  m_File.open(aFileName.c_str(),std::ifstream::in | std::ifstream::binary);
+  char lMagic[sizeof(COMMAND_STREAM_MAGIC)];
+  m_File.read(lMagic,sizeof(lMagic));
+  return m_File.good() &&
+    (std::string(lMagic,sizeof(lMagic))==
+     std::string(COMMAND_STREAM_MAGIC,sizeof(COMMAND_STREAM_MAGIC)));
+}
+
+bool CommandStreamReader::Next(CommandStreamRecord & aRecord)
+{
+  unsigned int lSize;
+  if (!m_File.get(aRecord.Type))
+    return false;
+  m_File.read((char *)&aRecord.Tick,sizeof(aRecord.Tick));
+  m_File.read((char *)&lSize,sizeof(lSize));
+  if (!m_File.good())
+    return false;
+
+  aRecord.Command.clear();
+  aRecord.Values.clear();
+  if (lSize==0)
+    return true;
+  if (aRecord.Type==RECORD_PARSE_CMD)
+    {
+      aRecord.Command.resize(lSize);
+      m_File.read(&aRecord.Command[0],lSize);
+    }
+  else
+    {
+      if (lSize%sizeof(double)!=0)
+	return false;
+      aRecord.Values.resize(lSize/sizeof(double));
+      m_File.read((char *)&aRecord.Values[0],
+		  aRecord.Values.size()*sizeof(double));
+    }
+  return m_File.good();
+}
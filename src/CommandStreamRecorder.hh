@@ -0,0 +1,202 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file CommandStreamRecorder.hh
+  \brief Commands received by a pattern generator, recorded with
+  the step of the control loop at which they were received.
+*/
+
+#ifndef _COMMAND_STREAM_RECORDER_H_
+#define _COMMAND_STREAM_RECORDER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "portability/atomic.hh"
+#include "portability/thread.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Types of the records of a command stream. */
+  enum CommandStreamRecordType
+    {
+      /*! A command given to ParseCmd, with its arguments. */
+      RECORD_PARSE_CMD='P',
+      /*! SetCurrentJointValues: the joint values. */
+      RECORD_JOINT_VALUES='J',
+      /*! setVelocityReference: x, y, yaw. */
+      RECORD_VELOCITY_REFERENCE='V',
+      /*! setCoMPerturbationForce: x, y. */
+      RECORD_PERTURBATION_FORCE='F',
+      /*! AddOnLineStep: x, y, theta. */
+      RECORD_ADD_ONLINE_STEP='A',
+      /*! ChangeOnLineStep: time, x, y, z, theta, omega, omega2. */
+      RECORD_CHANGE_ONLINE_STEP='S',
+      /*! Last record: the number of steps of the control loop. */
+      RECORD_END='E'
+    };
+
+  /*! \brief One record of a command stream. */
+  struct CommandStreamRecord_s
+  {
+    char Type;
+    /*! Number of steps of the control loop done before the command. */
+    unsigned int Tick;
+    /*! Command line of RECORD_PARSE_CMD. */
+    std::string Command;
+    /*! Numerical arguments of the other records. */
+    std::vector<double> Values;
+  };
+  typedef struct CommandStreamRecord_s CommandStreamRecord;
+
+  /*! \brief Write the commands received by a pattern generator
+    in a binary file.
+
+    The commands given by the user are recorded, not the ones a
+    command calls in turn: Scope marks the calls whose commands
+    are not recorded. When the recording starts with the pattern
+    generator, replaying the file on a new pattern generator built
+    with the same robot, before the same number of steps of the
+    control loop, gives the same trajectories. A recording started
+    later by ":recordcommands" begins with the joint values only:
+    the commands received before (algorithm, step timing, ...) are
+    not in the file, and the replay starts from the default setup.
+
+    The records are appended to a buffer under a mutex, and a
+    background thread writes this buffer in the file, as
+    TelemetryLogger does, so that the control loop never waits
+    for the disk.
+  */
+  class CommandStreamRecorder
+  {
+  public:
+    /*! \brief The commands received during the life
+      of a scope are not recorded. */
+    class Scope
+    {
+    public:
+      explicit Scope(CommandStreamRecorder * aRecorder):
+	m_Recorder(aRecorder)
+      {
+	if (m_Recorder!=0)
+	  m_Recorder->m_Depth++;
+      }
+      ~Scope()
+      {
+	if (m_Recorder!=0)
+	  m_Recorder->m_Depth--;
+      }
+    private:
+      CommandStreamRecorder * m_Recorder;
+    };
+
+    CommandStreamRecorder();
+
+    /*! \brief Close the file. */
+    ~CommandStreamRecorder();
+
+    /*! \brief Start recording in \a aFileName, the steps
+      are counted from 0.
+      @param aJointValues Current joint values, recorded first
+      when the pattern generator has already been set.
+      \return false if the file could not be opened. */
+    bool Open(const std::string & aFileName,
+	      const std::vector<double> & aJointValues=std::vector<double>());
+
+    /*! \brief Write the number of steps, the buffered records
+      and close the file. */
+    void Close();
+
+    bool IsOpen() const
+    { return AtomicLoad(m_Running)!=0; }
+
+    /*! \brief Called at each step of the control loop. */
+    void NextTick()
+    { m_Tick++; }
+
+    /*! \brief Record a command line of ParseCmd. */
+    void RecordCommand(const std::string & aCommand);
+
+    /*! \brief Record the numerical arguments of a typed command. */
+    void RecordValues(CommandStreamRecordType aType,
+		      const double * aValues,
+		      unsigned int aNbOfValues);
+
+    /*! \brief File name given by the environment variable
+      JRL_WALKGEN_RECORD_COMMANDS, empty if it is not set.
+      The n-th pattern generator of the process, starting from 0,
+      adds .n to this name when n>0. */
+    static std::string FileNameFromEnvironment();
+
+  private:
+    /*! \brief True if a command can be recorded now. */
+    bool Recording() const
+    { return (m_Depth==0) && IsOpen(); }
+
+    /*! \brief Append a record to the buffer of the writer. */
+    void WriteRecord(char aType, const char * aData, unsigned int aSize);
+
+    /*! \brief Write the buffered records.
+      \return false if there was none. */
+    bool WriteRecords();
+
+    /*! \brief Loop of the background thread. */
+    static void Run(void * aRecorder);
+
+    std::ofstream m_File;
+    unsigned int m_Tick;
+    /*! Number of scopes alive. */
+    unsigned int m_Depth;
+
+    /*! Records not written yet, and the ones being written.
+      The two buffers are swapped and keep their capacity. */
+    Mutex m_PendingMutex;
+    std::string m_Pending, m_Writing;
+
+    /*! Non zero while the background thread runs. */
+    AtomicCounter m_Running;
+    Thread m_Writer;
+
+    /* Not copyable. */
+    CommandStreamRecorder(const CommandStreamRecorder &);
+    CommandStreamRecorder & operator=(const CommandStreamRecorder &);
+  };
+
+  /*! \brief Read a file written by CommandStreamRecorder. */
+  class CommandStreamReader
+  {
+  public:
+    /*! \return false if \a aFileName is not a command stream. */
+    bool Open(const std::string & aFileName);
+
+    /*! \brief Read the next record.
+      \return false at the end of the file, or if the file
+      is truncated. */
+    bool Next(CommandStreamRecord & aRecord);
+
+  private:
+    std::ifstream m_File;
+  };
+}
+#endif /* _COMMAND_STREAM_RECORDER_H_ */
@@ -25,6 +25,58 @@
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <string>
+
+#ifndef _JRL_WALKGEN_OUTPUT_DIRECTORY_
+#define _JRL_WALKGEN_OUTPUT_DIRECTORY_
+
+#include "portability/threadlocal.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! Directory where the current thread writes its files,
+    0 for the working directory. Each instance of the pattern generator
+    sets it while it is called, so that two instances running
+    in different threads do not write in the same files. */
+  inline const std::string * & CurrentOutputDirectory()
+  {
+    static JRL_WALKGEN_THREAD_LOCAL const std::string * r = 0;
+    return r;
+  }
+
+  /*! Name of a file written by the current thread.
+    @param aFileName Name relative to the output directory.
+    @param aDefaultDirectory Directory used when none is set,
+    0 for the working directory. */
+  inline std::string OutputFileName(const char * aFileName,
+				    const char * aDefaultDirectory=0)
+  {
+    const std::string * lDirectory = CurrentOutputDirectory();
+    if ((lDirectory!=0) && (lDirectory->size()>0))
+      return *lDirectory + "/" + aFileName;
+    if (aDefaultDirectory!=0)
+      return std::string(aDefaultDirectory) + "/" + aFileName;
+    return std::string(aFileName);
+  }
+
+  inline std::string OutputFileName(const std::string & aFileName)
+  { return OutputFileName(aFileName.c_str()); }
+
+  /*! Set the output directory of the current thread
+    for the life time of the object. */
+  class ScopedOutputDirectory
+  {
+  public:
+    explicit ScopedOutputDirectory(const std::string & aDirectory):
+      m_Previous(CurrentOutputDirectory())
+    { CurrentOutputDirectory() = &aDirectory; }
+    ~ScopedOutputDirectory()
+    { CurrentOutputDirectory() = m_Previous; }
+  private:
+    const std::string * m_Previous;
+  };
+}
+#endif /* _JRL_WALKGEN_OUTPUT_DIRECTORY_ */
 
 #define LTHROW(x) \
   { \
@@ -44,16 +96,16 @@
                              << __FUNCTION__ << "(#" \
                              << __LINE__ << "):" << x << std::endl;
 #define RESETDEBUG5(y) { std::ofstream DebugFile; \
-DebugFile.open(y,ofstream::out); \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::out); \
 DebugFile.close();}
 #define ODEBUG5(x,y) { std::ofstream DebugFile; \
-DebugFile.open(y,ofstream::app); \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::app); \
 DebugFile << __FILE__ << ":" \
           << __FUNCTION__ << "(#" \
           << __LINE__ << "):" << x << std::endl; \
           DebugFile.close();}
 #define ODEBUG5SIMPLE(x,y) { std::ofstream DebugFile; \
-DebugFile.open(y,ofstream::app); \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::app); \
 DebugFile << x << std::endl; \
           DebugFile.close();}
 
@@ -74,22 +126,37 @@ DebugFile << x << std::endl; \
 #endif
 
 #ifdef _DEBUG_MODE_ON_
-#define RESETDEBUG4(y) { std::ofstream DebugFile; DebugFile.open(y,ofstream::out); DebugFile.close();}
-#define ODEBUG4(x,y) { std::ofstream DebugFile; DebugFile.open(y,ofstream::app); \
+#include "Telemetry.hh"
+
+#define RESETDEBUG4(y) { std::ofstream DebugFile; \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::out); \
+DebugFile.close();}
+#define ODEBUG4(x,y) { std::ofstream DebugFile; \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::app); \
     DebugFile << __FILE__ << ":" \
               << __FUNCTION__ << "(#" \
               << __LINE__ << "):" << x << std::endl; \
     DebugFile.close();}
 #define ODEBUG4SIMPLE(x,y) { std::ofstream DebugFile; \
-DebugFile.open(y,ofstream::app); \
+DebugFile.open(PatternGeneratorJRL::OutputFileName(y).c_str(),std::ofstream::app); \
 DebugFile << x << std::endl; \
           DebugFile.close();}
+/* Per-tick numbers: x is a sequence of values separated by <<,
+   queued in the channel y and converted by walkgen-telemetry2dat. */
+#define ODEBUG4TELEMETRY(x,y) { \
+static int lTelemetryChannel = \
+  PatternGeneratorJRL::TelemetryLogger::Channel(y); \
+PatternGeneratorJRL::TelemetryRecord aTelemetryRecord; \
+aTelemetryRecord << x; \
+PatternGeneratorJRL::TelemetryLogger::Current(). \
+  Log(lTelemetryChannel,aTelemetryRecord);}
 
 #define _DEBUG_4_ACTIVATED_ 1
 #else
 #define RESETDEBUG4(y)
 #define ODEBUG4(x,y)
 #define ODEBUG4SIMPLE(x,y)
+#define ODEBUG4TELEMETRY(x,y)
 #endif
 
 #define RESETDEBUG6(x)
@@ -38,6 +38,7 @@ FootTrajectoryGenerationMultiple::FootTrajectoryGenerationMultiple(SimplePluginM
 {
   m_Foot = aFoot;
   m_Sensitivity=0.0;
+  m_IntervalCursor=0;
 }
 
 FootTrajectoryGenerationMultiple::~FootTrajectoryGenerationMultiple()
@@ -85,7 +86,7 @@ void FootTrajectoryGenerationMultiple::SetTimeIntervals(const vector<double> &lD
 	  ODEBUG(" m_RefTime["<< li <<"]: " << setprecision(12) << m_RefTime[li] << " reftime: "<< setprecision(12) << reftime );
       reftime+=m_DeltaTj[li];
     }
-  
+  m_IntervalCursor=0;
 }
 
 void FootTrajectoryGenerationMultiple::GetTimeIntervals(vector<double> &lDeltaTj) const
@@ -93,35 +94,63 @@ void FootTrajectoryGenerationMultiple::GetTimeIntervals(vector<double> &lDeltaTj
   lDeltaTj = m_DeltaTj;
 }
 
-bool FootTrajectoryGenerationMultiple::Compute(int axis, double t, double &result)
+bool FootTrajectoryGenerationMultiple::GetIntervalIndexFromTime(double t, unsigned int &IndexInterval)
 {
   t -= m_AbsoluteTimeReference;
-  result = -1.0;
-  double reftime=0;
-  ODEBUG(" ====== CoM ====== ");
-  ODEBUG(" t: " << t << " reftime :" << reftime << " m_Sensitivity: "<< m_Sensitivity <<" m_DeltaTj.size(): "<< m_DeltaTj.size() );
-	  
-  for(unsigned int j=0;j<m_DeltaTj.size();j++)
+  unsigned int lNbOfIntervals = m_RefTime.size();
+  unsigned int j = m_IntervalCursor;
+
+  /* The interval j contains t if
+     t+m_Sensitivity >= m_RefTime[j] and t <= m_RefTime[j]+m_DeltaTj[j]+m_Sensitivity.
+     When several intervals contain t, the first one is selected. */
+  if ((j<lNbOfIntervals) &&
+      ((t+m_Sensitivity)>=m_RefTime[j]) &&
+      ((j==0) || (t>m_RefTime[j-1]+m_DeltaTj[j-1]+m_Sensitivity)))
     {
-      ODEBUG(" t: " << t << " reftime :" << reftime << " Tj["<<j << "]= "<< m_DeltaTj[j]);
-	  
-      if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
+      /* Time is increasing: move the cursor forward. */
+      while((j<lNbOfIntervals) &&
+	    (t>m_RefTime[j]+m_DeltaTj[j]+m_Sensitivity))
+	j++;
+      if (j==lNbOfIntervals)
+	return false;
+    }
+  else
+    {
+      /* Random access: binary search of the first interval
+	 ending after t. */
+      unsigned int lower=0, upper=lNbOfIntervals;
+      while(lower<upper)
 	{
-	  double deltaj=0.0;
-	  deltaj = t-reftime;
-	  
-	  if (m_SetOfFootTrajectoryGenerationObjects[j]!=0)
-	    {
-	      result = m_SetOfFootTrajectoryGenerationObjects[j]->Compute(axis,deltaj);
-	    }
-	  return true;
+	  unsigned int middle = (lower+upper)/2;
+	  if (t>m_RefTime[middle]+m_DeltaTj[middle]+m_Sensitivity)
+	    lower = middle+1;
+	  else
+	    upper = middle;
 	}
-      
-      reftime+=m_DeltaTj[j];
+      j = lower;
+      if ((j==lNbOfIntervals) ||
+	  ((t+m_Sensitivity)<m_RefTime[j]))
+	return false;
     }
-  ODEBUG(" reftime :" << reftime );
-	  
-  return false;
+  ODEBUG("t: " << t << " interval: " << j << " cursor: " << m_IntervalCursor);
+  IndexInterval = j;
+  m_IntervalCursor = j;
+  return true;
+}
+
+bool FootTrajectoryGenerationMultiple::Compute(int axis, double t, double &result)
+{
+  result = -1.0;
+  unsigned int j;
+  if (!GetIntervalIndexFromTime(t,j))
+    return false;
+
+  double deltaj = t - m_AbsoluteTimeReference - m_RefTime[j];
+  if (m_SetOfFootTrajectoryGenerationObjects[j]!=0)
+    {
+      result = m_SetOfFootTrajectoryGenerationObjects[j]->Compute(axis,deltaj);
+    }
+  return true;
 }
 
 
@@ -136,52 +165,30 @@ bool FootTrajectoryGenerationMultiple::Compute(double t, FootAbsolutePosition &
 
 bool FootTrajectoryGenerationMultiple::Compute(double t, FootAbsolutePosition & aFootAbsolutePosition)
 {
-  t -= m_AbsoluteTimeReference;
-  double reftime=0;
-  ODEBUG(" ====== Foot ====== " << m_DeltaTj.size());
-  ODEBUG("t: " << setprecision(12) << t << " reftime :" << reftime << 
-  	" m_Sensitivity: "<< m_Sensitivity  <<" m_DeltaTj.size(): "<< m_DeltaTj.size() );
-	  
-  for(unsigned int j=0;j<m_DeltaTj.size();j++)
+  unsigned int j;
+  if (!GetIntervalIndexFromTime(t,j))
     {
-      ODEBUG("t: " << t << " reftime :" << setprecision(12) << reftime <<
-	     " Tj["<<j << "]= " << setprecision(12) << m_DeltaTj[j] 
-	     <<" max limit: " << setprecision(12) << (reftime+m_DeltaTj[j]+m_Sensitivity) );
-      ODEBUG(" Tj["<<j << "]= " << setprecision(12) << m_DeltaTj[j] );
-      if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
-	{
-	  double deltaj=0.0;
-	  deltaj = t-reftime;
-	  
-	  if (m_SetOfFootTrajectoryGenerationObjects[j]!=0)
-	    {	      
-	      m_SetOfFootTrajectoryGenerationObjects[j]->ComputeAll(aFootAbsolutePosition,deltaj);
-	      aFootAbsolutePosition.stepType = m_NatureOfIntervals[j];
-	    }
-	  ODEBUG("t: " << t << " reftime :" << setprecision(12) << reftime <<
-		  " AbsoluteTimeReference : " << m_AbsoluteTimeReference <<
-		  " Tj["<<j << "]= " << setprecision(12) << m_DeltaTj[j] 
-	     <<" max limit: " << setprecision(12) << (reftime+m_DeltaTj[j]+m_Sensitivity) );
-	  ODEBUG("X: " << aFootAbsolutePosition.x << 
-		  " Y: " << aFootAbsolutePosition.y << 
-		  " Z: " << aFootAbsolutePosition.z << 
-		  " Theta: " << aFootAbsolutePosition.theta <<
-		  " Omega: " << aFootAbsolutePosition.omega << 
-		  " stepType: " << aFootAbsolutePosition.stepType << 
-		  " NI: " << m_NatureOfIntervals[j] <<
-		  " interval : " << j);
-
-	  return true;
-	}
-      
-      reftime+=m_DeltaTj[j];
+      ODEBUG("t: " << setprecision(12) << t << 
+	     " m_AbsoluteReferenceTime" << m_AbsoluteTimeReference <<
+	     " m_Sensitivity: "<< m_Sensitivity  <<" m_DeltaTj.size(): "<< m_DeltaTj.size() );
+      return false;
     }
-  ODEBUG(" reftime :" << reftime <<
-	  " m_AbsoluteReferenceTime" << m_AbsoluteTimeReference);
-  ODEBUG("t: " << setprecision(12) << t << " reftime :" << reftime << 
-	  " m_Sensitivity: "<< m_Sensitivity  <<" m_DeltaTj.size(): "<< m_DeltaTj.size() );
 
-  return false;
+  double deltaj = t - m_AbsoluteTimeReference - m_RefTime[j];
+  if (m_SetOfFootTrajectoryGenerationObjects[j]!=0)
+    {	      
+      m_SetOfFootTrajectoryGenerationObjects[j]->ComputeAll(aFootAbsolutePosition,deltaj);
+      aFootAbsolutePosition.stepType = m_NatureOfIntervals[j];
+    }
+  ODEBUG("X: " << aFootAbsolutePosition.x << 
+	 " Y: " << aFootAbsolutePosition.y << 
+	 " Z: " << aFootAbsolutePosition.z << 
+	 " Theta: " << aFootAbsolutePosition.theta <<
+	 " Omega: " << aFootAbsolutePosition.omega << 
+	 " stepType: " << aFootAbsolutePosition.stepType << 
+	 " NI: " << m_NatureOfIntervals[j] <<
+	 " interval : " << j);
+  return true;
 }
 
 /*! This method specifies the nature of the interval. 
@@ -112,6 +112,16 @@ namespace PatternGeneratorJRL
 
     /*! \brief Display intervals time. */
     int DisplayIntervals() const;
+
+    /*! \brief Get the index of the interval according to the time.
+      The search starts from the interval found by the previous call
+      and moves forward, so that it is O(1) when time increases monotonically.
+      A binary search is performed if t is before this interval.
+      @param[in] t: the absolute time,
+      @param[out] IndexInterval: the index of the interval containing t.
+      @return false if t is outside the intervals.
+    */
+    bool GetIntervalIndexFromTime(double t, unsigned int & IndexInterval);
     
     /*! @} */
     
@@ -238,6 +248,9 @@ namespace PatternGeneratorJRL
     /*! \brief Sensitivity to numerical unstability when using time. */
     double m_Sensitivity;
 
+    /*! \brief Index of the last interval found by GetIntervalIndexFromTime. */
+    unsigned int m_IntervalCursor;
+
   };
 }
 #endif /* _FOOT_TRAJECTORY_GENERATION_MULTIPLE_H_ */
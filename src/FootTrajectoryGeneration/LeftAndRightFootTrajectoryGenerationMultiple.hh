@@ -104,6 +104,8 @@ namespace PatternGeneratorJRL
 	of the trajectory.
 	@param[out] aFootAbsolutePosition: The data structure to be filled with the information
 	\f$ (x,y,z,\omega, \omega_2, \theta) \f$.
+	The interval is found from the one used by the previous call for the same foot,
+	which is efficient when time increases monotonically.
       */
       bool ComputeAnAbsoluteFootPosition(int LeftOrRight, double time, FootAbsolutePosition & aFootAbsolutePosition);
 
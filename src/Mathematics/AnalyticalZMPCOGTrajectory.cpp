@@ -37,6 +37,7 @@ namespace PatternGeneratorJRL
 
   AnalyticalZMPCOGTrajectory::AnalyticalZMPCOGTrajectory(int lNbOfIntervals)
   {
+    m_IntervalCursor = 0;
     SetNumberOfIntervals(lNbOfIntervals);
     m_AbsoluteTimeReference = 0.0;
     m_Sensitivity = 0.0;
@@ -75,6 +76,7 @@ namespace PatternGeneratorJRL
     m_V.resize(m_NbOfIntervals);
     m_W.resize(m_NbOfIntervals);
     m_DeltaTj.resize(m_NbOfIntervals);
+    UpdateRefTime();
     m_omegaj.resize(m_NbOfIntervals);
     m_PolynomialDegree.resize(m_NbOfIntervals);
     FreePolynomes();
@@ -88,88 +90,82 @@ namespace PatternGeneratorJRL
 
   }
 
+  void AnalyticalZMPCOGTrajectory::UpdateRefTime()
+  {
+    m_RefTime.resize(m_DeltaTj.size());
+    double reftime = 0;
+    for(unsigned int j=0;j<m_DeltaTj.size();j++)
+      {
+	m_RefTime[j] = reftime;
+	reftime += m_DeltaTj[j];
+      }
+    m_IntervalCursor = 0;
+  }
+
   bool AnalyticalZMPCOGTrajectory::ComputeCOM(double t, double &r)
   {
-    t -= m_AbsoluteTimeReference;
     r = -1.0;
-    double reftime=0;
+    unsigned int j;
     ODEBUG(" ====== CoM ====== ");
-    for(unsigned int j=0;j<m_DeltaTj.size();j++)
-      {
-	ODEBUG("t: " << t << " reftime :" << reftime << " Tj["<<j << "]= "<< m_DeltaTj[j]);
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
-	  {
-	    double deltaj=0.0;
-	    deltaj = t-reftime;
-	  
-	    r = cosh(m_omegaj[j]*deltaj) * m_V[j] +
-	      sinh(m_omegaj[j]*deltaj) * m_W[j];
-	    ODEBUG( " coefficients hyperbolique : " << r << \
-		     " m_omegaj["<<j<<"]=" << m_omegaj[j] <<	     \
-		     " deltaj " << deltaj <<		     \
-		     " m_V["<<j<<"]:" << m_V[j] <<		     \
-		     " m_W["<<j<<"]:" << m_W[j] <<
-		     " m_T["<<j<<"]:" << m_DeltaTj[j]);
-	    if (m_ListOfCOGPolynomials[j]!=0)
-	      {
-		double add2r;
-		add2r = m_ListOfCOGPolynomials[j]->Compute(deltaj);
-		ODEBUG( " add2r: " << add2r <<" " \
-			<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
-			<< "Coefficients:"); 
-		//	      m_ListOfCOGPolynomials[j]->print();
-		r+=add2r;
-	      }
-	    else 
-	      return false;
-	    return true;
-	  }
+    if (!GetIntervalIndexFromTime(t,j))
+      return false;
 
-	reftime+=m_DeltaTj[j];
+    double deltaj=0.0;
+    deltaj = t-m_AbsoluteTimeReference-m_RefTime[j];
+	  
+    r = cosh(m_omegaj[j]*deltaj) * m_V[j] +
+      sinh(m_omegaj[j]*deltaj) * m_W[j];
+    ODEBUG( " coefficients hyperbolique : " << r << \
+	    " m_omegaj["<<j<<"]=" << m_omegaj[j] <<	     \
+	    " deltaj " << deltaj <<		     \
+	    " m_V["<<j<<"]:" << m_V[j] <<		     \
+	    " m_W["<<j<<"]:" << m_W[j] <<
+	    " m_T["<<j<<"]:" << m_DeltaTj[j]);
+    if (m_ListOfCOGPolynomials[j]!=0)
+      {
+	double add2r;
+	add2r = m_ListOfCOGPolynomials[j]->Compute(deltaj);
+	ODEBUG( " add2r: " << add2r <<" " \
+		<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
+		<< "Coefficients:"); 
+	r+=add2r;
       }
-    return false;
+    else 
+      return false;
+    return true;
   }
 
  
   bool AnalyticalZMPCOGTrajectory::ComputeCOMSpeed(double t, double &r)
   {
-    t -= m_AbsoluteTimeReference;
     r = -1.0;
-    double reftime=0;
+    unsigned int j;
     ODEBUG(" ====== CoM ====== ");
-    for(unsigned int j=0;j<m_DeltaTj.size();j++)
-      {
-	ODEBUG("t: " << t << " reftime :" << reftime << " Tj["<<j << "]= "<< m_DeltaTj[j]);
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
-	  {
-	    double deltaj=0.0;
-	    deltaj = t-reftime;
-	  
-	    r = m_omegaj[j] * sinh(m_omegaj[j]*deltaj) * m_V[j] +
-	      m_omegaj[j] * cosh(m_omegaj[j]*deltaj) * m_W[j];
-	    ODEBUG( " coefficients hyperbolique : " << r << \
-		    " m_omegaj[j]=" << m_omegaj[j] << \
-		    " deltaj " << deltaj <<  \
-		    " m_V[j]:" << m_V[j] <<  \
-		    " m_W[j]:" << m_W[j] );
-	    if (m_ListOfCOGPolynomials[j]!=0)
-	      {
-		double add2r;
-		add2r = m_ListOfCOGPolynomials[j]->ComputeDerivative(deltaj);
-		ODEBUG( " add2r: " << add2r <<" " \
-			<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
-			<< "Coefficients:"); 
-		//	      m_ListOfCOGPolynomials[j]->print();
-		r+=add2r;
-	      }
-	    else 
-	      return false;
-	    return true;
-	  }
+    if (!GetIntervalIndexFromTime(t,j))
+      return false;
 
-	reftime+=m_DeltaTj[j];
+    double deltaj=0.0;
+    deltaj = t-m_AbsoluteTimeReference-m_RefTime[j];
+	  
+    r = m_omegaj[j] * sinh(m_omegaj[j]*deltaj) * m_V[j] +
+      m_omegaj[j] * cosh(m_omegaj[j]*deltaj) * m_W[j];
+    ODEBUG( " coefficients hyperbolique : " << r << \
+	    " m_omegaj[j]=" << m_omegaj[j] << \
+	    " deltaj " << deltaj <<  \
+	    " m_V[j]:" << m_V[j] <<  \
+	    " m_W[j]:" << m_W[j] );
+    if (m_ListOfCOGPolynomials[j]!=0)
+      {
+	double add2r;
+	add2r = m_ListOfCOGPolynomials[j]->ComputeDerivative(deltaj);
+	ODEBUG( " add2r: " << add2r <<" " \
+		<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
+		<< "Coefficients:"); 
+	r+=add2r;
       }
-    return false;
+    else 
+      return false;
+    return true;
   }
 
   bool AnalyticalZMPCOGTrajectory::ComputeCOM(double t, double &r, int j)
@@ -198,79 +194,57 @@ namespace PatternGeneratorJRL
   bool AnalyticalZMPCOGTrajectory::ComputeZMP(double t, double &r)
   {
     r = -1.0;
-    t -= m_AbsoluteTimeReference;
-    double reftime =0.0;
+    unsigned int j;
     ODEBUG(" ====== ZMP ====== " );
-    for(unsigned int j=0;j<m_DeltaTj.size();j++)
-      {
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
-	  {
-	    double deltaj=0.0;
-	    deltaj = t-reftime;
-	    r = 0;
-	    ODEBUG(" coefficients hyperbolique : " << r << \
-		   " m_omegaj[j]=" << m_omegaj[j] <<	 \
-		   " deltaj " << deltaj <<		 \
-		   " m_V[j]:" << m_V[j] <<		 \
-		   " m_W[j]:" << m_W[j] );
+    if (!GetIntervalIndexFromTime(t,j))
+      return false;
+
+    double deltaj=0.0;
+    deltaj = t-m_AbsoluteTimeReference-m_RefTime[j];
+    r = 0;
+    ODEBUG(" coefficients hyperbolique : " << r << \
+	   " m_omegaj[j]=" << m_omegaj[j] <<	 \
+	   " deltaj " << deltaj <<		 \
+	   " m_V[j]:" << m_V[j] <<		 \
+	   " m_W[j]:" << m_W[j] );
 	  
-	    if (m_ListOfZMPPolynomials[j]!=0)
-	      {
-		double add2r;
-		add2r = m_ListOfZMPPolynomials[j]->Compute(deltaj);
-		ODEBUG( " add2r: " << add2r << " " );
-		ODEBUG("Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")");
-		ODEBUG("Coefficients:"); 
-		//	      m_ListOfZMPPolynomials[j]->print();
-		r+=add2r;	      
-	      }
-	    else 
-	      return false;
-	    return true;
-	  }
-	reftime+=m_DeltaTj[j];
+    if (m_ListOfZMPPolynomials[j]!=0)
+      {
+	double add2r;
+	add2r = m_ListOfZMPPolynomials[j]->Compute(deltaj);
+	ODEBUG( " add2r: " << add2r << " " );
+	ODEBUG("Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")");
+	r+=add2r;	      
       }
-    return false;
+    else 
+      return false;
+    return true;
   }
 
   bool AnalyticalZMPCOGTrajectory::ComputeZMPSpeed(double t, double &r)
   {
     r = -1.0;
-    t -= m_AbsoluteTimeReference;
-    double reftime=0;
+    unsigned int j;
     ODEBUG(" ====== CoM ====== ");
-    for(unsigned int j=0;j<m_DeltaTj.size();j++)
-      {
-	ODEBUG("t: " << t << " reftime :" << reftime << " Tj["<<j << "]= "<< m_DeltaTj[j]);
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[j]+m_Sensitivity))
-	  {
-	    double deltaj=0.0;
-	    deltaj = t-reftime;
-	  
-	    r = 0.0;
-	    ODEBUG( " coefficients hyperbolique : " << r << \
-		    " m_omegaj[j]=" << m_omegaj[j] << \
-		    " deltaj " << deltaj <<  \
-		    " m_V[j]:" << m_V[j] <<  \
-		    " m_W[j]:" << m_W[j] );
-	    if (m_ListOfCOGPolynomials[j]!=0)
-	      {
-		double add2r;
-		add2r = m_ListOfCOGPolynomials[j]->ComputeDerivative(deltaj);
-		ODEBUG( " add2r: " << add2r <<" " \
-			<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
-			<< "Coefficients:"); 
-		//	      m_ListOfCOGPolynomials[j]->print();
-		r+=add2r;
-	      }
-	    else 
-	      return false;
-	    return true;
-	  }
+    if (!GetIntervalIndexFromTime(t,j))
+      return false;
 
-	reftime+=m_DeltaTj[j];
+    double deltaj=0.0;
+    deltaj = t-m_AbsoluteTimeReference-m_RefTime[j];
+	  
+    r = 0.0;
+    if (m_ListOfCOGPolynomials[j]!=0)
+      {
+	double add2r;
+	add2r = m_ListOfCOGPolynomials[j]->ComputeDerivative(deltaj);
+	ODEBUG( " add2r: " << add2r <<" " \
+		<< "Polynomial ("<<j<<") with degree (supposed:"<<  m_PolynomialDegree[j] << ")"<<endl \
+		<< "Coefficients:"); 
+	r+=add2r;
       }
-    return false;
+    else 
+      return false;
+    return true;
   }
 
   bool AnalyticalZMPCOGTrajectory::ComputeZMP(double t, double &r, int j)
@@ -296,13 +270,7 @@ namespace PatternGeneratorJRL
     if ((int)lTj.size()==m_NbOfIntervals)
       {
 	m_DeltaTj = lTj;
-	m_RefTime.resize(lTj.size());
-	double reftime = 0;
-	for(unsigned int j=0;j<m_DeltaTj.size();j++)
-	  {
-	    m_RefTime[j] = reftime;
-	    reftime += m_DeltaTj[j];
-	  }
+	UpdateRefTime();
       }
     else 
       cerr << "Pb while initializing the time intervals. " << lTj.size() << " " << m_NbOfIntervals << endl;
@@ -471,39 +439,51 @@ namespace PatternGeneratorJRL
 
   bool AnalyticalZMPCOGTrajectory::GetIntervalIndexFromTime(double t, unsigned int &j)
   {
-    ODEBUG("Here "<< m_DeltaTj.size());
-    t -= m_AbsoluteTimeReference;
-    double reftime=0;
-    ODEBUG(" ====== CoM ====== ");
-    for(unsigned int lj=0;lj<m_DeltaTj.size();lj++)
-      {
-	ODEBUG("t: " << t << " reftime :" << reftime << " Tj["<<lj << "]= "<< m_DeltaTj[lj]);
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[lj]+m_Sensitivity))
-	  {
-	    j = lj;
-	    return true;
-	  }
-	reftime+=m_DeltaTj[lj];
-      }
-    return false;
+    return GetIntervalIndexFromTime(t,j,m_IntervalCursor);
   }
 
   bool AnalyticalZMPCOGTrajectory::GetIntervalIndexFromTime(double t, unsigned int &j, unsigned int &prev_j)
   {
     t -= m_AbsoluteTimeReference;
-    double reftime=0;
-    ODEBUG(" ====== CoM ====== ");
-    for(unsigned int lj=prev_j;lj<m_DeltaTj.size();lj++)
+    unsigned int lNbOfIntervals = m_RefTime.size();
+    unsigned int lj = prev_j;
+    ODEBUG("t: " << t << " prev_j: " << prev_j << " nb intervals: " << lNbOfIntervals);
+
+    /* An interval j contains t if
+       t+m_Sensitivity >= m_RefTime[j] and t <= m_RefTime[j]+m_DeltaTj[j]+m_Sensitivity.
+       When several intervals contain t, the first one is selected. */
+    if ((lj<lNbOfIntervals) &&
+	((t+m_Sensitivity)>=m_RefTime[lj]) &&
+	((lj==0) || (t>m_RefTime[lj-1]+m_DeltaTj[lj-1]+m_Sensitivity)))
       {
-	ODEBUG("t: " << t << " reftime :" << reftime << " Tj["<<j << "]= "<< m_DeltaTj[j]);
-	if (((t+m_Sensitivity)>=reftime) && (t<=reftime+m_DeltaTj[lj]+m_Sensitivity))
+	/* Time is increasing: move the cursor forward. */
+	while((lj<lNbOfIntervals) &&
+	      (t>m_RefTime[lj]+m_DeltaTj[lj]+m_Sensitivity))
+	  lj++;
+	if (lj==lNbOfIntervals)
+	  return false;
+      }
+    else
+      {
+	/* Random access: binary search of the first interval
+	   ending after t. */
+	unsigned int lower=0, upper=lNbOfIntervals;
+	while(lower<upper)
 	  {
-	    j = lj;
-	    return true;
+	    unsigned int middle = (lower+upper)/2;
+	    if (t>m_RefTime[middle]+m_DeltaTj[middle]+m_Sensitivity)
+	      lower = middle+1;
+	    else
+	      upper = middle;
 	  }
-	reftime+=m_DeltaTj[lj];
+	lj = lower;
+	if ((lj==lNbOfIntervals) ||
+	    ((t+m_Sensitivity)<m_RefTime[lj]))
+	  return false;
       }
-    return false;
+    j = lj;
+    prev_j = lj;
+    return true;
   }
   
   ostream& operator <<(ostream &os,const AnalyticalZMPCOGTrajectory &obj)
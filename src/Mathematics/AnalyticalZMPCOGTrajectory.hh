@@ -215,12 +215,22 @@ namespace PatternGeneratorJRL
       void SetAbsoluteTimeReference(double anAbsoluteTimeReference)
       { m_AbsoluteTimeReference = anAbsoluteTimeReference; }
 
-      /*! \brief Get the index of the interval according to the time. */
+      /*! \brief Get the index of the interval according to the time.
+	The search starts from the interval found by the previous call. */
       bool GetIntervalIndexFromTime(double t, unsigned int &j);
       
       /*! \brief Get the index of the interval according to the time,
-	and the previous value of the interval. */
+	and the previous value of the interval.
+	The search starts from prev_j and moves forward, which is O(1)
+	when the time increases monotonically. If t is before
+	the interval prev_j a binary search is performed.
+	prev_j is updated with the new value of the interval. */
       bool GetIntervalIndexFromTime(double t, unsigned int &j, unsigned int &prev_j);
+
+      /*! \brief Reset the interval cursor used by GetIntervalIndexFromTime
+	and the ComputeXXX(t,r) methods to the first interval. */
+      void ResetIntervalCursor()
+      { m_IntervalCursor = 0; }
       
     protected:
       
@@ -262,6 +272,13 @@ namespace PatternGeneratorJRL
 
       /* \brien Sensitivity to numerical noise. */
       double m_Sensitivity;
+
+      /*! \brief Index of the last interval found, used as a starting point
+	for the next search. */
+      unsigned int m_IntervalCursor;
+
+      /*! \brief Update the reference time of each interval from m_DeltaTj. */
+      void UpdateRefTime();
     };
 
   std::ostream& operator <<(std::ostream &os,const AnalyticalZMPCOGTrajectory &obj);
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+# include <process.h>
+# define getpid _getpid
+#else
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif /* WIN32 */
+
+#include <sstream>
+
+#include <Mathematics/ConstantMatricesCache.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+/*! Magic number and version of the file format. */
+static const char g_Magic[8] = {'J','R','L','W','G','M','C','1'};
+
+/*! Magic number, hash of the key, size of the key, number of arrays
+  and hash of the remaining of the file. */
+static const unsigned int g_HeaderSize = 5*8;
+
+static const unsigned long long g_FNVOffset = 14695981039346656037ULL;
+static const unsigned long long g_FNVPrime = 1099511628211ULL;
+
+ConstantMatricesCache::ConstantMatricesCache(const string & aDirectory,
+					     const string & aPrefix):
+  m_Directory(aDirectory),
+  m_Prefix(aPrefix)
+{
+}
+
+void ConstantMatricesCache::AddToKey(double aValue)
+{
+  m_Key.push_back(aValue);
+}
+
+void ConstantMatricesCache::AddArray(double * anArray, unsigned int aSize)
+{
+  m_Arrays.push_back(anArray);
+  m_Sizes.push_back(aSize);
+}
+
+void ConstantMatricesCache::ClearArrays()
+{
+  m_Arrays.clear();
+  m_Sizes.clear();
+}
+
+string ConstantMatricesCache::DefaultDirectory()
+{
+  const char * lDirectory = getenv("JRL_WALKGEN_CACHE_DIR");
+  if (lDirectory==0)
+    return string("");
+  return string(lDirectory);
+}
+
+unsigned long long ConstantMatricesCache::Hash(const void * aBuffer,
+					       unsigned long long aSize,
+					       unsigned long long aSeed)
+{
+  const unsigned char * lBuffer = (const unsigned char *)aBuffer;
+  unsigned long long r = aSeed;
+  for(unsigned long long i=0;i<aSize;i++)
+    {
+      r ^= lBuffer[i];
+      r *= g_FNVPrime;
+    }
+  return r;
+}
+
+string ConstantMatricesCache::FileName() const
+{
+  unsigned long long lKeyHash =
+    Hash(&m_Key[0],m_Key.size()*sizeof(double),g_FNVOffset);
+  ostringstream oss;
+  oss << m_Directory << "/" << m_Prefix << "-"
+      << hex << lKeyHash << ".bin";
+  return oss.str();
+}
+
+int ConstantMatricesCache::ReadImage(const char * anImage,
+				     unsigned long long aSize)
+{
+  unsigned long long lNbKey = m_Key.size(), lNbArrays = m_Arrays.size();
+  unsigned long long lDataSize = 0;
+  for(unsigned int i=0;i<lNbArrays;i++)
+    lDataSize += m_Sizes[i];
+
+  unsigned long long lExpectedSize = g_HeaderSize +
+    8*(lNbKey + lNbArrays + lDataSize);
+  if (aSize!=lExpectedSize)
+    return -1;
+
+  unsigned long long lHeader[4];
+  memcpy(lHeader,anImage+8,sizeof(lHeader));
+  if ((memcmp(anImage,g_Magic,8)!=0) ||
+      (lHeader[0]!=Hash(&m_Key[0],lNbKey*sizeof(double),g_FNVOffset)) ||
+      (lHeader[1]!=lNbKey) ||
+      (lHeader[2]!=lNbArrays) ||
+      (lHeader[3]!=Hash(anImage+g_HeaderSize,aSize-g_HeaderSize,g_FNVOffset)))
+    return -1;
+
+  // The hash of the key may collide, compare the values.
+  const char * lPtr = anImage+g_HeaderSize;
+  if (memcmp(lPtr,&m_Key[0],lNbKey*sizeof(double))!=0)
+    return -1;
+  lPtr += lNbKey*8;
+
+  for(unsigned int i=0;i<lNbArrays;i++)
+    {
+      unsigned long long lSize;
+      memcpy(&lSize,lPtr,8);
+      if (lSize!=m_Sizes[i])
+	return -1;
+      lPtr += 8;
+    }
+
+  for(unsigned int i=0;i<lNbArrays;i++)
+    {
+      memcpy(m_Arrays[i],lPtr,m_Sizes[i]*sizeof(double));
+      lPtr += m_Sizes[i]*8;
+    }
+  return 0;
+}
+
+int ConstantMatricesCache::Load()
+{
+  if ((!IsEnabled()) || (m_Key.size()==0))
+    return -1;
+
+  string lFileName = FileName();
+  int r=-1;
+
+#ifdef WIN32
+  FILE * fp = fopen(lFileName.c_str(),"rb");
+  if (fp==0)
+    return -1;
+  fseek(fp,0,SEEK_END);
+  long lSize = ftell(fp);
+  fseek(fp,0,SEEK_SET);
+  if (lSize>0)
+    {
+      char * lImage = new char[lSize];
+      if (fread(lImage,1,lSize,fp)==(size_t)lSize)
+	r = ReadImage(lImage,lSize);
+      delete [] lImage;
+    }
+  fclose(fp);
+#else
+  int fd = open(lFileName.c_str(),O_RDONLY);
+  if (fd<0)
+    return -1;
+  struct stat lStat;
+  if ((fstat(fd,&lStat)==0) && (lStat.st_size>0))
+    {
+      void * lImage = mmap(0,lStat.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+      if (lImage!=MAP_FAILED)
+	{
+	  r = ReadImage((const char *)lImage,lStat.st_size);
+	  munmap(lImage,lStat.st_size);
+	}
+    }
+  close(fd);
+#endif /* WIN32 */
+
+  if (r<0)
+    {
+      ODEBUG3("The cache file " << lFileName << " does not match, "
+	      "the matrices are recomputed.");
+    }
+  return r;
+}
+
+int ConstantMatricesCache::Save()
+{
+  if ((!IsEnabled()) || (m_Key.size()==0))
+    return -1;
+
+  // Build the image after the header.
+  unsigned long long lNbKey = m_Key.size(), lNbArrays = m_Arrays.size();
+  vector<double> lBody(m_Key);
+  for(unsigned int i=0;i<lNbArrays;i++)
+    {
+      unsigned long long lSize = m_Sizes[i];
+      double lValue;
+      memcpy(&lValue,&lSize,8);
+      lBody.push_back(lValue);
+    }
+  for(unsigned int i=0;i<lNbArrays;i++)
+    lBody.insert(lBody.end(),m_Arrays[i],m_Arrays[i]+m_Sizes[i]);
+
+  unsigned long long lHeader[4];
+  lHeader[0] = Hash(&m_Key[0],lNbKey*sizeof(double),g_FNVOffset);
+  lHeader[1] = lNbKey;
+  lHeader[2] = lNbArrays;
+  lHeader[3] = Hash(&lBody[0],lBody.size()*sizeof(double),g_FNVOffset);
+
+  // Write in a temporary file and rename it, so that a reader
+  // never sees a partial file.
+  string lFileName = FileName();
+  ostringstream oss;
+  oss << lFileName << "." << getpid() << ".tmp";
+  string lTmpFileName = oss.str();
+
+  FILE * fp = fopen(lTmpFileName.c_str(),"wb");
+  if (fp==0)
+    return -1;
+  bool ok = (fwrite(g_Magic,1,8,fp)==8) &&
+    (fwrite(lHeader,8,4,fp)==4) &&
+    (fwrite(&lBody[0],sizeof(double),lBody.size(),fp)==lBody.size());
+  ok = (fclose(fp)==0) && ok;
+
+#ifdef WIN32
+  if (ok)
+    remove(lFileName.c_str());
+#endif /* WIN32 */
+  if ((!ok) || (rename(lTmpFileName.c_str(),lFileName.c_str())!=0))
+    {
+      remove(lTmpFileName.c_str());
+      return -1;
+    }
+  return 0;
+}
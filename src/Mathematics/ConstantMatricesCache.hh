@@ -0,0 +1,100 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ConstantMatricesCache.hh
+  \brief Persistent binary cache for constant matrices.
+
+  The file is a flat image: a header, the values of the key,
+  the sizes of the arrays and the arrays themselves, all the
+  fields being 8 bytes wide. It is mapped in memory when loaded.
+*/
+
+#ifndef _CONSTANT_MATRICES_CACHE_H_
+#define _CONSTANT_MATRICES_CACHE_H_
+
+#include <string>
+#include <vector>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Store a set of arrays of doubles in a file whose name
+    is derived from a key (the parameters the arrays have been computed
+    from). A file is only accepted if its key, the sizes of the arrays
+    and the hash of its content match. */
+  class ConstantMatricesCache
+  {
+  public:
+    /*! \brief Constructor.
+      @param[in] aDirectory Directory storing the cache files,
+      an empty string disables the cache.
+      @param[in] aPrefix Prefix of the file names. */
+    ConstantMatricesCache(const std::string & aDirectory,
+			  const std::string & aPrefix);
+
+    /*! \brief Add a value to the key. */
+    void AddToKey(double aValue);
+
+    /*! \brief Register an array of \a aSize doubles.
+      The array should be allocated until Load() or Save() is called. */
+    void AddArray(double * anArray, unsigned int aSize);
+
+    /*! \brief Forget the registered arrays, the key is kept. */
+    void ClearArrays();
+
+    /*! \brief Fill the registered arrays from the cache.
+      \return -1 if there is no valid file for the current key. */
+    int Load();
+
+    /*! \brief Store the registered arrays.
+      \return -1 if the file could not be written. */
+    int Save();
+
+    /*! \brief Returns true if a directory has been specified. */
+    bool IsEnabled() const
+    { return m_Directory.size()>0; }
+
+    /*! \brief Name of the file related to the current key. */
+    std::string FileName() const;
+
+    /*! \brief Directory given by the environment variable
+      JRL_WALKGEN_CACHE_DIR, empty if it is not set. */
+    static std::string DefaultDirectory();
+
+  protected:
+    /*! FNV-1a hash of \a aSize bytes. */
+    static unsigned long long Hash(const void * aBuffer,
+				   unsigned long long aSize,
+				   unsigned long long aSeed);
+
+    /*! Check the image of a file and copy the arrays.
+      \return -1 if the image does not match. */
+    int ReadImage(const char * anImage, unsigned long long aSize);
+
+  private:
+    std::string m_Directory, m_Prefix;
+    std::vector<double> m_Key;
+    std::vector<double *> m_Arrays;
+    std::vector<unsigned int> m_Sizes;
+  };
+}
+#endif /* _CONSTANT_MATRICES_CACHE_H_ */
@@ -34,46 +34,36 @@ using namespace std;
 
 namespace PatternGeneratorJRL 
 {
-  CH_Point HRP2CIO_GlobalP0;
-  struct ltCH_Point
-  {
-    bool operator() (const CH_Point & s1, const CH_Point &s2)
-    {
-      double x1,x2,y1,y2;
-      x1 = s1.col - HRP2CIO_GlobalP0.col;
-      x2 = s2.col - HRP2CIO_GlobalP0.col;
-      y1 = s1.row - HRP2CIO_GlobalP0.row;
-      y2 = s2.row - HRP2CIO_GlobalP0.row;
-
-      return (x1*y2 - x2*y1)>0.0;
-    }
-  };
-
-  void DistanceCHRep(CH_Point & s1,CH_Point & s2,
-		     double & distance1, double &distance2)
+  /*! Cross product of (s1-p0) and (s2-p0): positive if s2 comes after s1
+    counter-clockwise around p0. */
+  static double CompareCBRep(const CH_Point & p0,
+			     const CH_Point & s1,const CH_Point &s2)
   {
     double x1,x2,y1,y2;
-    x1 = s1.col - HRP2CIO_GlobalP0.col;
-    x2 = s2.col - HRP2CIO_GlobalP0.col;
-    y1 = s1.row - HRP2CIO_GlobalP0.row;
-    y2 = s2.row - HRP2CIO_GlobalP0.row;
-    
-    distance1 = sqrt(x1*x1 + y1*y1);
-    distance2 = sqrt(x2*x2 + y2*y2);
+    x1 = s1.col - p0.col;
+    x2 = s2.col - p0.col;
+    y1 = s1.row - p0.row;
+    y2 = s2.row - p0.row;
     
+    return (x1*y2 - x2*y1);
   }
 
-  double CompareCBRep(CH_Point & s1,CH_Point &s2)
+  /*! Squared distance from p0. */
+  static double DistanceCHRep(const CH_Point & p0,const CH_Point & s1)
   {
-    double x1,x2,y1,y2;
-    x1 = s1.col - HRP2CIO_GlobalP0.col;
-    x2 = s2.col - HRP2CIO_GlobalP0.col;
-    y1 = s1.row - HRP2CIO_GlobalP0.row;
-    y2 = s2.row - HRP2CIO_GlobalP0.row;
-    
-    return (x1*y2 - x2*y1);
+    double x1,y1;
+    x1 = s1.col - p0.col;
+    y1 = s1.row - p0.row;
+    return x1*x1 + y1*y1;
   }
 
+  /*! Graham's scan of Points into TheConvexHull, 
+    lSorted being a buffer of NbPoints points. */
+  static unsigned int GrahamScan(const CH_Point *Points,
+				 unsigned int NbPoints,
+				 CH_Point *TheConvexHull,
+				 CH_Point *lSorted);
+
   ComputeConvexHull::ComputeConvexHull()
   {
     
@@ -84,122 +74,106 @@ namespace PatternGeneratorJRL
     
   }
   
-  void ComputeConvexHull::DoComputeConvexHull(vector <CH_Point> aVecOfPoints,
+  void ComputeConvexHull::DoComputeConvexHull(const vector <CH_Point> & aVecOfPoints,
 				     vector <CH_Point> & TheConvexHull)
   {
-  
     if (aVecOfPoints.size()==0)
       return;
 
-    CH_Point p0 = aVecOfPoints[0];
+    vector<CH_Point> lHull(aVecOfPoints.size()), lSorted(aVecOfPoints.size());
+    unsigned int lNbHull = GrahamScan(&aVecOfPoints[0],aVecOfPoints.size(),
+				      &lHull[0],&lSorted[0]);
+    TheConvexHull.insert(TheConvexHull.end(),lHull.begin(),lHull.begin()+lNbHull);
+  }
 
-    // Detects the point with the smallest value for y.
-    for(unsigned int i=0;i<aVecOfPoints.size();i++)
-      if (aVecOfPoints[i].row < p0.row)
-	p0 = aVecOfPoints[i];
-  
-  
-    HRP2CIO_GlobalP0 = p0;
-    // Create the list of pixels sortes according to their
-    // polar coordinates regarding p0.
+  unsigned int ComputeConvexHull::DoComputeConvexHull(const CH_Point *Points,
+						      unsigned int NbPoints,
+						      CH_Point *TheConvexHull) const
+  {
+    if ((NbPoints==0) || (NbPoints>MaxNbPoints))
+      return 0;
+
+    CH_Point lSorted[MaxNbPoints];
+    return GrahamScan(Points,NbPoints,TheConvexHull,lSorted);
+  }
 
-    ODEBUG2(" VecOfPoints : " << aVecOfPoints.size());
-    set<CH_Point, ltCH_Point> ListOfPointinPolarCoord;
-    for(unsigned int i=0;i<aVecOfPoints.size();i++)
-      { 
-	unsigned char bInsert=1;
+  static unsigned int GrahamScan(const CH_Point *Points,
+				 unsigned int NbPoints,
+				 CH_Point *TheConvexHull,
+				 CH_Point *lSorted)
+  {
+    CH_Point p0 = Points[0];
 
-	// Check if the current point already exist with the same angle.
-	// Cannot use find because of some pb with gcc version 2.95.
-	set<CH_Point, ltCH_Point>::iterator it_PtinPolarCoord;
-      
-	it_PtinPolarCoord = ListOfPointinPolarCoord.begin();
-	while (it_PtinPolarCoord!=ListOfPointinPolarCoord.end())
+    // Detects the point with the smallest value for y.
+    for(unsigned int i=0;i<NbPoints;i++)
+      if (Points[i].row < p0.row)
+	p0 = Points[i];
+  
+    // Sort the points according to their polar angle regarding p0
+    // (insertion sort, the sets are small). Among points with the
+    // same angle only the farthest is kept. p0 itself is aligned 
+    // with every point, so it is never kept.
+    unsigned int lNbSorted=0;
+    for(unsigned int i=0;i<NbPoints;i++)
+      {
+	const CH_Point & pi = Points[i];
+	bool bInsert = true;
+	unsigned int k=0;
+	while(k<lNbSorted)
 	  {
-	    bool ToBeDeleted = false;
-	    CH_Point Current = *it_PtinPolarCoord;
-	    if (CompareCBRep(Current,aVecOfPoints[i])==0.0)
+	    if (CompareCBRep(p0,lSorted[k],pi)==0.0)
 	      {
-		double distance1, distance2;
-		DistanceCHRep(Current,aVecOfPoints[i],
-			      distance1, distance2);
-		if (distance1<=distance2)
-		  ToBeDeleted = true;
-		else 
-		  bInsert=0;
+		if (DistanceCHRep(p0,lSorted[k])<=DistanceCHRep(p0,pi))
+		  {
+		    for(unsigned int l=k+1;l<lNbSorted;l++)
+		      lSorted[l-1] = lSorted[l];
+		    lNbSorted--;
+		    continue;
+		  }
+		else
+		  bInsert = false;
 	      }
-	    set<CH_Point, ltCH_Point>::iterator it_ToBeDeleted = it_PtinPolarCoord;
-
-	    it_PtinPolarCoord++;
-	    if(ToBeDeleted)
-	      ListOfPointinPolarCoord.erase(it_ToBeDeleted);
-	    
+	    k++;
 	  }
+	if (!bInsert)
+	  continue;
 
-	if (bInsert)
+	unsigned int lPos=lNbSorted;
+	while((lPos>0) && (CompareCBRep(p0,pi,lSorted[lPos-1])>0.0))
 	  {
-	    ListOfPointinPolarCoord.insert(aVecOfPoints[i]);
+	    lSorted[lPos] = lSorted[lPos-1];
+	    lPos--;
 	  }
-      
+	lSorted[lPos] = pi;
+	lNbSorted++;
       }
 
-    // Apply the Graham's scan in O(n log n)
-
-    // Creates the stack.
-
-    set<CH_Point, ltCH_Point>::iterator it_LPPC;
-    ODEBUG2( "LPPC: " <<ListOfPointinPolarCoord.size());
-
-
-    it_LPPC = ListOfPointinPolarCoord.begin();
-    TheConvexHull.insert(TheConvexHull.end(),p0);
-    TheConvexHull.insert(TheConvexHull.end(),(*it_LPPC));
-    it_LPPC++;
-    TheConvexHull.insert(TheConvexHull.end(),(*it_LPPC));
-    it_LPPC++;
+    ODEBUG2( "LPPC: " << lNbSorted);
 
-
-    // Create the convex hull.
-    while(it_LPPC!=ListOfPointinPolarCoord.end())
+    // Apply the Graham's scan, the convex hull being the stack.
+    unsigned int lNbHull=0;
+    TheConvexHull[lNbHull++] = p0;
+    for(unsigned int i=0;i<lNbSorted;i++)
       {
-	CH_Point pi = *it_LPPC;
-	unsigned char ok=0;
-	double x1,x2,y1,y2;
-	CH_Point s1;
-	CH_Point s2;
-
-	do
+	const CH_Point & pi = lSorted[i];
+	if (i>=2)
 	  {
-	    if (TheConvexHull.size()>=2)
+	    while (lNbHull>=2)
 	      {
-		s1 = TheConvexHull[TheConvexHull.size()-1];
-		s2 = TheConvexHull[TheConvexHull.size()-2];
-	      
-		x1 = s1.col - s2.col;
-		x2 = pi.col - s2.col;
-		y1 = s1.row - s2.row;
-		y2 = pi.row - s2.row;
-	  
-		if ((x1*y2 - x2*y1)>0.0)
-		  ok = 1;
-		else 
-		  ok = 0;
+		const CH_Point & s1 = TheConvexHull[lNbHull-1];
+		const CH_Point & s2 = TheConvexHull[lNbHull-2];
+		double x1 = s1.col - s2.col;
+		double x2 = pi.col - s2.col;
+		double y1 = s1.row - s2.row;
+		double y2 = pi.row - s2.row;
 		
+		if ((x1*y2 - x2*y1)>0.0)
+		  break;
+		lNbHull--;
 	      }
-	    else 
-	      {
-		ok=1;
-	      }
-
-	    if (!ok)
-	      TheConvexHull.pop_back();
 	  }
-	while(!ok);
-      
-      
-	TheConvexHull.push_back(*it_LPPC);
-	it_LPPC++;
+	TheConvexHull[lNbHull++] = pi;
       }
-  
+    return lNbHull;
   }
 }
@@ -54,8 +54,21 @@ namespace PatternGeneratorJRL
       by applying Graham's algorithm. 
     @param aVecOfPoints: The set of 2D points on which the convex hull is computed. 
     @param TheConvexHull: The set of 2D points which give the convex hull. */
-    void DoComputeConvexHull(std::vector<CH_Point> aVecOfPoints,
+    void DoComputeConvexHull(const std::vector<CH_Point> &aVecOfPoints,
 		      std::vector<CH_Point> &TheConvexHull);
+
+    /*! Same as above on fixed-size arrays, without any allocation.
+    @param Points: The set of 2D points on which the convex hull is computed.
+    @param NbPoints: The number of points, nothing is done above MaxNbPoints.
+    @param TheConvexHull: The points of the convex hull, counter-clockwise
+    starting from the point with the smallest y. It should hold NbPoints points.
+    @return The number of points of the convex hull. */
+    unsigned int DoComputeConvexHull(const CH_Point *Points,
+				     unsigned int NbPoints,
+				     CH_Point *TheConvexHull) const;
+
+    /*! Maximal number of points handled by the array version. */
+    static const unsigned int MaxNbPoints=32;
     
   };
 }
@@ -46,6 +46,11 @@ FootConstraintsAsLinearSystem::FootConstraintsAsLinearSystem(SimplePluginManager
 {
   m_HS = aHS;
   //RESETDEBUG5("Constraints-FCSALS.dat");
+
+  for(unsigned int i=0;i<4;i++)
+    m_CachedHalfSizes[i] = 0.0;
+  m_PositionQuantum = 1e-8;
+  m_OrientationQuantum = 1e-6;
 }
 
 FootConstraintsAsLinearSystem::~FootConstraintsAsLinearSystem()
@@ -94,16 +99,62 @@ int FootConstraintsAsLinearSystem::FindSimilarConstraints(MAL_MATRIX(&A,double),
 // Assuming that the points are going counter-clockwise
 // and that the foot's interior is at the left of the points.
 // The result is : A [ Zx(k), Zy(k)]' + B  >=0
-int FootConstraintsAsLinearSystem::ComputeLinearSystem(vector<CH_Point> aVecOfPoints, 
+int FootConstraintsAsLinearSystem::ComputeLinearSystem(const vector<CH_Point> &aVecOfPoints, 
 						       MAL_MATRIX(&A,double),
 						       MAL_MATRIX(&B,double),
 						       MAL_VECTOR(&C,double))
 {
-  double a,b,c;
-  unsigned int n = aVecOfPoints.size();
-  MAL_MATRIX_RESIZE(A,aVecOfPoints.size(),2);
-  MAL_MATRIX_RESIZE(B,aVecOfPoints.size(),1);
+  if (aVecOfPoints.size()==0)
+    return -1;
+  return ComputeLinearSystem(&aVecOfPoints[0],aVecOfPoints.size(),A,B,C);
+}
+
+int FootConstraintsAsLinearSystem::ComputeLinearSystem(const CH_Point *Points,
+						       unsigned int n,
+						       MAL_MATRIX(&A,double),
+						       MAL_MATRIX(&B,double),
+						       MAL_VECTOR(&C,double))
+{
+  if (n==0)
+    return -1;
+
+  // The buffers are on the stack up to MaxNbPoints points,
+  // allocated above.
+  const unsigned int lMaxNbPoints = ComputeConvexHull::MaxNbPoints;
+  double lStackA[2*lMaxNbPoints], lStackB[lMaxNbPoints], lC[2];
+  vector<double> lHeapA, lHeapB;
+  double * lA = lStackA, * lB = lStackB;
+  if (n>lMaxNbPoints)
+    {
+      lHeapA.resize(2*n);
+      lHeapB.resize(n);
+      lA = &lHeapA[0];
+      lB = &lHeapB[0];
+    }
+  int r = ComputeLinearSystem(Points,n,lA,lB,lC);
+
+  MAL_MATRIX_RESIZE(A,n,2);
+  MAL_MATRIX_RESIZE(B,n,1);
   MAL_VECTOR_RESIZE(C,2);
+  for(unsigned int i=0;i<n;i++)
+    {
+      A(i,0) = lA[2*i]; A(i,1) = lA[2*i+1];
+      B(i,0) = lB[i];
+    }
+  C(0) = lC[0]; C(1) = lC[1];
+
+  ODEBUG("A: " << A );
+  ODEBUG("B: " << B);
+  return r;
+}
+
+int FootConstraintsAsLinearSystem::ComputeLinearSystem(const CH_Point *aVecOfPoints,
+						       unsigned int n,
+						       double *A,
+						       double *B,
+						       double *C) const
+{
+  double a,b,c;
 
   // Dump a file to display on scilab .
   // This should be removed during real usage inside a robot.
@@ -111,48 +162,55 @@ int FootConstraintsAsLinearSystem::ComputeLinearSystem(vector<CH_Point> aVecOfPo
     {
       ofstream aof;
       aof.open("Constraints-FCSALS.dat",ofstream::app);
-      for(unsigned int i=0;i<n-1;i++)
+      for(unsigned int i=0;i<n;i++)
 	{
+	  unsigned int j = (i+1)%n;
 	  aof << aVecOfPoints[i].col << " " <<  aVecOfPoints[i].row << " "
-	      << aVecOfPoints[i+1].col << " "  << aVecOfPoints[i+1].row << endl;
+	      << aVecOfPoints[j].col << " "  << aVecOfPoints[j].row << endl;
 	}
-      aof << aVecOfPoints[n-1].col << " " <<  aVecOfPoints[n-1].row << " "
-	  << aVecOfPoints[0].col << " "  << aVecOfPoints[0].row << endl;
       aof.close();
     }
-  
-  for(unsigned int i=0;i<n-1;i++)
+
+  C[0] = 0.0; C[1] = 0.0;
+  for(unsigned int i=0;i<n;i++)
     {
+      // The last edge closes the polygon.
+      unsigned int j = (i+1)%n;
+      
       // Compute center of the convex hull.
-      C(0)+= aVecOfPoints[i].col;
-      C(1)+= aVecOfPoints[i].row;
+      C[0]+= aVecOfPoints[i].col;
+      C[1]+= aVecOfPoints[i].row;
 	
       ODEBUG("(x["<< i << "],y["<<i << "]): " << aVecOfPoints[i].col << " " <<  aVecOfPoints[i].row << " "
-	     << aVecOfPoints[i+1].col << " "  << aVecOfPoints[i+1].row );
+	     << aVecOfPoints[j].col << " "  << aVecOfPoints[j].row );
 
-      if (fabs(aVecOfPoints[i+1].col-aVecOfPoints[i].col)>1e-7)
+      if (fabs(aVecOfPoints[j].col-aVecOfPoints[i].col)>1e-7)
 	{
 	  double y1,x1,y2,x2,lmul=-1.0;
 
-	  if (aVecOfPoints[i+1].col < aVecOfPoints[i].col)
+	  if (aVecOfPoints[j].col < aVecOfPoints[i].col)
 	    {
 	      lmul=1.0;
 	      y2 = aVecOfPoints[i].row;
-	      y1 = aVecOfPoints[i+1].row;
+	      y1 = aVecOfPoints[j].row;
 	      x2 = aVecOfPoints[i].col;
-	      x1 = aVecOfPoints[i+1].col;
+	      x1 = aVecOfPoints[j].col;
 	    }
 	  else
 	    {
-	      y2 = aVecOfPoints[i+1].row;
+	      y2 = aVecOfPoints[j].row;
 	      y1 = aVecOfPoints[i].row;
-	      x2 = aVecOfPoints[i+1].col;
+	      x2 = aVecOfPoints[j].col;
 	      x1 = aVecOfPoints[i].col;	 
 	    }
 	  
 	  
 	  a = (y2 - y1)/(x2-x1) ;
-	  b = (aVecOfPoints[i].row - a * aVecOfPoints[i].col);
+	  // The closing edge is expressed from its end point.
+	  if (j==0)
+	    b = (aVecOfPoints[0].row - a * aVecOfPoints[0].col);
+	  else
+	    b = (aVecOfPoints[i].row - a * aVecOfPoints[i].col);
 
 	  a = lmul*a;
 	  b = lmul*b;
@@ -164,8 +222,8 @@ int FootConstraintsAsLinearSystem::ComputeLinearSystem(vector<CH_Point> aVecOfPo
 	{
 	  c = 0.0;
 	  a = -1.0;	  
-	  b = aVecOfPoints[i+1].col;
-	  if (aVecOfPoints[i+1].row < aVecOfPoints[i].row)
+	  b = aVecOfPoints[j].col;
+	  if (aVecOfPoints[j].row < aVecOfPoints[i].row)
 	    {
 	      a=-a;
 	      b=-b;
@@ -173,86 +231,118 @@ int FootConstraintsAsLinearSystem::ComputeLinearSystem(vector<CH_Point> aVecOfPo
 	}
       
       
-      A(i,0) = a; A(i,1)= c;
-      B(i,0) = b;
+      A[2*i] = a; A[2*i+1]= c;
+      B[i] = b;
 
     }
 
-  // Compute center of the convex hull.
-  C(0)+= aVecOfPoints[n-1].col;
-  C(1)+= aVecOfPoints[n-1].row;
+  C[0] /= (double)n;
+  C[1] /= (double)n;
 
-  C(0) /= (double)n;
-  C(1) /= (double)n;
-
-
-  ODEBUG("(x["<< n-1 << "],y["<< n-1 << "]): " << aVecOfPoints[n-1].col << " " <<  aVecOfPoints[n-1].row << " "
-	 << aVecOfPoints[0].col << " "  << aVecOfPoints[0].row );
-  
-  if (fabs(aVecOfPoints[0].col-aVecOfPoints[n-1].col)>1e-7)
+  // Verification of inclusion of the center inside the polytope.
+  if (n>=2)
     {
-      double y1,x1,y2,x2,lmul=-1.0;
-      
-      if (aVecOfPoints[0].col < aVecOfPoints[n-1].col)
-	{
-	  lmul=1.0;
-	  y2 = aVecOfPoints[n-1].row;
-	  y1 = aVecOfPoints[0].row;
-	  x2 = aVecOfPoints[n-1].col;
-	  x1 = aVecOfPoints[0].col;
-	}
-      else
+      double W0 = A[0]*C[0] + A[1]*C[1] + B[0];
+      double W1 = A[2]*C[0] + A[3]*C[1] + B[1];
+      if ((W0<0) || (W1<0))
 	{
-	  y2 = aVecOfPoints[0].row;
-	  y1 = aVecOfPoints[n-1].row;
-	  x2 = aVecOfPoints[0].col;
-	  x1 = aVecOfPoints[n-1].col;
-	  
+	  ODEBUG3("Linear system ill-computed.");
+	  ODEBUG3("Stop.");
+	  return -1;
 	}
-      
-      
-      a = (y2 - y1)/(x2-x1) ;
-      b = (aVecOfPoints[0].row - a * aVecOfPoints[0].col);
-      
-      a = lmul*a;
-      b = lmul*b;
-      c= -lmul;
-      
     }
-  else
+  
+  return 0;
+}
+
+bool FootConstraintsAsLinearSystem::SupportPolygonKey_s::
+operator<(const SupportPolygonKey_s & aKey) const
+{
+  if (Type!=aKey.Type)
+    return Type<aKey.Type;
+  if (dx!=aKey.dx)
+    return dx<aKey.dx;
+  if (dy!=aKey.dy)
+    return dy<aKey.dy;
+  return dtheta<aKey.dtheta;
+}
+
+const FootConstraintsAsLinearSystem::SupportPolygon_t & 
+FootConstraintsAsLinearSystem::LocalSupportPolygon(SupportType_e aType,
+						   const FootAbsolutePosition & LeftFoot,
+						   const FootAbsolutePosition & RightFoot,
+						   const double HalfSizes[4])
+{
+  // The polygons depend on the size of the feet.
+  bool SameSizes = true;
+  for(unsigned int i=0;i<4;i++)
+    SameSizes = SameSizes && (HalfSizes[i]==m_CachedHalfSizes[i]);
+  if ((!SameSizes) || (m_SupportPolygons.size()>1024))
     {
-      c = 0.0;
-      a = -1.0;	  
-      b = aVecOfPoints[0].col;
-      if (aVecOfPoints[0].row < aVecOfPoints[n-1].row)
-	{
-	  a=-a;
-	  b=-b;
-	}
+      m_SupportPolygons.clear();
+      for(unsigned int i=0;i<4;i++)
+	m_CachedHalfSizes[i] = HalfSizes[i];
     }
 
-  
-  A(n-1,0) = a; A(n-1,1)= c;
-  B(n-1,0) = b;
-  
-  // Verification of inclusion of the center inside the polytope.
-  MAL_VECTOR_DIM(W,double,2);  
-  W = MAL_RET_A_by_B(A,C);
+  double lxcoefs[4] = { 1.0, 1.0, -1.0, -1.0};
+  double lycoefs[4] = {-1.0, 1.0,  1.0, -1.0};
+
+  SupportPolygonKey_t aKey;
+  aKey.Type = aType;
+  aKey.dx = aKey.dy = aKey.dtheta = 0;
+  double dx=0.0, dy=0.0, dtheta=0.0;
+  if (aType==DOUBLE_SUPPORT)
+    {
+      // Pose of the right foot in the frame of the left foot.
+      double s_t = sin(LeftFoot.theta*M_PI/180.0);
+      double c_t = cos(LeftFoot.theta*M_PI/180.0);
+      double lx = RightFoot.x - LeftFoot.x;
+      double ly = RightFoot.y - LeftFoot.y;
+      aKey.dx = (long)floor((c_t*lx + s_t*ly)/m_PositionQuantum+0.5);
+      aKey.dy = (long)floor((-s_t*lx + c_t*ly)/m_PositionQuantum+0.5);
+      aKey.dtheta = (long)floor((RightFoot.theta - LeftFoot.theta)/
+				m_OrientationQuantum+0.5);
+      dx = aKey.dx*m_PositionQuantum;
+      dy = aKey.dy*m_PositionQuantum;
+      dtheta = aKey.dtheta*m_OrientationQuantum;
+    }
 
-  W(0) = W(0) + B(0,0);
-  W(1) = W(1) + B(1,0);
+  std::map<SupportPolygonKey_t, SupportPolygon_t>::iterator it =
+    m_SupportPolygons.find(aKey);
+  if (it!=m_SupportPolygons.end())
+    return it->second;
 
-  if ((W(0)<0) || (W(1)<0))
+  SupportPolygon_t & aPolygon = m_SupportPolygons[aKey];
+  if (aType==DOUBLE_SUPPORT)
+    {
+      // The quantized pose is used so that the polygon does not
+      // depend on the configuration which filled the cache.
+      CH_Point lPoints[8];
+      double s_t = sin(dtheta*M_PI/180.0);
+      double c_t = cos(dtheta*M_PI/180.0);
+      for(unsigned j=0;j<4;j++)
+	{
+	  lPoints[j].col = lxcoefs[j] * HalfSizes[0];
+	  lPoints[j].row = lycoefs[j] * HalfSizes[1];
+	  lPoints[j+4].col = dx + ( lxcoefs[j] * HalfSizes[2] * c_t 
+				    - lycoefs[j] * HalfSizes[3] * s_t );
+	  lPoints[j+4].row = dy + ( lxcoefs[j] * HalfSizes[2] * s_t 
+				    + lycoefs[j] * HalfSizes[3] * c_t );
+	}
+      ComputeConvexHull aCH;
+      aPolygon.NbVertices = aCH.DoComputeConvexHull(lPoints,8,aPolygon.Vertices);
+    }
+  else
     {
-      ODEBUG3("Linear system ill-computed.");
-      ODEBUG3("Stop.");
-      return -1;
+      unsigned int lOffset = (aType==LEFT_SUPPORT) ? 0 : 2;
+      for(unsigned j=0;j<4;j++)
+	{
+	  aPolygon.Vertices[j].col = lxcoefs[j] * HalfSizes[lOffset];
+	  aPolygon.Vertices[j].row = lycoefs[j] * HalfSizes[lOffset+1];
+	}
+      aPolygon.NbVertices = 4;
     }
-  
-  ODEBUG("A: " << A );
-  ODEBUG("B: " << B);
-      
-  return 0;
+  return aPolygon;
 }
 
 int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootAbsolutePosition> 
@@ -266,7 +356,6 @@ int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootA
 {
   // Find the convex hull for each of the position,
   // in order to create the corresponding trajectory.
-  ComputeConvexHull aCH;
   double lLeftFootHalfWidth,lLeftFootHalfHeight,
     lRightFootHalfWidth,lRightFootHalfHeight,lZ;
   
@@ -290,6 +379,9 @@ int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootA
 
   lLeftFootHalfWidth -= ConstraintOnX;
   lRightFootHalfWidth -= ConstraintOnX;
+
+  double lHalfSizes[4] = { lLeftFootHalfWidth, lLeftFootHalfHeight,
+			   lRightFootHalfWidth, lRightFootHalfHeight };
   
   if (LeftFootAbsolutePositions.size()!=
       RightFootAbsolutePositions.size())
@@ -299,8 +391,6 @@ int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootA
   // 3: Double Support.
   int ComputeCH=0;
   double lx=0.0, ly=0.0;
-  double lxcoefs[4] = { 1.0, 1.0, -1.0, -1.0};
-  double lycoefs[4] = {-1.0, 1.0,  1.0, -1.0};
   double prev_xmin=1e7, prev_xmax=-1e7, prev_ymin=1e7, prev_ymax=-1e7;
   RESETDEBUG4("ConstraintMax.dat");
 
@@ -361,135 +451,87 @@ int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootA
 	  ODEBUG("RightFootAbsolutePositions[" << i << " ].theta= " << 
 		  RightFootAbsolutePositions[i].theta);
 	      
-	  vector<CH_Point> TheConvexHull;
 	  // Check if we are in a single or double support phase,
 	  // by testing the step type. In double support phase
 	  // the value is greater than or equal to 10.
-	  // In this case, we have to compute the convex hull
-	  // of both feet.
+	  // In this case, the support polygon is the convex hull
+	  // of both feet, expressed in the frame of the left foot.
+	  // Otherwise it is the support foot.
+	  FootAbsolutePosition * lReferenceFoot;
+	  SupportType_e lSupportType;
 	  if (State==3)
 	    {
-	      vector<CH_Point> aVecOfPoints;
-	      
-	      aVecOfPoints.resize(8);
-
-	      lx=LeftFootAbsolutePositions[i].x;
-	      ly=LeftFootAbsolutePositions[i].y;
-	      
-	      s_t = sin(LeftFootAbsolutePositions[i].theta*M_PI/180.0); 
-	      c_t = cos(LeftFootAbsolutePositions[i].theta*M_PI/180.0);  
-	      for(unsigned j=0;j<4;j++)
-		{
-		  aVecOfPoints[j].col = lx + ( lxcoefs[j] * lLeftFootHalfWidth 
-					       * c_t 
-					       - lycoefs[j] * 
-					       lLeftFootHalfHeight * s_t );
-		  aVecOfPoints[j].row = ly + ( lxcoefs[j] * lLeftFootHalfWidth 
-					       * s_t 
-					       + lycoefs[j] * 
-					       lLeftFootHalfHeight * c_t );
-
-
-		  // Computes the maxima.
-		  xmin = aVecOfPoints[j].col < xmin ? aVecOfPoints[j].col : xmin;
-		  xmax = aVecOfPoints[j].col > xmax ? aVecOfPoints[j].col : xmax;
-		  ymin = aVecOfPoints[j].row < ymin ? aVecOfPoints[j].row : ymin;
-		  ymax = aVecOfPoints[j].row > ymax ? aVecOfPoints[j].row : ymax;
-		  
-		}
-	      ODEBUG("State 3-1 " << xmin << " " << xmax << " " << ymin << " " << ymax);
-	      lx=RightFootAbsolutePositions[i].x;
-	      ly=RightFootAbsolutePositions[i].y;
+	      lSupportType = DOUBLE_SUPPORT;
+	      lReferenceFoot = &LeftFootAbsolutePositions[i];
+	    }
+	  // Who is support foot ?
+	  else if (LeftFootAbsolutePositions[i].z < RightFootAbsolutePositions[i].z)
+	    {
+	      lSupportType = LEFT_SUPPORT;
+	      lReferenceFoot = &LeftFootAbsolutePositions[i];
+	      ODEBUG("Left support foot");
+	    }
+	  else
+	    {
+	      lSupportType = RIGHT_SUPPORT;
+	      lReferenceFoot = &RightFootAbsolutePositions[i];
+	      ODEBUG("Right support foot");
+	    }
 
+	  // The polygon only depends on the relative position of the feet,
+	  // so it is taken from the cache and moved to the reference foot.
+	  const SupportPolygon_t & aPolygon = 
+	    LocalSupportPolygon(lSupportType,
+				LeftFootAbsolutePositions[i],
+				RightFootAbsolutePositions[i],
+				lHalfSizes);
+
+	  CH_Point TheConvexHull[8];
+	  unsigned int lNbVertices = aPolygon.NbVertices;
+	  lx=lReferenceFoot->x;
+	  ly=lReferenceFoot->y;
+	  s_t = sin(lReferenceFoot->theta*M_PI/180.0); 
+	  c_t = cos(lReferenceFoot->theta*M_PI/180.0);
+
+	  // As the convex hull computation does, the polygon 
+	  // of the double support starts from its lowest point.
+	  unsigned int lFirst=0;
+	  double lLowest=1e7;
+	  for(unsigned j=0;j<lNbVertices;j++)
+	    {
+	      const CH_Point & lVertex = aPolygon.Vertices[j];
+	      TheConvexHull[j].col = lx + 
+		( lVertex.col * c_t - lVertex.row * s_t ); 
+	      TheConvexHull[j].row = ly + 
+		( lVertex.col * s_t + lVertex.row * c_t ); 
 	      
-	      s_t = sin(RightFootAbsolutePositions[i].theta*M_PI/180.0); //+
-	      c_t = cos(RightFootAbsolutePositions[i].theta*M_PI/180.0); //+ 
-	      
-	      ODEBUG("Right Foot: " << lx << " " << ly << " " << RightFootAbsolutePositions[i].theta);
-	      for(unsigned j=0;j<4;j++)
+	      if (TheConvexHull[j].row < lLowest)
 		{
-		  aVecOfPoints[j+4].col = lx + ( lxcoefs[j] * lRightFootHalfWidth
-						 * c_t - lycoefs[j] * 
-						 lRightFootHalfHeight * s_t ); 
-		  aVecOfPoints[j+4].row = ly + ( lxcoefs[j] * lRightFootHalfWidth
-						 * s_t + lycoefs[j] * 
-						 lRightFootHalfHeight * c_t );  
-		  // Computes the maxima.
-		  xmin = aVecOfPoints[j+4].col < xmin ? aVecOfPoints[j+4].col : xmin;
-		  xmax = aVecOfPoints[j+4].col > xmax ? aVecOfPoints[j+4].col : xmax;
-		  ymin = aVecOfPoints[j+4].row < ymin ? aVecOfPoints[j+4].row : ymin;
-		  ymax = aVecOfPoints[j+4].row > ymax ? aVecOfPoints[j+4].row : ymax;
-		  
+		  lLowest = TheConvexHull[j].row;
+		  lFirst = j;
 		}
 
-	      ODEBUG("State 3-2" << xmin << " " << xmax << " " << ymin << " " << ymax);
-	      aCH.DoComputeConvexHull(aVecOfPoints,TheConvexHull);
+	      // Computes the maxima.
+	      xmin = TheConvexHull[j].col < xmin ? TheConvexHull[j].col : xmin;
+	      xmax = TheConvexHull[j].col > xmax ? TheConvexHull[j].col : xmax;
+	      ymin = TheConvexHull[j].row < ymin ? TheConvexHull[j].row : ymin;
+	      ymax = TheConvexHull[j].row > ymax ? TheConvexHull[j].row : ymax;
 	    }
-	  // In the second case, it is necessary to compute 
-	  // the support foot.
-	  else
+	  if ((lSupportType==DOUBLE_SUPPORT) && (lFirst!=0))
 	    {
-	      
-	      TheConvexHull.resize(4);
-	      
-	      // Who is support foot ?
-	      if (LeftFootAbsolutePositions[i].z < RightFootAbsolutePositions[i].z)
-		{
-		  lx=LeftFootAbsolutePositions[i].x;
-		  ly=LeftFootAbsolutePositions[i].y;
-		  
-		  s_t = sin(LeftFootAbsolutePositions[i].theta*M_PI/180.0); 
-		  c_t = cos(LeftFootAbsolutePositions[i].theta*M_PI/180.0);
- 		  for(unsigned j=0;j<4;j++)
-		    {
-		      TheConvexHull[j].col = lx + 
-			( lxcoefs[j] * lLeftFootHalfWidth * c_t -
-			  lycoefs[j] * lLeftFootHalfHeight * s_t ); 
-		      TheConvexHull[j].row = ly + 
-			( lxcoefs[j] * lLeftFootHalfWidth * s_t + 
-			  lycoefs[j] * lLeftFootHalfHeight * c_t ); 
-		      // Computes the maxima.
-		      xmin = TheConvexHull[j].col < xmin ? TheConvexHull[j].col : xmin;
-		      xmax = TheConvexHull[j].col > xmax ? TheConvexHull[j].col : xmax;
-		      ymin = TheConvexHull[j].row < ymin ? TheConvexHull[j].row : ymin;
-		      ymax = TheConvexHull[j].row > ymax ? TheConvexHull[j].row : ymax;
-
-		    }
-		  ODEBUG("Left support foot");
-		}
-	      else
-		{
-		  lx=RightFootAbsolutePositions[i].x;
-		  ly=RightFootAbsolutePositions[i].y;
-		  s_t = sin(RightFootAbsolutePositions[i].theta*M_PI/180.0); 
-		  c_t = cos(RightFootAbsolutePositions[i].theta*M_PI/180.0);      
-		  for(unsigned j=0;j<4;j++)
-		    {
-		      TheConvexHull[j].col = lx + ( lxcoefs[j] * 
-						    lRightFootHalfWidth * c_t -
-						    lycoefs[j] * 
-						    lRightFootHalfHeight * s_t );
-		      TheConvexHull[j].row = ly + ( lxcoefs[j] * 
-						    lRightFootHalfWidth * s_t +
-						    lycoefs[j] * 
-						    lRightFootHalfHeight * c_t ); 
-		      // Computes the maxima.
-		      xmin = TheConvexHull[j].col < xmin ? TheConvexHull[j].col : xmin;
-		      xmax = TheConvexHull[j].col > xmax ? TheConvexHull[j].col : xmax;
-		      ymin = TheConvexHull[j].row < ymin ? TheConvexHull[j].row : ymin;
-		      ymax = TheConvexHull[j].row > ymax ? TheConvexHull[j].row : ymax;
-
-		    }
-		  ODEBUG("Right support foot");
-		}
-	      ODEBUG("State !=3 " << xmin << " " << xmax << " " << ymin << " " << ymax);
-	      
+	      CH_Point lRotated[8];
+	      for(unsigned j=0;j<lNbVertices;j++)
+		lRotated[j] = TheConvexHull[(j+lFirst)%lNbVertices];
+	      for(unsigned j=0;j<lNbVertices;j++)
+		TheConvexHull[j] = lRotated[j];
 	    }
+	  ODEBUG("State " << State << " " << xmin << " " << xmax << " " << ymin << " " << ymax);
 
 	  // Linear Constraint Inequality
 	  LinearConstraintInequality_t * aLCI = new LinearConstraintInequality_t;
 	  // Building those constraints.
-	  ComputeLinearSystem(TheConvexHull,aLCI->A, aLCI->B, aLCI->Center);
+	  ComputeLinearSystem(TheConvexHull,lNbVertices,
+			      aLCI->A, aLCI->B, aLCI->Center);
 	  // Finding the similar one (i.e. Ai identical).
 	  FindSimilarConstraints(aLCI->A,aLCI->SimilarConstraints);
 
@@ -33,6 +33,7 @@
 
 #include <vector>
 #include <deque>
+#include <map>
 #include <string>
 #include <sstream>
 
@@ -67,11 +68,28 @@ namespace PatternGeneratorJRL
 	set of points specified by aVecOfPoints. aVecOfPoints is supposed to represent
 	the convex hull of the robot contact points with the ground.
        */
-      int ComputeLinearSystem(std::vector<CH_Point> aVecOfPoints,
+      int ComputeLinearSystem(const std::vector<CH_Point> &aVecOfPoints,
 			      MAL_MATRIX(&A,double),
 			      MAL_MATRIX(&B,double),
 			      MAL_VECTOR(&C,double));
 
+      /*! Same as above for the \a n points of \a Points.
+	Up to ComputeConvexHull::MaxNbPoints points nothing is
+	allocated but \a A, \a B and \a C. */
+      int ComputeLinearSystem(const CH_Point *Points,
+			      unsigned int n,
+			      MAL_MATRIX(&A,double),
+			      MAL_MATRIX(&B,double),
+			      MAL_VECTOR(&C,double));
+
+      /*! Allocation-free version: \a A is a row-major n x 2 array,
+	\a B has n values and \a C two values. */
+      int ComputeLinearSystem(const CH_Point *Points,
+			      unsigned int n,
+			      double *A,
+			      double *B,
+			      double *C) const;
+
       /*!  Build a queue of constraint Inequalities based on a list of Foot Absolute
 	Position.
        */
@@ -100,10 +118,56 @@ namespace PatternGeneratorJRL
        */
       virtual void CallMethod(std::string & Method, std::istringstream &Args);
 
+    protected:
+
+      /*! Kind of support polygon. */
+      enum SupportType_e { DOUBLE_SUPPORT, LEFT_SUPPORT, RIGHT_SUPPORT };
+
+      /*! \brief Key of the cache of support polygons: the kind of support
+	and, in double support, the pose of the right foot in the frame
+	of the left foot quantized. */
+      struct SupportPolygonKey_s
+      {
+	long dx, dy, dtheta;
+	int Type;
+	bool operator<(const SupportPolygonKey_s & aKey) const;
+      };
+      typedef struct SupportPolygonKey_s SupportPolygonKey_t;
+
+      /*! \brief Support polygon in the frame of the reference foot
+	(the left foot in double support, the support foot otherwise). */
+      struct SupportPolygon_s
+      {
+	unsigned int NbVertices;
+	CH_Point Vertices[8];
+      };
+      typedef struct SupportPolygon_s SupportPolygon_t;
+
+      /*! \brief Returns the support polygon of \a aType in the frame
+	of the reference foot, computing it if it is not in the cache.
+	\a HalfSizes are the half width and half height of the left
+	and the right feet. */
+      const SupportPolygon_t & LocalSupportPolygon(SupportType_e aType,
+						   const FootAbsolutePosition & LeftFoot,
+						   const FootAbsolutePosition & RightFoot,
+						   const double HalfSizes[4]);
+
     private:
 
       /* ! Reference on the Humanoid Specificities. */
       CjrlHumanoidDynamicRobot * m_HS;
+
+      /*! \name Cache of the support polygons.
+	@{ */
+      std::map<SupportPolygonKey_t, SupportPolygon_t> m_SupportPolygons;
+
+      /*! Feet sizes the cached polygons have been computed for. */
+      double m_CachedHalfSizes[4];
+
+      /*! Quantization of the relative position (m) 
+	and orientation (degrees) of the feet. */
+      double m_PositionQuantum, m_OrientationQuantum;
+      /*! @} */
       
     };
 }
@@ -25,11 +25,34 @@
     \brief This object performs a cholesky decomposition optimized for 
     the problem to solved. */
 
+#include <cstring>
+#include <cmath>
+
 #include <Mathematics/OptCholesky.hh>
 #include <Debug.hh>
 
 using namespace PatternGeneratorJRL;
 
+namespace {
+  /*! Inner product with four partial sums, so that the main loop
+    can be vectorized by the compiler. */
+  inline double DotProduct(const double *a, const double *b, unsigned int n)
+  {
+    double s0=0.0, s1=0.0, s2=0.0, s3=0.0;
+    unsigned int lk=0;
+    for(;lk+4<=n;lk+=4)
+      {
+	s0 += a[lk]   * b[lk];
+	s1 += a[lk+1] * b[lk+1];
+	s2 += a[lk+2] * b[lk+2];
+	s3 += a[lk+3] * b[lk+3];
+      }
+    for(;lk<n;lk++)
+      s0 += a[lk] * b[lk];
+    return (s0+s1)+(s2+s3);
+  }
+}
+
 OptCholesky::OptCholesky(unsigned int lNbMaxOfConstraints,
 			 unsigned int lCardU,
 			 unsigned int lUpdateMode):
@@ -39,18 +62,39 @@ OptCholesky::OptCholesky(unsigned int lNbMaxOfConstraints,
   m_L(0),
   m_iL(0),
   m_UpdateMode(lUpdateMode),
-  m_NbOfConstraints(0)
+  m_NbOfConstraints(0),
+  m_E(0),
+  m_EBuffer(0),
+  m_CardUPadded(0)
 {
   InitializeInternalVariables();
 }
 
 OptCholesky::~OptCholesky()
 {
+  FreeMemory();
 }
 
 
 void OptCholesky::InitializeInternalVariables()
 {
+  m_CardUPadded = (m_CardU+3) & ~3u;
+  unsigned int lSize = m_NbMaxOfConstraints*m_CardUPadded;
+
+  /* 4 more doubles to align the rows of E on 32 bytes. */
+  m_EBuffer = new double[lSize+4];
+  m_E = (double *)(((size_t)m_EBuffer + 31) & ~((size_t)31));
+  memset(m_E,0,lSize*sizeof(double));
+
+  m_SetActiveConstraints.reserve(m_NbMaxOfConstraints);
+}
+
+void OptCholesky::FreeMemory()
+{
+  if (m_EBuffer!=0)
+    delete [] m_EBuffer;
+  m_EBuffer = 0;
+  m_E = 0;
 }
 
 void OptCholesky::SetToZero()
@@ -91,18 +135,31 @@ int OptCholesky::AddActiveConstraints(vector<unsigned int> & lConstraints)
 
 int OptCholesky::AddActiveConstraint(unsigned int aConstraint)
 {
+  if (m_SetActiveConstraints.size()>=m_NbMaxOfConstraints)
+    return -1;
+
   /* Update set of active constraints */
   m_SetActiveConstraints.push_back(aConstraint);
 
   int r = 0;
   if (m_UpdateMode==MODE_NORMAL)
-    UpdateCholeskyMatrixNormal();
+    r = UpdateCholeskyMatrixNormal();
   else if (m_UpdateMode==MODE_FORTRAN)
-    UpdateCholeskyMatrixFortran();
+    r = UpdateCholeskyMatrixFortran();
     
   return r;
 }
 
+int OptCholesky::RemoveActiveConstraint(unsigned int aConstraint)
+{
+  for(unsigned int li=0;li<m_SetActiveConstraints.size();li++)
+    {
+      if (m_SetActiveConstraints[li]==aConstraint)
+	return DowndateCholeskyMatrix(li);
+    }
+  return -1;
+}
+
 int OptCholesky::CurrentNumberOfRows()
 {
   return m_SetActiveConstraints.size();
@@ -115,8 +172,7 @@ void OptCholesky::SetL(double *aL)
 
 void OptCholesky::SetiL(double *aiL)
 {
-  if (m_iL!=0)
-    delete [] m_iL;
+  /* As for L, the memory belongs to the caller. */
   m_iL = aiL;
 }
 
@@ -126,46 +182,16 @@ int OptCholesky::UpdateCholeskyMatrixNormal()
   if ((m_A==0) | (m_L==0))
     return -1;
 
-  double Mij=0.0;
   unsigned int IndexNewRowAKAi = 0;
   if (m_SetActiveConstraints.size()>0)
     IndexNewRowAKAi = m_SetActiveConstraints.size()-1;
   
-  double *PointerArow_i = m_A +  m_CardU * 
-    m_SetActiveConstraints[IndexNewRowAKAi];
-
-  /* Compute Li,j */
-  for(int lj=0;lj<(int)m_SetActiveConstraints.size();lj++)
-    {
-
-      /* A value M(i,j) is computed once,
-	 directly from the matrix A */      
-      double *Arow_i = PointerArow_i;
-      double *Arow_j = m_A + m_CardU * m_SetActiveConstraints[lj];
-      Mij=0.0;
-      for(int lk=0;lk<(int)m_CardU;lk++)
-	{
-	  Mij+= (*Arow_i++) * (*Arow_j++);
-	}
-
-      /* */
-      double r = Mij;
-      double * ptLik =m_L + IndexNewRowAKAi*m_NbMaxOfConstraints;
-      double * ptLjk =m_L + lj*m_NbMaxOfConstraints;
+  /* Copy the row of A in E. */
+  memcpy(m_E + IndexNewRowAKAi*m_CardUPadded,
+	 m_A + m_CardU * m_SetActiveConstraints[IndexNewRowAKAi],
+	 m_CardU*sizeof(double));
 
-      for(int lk=0;lk<lj;lk++)
-	{
-	  r = r - (*ptLik++)  * (*ptLjk++);
-	}
-      if (lj!=(int)m_SetActiveConstraints.size()-1)
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj]=r/m_L[lj*m_NbMaxOfConstraints+lj];
-      else
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] = sqrt(r);
-      
-    }
-  
-  return 0;
-  
+  return UpdateCholeskyMatrixFromE();
 }
 
 int OptCholesky::UpdateCholeskyMatrixFortran()
@@ -174,54 +200,108 @@ int OptCholesky::UpdateCholeskyMatrixFortran()
   if ((m_A==0) | (m_L==0))
     return -1;
 
-  double Mij=0.0;
   unsigned int IndexNewRowAKAi = 0;
   if (m_SetActiveConstraints.size()>0)
     IndexNewRowAKAi = m_SetActiveConstraints.size()-1;
   
-  double *PointerArow_i = m_A +  
-    m_SetActiveConstraints[IndexNewRowAKAi];
+  /* Gather the row of A in E: in Fortran mode A is stored
+     by columns with a stride of m_NbOfConstraints+1. 
+     This strided access is done only once per constraint. */
+  double *Arow_i = m_A + m_SetActiveConstraints[IndexNewRowAKAi];
+  double *Erow_i = m_E + IndexNewRowAKAi*m_CardUPadded;
+  for(int lk=0;lk<(int)m_CardU;lk++)
+    {
+      Erow_i[lk] = *Arow_i;
+      Arow_i+= m_NbOfConstraints+1;
+    }
+
+  return UpdateCholeskyMatrixFromE();
+}
+
+int OptCholesky::UpdateCholeskyMatrixFromE()
+{
+  unsigned int IndexNewRowAKAi = 0;
+  if (m_SetActiveConstraints.size()>0)
+    IndexNewRowAKAi = m_SetActiveConstraints.size()-1;
+
+  const double *Erow_i = m_E + IndexNewRowAKAi*m_CardUPadded;
+  double * ptLi =m_L + IndexNewRowAKAi*m_NbMaxOfConstraints;
 
   /* Compute Li,j */
   for(int lj=0;lj<(int)m_SetActiveConstraints.size();lj++)
     {
-
       /* A value M(i,j) is computed once,
-	 directly from the matrix A */      
-      double *Arow_i = PointerArow_i;
-      double *Arow_j = m_A + m_SetActiveConstraints[lj];
-      Mij=0.0;
-      for(int lk=0;lk<(int)m_CardU;lk++)
-	{
-	  Mij+= (*Arow_i) * (*Arow_j);
-	  Arow_i+= m_NbOfConstraints+1;
-	  Arow_j+= m_NbOfConstraints+1;
-	}
-
-      /* */
-      double r = Mij;
+	 directly from the rows of E. The padding is zero. */
+      const double *Erow_j = m_E + lj*m_CardUPadded;
+      double r = DotProduct(Erow_i,Erow_j,m_CardUPadded);
       ODEBUG("r: M("<< m_SetActiveConstraints[IndexNewRowAKAi] << "," 
 	      << m_SetActiveConstraints[lj] <<")="<< r);
-      double * ptLik =m_L + IndexNewRowAKAi*m_NbMaxOfConstraints;
-      double * ptLjk =m_L + lj*m_NbMaxOfConstraints;
 
-      for(int lk=0;lk<lj;lk++)
-	{
-	  r = r - (*ptLik++)  * (*ptLjk++);
-	}
-      if (lj!=(int)m_SetActiveConstraints.size()-1)
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj]=r/m_L[lj*m_NbMaxOfConstraints+lj];
+      double * ptLj =m_L + lj*m_NbMaxOfConstraints;
+      r -= DotProduct(ptLi,ptLj,lj);
+
+      if (lj!=(int)IndexNewRowAKAi)
+	ptLi[lj]=r/ptLj[lj];
       else
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] = sqrt(r);
+	ptLi[lj] = sqrt(r);
       
       ODEBUG("m_L(" << IndexNewRowAKAi << "," << lj << ")="
-	      << m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] );
+	      << ptLi[lj] );
     }
   
   return 0;
   
 }
 
+int OptCholesky::DowndateCholeskyMatrix(unsigned int IndexInActiveSet)
+{
+  if (m_L==0)
+    return -1;
+
+  unsigned int lNbOfRows = m_SetActiveConstraints.size();
+  if (IndexInActiveSet>=lNbOfRows)
+    return -1;
+
+  /* Remove the row of L, E and the constraint from the active set.
+     The rows of L below IndexInActiveSet have now a non zero element
+     above the diagonal. */
+  for(unsigned int li=IndexInActiveSet;li<lNbOfRows-1;li++)
+    {
+      memcpy(m_L + li*m_NbMaxOfConstraints,
+	     m_L + (li+1)*m_NbMaxOfConstraints,
+	     (li+2)*sizeof(double));
+      memcpy(m_E + li*m_CardUPadded,
+	     m_E + (li+1)*m_CardUPadded,
+	     m_CardUPadded*sizeof(double));
+    }
+  m_SetActiveConstraints.erase(m_SetActiveConstraints.begin()+IndexInActiveSet);
+  lNbOfRows--;
+
+  /* Restore the lower triangular form with Givens rotations
+     applied on the columns (k,k+1). */
+  for(unsigned int lk=IndexInActiveSet;lk<lNbOfRows;lk++)
+    {
+      double * ptLk = m_L + lk*m_NbMaxOfConstraints;
+      double a = ptLk[lk];
+      double b = ptLk[lk+1];
+      double r = sqrt(a*a+b*b);
+      if (r==0.0)
+	return -1;
+      double c = a/r, s = b/r;
+
+      ptLk[lk] = r;
+      ptLk[lk+1] = 0.0;
+      for(unsigned int li=lk+1;li<lNbOfRows;li++)
+	{
+	  double * ptLi = m_L + li*m_NbMaxOfConstraints;
+	  double x = ptLi[lk], y = ptLi[lk+1];
+	  ptLi[lk]   =  c*x + s*y;
+	  ptLi[lk+1] = -s*x + c*y;
+	}
+    }
+  return 0;
+}
+
 int OptCholesky::ComputeNormalCholeskyOnANormal()
 {
   if ((m_A==0) | (m_L==0))
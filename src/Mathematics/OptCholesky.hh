@@ -74,6 +74,14 @@ namespace PatternGeneratorJRL
        */
       int AddActiveConstraint(unsigned int aConstraint);
 
+      /*! \brief Remove one active constraint.
+	The cholesky matrix is downdated with a sequence of Givens rotations,
+	and the order of the remaining active constraints is kept.
+	@param[in] aConstraint: row index of the constraint in \f${\bf A} \f$.
+	@return -1 if the constraint is not active, 0 otherwise.
+       */
+      int RemoveActiveConstraint(unsigned int aConstraint);
+
       /*! \brief Returns the current number of rows 
        or the current number of active constraints on \f$ {\bf A} \f$.*/
       int CurrentNumberOfRows();
@@ -128,6 +136,18 @@ namespace PatternGeneratorJRL
 	Its size gives the size of \f$ {\bf L} \f$, and \f$ {\bf E} \f$ */
       vector<unsigned int> m_SetActiveConstraints;
 
+      /*! \brief Rows of \f$ {\bf A} \f$ for the active constraints, i.e. \f$ {\bf E} \f$.
+	They are stored contiguously whatever the update mode, with a stride
+	of m_CardUPadded, on an aligned memory area. */
+      double *m_E;
+
+      /*! \brief Memory allocated for m_E before alignment. */
+      double *m_EBuffer;
+
+      /*! \brief Size of the control vector rounded up to a multiple of 4.
+	The padding of each row of m_E is set to zero. */
+      unsigned int m_CardUPadded;
+
 
       /*! \brief Update Cholesky computation */
       int UpdateCholeskyMatrixFortran();
@@ -135,6 +155,14 @@ namespace PatternGeneratorJRL
       /*! \brief Update Cholesky computation */
       int UpdateCholeskyMatrixNormal();
 
+      /*! \brief Update Cholesky computation once the new row of \f$ {\bf E} \f$
+	has been copied. */
+      int UpdateCholeskyMatrixFromE();
+
+      /*! \brief Downdate Cholesky computation when the constraint IndexInActiveSet
+	is removed. */
+      int DowndateCholeskyMatrix(unsigned int IndexInActiveSet);
+
       /*! \brief  Free memory. */
       void FreeMemory();
 
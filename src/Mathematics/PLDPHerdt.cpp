@@ -53,13 +53,73 @@ using namespace PatternGeneratorJRL;
 using namespace Optimization::Solver;
 using namespace std;
 
+/*! Current time in seconds. */
+static double CurrentTime()
+{
+  struct timeval current;
+  gettimeofday(&current,0);
+  return (double)current.tv_sec + 0.000001*current.tv_usec;
+}
+
+/*! Cholesky decomposition of the symmetric matrix \a Q of size \a n.
+  Only the lower part of \a Q is read, so \a L may be equal to \a Q.
+  The upper part of \a L is set to zero.
+  \return -1 if the matrix is not positive definite. */
+static int CholeskyDecomposition(const double *Q, unsigned int ldQ,
+				 unsigned int n,
+				 double *L, unsigned int ldL)
+{
+  for(unsigned int j=0;j<n;j++)
+    {
+      double r = Q[j*ldQ+j];
+      for(unsigned int k=0;k<j;k++)
+	r -= L[j*ldL+k]*L[j*ldL+k];
+      if (r<=0.0)
+	return -1;
+      r = sqrt(r);
+
+      for(unsigned int i=j+1;i<n;i++)
+	{
+	  double lij = Q[i*ldQ+j];
+	  for(unsigned int k=0;k<j;k++)
+	    lij -= L[i*ldL+k]*L[j*ldL+k];
+	  L[i*ldL+j] = lij/r;
+	}
+      L[j*ldL+j] = r;
+      for(unsigned int k=j+1;k<n;k++)
+	L[j*ldL+k] = 0.0;
+    }
+  return 0;
+}
+
+/*! Inverse of the lower triangular matrix \a L of size \a n. */
+static void InverseLowerTriangular(const double *L, unsigned int ldL,
+				   unsigned int n,
+				   double *iL, unsigned int ldiL)
+{
+  for(unsigned int j=0;j<n;j++)
+    {
+      for(unsigned int i=0;i<j;i++)
+	iL[i*ldiL+j] = 0.0;
+
+      iL[j*ldiL+j] = 1.0/L[j*ldL+j];
+      for(unsigned int i=j+1;i<n;i++)
+	{
+	  double r=0.0;
+	  for(unsigned int k=j;k<i;k++)
+	    r -= L[i*ldL+k]*iL[k*ldiL+j];
+	  iL[i*ldiL+j] = r/L[i*ldL+i];
+	}
+    }
+}
+
 PLDPSolverHerdt::PLDPSolverHerdt(unsigned int CardU,
 				 double *iPu,
 				 double *Px,
 				 double *Pu,
 				 double *iLQ)
 {
-  m_DebugMode = 3;
+  m_DebugMode = 0;
   m_HotStart = true;
   m_NoCholesky = true;
 
@@ -79,7 +139,7 @@ PLDPSolverHerdt::PLDPSolverHerdt(unsigned int CardU,
   m_Vk = 0;
   m_CstPartOfCostFunction = 0;
   m_UnconstrainedDescentDirection =0;
-  m_L =0 ;
+  m_L = m_iL = 0;
   m_iLQ = iLQ;
   m_d = 0;
   m_v1 = m_v2 = m_y = 0;
@@ -87,14 +147,25 @@ PLDPSolverHerdt::PLDPSolverHerdt(unsigned int CardU,
   m_A = m_b= 0;
 
   m_ConstraintsValueComputed = 0;
+  m_InitialZMPSolution = 0;
+  m_iPuPxNumberSteps = -1;
+  memset(&m_Statistics,0,sizeof(m_Statistics));
+
+  m_NbInvariant = 0;
+  m_LInvariant = m_iLInvariant = 0;
+  m_LHessian = m_iLHessian = 0;
+  m_ALDP = m_bLDP = m_cLDP = 0;
+  m_QPSizeOfControl = m_QPNbMaxOfConstraints = 0;
 
   m_NbMaxOfConstraints = 8*m_CardV;
   m_NbOfConstraints = 0;
 
   m_DistanceFeetCenters = 0.2;
 
-  m_OptCholesky = new PatternGeneratorJRL::OptCholesky(m_NbMaxOfConstraints,2*m_CardV,
+  m_SizeOfControl = 2*m_CardV;
+  m_OptCholesky = new PatternGeneratorJRL::OptCholesky(m_NbMaxOfConstraints,m_SizeOfControl,
 						       OptCholesky::MODE_FORTRAN);
+  m_iPuPx = new double[2*m_CardV*6];
 
   string Buffer("InfosPLDP");
   if (m_HotStart)
@@ -102,41 +173,98 @@ PLDPSolverHerdt::PLDPSolverHerdt(unsigned int CardU,
   if (m_LimitedComputationTime)
     Buffer+="LT";
   Buffer+=".dat";
+  m_InfosFileName = Buffer;
   RESETDEBUG6((char*)Buffer.c_str());
   RESETDEBUG6("ActivatedConstraints.dat");
 
+  AllocateMemoryForSolver(0);
 
 }
 
 void PLDPSolverHerdt::AllocateMemoryForSolver(unsigned int NumberSteps)
 {
+  unsigned int lSizeOfControl = 2*(m_CardV+NumberSteps);
 
-  PrecomputeiPuPx(NumberSteps);
+  /* The cholesky decomposition reads the rows of A with
+     the exact size of the control vector. */
+  if ((lSizeOfControl!=m_SizeOfControl) ||
+      (m_NbMaxOfConstraints>m_Workspace.NbMaxOfConstraints()))
+    {
+      delete m_OptCholesky;
+      m_SizeOfControl = lSizeOfControl;
+      m_OptCholesky = new PatternGeneratorJRL::OptCholesky(m_NbMaxOfConstraints,m_SizeOfControl,
+							   OptCholesky::MODE_FORTRAN);
+      m_OptCholesky->SetL(m_L);
+      m_OptCholesky->SetiL(m_iL);
+    }
 
-  m_Vk = new double[2*(m_CardV+NumberSteps)];
-  memset(m_Vk,0,2*(m_CardV+NumberSteps)*sizeof(double));
+  if ((m_iPu!=0) &&
+      ((m_iPuPxNumberSteps<0) ||
+       (NumberSteps!=(unsigned int)m_iPuPxNumberSteps)))
+    {
+      PrecomputeiPuPx(NumberSteps);
+      m_iPuPxNumberSteps = NumberSteps;
+    }
 
-  m_InitialZMPSolution = new double[2*(m_CardV+NumberSteps)];
-  memset(m_InitialZMPSolution,0,2*(m_CardV+NumberSteps)*sizeof(double));
+  if (!m_Workspace.Reserve(lSizeOfControl,m_NbMaxOfConstraints))
+    return;
 
-  m_UnconstrainedDescentDirection = new double[2*(m_CardV+NumberSteps)];
-  memset(m_UnconstrainedDescentDirection,0,2*(m_CardV+NumberSteps)*sizeof(double));
+  /* The pointers below are shortcuts inside the workspace. */
+  m_Vk = m_Workspace.Vk();
+  m_InitialZMPSolution = m_Workspace.ZMPSolution();
+  m_UnconstrainedDescentDirection = m_Workspace.UnconstrainedDescentDirection();
+  m_d = m_Workspace.d();
 
-  m_L = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
-  m_iL = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
+  m_L = m_Workspace.L();
+  m_iL = m_Workspace.iL();
+  m_v1 = m_Workspace.v1();
+  m_v2 = m_Workspace.v2();
+  m_y = m_Workspace.y();
+  m_tmp1 = m_Workspace.tmp1();
+  m_tmp2 = m_Workspace.tmp2();
+  m_ConstraintsValueComputed = m_Workspace.ConstraintsValueComputed();
 
-  m_v1 = new double[m_NbMaxOfConstraints];
-  m_v2 = new double[m_NbMaxOfConstraints];
-  m_tmp1 = new double[m_NbMaxOfConstraints];
-  m_tmp2 = new double[m_NbMaxOfConstraints];
+  m_OptCholesky->SetL(m_L);
+  m_OptCholesky->SetiL(m_iL);
+}
 
-  m_y = new double[m_NbMaxOfConstraints];
+void PLDPSolverHerdt::AllocateMemoryForQP(unsigned int NbVariables)
+{
+  if (NbVariables>m_QPSizeOfControl)
+    {
+      if (m_LHessian!=0)
+	delete [] m_LHessian;
+      if (m_iLHessian!=0)
+	delete [] m_iLHessian;
+      if (m_cLDP!=0)
+	delete [] m_cLDP;
+
+      m_QPSizeOfControl = NbVariables;
+      m_LHessian = new double[m_QPSizeOfControl*m_QPSizeOfControl];
+      m_iLHessian = new double[m_QPSizeOfControl*m_QPSizeOfControl];
+      m_cLDP = new double[m_QPSizeOfControl];
+      /* The size of A depends on the size of the control vector. */
+      m_QPNbMaxOfConstraints = 0;
+    }
 
-  m_ConstraintsValueComputed = new bool [m_NbMaxOfConstraints*2];
+  if (m_NbMaxOfConstraints>m_QPNbMaxOfConstraints)
+    {
+      if (m_ALDP!=0)
+	delete [] m_ALDP;
+      if (m_bLDP!=0)
+	delete [] m_bLDP;
+
+      m_QPNbMaxOfConstraints = m_NbMaxOfConstraints;
+      m_ALDP = new double[(m_QPNbMaxOfConstraints+1)*m_QPSizeOfControl];
+      m_bLDP = new double[m_QPNbMaxOfConstraints];
+    }
+}
 
-  m_d = new double[2*(m_CardV+NumberSteps)];
-  m_OptCholesky->SetL(m_L);
-  m_OptCholesky->SetiL(m_iL);
+void PLDPSolverHerdt::SetLimitedComputationTime(double aTime)
+{
+  m_LimitedComputationTime = (aTime>=0.0);
+  if (m_LimitedComputationTime)
+    m_AmountOfLimitedComputationTime = aTime;
 }
 
 void PLDPSolverHerdt::InitializeSolver(unsigned int /* NumberSteps*/ )
@@ -159,7 +287,7 @@ void PLDPSolverHerdt::InitializeSolver(unsigned int /* NumberSteps*/ )
   // Same for the descent.
   memset(m_d,0,2*(m_CardV+NumberSteps)*sizeof(double));
 #endif
-  m_ActivatedConstraints.clear();
+  m_Workspace.ClearActiveSet();
 }
 
 PLDPSolverHerdt::~PLDPSolverHerdt()
@@ -167,57 +295,27 @@ PLDPSolverHerdt::~PLDPSolverHerdt()
   if (m_iPuPx!=0)
     delete [] m_iPuPx;
 
-  if (m_Vk!=0)
-    delete [] m_Vk;
-
-  if (m_InitialZMPSolution!=0)
-    delete [] m_InitialZMPSolution;
-
-  if (m_UnconstrainedDescentDirection!=0)
-    delete [] m_UnconstrainedDescentDirection;
-
   if (m_OptCholesky!=0)
     delete m_OptCholesky;
 
-  if (m_L!=0)
-    delete [] m_L;
-
-  if (m_iL!=0)
-    delete [] m_iL;
-
-  if (m_v1!=0)
-    delete [] m_v1;
-
-  if (m_v2!=0)
-    delete [] m_v2;
-
-  if (m_tmp1!=0)
-    delete [] m_tmp1;
-
-  if (m_tmp2!=0)
-    delete [] m_tmp2;
-
-  if (m_d!=0)
-    delete [] m_d;
-
-  if (m_y!=0)
-    delete [] m_y;
-
-  if ( m_ConstraintsValueComputed!=0)
-    delete [] m_ConstraintsValueComputed;
+  double ** lQPBuffers[7] =
+    { &m_LInvariant, &m_iLInvariant, &m_LHessian, &m_iLHessian,
+      &m_ALDP, &m_bLDP, &m_cLDP };
+  for(unsigned int i=0;i<7;i++)
+    if (*lQPBuffers[i]!=0)
+      delete [] *lQPBuffers[i];
 
+  /* The other buffers belong to m_Workspace. */
 }
 
 int PLDPSolverHerdt::PrecomputeiPuPx(unsigned int NumberSteps)
 {
-  m_iPuPx = new double[2*(m_CardV)*6];
-
-  memset(m_iPuPx,0,2*(m_CardV)*6);
+  memset(m_iPuPx,0,2*(m_CardV)*6*sizeof(double));
 
   if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("iPu.dat",ofstream::out);
+      aof.open(OutputFileName("iPu.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	{
 	  for(unsigned int j=0;j<2*(m_CardV+NumberSteps);j++)
@@ -228,7 +326,7 @@ int PLDPSolverHerdt::PrecomputeiPuPx(unsigned int NumberSteps)
 	}
       aof.close();
 
-      aof.open("Pu.dat",ofstream::out);
+      aof.open(OutputFileName("Pu.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	{
 	  for(unsigned int j=0;j<2*(m_CardV+NumberSteps);j++)
@@ -240,7 +338,7 @@ int PLDPSolverHerdt::PrecomputeiPuPx(unsigned int NumberSteps)
       aof.close();
 
 
-      aof.open("Px.dat",ofstream::out);
+      aof.open(OutputFileName("Px.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<3;j++)
@@ -251,7 +349,7 @@ int PLDPSolverHerdt::PrecomputeiPuPx(unsigned int NumberSteps)
 	}
       aof.close();
 
-      aof.open("isLQ.dat",ofstream::out);
+      aof.open(OutputFileName("isLQ.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	{
 	  for(unsigned int j=0;j<2*(m_CardV+NumberSteps);j++)
@@ -372,7 +470,7 @@ int PLDPSolverHerdt::ComputeInitialSolution(deque<LinearConstraintInequalityFree
    if(m_DebugMode>0)
      {
        ofstream aof;
-       aof.open("InitialZMPSolution.dat",ofstream::out);
+       aof.open(OutputFileName("InitialZMPSolution.dat").c_str(),ofstream::out);
        for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	 aof <<m_InitialZMPSolution[i] << " ";
        aof << endl;
@@ -394,7 +492,8 @@ int PLDPSolverHerdt::ForwardSubstitution()
       (m_ItNb>0))
     startIndex = m_ActivatedConstraints.size()-1;
   */
-  for(unsigned int i=startIndex;i<m_ActivatedConstraints.size();i++)
+  unsigned int SizeOfL = m_Workspace.NbOfActiveConstraints();
+  for(unsigned int i=startIndex;i<SizeOfL;i++)
     {
       m_y[i] = m_v1[i] ;
       for(unsigned int k=0;k<i;k++)
@@ -414,7 +513,7 @@ int PLDPSolverHerdt::BackwardSubstitution()
   // LL^t v2 = v1 <-> L y = v1 with L^t v2 = y
   // y solved with first phase.
   // So now we are looking for v2.
-  unsigned int SizeOfL = m_ActivatedConstraints.size();
+  unsigned int SizeOfL = m_Workspace.NbOfActiveConstraints();
   if (SizeOfL==0)
     return 0;
 
@@ -445,6 +544,7 @@ int PLDPSolverHerdt::BackwardSubstitution()
 
 int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
 {
+  unsigned int NbOfActiveConstraints = m_Workspace.NbOfActiveConstraints();
 
   if(m_DebugMode>1)
     {
@@ -452,17 +552,17 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
 
       char Buffer[1024];
       sprintf(Buffer,"AC_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int li=0;li<m_ActivatedConstraints.size();li++)
-	aof<< m_ActivatedConstraints[li] << " ";
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int li=0;li<NbOfActiveConstraints;li++)
+	aof<< m_Workspace.ActiveConstraint(li) << " ";
       aof <<endl;
       aof.close();
 
       sprintf(Buffer,"E_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int li=0;li<m_ActivatedConstraints.size();li++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int li=0;li<NbOfActiveConstraints;li++)
 	{
-	  unsigned int RowCstMatrix = m_ActivatedConstraints[li];
+	  unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(li);
 	  for(unsigned int lj=0;lj<2*(m_CardV+NumberSteps);lj++)
 	    {
 	      aof << m_A[RowCstMatrix+lj*(m_NbOfConstraints+1)] << " ";
@@ -472,7 +572,7 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       aof.close();
 
       sprintf(Buffer,"c_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int li=0;li<2*(m_CardV+NumberSteps);li++)
  	{
 	  aof << m_UnconstrainedDescentDirection[li] << " " ;
@@ -488,10 +588,10 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       (m_ItNb>0))
     startIndex = m_ActivatedConstraints.size()-1;
   */
-  for(unsigned int li=startIndex;li<m_ActivatedConstraints.size();li++)
+  for(unsigned int li=startIndex;li<NbOfActiveConstraints;li++)
     {
       m_v1[li] = 0.0;
-      unsigned int RowCstMatrix = m_ActivatedConstraints[li];
+      unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(li);
       ODEBUG("RowCstMatrix:"<<RowCstMatrix);
       for(unsigned int lj=0;lj<2*(m_CardV+NumberSteps);lj++)
 	{
@@ -507,8 +607,8 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"v1_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_v1[lj] << endl;
       aof.close();
     }
@@ -523,8 +623,8 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"y_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_y[lj] << endl;
       aof.close();
 
@@ -538,8 +638,8 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"v2_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_v2[lj] << endl;
       aof.close();
     }
@@ -547,13 +647,13 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
   // Compute d
   // d = c - Et v2
   ODEBUG("Size of ActivatedConstraints: "<<
-	  m_ActivatedConstraints.size());
+	  NbOfActiveConstraints);
   for(unsigned int li=0;li<2*(m_CardV+NumberSteps);li++)
     {
       m_d[li] = m_UnconstrainedDescentDirection[li];
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	{
-	  unsigned int RowCstMatrix = m_ActivatedConstraints[lj];
+	  unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(lj);
 	  m_d[li]-= m_A[RowCstMatrix+li*(m_NbOfConstraints+1)]*
 	    m_v2[lj];
 	}
@@ -564,7 +664,7 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"UDD_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int lj=0;lj<2*(m_CardV+NumberSteps);lj++)
 	aof  << m_d[lj] << " ";
       aof << endl;
@@ -573,34 +673,21 @@ int PLDPSolverHerdt::ComputeProjectedDescentDirection(unsigned int NumberSteps)
   return 0;
 }
 
-double PLDPSolverHerdt::ComputeAlpha(vector<unsigned int> & NewActivatedConstraints,
+double PLDPSolverHerdt::ComputeAlpha(int & TheConstraintToActivate,
 				     unsigned int NumberSteps)
 {
   double Alpha=10000000.0;
   double *ptA = 0;
-  bool TheConstraintIsToBeAdded=false;
-  unsigned int TheConstraintToActivate=0;
+  TheConstraintToActivate=-1;
 
   for(unsigned li=0;li<m_NbOfConstraints;li++)
     {
-      bool ConstraintAlreadyActive=false;
-
       // Register that this constraint has yet been computed.
       m_ConstraintsValueComputed[li] = false;
       m_ConstraintsValueComputed[li+m_NbOfConstraints] = false;
 
       // Make sure that this constraint is not already activated.
-      for(unsigned int ConstraintIndex=0;
-	  ConstraintIndex<m_ActivatedConstraints.size();
-	  ConstraintIndex++)
-	{
-	  if (m_ActivatedConstraints[ConstraintIndex]==li)
-	    {
-	      ConstraintAlreadyActive=true;
-	      break;
-	    }
-	}
-      if (ConstraintAlreadyActive)
+      if (m_Workspace.IsActive(li))
 	continue;
 
       ptA = m_A + li;
@@ -669,7 +756,7 @@ double PLDPSolverHerdt::ComputeAlpha(vector<unsigned int> & NewActivatedConstrai
 
 	  if (Alpha>lalpha)
 	    {
-	      ODEBUG3("m_v2[li] : "<< m_v2[li] <<
+	      ODEBUG("m_v2[li] : "<< m_v2[li] <<
 		      " m_v1[li] : " << m_v1[li] << " "
 		      " lalpha: "<< lalpha << " "
 		      " Constraint " << li << " of "
@@ -677,19 +764,150 @@ double PLDPSolverHerdt::ComputeAlpha(vector<unsigned int> & NewActivatedConstrai
 
 	      Alpha = lalpha;
 	      if (Alpha<1)
+		TheConstraintToActivate=li;
+	    }
+	}
+    }
+  ODEBUG("TheConstraintToActivate"<<TheConstraintToActivate);
+
+  return Alpha;
+}
+
+int PLDPSolverHerdt::ActivateConstraint(unsigned int aConstraint)
+{
+  if ((aConstraint>=m_NbOfConstraints) ||
+      (m_Workspace.AddActiveConstraint(aConstraint)<0))
+    return -1;
+
+  if (m_OptCholesky->AddActiveConstraint(aConstraint)<0)
+    {
+      m_Workspace.RemoveLastActiveConstraint();
+      return -1;
+    }
+  return 0;
+}
+
+int PLDPSolverHerdt::ActiveSetLoop(unsigned int NumberSteps,
+				   double *XkYk,
+				   double BeginTime)
+{
+  int TheConstraintToActivate=-1;
+  bool ContinueAlgo=true;
+
+  double alpha=0.0;
+  m_ItNb=0;
+  while(ContinueAlgo)
+    {
+      ODEBUG("Iteration Number:" << m_ItNb);
+      /* Step one : Compute descent direction. */
+      for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
+	 m_UnconstrainedDescentDirection[i] =
+	  -m_CstPartOfCostFunction[i] -  m_Vk[i];
+
+      /*! Step two: Compute the projected descent direction. */
+      ComputeProjectedDescentDirection(NumberSteps);
+
+      /*! Step three : Compute alpha */
+      alpha = ComputeAlpha(TheConstraintToActivate, NumberSteps);
+
+      if (m_DebugMode>1)
+	{
+
+	  ODEBUG("Alpha:" <<alpha);
+
+	  ofstream aof;
+	  char Buffer[1024];
+	  sprintf(Buffer,"U_%.3f_%02d.dat",m_InternalTime,m_ItNb);
+	  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+	  for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
+	    {
+	      aof << m_Vk[i] << " " ;
+	    }
+	  aof.close();
+
+	  if (XkYk!=0)
+	    {
+	      sprintf(Buffer,"Zk_%02d.dat",m_ItNb);
+	      WriteCurrentZMPSolution(Buffer,XkYk);
+	    }
+	}
+
+
+      if (alpha>=1.0)
+	{
+	  alpha=1.0;
+	  ContinueAlgo=false;
+	}
+      if (alpha<0.0)
+	{
+	  ODEBUG3("Problem with alpha: should be positive");
+	  ODEBUG3("The initial solution is incorrect: "<< m_ItNb << " " << m_InternalTime);
+
+	  return -1;
+	}
+
+      /*! Compute new solution. */
+      for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
+	{
+	  m_Vk[i] = m_Vk[i] + alpha*m_d[i];
+	}
+
+
+
+      if (ContinueAlgo)
+	{
+	  ODEBUG("Activated constraint: " << TheConstraintToActivate);
+	  if ((TheConstraintToActivate>=0) &&
+	      (ActivateConstraint(TheConstraintToActivate)==0))
+	    m_Statistics.NbOfActivations++;
+
+	  if (m_DebugMode>1)
+	    {
+	      ofstream aof;
+	      char Buffer[1024];
+	      sprintf(Buffer,"LE_%02d.dat",m_ItNb);
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+	      for(unsigned int i=0;i<m_Workspace.NbOfActiveConstraints();i++)
 		{
-		  TheConstraintIsToBeAdded = true;
-		  TheConstraintToActivate=li;
+		  for(unsigned int j=0;j<m_Workspace.NbOfActiveConstraints();j++)
+		    {
+		      aof << m_L[i*m_NbMaxOfConstraints+j] << " ";
+		    }
+		  aof<<endl;
 		}
+	      aof.close();
+	      ODEBUG("m_L(0,0)= " << m_L[0]);
+	      sprintf(Buffer,"alpha_%02d.dat",m_ItNb);
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+	      aof << alpha << endl;
+	      aof.close();
+
 	    }
+
 	}
+
+      // If limited computation time stop the algorithm.
+      if (m_LimitedComputationTime)
+	{
+	  double r=CurrentTime()-BeginTime;
+	  if ((ContinueAlgo) &&
+	      (r> m_AmountOfLimitedComputationTime))
+	    {
+	      ContinueAlgo=false;
+	      m_Statistics.TimeLimitReached=true;
+	    }
+	}
+
+      m_ItNb++;
     }
-  cout<<"TheConstraintToActivate"<<TheConstraintToActivate<<endl;
-  if (TheConstraintIsToBeAdded)
-    NewActivatedConstraints.push_back(TheConstraintToActivate);
 
-  return Alpha;
+  m_Statistics.ComputationTime = CurrentTime()-BeginTime;
+  m_Statistics.NbOfIterations = m_ItNb;
+  m_Statistics.NbOfActiveConstraints = m_Workspace.NbOfActiveConstraints();
+
+  return 0;
 }
+
 int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> & QueueOfLConstraintInequalitiesFreeFeet,
 			     deque<SupportFeet_t> & QueueOfSupportFeet,
 			     double *CstPartOfTheCostFunction,
@@ -701,7 +919,6 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
 			     unsigned int NumberOfRemovedConstraints, unsigned int NbRemovedFootCstr,
 			     bool StartingSequence,unsigned int NumberSteps, bool CurrentStateChanged, double time)
 {
-  vector<unsigned int> NewActivatedConstraints;
   if (StartingSequence)
     m_InternalTime = 0.0;
 
@@ -732,14 +949,14 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       char Buffer[1024];
       sprintf(Buffer,"InitialSolution_%02f.dat",time);
       ofstream aof;
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	aof <<m_Vk[i] << " ";
       aof << endl;
       aof.close();
 
       sprintf(Buffer,"iPuPx_%02f.dat",time);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV);i++)
 	{
 	  for(unsigned int j=0;j<6;j++)
@@ -750,7 +967,7 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       aof.close();
 
       sprintf(Buffer,"iPu_%02f.dat",time);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	{
 	  for(unsigned int j=0;j<2*(m_CardV+NumberSteps);j++)
@@ -761,7 +978,7 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       aof.close();
 
       sprintf(Buffer,"A_%02f.dat",time);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_NbOfConstraints;i++)
 	{
 	  for(unsigned int j=0;j<2*(m_CardV+NumberSteps);j++)
@@ -771,7 +988,7 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       aof << endl;
       aof.close();
 
-      aof.open("b.dat",ofstream::out);
+      aof.open(OutputFileName("b.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_NbOfConstraints;i++)
 	{
 	  aof << m_b[i] << " ";
@@ -780,7 +997,7 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       aof.close();
 
       sprintf(Buffer,"XkYk_%02f.dat",time);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<6;i++)
 	{
 	    aof << XkYk[i] << " ";
@@ -790,151 +1007,44 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
     }
 
 
-  bool ContinueAlgo=true;
-
   /*! Initialization de cholesky. */
   m_OptCholesky->SetA(LinearPartOfConstraints,m_NbOfConstraints);
   m_OptCholesky->SetToZero();
 
-  struct timeval begin;
+  double BeginTime = CurrentTime();
 
-  gettimeofday(&begin,0);
+  m_Statistics.NbOfConstraints = m_NbOfConstraints;
+  m_Statistics.NbOfActivations = 0;
+  m_Statistics.TimeLimitReached = false;
 
   // Hot Start
   if (m_HotStart)
     {
-      unsigned int lindex,IndexFootCstr;
       //Shift the constraints
-      for(unsigned int i=0;i<m_PreviouslyActivatedConstraints.size();i++)
+      for(unsigned int i=0;i<m_Workspace.NbOfPreviouslyActiveConstraints();i++)
 	{
-	  if(m_PreviouslyActivatedConstraints[i] < 4*m_CardV)//ZMP constraints
+	  int lConstraint = m_Workspace.PreviouslyActiveConstraint(i);
+	  if(lConstraint < (int)(4*m_CardV))//ZMP constraints
 	    {
-	      lindex=m_PreviouslyActivatedConstraints[i]-NumberOfRemovedConstraints;
+	      lConstraint-=NumberOfRemovedConstraints;
+	      if (lConstraint<0)
+		continue;
 	    }
-	  else if(m_PreviouslyActivatedConstraints[i] >= 4*m_CardV && CurrentStateChanged == true)//Foot placement constraints
+	  else if (CurrentStateChanged)//Foot placement constraints
 	    {
-	      IndexFootCstr = m_PreviouslyActivatedConstraints[i]-NbRemovedFootCstr;
-	    }
-
-	  m_ActivatedConstraints.push_back(lindex);
-
-	  if(IndexFootCstr>=4*m_CardV)
-	    {
-	      m_ActivatedConstraints.push_back(IndexFootCstr);
+	      lConstraint-=NbRemovedFootCstr;
+	      if (lConstraint<(int)(4*m_CardV))
+		continue;
 	    }
+	  ActivateConstraint(lConstraint);
 	}
-      if(m_ActivatedConstraints.size()>0)
-	m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints);
     }
+  m_Statistics.NbOfHotStartConstraints = m_Workspace.NbOfActiveConstraints();
 
-  m_PreviouslyActivatedConstraints.clear();
+  m_Workspace.ClearPreviouslyActiveSet();
 
-  double alpha=0.0;
-  m_ItNb=0;
-  while(ContinueAlgo)
-    {
-      ODEBUG("Iteration Number:" << m_ItNb);
-      /* Step one : Compute descent direction. */
-      for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
-	 m_UnconstrainedDescentDirection[i] =
-	  -m_CstPartOfCostFunction[i] -  m_Vk[i];
-
-      /*! Step two: Compute the projected descent direction. */
-      ComputeProjectedDescentDirection(NumberSteps);
-
-      /*! Step three : Compute alpha */
-      alpha = ComputeAlpha(NewActivatedConstraints, NumberSteps);
-
-      if (m_DebugMode>1)
-	{
-
-	  ODEBUG("Alpha:" <<alpha);
-
-	  ofstream aof;
-	  char Buffer[1024];
-	  sprintf(Buffer,"U_%.3f_%02d.dat",m_InternalTime,m_ItNb);
-	  aof.open(Buffer,ofstream::out);
-	  for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
-	    {
-	      aof << m_Vk[i] << " " ;
-	    }
-	  aof.close();
-
-	  sprintf(Buffer,"Zk_%02d.dat",m_ItNb);
-	  WriteCurrentZMPSolution(Buffer,XkYk);
-	}
-
-
-      if (alpha>=1.0)
-	{
-	  alpha=1.0;
-	  ContinueAlgo=false;
-	}
-      if (alpha<0.0)
-	{
-	  ODEBUG3("Problem with alpha: should be positive");
-	  ODEBUG3("The initial solution is incorrect: "<< m_ItNb << " " << m_InternalTime);
-
-	  exit(0);
-	}
-
-      /*! Compute new solution. */
-      for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
-	{
-	  m_Vk[i] = m_Vk[i] + alpha*m_d[i];
-	}
-
-
-
-      if (ContinueAlgo)
-	{
-	  ODEBUG("Nb of activated constraints: " << NewActivatedConstraints.size());
-	  m_OptCholesky->AddActiveConstraints(NewActivatedConstraints);
-	  for(unsigned int i=0;i<NewActivatedConstraints.size();i++)
-	    m_ActivatedConstraints.push_back(NewActivatedConstraints[i]);
-
-	  NewActivatedConstraints.clear();
-
-	  if (m_DebugMode>1)
-	    {
-	      ofstream aof;
-	      char Buffer[1024];
-	      sprintf(Buffer,"LE_%02d.dat",m_ItNb);
-	      aof.open(Buffer,ofstream::out);
-	      for(unsigned int i=0;i<m_ActivatedConstraints.size();i++)
-		{
-		  for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
-		    {
-		      aof << m_L[i*m_NbMaxOfConstraints+j] << " ";
-		    }
-		  aof<<endl;
-		}
-	      aof.close();
-	      ODEBUG("m_L(0,0)= " << m_L[0]);
-	      sprintf(Buffer,"alpha_%02d.dat",m_ItNb);
-	      aof.open(Buffer,ofstream::out);
-	      aof << alpha << endl;
-	      aof.close();
-
-	    }
-
-	}
-
-      // If limited computation time stop the algorithm.
-      if (m_LimitedComputationTime)
-	{
-	  struct timeval current;
-	  gettimeofday(&current,0);
-	  double r=(double)(current.tv_sec-begin.tv_sec) +
-	    0.000001*(current.tv_usec-begin.tv_usec);
-	  if (r> m_AmountOfLimitedComputationTime)
-	    {
-	      ContinueAlgo=false;
-	    }
-	}
-
-      m_ItNb++;
-    }
+  if (ActiveSetLoop(NumberSteps,XkYk,BeginTime)<0)
+    exit(0);
 
   for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
     X[i] = m_Vk[i];
@@ -942,41 +1052,28 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
 
   if (m_HotStart)
     {
-      //cout << "AR (" << lTime <<") :" ;
-      for( unsigned int i=0;i<m_ActivatedConstraints.size();i++)
+      for( unsigned int i=0;i<m_Workspace.NbOfActiveConstraints();i++)
 	{
-	  //cout << "( " << m_ActivatedConstraints[i] << " , " << m_v2[i] << " ) ";
 	  if (m_v2[i]<0.0)
-	    {
-	      m_PreviouslyActivatedConstraints.push_back(m_ActivatedConstraints[i]);
-	      //cout << m_ActivatedConstraints[i] << " " ;
-	    }
+	    m_Workspace.AddPreviouslyActiveConstraint(m_Workspace.ActiveConstraint(i));
 	}
-
-      cout << (int)m_ActivatedConstraints.size() - (int)m_PreviouslyActivatedConstraints.size() <<  " "
-	   << m_PreviouslyActivatedConstraints.size() << endl;
-      cout << endl;
       //StoreCurrentZMPSolution(XkYk);
 
     }
 
-  if (1)
+  if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("ActivatedConstraints.dat",ofstream::app);
+      aof.open(OutputFileName("ActivatedConstraints.dat").c_str(),ofstream::app);
       for(unsigned int i=0;i<320;i++)
       {
 	bool FoundConstraint=false;
 
-	if (i<m_NbOfConstraints)
+	if ((i<m_NbOfConstraints) &&
+	    (m_Workspace.IsActive(i)))
 	  {
-	    for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
-	      if (m_ActivatedConstraints[j]==i)
-		{
-		  aof << "1 ";
-		  FoundConstraint=true;
-		  break;
-		}
+	    aof << "1 ";
+	    FoundConstraint=true;
 	  }
 	if (!FoundConstraint)
 	  aof << "0 ";
@@ -1000,15 +1097,15 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
   if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("NbIt.dat",ofstream::out);
+      aof.open(OutputFileName("NbIt.dat").c_str(),ofstream::out);
       aof << m_ItNb;
       aof.close();
 
-      aof.open("Pb.dat",ofstream::out);
+      aof.open(OutputFileName("Pb.dat").c_str(),ofstream::out);
       aof<<" Number of iterations " << m_ItNb << endl;
       aof.close();
 
-      aof.open("UFinal.dat",ofstream::out);
+      aof.open(OutputFileName("UFinal.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*(m_CardV+NumberSteps);i++)
 	{
 	  aof << X[i] << " " ;
@@ -1017,29 +1114,216 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
       aof.close();
 
       WriteCurrentZMPSolution("FinalSolution.dat",XkYk);
-      aof.open("Pb.dat",ofstream::out);
+      aof.open(OutputFileName("Pb.dat").c_str(),ofstream::out);
       aof<<" Number of iterations " << m_ItNb << endl;
       aof.close();
 
     }
 
 
-  string Buffer("InfosPLDP");
-  if (m_HotStart)
-    Buffer+="HS";
-  if (m_LimitedComputationTime)
-    Buffer+="LT";
-  Buffer+=".dat";
-
-  ODEBUG6(m_ActivatedConstraints.size() << " "
+  ODEBUG6(m_Workspace.NbOfActiveConstraints() << " "
 	  << NbOfConstraints << " "
-	  << m_ActivatedConstraints.size() - m_PreviouslyActivatedConstraints.size() << " "
-	  << m_ItNb,(char*)Buffer.c_str());
+	  << m_Workspace.NbOfActiveConstraints() -
+	  m_Workspace.NbOfPreviouslyActiveConstraints() << " "
+	  << m_ItNb,(char*)m_InfosFileName.c_str());
 
   m_InternalTime += 0.02;
   return 0;
 }
 
+int PLDPSolverHerdt::PrecomputeInvariantPart(const double *Q, unsigned int ldQ,
+					     unsigned int NbInvariant)
+{
+  if (NbInvariant!=m_NbInvariant)
+    {
+      if (m_LInvariant!=0)
+	delete [] m_LInvariant;
+      if (m_iLInvariant!=0)
+	delete [] m_iLInvariant;
+      m_LInvariant = new double[NbInvariant*NbInvariant];
+      m_iLInvariant = new double[NbInvariant*NbInvariant];
+    }
+
+  m_NbInvariant = 0;
+  if (CholeskyDecomposition(Q,ldQ,NbInvariant,
+			    m_LInvariant,NbInvariant)<0)
+    {
+      ODEBUG3("The invariant part of the hessian is not positive definite.");
+      return -1;
+    }
+  InverseLowerTriangular(m_LInvariant,NbInvariant,NbInvariant,
+			 m_iLInvariant,NbInvariant);
+  m_NbInvariant = NbInvariant;
+  return 0;
+}
+
+int PLDPSolverHerdt::SolveProblem(const double *Q, unsigned int ldQ,
+				  const double *D,
+				  const double *DU, unsigned int ldDU,
+				  const double *DS,
+				  unsigned int NbVariables,
+				  unsigned int NbConstraints,
+				  const double *InitialSolution,
+				  double *X)
+{
+  /* The control vector is made of the jerks along x and y,
+     followed by the positions of the feet along x and y. */
+  if ((NbVariables<2*m_CardV) ||
+      ((NbVariables-2*m_CardV)%2!=0))
+    return -1;
+  unsigned int NumberSteps = (NbVariables-2*m_CardV)/2;
+  unsigned int n = NbVariables;
+  unsigned int nI = 2*m_CardV;
+
+  if ((m_NbInvariant!=nI) &&
+      (PrecomputeInvariantPart(Q,ldQ,nI)<0))
+    return -1;
+
+  /* Check that the initial solution is feasible. */
+  for(unsigned int li=0;li<NbConstraints;li++)
+    {
+      double r = DS[li];
+      for(unsigned int lj=0;lj<n;lj++)
+	r += DU[li+lj*ldDU]*InitialSolution[lj];
+      if (r<-m_tol)
+	{
+	  ODEBUG("Infeasible initial solution for constraint " << li);
+	  return -1;
+	}
+    }
+
+  if (NbConstraints>m_NbMaxOfConstraints)
+    m_NbMaxOfConstraints = NbConstraints;
+  AllocateMemoryForSolver(NumberSteps);
+  AllocateMemoryForQP(n);
+  InitializeSolver(NumberSteps);
+
+  /* Cholesky decomposition of the hessian:
+     L = [ LI 0 ; M LS ] with M^t = iLI B and LS LS^t = C - M M^t
+     where B and C are the upper right and lower right blocks of Q. */
+  for(unsigned int i=0;i<nI;i++)
+    {
+      for(unsigned int j=0;j<nI;j++)
+	{
+	  m_LHessian[i*n+j] = m_LInvariant[i*nI+j];
+	  m_iLHessian[i*n+j] = m_iLInvariant[i*nI+j];
+	}
+      for(unsigned int j=nI;j<n;j++)
+	{
+	  m_LHessian[i*n+j] = 0.0;
+	  m_iLHessian[i*n+j] = 0.0;
+	}
+    }
+
+  for(unsigned int i=nI;i<n;i++)
+    for(unsigned int j=0;j<nI;j++)
+      {
+	double r=0.0;
+	for(unsigned int k=0;k<=j;k++)
+	  r += m_iLInvariant[j*nI+k]*Q[k*ldQ+i];
+	m_LHessian[i*n+j] = r;
+      }
+
+  for(unsigned int i=nI;i<n;i++)
+    for(unsigned int j=nI;j<=i;j++)
+      {
+	double r=Q[i*ldQ+j];
+	for(unsigned int k=0;k<nI;k++)
+	  r -= m_LHessian[i*n+k]*m_LHessian[j*n+k];
+	m_LHessian[i*n+j] = r;
+      }
+
+  if (CholeskyDecomposition(m_LHessian+nI*n+nI,n,n-nI,
+			    m_LHessian+nI*n+nI,n)<0)
+    {
+      ODEBUG3("The hessian is not positive definite.");
+      return -1;
+    }
+
+  /* Inverse: iL = [ iLI 0 ; -iLS M iLI iLS ] */
+  InverseLowerTriangular(m_LHessian+nI*n+nI,n,n-nI,
+			 m_iLHessian+nI*n+nI,n);
+  for(unsigned int i=nI;i<n;i++)
+    for(unsigned int j=0;j<nI;j++)
+      {
+	double r=0.0;
+	for(unsigned int k=j;k<nI;k++)
+	  r += m_LHessian[i*n+k]*m_iLInvariant[k*nI+j];
+	m_iLHessian[i*n+j] = r;
+      }
+  for(int i=n-1;i>=(int)nI;i--)
+    for(unsigned int j=0;j<nI;j++)
+      {
+	double r=0.0;
+	for(int k=nI;k<=i;k++)
+	  r -= m_iLHessian[i*n+k]*m_iLHessian[k*n+j];
+	m_iLHessian[i*n+j] = r;
+      }
+
+  /* Least distance problem with V = L^t x:
+     c = iL D, A = DU iL^t, b = DS */
+  for(unsigned int i=0;i<n;i++)
+    {
+      double r=0.0;
+      for(unsigned int k=0;k<=i;k++)
+	r += m_iLHessian[i*n+k]*D[k];
+      m_cLDP[i] = r;
+    }
+
+  for(unsigned int li=0;li<NbConstraints;li++)
+    {
+      for(unsigned int i=0;i<n;i++)
+	{
+	  double r=0.0;
+	  for(unsigned int k=0;k<=i;k++)
+	    r += m_iLHessian[i*n+k]*DU[li+k*ldDU];
+	  m_ALDP[li+i*(NbConstraints+1)] = r;
+	}
+      m_bLDP[li] = DS[li];
+    }
+
+  for(unsigned int i=0;i<n;i++)
+    {
+      double r=0.0;
+      for(unsigned int k=i;k<n;k++)
+	r += m_LHessian[k*n+i]*InitialSolution[k];
+      m_Vk[i] = r;
+    }
+
+  m_A = m_ALDP;
+  m_b = m_bLDP;
+  m_NbOfConstraints = NbConstraints;
+  m_CstPartOfCostFunction = m_cLDP;
+
+  m_OptCholesky->SetA(m_A,m_NbOfConstraints);
+  m_OptCholesky->SetToZero();
+
+  double BeginTime = CurrentTime();
+
+  m_Statistics.NbOfConstraints = m_NbOfConstraints;
+  m_Statistics.NbOfActivations = 0;
+  m_Statistics.NbOfHotStartConstraints = 0;
+  m_Statistics.TimeLimitReached = false;
+
+  if (ActiveSetLoop(NumberSteps,0,BeginTime)<0)
+    return -1;
+
+  /* Back to the original variables: x = iL^t V */
+  for(unsigned int i=0;i<n;i++)
+    {
+      double r=0.0;
+      for(unsigned int k=i;k<n;k++)
+	r += m_iLHessian[k*n+i]*m_Vk[k];
+      X[i] = r;
+    }
+
+  for(unsigned int i=0;i<n;i++)
+    if ((isnan(X[i])) || (isinf(X[i])))
+      return -1;
+
+  return 0;
+}
+
 /* Store the ZMP solution for hotstart. */
 // void PLDPSolverHerdt::StoreCurrentZMPSolution(double *XkYk)
 // {
@@ -1080,7 +1364,7 @@ void PLDPSolverHerdt::WriteCurrentZMPSolution(string filename,
   double* lZMP = new double [lZMP_size];
 
   ofstream aof;
-  aof.open(filename.c_str(),ofstream::out);
+  aof.open(OutputFileName(filename).c_str(),ofstream::out);
 
 
   for(unsigned int i=0;i<m_CardV;i++)
@@ -1103,5 +1387,5 @@ void PLDPSolverHerdt::WriteCurrentZMPSolution(string filename,
     }
 
   aof.close();
-  delete lZMP;
+  delete [] lZMP;
 }
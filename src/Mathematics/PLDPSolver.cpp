@@ -85,6 +85,8 @@ PLDPSolver::PLDPSolver(unsigned int CardU,
   m_A = m_b= 0;
 
   m_ConstraintsValueComputed = 0;
+  m_PreviousZMPSolution = 0;
+  memset(&m_Statistics,0,sizeof(m_Statistics));
 
   m_NbMaxOfConstraints = 8*m_CardV;
   m_NbOfConstraints = 0;
@@ -98,6 +100,7 @@ PLDPSolver::PLDPSolver(unsigned int CardU,
   if (m_LimitedComputationTime)
     Buffer+="LT";
   Buffer+=".dat";
+  m_InfosFileName = Buffer;
   RESETDEBUG6((char*)Buffer.c_str());
   RESETDEBUG6("ActivatedConstraints.dat");
   AllocateMemoryForSolver();
@@ -107,28 +110,25 @@ PLDPSolver::PLDPSolver(unsigned int CardU,
 void PLDPSolver::AllocateMemoryForSolver()
 {
   PrecomputeiPuPx();
-  m_Vk = new double[2*m_CardV];
-  memset(m_Vk,0,2*m_CardV*sizeof(double));
 
-  m_PreviousZMPSolution = new double[2*m_CardV];
-  memset(m_PreviousZMPSolution,0,2*m_CardV*sizeof(double));
+  /* All the memory needed by SolveProblem is allocated here,
+     the pointers below are shortcuts inside the workspace. */
+  m_Workspace.Reserve(2*m_CardV,m_NbMaxOfConstraints);
 
-  m_UnconstrainedDescentDirection = new double[2*m_CardV];
-  memset(m_UnconstrainedDescentDirection,0,2*m_CardV*sizeof(double));
+  m_Vk = m_Workspace.Vk();
+  m_PreviousZMPSolution = m_Workspace.ZMPSolution();
+  m_UnconstrainedDescentDirection = m_Workspace.UnconstrainedDescentDirection();
+  m_d = m_Workspace.d();
 
-  m_L = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
-  m_iL = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
+  m_L = m_Workspace.L();
+  m_iL = m_Workspace.iL();
+  m_v1 = m_Workspace.v1();
+  m_v2 = m_Workspace.v2();
+  m_y = m_Workspace.y();
+  m_tmp1 = m_Workspace.tmp1();
+  m_tmp2 = m_Workspace.tmp2();
+  m_ConstraintsValueComputed = m_Workspace.ConstraintsValueComputed();
 
-  m_v1 = new double[m_NbMaxOfConstraints];
-  m_v2 = new double[m_NbMaxOfConstraints];
-  m_tmp1 = new double[m_NbMaxOfConstraints];
-  m_tmp2 = new double[m_NbMaxOfConstraints];
-
-  m_y = new double[m_NbMaxOfConstraints];
-
-  m_ConstraintsValueComputed = new bool [m_NbMaxOfConstraints*2];
-
-  m_d = new double[2*m_CardV];
   m_OptCholesky->SetL(m_L);
   m_OptCholesky->SetiL(m_iL);
 }
@@ -153,7 +153,14 @@ void PLDPSolver::InitializeSolver()
   // Same for the descent.
   memset(m_d,0,2*m_CardV*sizeof(double));
 #endif
-  m_ActivatedConstraints.clear();
+  m_Workspace.ClearActiveSet();
+}
+
+void PLDPSolver::SetLimitedComputationTime(double aTime)
+{
+  m_LimitedComputationTime = (aTime>=0.0);
+  if (m_LimitedComputationTime)
+    m_AmountOfLimitedComputationTime = aTime;
 }
 
 PLDPSolver::~PLDPSolver()
@@ -161,57 +168,22 @@ PLDPSolver::~PLDPSolver()
   if (m_iPuPx!=0)
     delete [] m_iPuPx;
 
-  if (m_Vk!=0)
-    delete [] m_Vk;
-
-  if (m_PreviousZMPSolution!=0)
-    delete [] m_PreviousZMPSolution;
-
-  if (m_UnconstrainedDescentDirection!=0)
-    delete [] m_UnconstrainedDescentDirection;
-
   if (m_OptCholesky!=0)
     delete m_OptCholesky;
 
-  if (m_L!=0)
-    delete [] m_L;
-
-  if (m_iL!=0)
-    delete [] m_iL;
-
-  if (m_v1!=0)
-    delete [] m_v1;
-
-  if (m_v2!=0)
-    delete [] m_v2;
-
-  if (m_tmp1!=0)
-    delete [] m_tmp1;
-
-  if (m_tmp2!=0)
-    delete [] m_tmp2;
-
-  if (m_d!=0)
-    delete [] m_d;
-
-  if (m_y!=0)
-    delete [] m_y;
-
-  if ( m_ConstraintsValueComputed!=0)
-    delete [] m_ConstraintsValueComputed;
-
+  /* The other buffers belong to m_Workspace. */
 }
 
 int PLDPSolver::PrecomputeiPuPx()
 {
   m_iPuPx = new double[2*m_CardV*6];
 
-  memset(m_iPuPx,0,2*m_CardV*6);
+  memset(m_iPuPx,0,2*m_CardV*6*sizeof(double));
 
   if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("iPu.dat",ofstream::out);
+      aof.open(OutputFileName("iPu.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<m_CardV;j++)
@@ -222,7 +194,7 @@ int PLDPSolver::PrecomputeiPuPx()
 	}
       aof.close();
 
-      aof.open("Pu.dat",ofstream::out);
+      aof.open(OutputFileName("Pu.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<m_CardV;j++)
@@ -234,7 +206,7 @@ int PLDPSolver::PrecomputeiPuPx()
       aof.close();
 
 
-      aof.open("Px.dat",ofstream::out);
+      aof.open(OutputFileName("Px.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<3;j++)
@@ -245,7 +217,7 @@ int PLDPSolver::PrecomputeiPuPx()
 	}
       aof.close();
 
-      aof.open("isLQ.dat",ofstream::out);
+      aof.open(OutputFileName("isLQ.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<m_CardV;j++)
@@ -352,7 +324,8 @@ int PLDPSolver::ForwardSubstitution()
       (m_ItNb>0))
     startIndex = m_ActivatedConstraints.size()-1;
   */
-  for(unsigned int i=startIndex;i<m_ActivatedConstraints.size();i++)
+  unsigned int SizeOfL = m_Workspace.NbOfActiveConstraints();
+  for(unsigned int i=startIndex;i<SizeOfL;i++)
     {
       m_y[i] = m_v1[i] ;
       for(unsigned int k=0;k<i;k++)
@@ -372,7 +345,7 @@ int PLDPSolver::BackwardSubstitution()
   // LL^t v2 = v1 <-> L y = v1 with L^t v2 = y
   // y solved with first phase.
   // So now we are looking for v2.
-  unsigned int SizeOfL = m_ActivatedConstraints.size();
+  unsigned int SizeOfL = m_Workspace.NbOfActiveConstraints();
   if (SizeOfL==0)
     return 0;
 
@@ -403,6 +376,7 @@ int PLDPSolver::BackwardSubstitution()
 
 int PLDPSolver::ComputeProjectedDescentDirection()
 {
+  unsigned int NbOfActiveConstraints = m_Workspace.NbOfActiveConstraints();
 
   if(m_DebugMode>1)
     {
@@ -410,17 +384,17 @@ int PLDPSolver::ComputeProjectedDescentDirection()
 
       char Buffer[1024];
       sprintf(Buffer,"AC_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int li=0;li<m_ActivatedConstraints.size();li++)
-	aof<< m_ActivatedConstraints[li] << " ";
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int li=0;li<NbOfActiveConstraints;li++)
+	aof<< m_Workspace.ActiveConstraint(li) << " ";
       aof <<endl;
       aof.close();
 
       sprintf(Buffer,"E_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int li=0;li<m_ActivatedConstraints.size();li++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int li=0;li<NbOfActiveConstraints;li++)
 	{
-	  unsigned int RowCstMatrix = m_ActivatedConstraints[li];
+	  unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(li);
 	  for(unsigned int lj=0;lj<2*m_CardV;lj++)
 	    {
 	      aof << m_A[RowCstMatrix+lj*(m_NbOfConstraints+1)] << " ";
@@ -430,7 +404,7 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       aof.close();
 
       sprintf(Buffer,"c_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int li=0;li<2*m_CardV;li++)
  	{
 	  aof << m_UnconstrainedDescentDirection[li] << " " ;
@@ -446,10 +420,10 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       (m_ItNb>0))
     startIndex = m_ActivatedConstraints.size()-1;
   */
-  for(unsigned int li=startIndex;li<m_ActivatedConstraints.size();li++)
+  for(unsigned int li=startIndex;li<NbOfActiveConstraints;li++)
     {
       m_v1[li] = 0.0;
-      unsigned int RowCstMatrix = m_ActivatedConstraints[li];
+      unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(li);
       ODEBUG("RowCstMatrix:"<<RowCstMatrix);
       for(unsigned int lj=0;lj<2*m_CardV;lj++)
 	{
@@ -465,8 +439,8 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"v1_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_v1[lj] << endl;
       aof.close();
     }
@@ -481,8 +455,8 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"y_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_y[lj] << endl;
       aof.close();
 
@@ -496,8 +470,8 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"v2_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	aof << m_v2[lj] << endl;
       aof.close();
     }
@@ -505,13 +479,13 @@ int PLDPSolver::ComputeProjectedDescentDirection()
   // Compute d
   // d = c - Et v2
   ODEBUG("Size of ActivatedConstraints: "<<
-	  m_ActivatedConstraints.size());
+	  NbOfActiveConstraints);
   for(unsigned int li=0;li<2*m_CardV;li++)
     {
       m_d[li] = m_UnconstrainedDescentDirection[li];
-      for(unsigned int lj=0;lj<m_ActivatedConstraints.size();lj++)
+      for(unsigned int lj=0;lj<NbOfActiveConstraints;lj++)
 	{
-	  unsigned int RowCstMatrix = m_ActivatedConstraints[lj];
+	  unsigned int RowCstMatrix = m_Workspace.ActiveConstraint(lj);
 	  m_d[li]-= m_A[RowCstMatrix+li*(m_NbOfConstraints+1)]*
 	    m_v2[lj];
 	}
@@ -522,7 +496,7 @@ int PLDPSolver::ComputeProjectedDescentDirection()
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"UDD_%02d.dat",m_ItNb);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int lj=0;lj<2*m_CardV;lj++)
 	aof  << m_d[lj] << " ";
       aof << endl;
@@ -531,36 +505,21 @@ int PLDPSolver::ComputeProjectedDescentDirection()
   return 0;
 }
 
-double PLDPSolver::ComputeAlpha(vector<unsigned int> & NewActivatedConstraints,
-				vector<int> &SimilarConstraint)
+double PLDPSolver::ComputeAlpha(int &TheConstraintToActivate,
+				const int *SimilarConstraint)
 {
   double Alpha=10000000.0;
   double *ptA = 0;
-  bool TheConstraintIsToBeAdded=false;
-  unsigned int TheConstraintToActivate=0;
+  TheConstraintToActivate=-1;
 
   for(unsigned li=0;li<m_NbOfConstraints;li++)
     {
-
-
-      bool ConstraintFound=false;
-
       // Register that this constraint has yet been computed.
       m_ConstraintsValueComputed[li] = false;
       m_ConstraintsValueComputed[li+m_NbOfConstraints] = false;
 
       // Make sure that this constraint is not already activated.
-      for(unsigned int ConstraintIndex=0;
-	  ConstraintIndex<m_ActivatedConstraints.size();
-	  ConstraintIndex++)
-	{
-	  if (m_ActivatedConstraints[ConstraintIndex]==li)
-	    {
-	      ConstraintFound=true;
-	      break;
-	    }
-	}
-      if (ConstraintFound)
+      if (m_Workspace.IsActive(li))
 	continue;
 
       ptA = m_A + li;
@@ -570,7 +529,7 @@ double PLDPSolver::ComputeAlpha(vector<unsigned int> & NewActivatedConstraints,
       // Check if we can not reuse an already computed result
       {
 	bool ToBeComputed=true;
-	if (SimilarConstraint[li]!=0)
+	if ((SimilarConstraint!=0) && (SimilarConstraint[li]!=0))
 	  {
 	    int lindex = li+SimilarConstraint[li];
 	    if (m_ConstraintsValueComputed[lindex])
@@ -599,7 +558,7 @@ double PLDPSolver::ComputeAlpha(vector<unsigned int> & NewActivatedConstraints,
 	  // Check if we can not reuse an already computed result
 	  {
 	    bool ToBeComputed=true;
-	    if (SimilarConstraint[li]!=0)
+	    if ((SimilarConstraint!=0) && (SimilarConstraint[li]!=0))
 	      {
 		int lindex = li+SimilarConstraint[li];
 		if (m_ConstraintsValueComputed[lindex+m_NbOfConstraints])
@@ -630,27 +589,33 @@ double PLDPSolver::ComputeAlpha(vector<unsigned int> & NewActivatedConstraints,
 
 	  if (Alpha>lalpha)
 	    {
-	      ODEBUG("m_v2[li] : "<< m_v2[li] <<
-		      " m_v1[li] : " << m_v1[li] << " "
-		      " lalpha: "<< lalpha << " "
+	      ODEBUG(" lalpha: "<< lalpha << " "
 		      " Constrainte " << li << " on "
 		      << m_NbOfConstraints << " constraints.");
 
 	      Alpha = lalpha;
 	      if (Alpha<1)
-		{
-		  TheConstraintIsToBeAdded = true;
-		  TheConstraintToActivate=li;
-		}
+		TheConstraintToActivate=li;
 	    }
 	}
     }
 
-  if (TheConstraintIsToBeAdded)
-    NewActivatedConstraints.push_back(TheConstraintToActivate);
-
   return Alpha;
 }
+
+int PLDPSolver::ActivateConstraint(unsigned int aConstraint)
+{
+  if (m_Workspace.AddActiveConstraint(aConstraint)<0)
+    return -1;
+
+  if (m_OptCholesky->AddActiveConstraint(aConstraint)<0)
+    {
+      m_Workspace.RemoveLastActiveConstraint();
+      return -1;
+    }
+  return 0;
+}
+
 int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 			     unsigned int NbOfConstraints,
 			     double *LinearPartOfConstraints,
@@ -662,7 +627,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 			     unsigned int NumberOfRemovedConstraints,
 			     bool StartingSequence)
 {
-  vector<unsigned int> NewActivatedConstraints;
+  int TheConstraintToActivate=-1;
   if (StartingSequence)
     m_InternalTime = 0.0;
 
@@ -689,13 +654,13 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       WriteCurrentZMPSolution("VkInit.dat",XkYk);
 
       ofstream aof;
-      aof.open("InitialSolution.dat",ofstream::out);
+      aof.open(OutputFileName("InitialSolution.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_CardV;i++)
 	aof <<m_Vk[i] << " ";
       aof << endl;
       aof.close();
 
-      aof.open("iPuPx.dat",ofstream::out);
+      aof.open(OutputFileName("iPuPx.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_CardV;i++)
 	{
 	  for(unsigned int j=0;j<6;j++)
@@ -705,7 +670,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof << endl;
       aof.close();
 
-      aof.open("A.dat",ofstream::out);
+      aof.open(OutputFileName("A.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_NbOfConstraints;i++)
 	{
 	  for(unsigned int j=0;j<2*m_CardV;j++)
@@ -715,7 +680,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof << endl;
       aof.close();
 
-      aof.open("b.dat",ofstream::out);
+      aof.open(OutputFileName("b.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_NbOfConstraints;i++)
 	{
 	  aof << m_b[i] << " ";
@@ -723,7 +688,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof << endl;
       aof.close();
 
-      aof.open("ZMPRef.dat",ofstream::out);
+      aof.open(OutputFileName("ZMPRef.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_CardV;i++)
 	{
 	    aof << ZMPRef[i] << " ";
@@ -731,7 +696,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof << endl;
       aof.close();
 
-      aof.open("XkYk.dat",ofstream::out);
+      aof.open(OutputFileName("XkYk.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<6;i++)
 	{
 	    aof << XkYk[i] << " ";
@@ -742,7 +707,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
   if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("A.dat",ofstream::out);
+      aof.open(OutputFileName("A.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<m_NbOfConstraints;i++)
 	{
 	  for(unsigned int j=0;j<2*m_CardV;j++)
@@ -754,7 +719,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof << endl;
       aof.close();
 
-      aof.open("b.dat",ofstream::out);
+      aof.open(OutputFileName("b.dat").c_str(),ofstream::out);
 
       for(unsigned int j=0;j<m_NbOfConstraints;j++)
 	{
@@ -777,24 +742,25 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 
   gettimeofday(&begin,0);
 
+  m_Statistics.NbOfConstraints = m_NbOfConstraints;
+  m_Statistics.NbOfActivations = 0;
+  m_Statistics.TimeLimitReached = false;
+
   // Hot Start
   if (m_HotStart)
     {
-      for(unsigned int i=0;i<m_PreviouslyActivatedConstraints.size();i++)
+      for(unsigned int i=0;i<m_Workspace.NbOfPreviouslyActiveConstraints();i++)
 	{
-	  int lindex=m_PreviouslyActivatedConstraints[i]-NumberOfRemovedConstraints;
-	  if (lindex>=0)
-	    {
-	      m_ActivatedConstraints.push_back(lindex);
-	    }
-
+	  int lindex=(int)m_Workspace.PreviouslyActiveConstraint(i)-
+	    (int)NumberOfRemovedConstraints;
+	  if ((lindex>=0) &&
+	      (lindex<(int)m_NbOfConstraints))
+	    ActivateConstraint(lindex);
 	}
-      if (m_ActivatedConstraints.size()>0)
-	m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints);
-
     }
+  m_Statistics.NbOfHotStartConstraints = m_Workspace.NbOfActiveConstraints();
 
-  m_PreviouslyActivatedConstraints.clear();
+  m_Workspace.ClearPreviouslyActiveSet();
 
   double alpha=0.0;
   m_ItNb=0;
@@ -811,8 +777,9 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       ComputeProjectedDescentDirection();
 
       /*! Step three : Compute alpha */
-      alpha = ComputeAlpha(NewActivatedConstraints,
-			   SimilarConstraints);
+      alpha = ComputeAlpha(TheConstraintToActivate,
+			   SimilarConstraints.empty() ? 0 :
+			   &SimilarConstraints[0]);
 
       if (alpha>=1.0)
 	{
@@ -841,7 +808,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	  ofstream aof;
 	  char Buffer[1024];
 	  sprintf(Buffer,"U_%.3f_%02d.dat",m_InternalTime,m_ItNb);
-	  aof.open(Buffer,ofstream::out);
+	  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	  for(unsigned int i=0;i<2*m_CardV;i++)
 	    {
 	      aof << m_Vk[i] << " " ;
@@ -854,22 +821,20 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 
       if (ContinueAlgo)
 	{
-	  ODEBUG("Nb of activated constraints: " << NewActivatedConstraints.size());
-	  m_OptCholesky->AddActiveConstraints(NewActivatedConstraints);
-	  for(unsigned int i=0;i<NewActivatedConstraints.size();i++)
-	    m_ActivatedConstraints.push_back(NewActivatedConstraints[i]);
-
-	  NewActivatedConstraints.clear();
+	  ODEBUG("Activated constraint: " << TheConstraintToActivate);
+	  if ((TheConstraintToActivate>=0) &&
+	      (ActivateConstraint(TheConstraintToActivate)==0))
+	    m_Statistics.NbOfActivations++;
 
 	  if (m_DebugMode>1)
 	    {
 	      ofstream aof;
 	      char Buffer[1024];
 	      sprintf(Buffer,"LE_%02d.dat",m_ItNb);
-	      aof.open(Buffer,ofstream::out);
-	      for(unsigned int i=0;i<m_ActivatedConstraints.size();i++)
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+	      for(unsigned int i=0;i<m_Workspace.NbOfActiveConstraints();i++)
 		{
-		  for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
+		  for(unsigned int j=0;j<m_Workspace.NbOfActiveConstraints();j++)
 		    {
 		      aof << m_L[i*m_NbMaxOfConstraints+j] << " ";
 		    }
@@ -878,7 +843,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	      aof.close();
 	      ODEBUG("m_L(0,0)= " << m_L[0]);
 	      sprintf(Buffer,"alpha_%02d.dat",m_ItNb);
-	      aof.open(Buffer,ofstream::out);
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	      aof << alpha << endl;
 	      aof.close();
 
@@ -893,15 +858,26 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	  gettimeofday(&current,0);
 	  double r=(double)(current.tv_sec-begin.tv_sec) +
 	    0.000001*(current.tv_usec-begin.tv_usec);
-	  if (r> m_AmountOfLimitedComputationTime)
+	  if ((ContinueAlgo) &&
+	      (r> m_AmountOfLimitedComputationTime))
 	    {
 	      ContinueAlgo=false;
+	      m_Statistics.TimeLimitReached=true;
 	    }
 	}
 
       m_ItNb++;
     }
 
+  {
+    struct timeval end;
+    gettimeofday(&end,0);
+    m_Statistics.ComputationTime = (double)(end.tv_sec-begin.tv_sec) +
+      0.000001*(end.tv_usec-begin.tv_usec);
+  }
+  m_Statistics.NbOfIterations = m_ItNb;
+  m_Statistics.NbOfActiveConstraints = m_Workspace.NbOfActiveConstraints();
+
   for(unsigned int i=0;i<2*m_CardV;i++)
     X[i] = m_Vk[i];
 
@@ -909,18 +885,15 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
   if (m_HotStart)
     {
       //cout << "AR (" << lTime <<") :" ;
-      for( unsigned int i=0;i<m_ActivatedConstraints.size();i++)
+      for( unsigned int i=0;i<m_Workspace.NbOfActiveConstraints();i++)
 	{
-	  //cout << "( " << m_ActivatedConstraints[i] << " , " << m_v2[i] << " ) ";
 	  if (m_v2[i]<0.0)
-	    {
-	      m_PreviouslyActivatedConstraints.push_back(m_ActivatedConstraints[i]);
-	      //cout << m_ActivatedConstraints[i] << " " ;
-	    }
+	    m_Workspace.AddPreviouslyActiveConstraint(m_Workspace.ActiveConstraint(i));
 	}
       /*
-	cout << (int)m_ActivatedConstraints.size() - (int)m_PreviouslyActivatedConstraints.size() <<  " "
-	<< m_PreviouslyActivatedConstraints.size() << endl;
+	cout << (int)m_Workspace.NbOfActiveConstraints() -
+	(int)m_Workspace.NbOfPreviouslyActiveConstraints() <<  " "
+	<< m_Workspace.NbOfPreviouslyActiveConstraints() << endl;
 	cout << endl; */
       StoreCurrentZMPSolution(XkYk);
 
@@ -929,20 +902,16 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
   if (0)
     {
       ofstream aof;
-      aof.open("ActivatedConstraints.dat",ofstream::app);
+      aof.open(OutputFileName("ActivatedConstraints.dat").c_str(),ofstream::app);
       for(unsigned int i=0;i<320;i++)
       {
 	bool FoundConstraint=false;
 
-	if (i<m_NbOfConstraints)
+	if ((i<m_NbOfConstraints) &&
+	    (m_Workspace.IsActive(i)))
 	  {
-	    for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
-	      if (m_ActivatedConstraints[j]==i)
-		{
-		  aof << "1 ";
-		  FoundConstraint=true;
-		  break;
-		}
+	    aof << "1 ";
+	    FoundConstraint=true;
 	  }
 	if (!FoundConstraint)
 	  aof << "0 ";
@@ -966,15 +935,15 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
   if (m_DebugMode>1)
     {
       ofstream aof;
-      aof.open("NbIt.dat",ofstream::out);
+      aof.open(OutputFileName("NbIt.dat").c_str(),ofstream::out);
       aof << m_ItNb;
       aof.close();
 
-      aof.open("Pb.dat",ofstream::out);
+      aof.open(OutputFileName("Pb.dat").c_str(),ofstream::out);
       aof<<" Number of iterations " << m_ItNb << endl;
       aof.close();
 
-      aof.open("UFinal.dat",ofstream::out);
+      aof.open(OutputFileName("UFinal.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_CardV;i++)
 	{
 	  aof << X[i] << " " ;
@@ -983,24 +952,18 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
       aof.close();
 
       WriteCurrentZMPSolution("FinalSolution.dat",XkYk);
-      aof.open("Pb.dat",ofstream::out);
+      aof.open(OutputFileName("Pb.dat").c_str(),ofstream::out);
       aof<<" Number of iterations " << m_ItNb << endl;
       aof.close();
 
     }
 
 
-  string Buffer("InfosPLDP");
-  if (m_HotStart)
-    Buffer+="HS";
-  if (m_LimitedComputationTime)
-    Buffer+="LT";
-  Buffer+=".dat";
-
-  ODEBUG6(m_ActivatedConstraints.size() << " "
+  ODEBUG6(m_Workspace.NbOfActiveConstraints() << " "
 	  << NbOfConstraints << " "
-	  << m_ActivatedConstraints.size() - m_PreviouslyActivatedConstraints.size() << " "
-	  << m_ItNb,(char*)Buffer.c_str());
+	  << m_Workspace.NbOfActiveConstraints() -
+	  m_Workspace.NbOfPreviouslyActiveConstraints() << " "
+	  << m_ItNb,(char*)m_InfosFileName.c_str());
 
   m_InternalTime += 0.02;
   return 0;
@@ -1046,7 +1009,7 @@ void PLDPSolver::WriteCurrentZMPSolution(string filename,
   double* lZMP = new double [lZMP_size];
 
   ofstream aof;
-  aof.open(filename.c_str(),ofstream::out);
+  aof.open(OutputFileName(filename).c_str(),ofstream::out);
 
 
   for(unsigned int i=0;i<m_CardV;i++)
@@ -1069,5 +1032,5 @@ void PLDPSolver::WriteCurrentZMPSolution(string filename,
     }
 
   aof.close();
-  delete lZMP;
+  delete [] lZMP;
 }
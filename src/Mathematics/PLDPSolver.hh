@@ -31,9 +31,11 @@
 */
 
 #ifndef _PLDP_SOLVER_H_
+#define _PLDP_SOLVER_H_
 
 #include <vector>
 #include <Mathematics/OptCholesky.hh>
+#include <Mathematics/PLDPWorkspace.hh>
 
 namespace Optimization
 {
@@ -66,6 +68,14 @@ namespace Optimization
 			   std::vector<int> &SimilarConstraint,
 			   unsigned int NumberOfRemovedConstraints,
 			   bool StartingSequence);
+
+	  /*! \brief Returns the statistics of the last call to SolveProblem. */
+	  const PLDPSolveStatistics_t & GetStatistics() const
+	  { return m_Statistics; }
+
+	  /*! \brief Set the maximal amount of time spent in the active set loop.
+	    A negative value removes the limit. */
+	  void SetLimitedComputationTime(double aTime);
 	protected:
 	  
 	  /*! \name Initial solution methods related 
@@ -113,9 +123,20 @@ namespace Optimization
 
 	  /*! @} */
 
-	  /*! Detecting violated constraints */
-	  double ComputeAlpha(vector<unsigned int> &NewActivatedConstraints,
-			      vector<int> &SimilarConstraint);
+	  /*! Detecting violated constraints.
+	    \param[out] TheConstraintToActivate the blocking constraint,
+	    -1 if the full step can be done.
+	    \param[in] SimilarConstraint for each constraint, offset to a
+	    previous constraint with the opposite row, 0 if there is none.
+	    It may be null when no constraint has a similar one.
+	   */
+	  double ComputeAlpha(int &TheConstraintToActivate,
+			      const int *SimilarConstraint);
+
+	  /*! Add a constraint to the active set and update the cholesky
+	    decomposition accordingly.
+	    \return -1 if the constraint could not be added. */
+	  int ActivateConstraint(unsigned int aConstraint);
 
 	  /*! Store the current ZMP solution for hot start purposes. */
 	  void StoreCurrentZMPSolution(double *XkYk);
@@ -206,11 +227,14 @@ namespace Optimization
 	   ( specifically this one). */
 	  PatternGeneratorJRL::OptCholesky * m_OptCholesky;
 
-	  /*! List of activated constraints. */
-	  vector<unsigned int> m_ActivatedConstraints;
+	  /*! Preallocated memory: buffers and active sets. */
+	  PLDPWorkspace m_Workspace;
+
+	  /*! Statistics about the last solve. */
+	  PLDPSolveStatistics_t m_Statistics;
 
-	  /*! List of previously activated constraints. */
-	  vector<unsigned int> m_PreviouslyActivatedConstraints;
+	  /*! Name of the file storing informations on each solve. */
+	  string m_InfosFileName;
 
 	  /*! Boolean to perform a hotstart */
 	  bool m_HotStart;
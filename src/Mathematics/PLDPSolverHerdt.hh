@@ -30,10 +30,12 @@
 */
 
 #ifndef _PLDP_SOLVER_H_HERDT
+#define _PLDP_SOLVER_H_HERDT
 
 #include <vector>
 #include <deque>
 #include <Mathematics/OptCholesky.hh>
+#include <Mathematics/PLDPWorkspace.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
 namespace Optimization
@@ -67,6 +69,55 @@ namespace Optimization
 			   double *X,
 			   unsigned int NumberOfRemovedConstraints, unsigned int NbRemovedFootCstr,
 			   bool StartingSequence, unsigned int NumberSteps, bool CurrentStateChanged, double time);
+
+	  /*! \brief Solve a generic quadratic program
+	    \f[ \min_x \frac{1}{2} x^{\top} Q x + D^{\top} x
+	    \quad \mbox{s.t.} \quad DU\, x + DS \geq 0 \f]
+	    with the variables ordered as in the velocity referenced
+	    formulation: the jerks of the CoM along x and y over the
+	    preview window, followed by the x and y positions of the
+	    previewed feet.
+	    The problem is turned into a least distance problem by
+	    the change of variables \f$ V = L^{\top} x \f$ where
+	    \f$ Q = L L^{\top} \f$. The block of \f$ L \f$ related to the
+	    jerks is provided by PrecomputeInvariantPart, only the rows
+	    related to the feet are computed here.
+	    No hot start is done and constraints are never removed from
+	    the active set.
+	    @param[in] Q Hessian stored with a leading dimension \a ldQ.
+	    @param[in] D Linear part of the cost function.
+	    @param[in] DU Linear part of the constraints, stored
+	    column-wise with a leading dimension \a ldDU.
+	    @param[in] DS Constant part of the constraints.
+	    @param[in] InitialSolution Feasible starting point.
+	    @param[out] X Solution of the problem.
+	    \return -1 if the problem can not be handled (wrong size,
+	    Hessian not positive definite, infeasible initial solution),
+	    0 otherwise. */
+	  int SolveProblem(const double *Q, unsigned int ldQ,
+			   const double *D,
+			   const double *DU, unsigned int ldDU,
+			   const double *DS,
+			   unsigned int NbVariables,
+			   unsigned int NbConstraints,
+			   const double *InitialSolution,
+			   double *X);
+
+	  /*! \brief Compute the cholesky decomposition of the
+	    upper left block of size \a NbInvariant of \a Q, and its inverse.
+	    This block is assumed to be constant between two calls
+	    to SolveProblem.
+	    \return -1 if the block is not positive definite. */
+	  int PrecomputeInvariantPart(const double *Q, unsigned int ldQ,
+				      unsigned int NbInvariant);
+
+	  /*! \brief Set the maximal amount of time spent in the active set loop.
+	    A negative value removes the limit. */
+	  void SetLimitedComputationTime(double aTime);
+
+	  /*! \brief Returns the statistics of the last call to SolveProblem. */
+	  const PLDPSolveStatistics_t & GetStatistics() const
+	  { return m_Statistics; }
 	protected:
 	  
 	  /*! \name Initial solution methods related 
@@ -86,9 +137,22 @@ namespace Optimization
 	    the class. */
 	  void InitializeSolver(unsigned int NumberSteps);
 
-	  /*! Allocate memory for solver. */
+	  /*! Allocate memory for solver.
+	    Nothing is allocated if the workspace is already large enough
+	    for \a NumberSteps. */
 	  void AllocateMemoryForSolver(unsigned int NumberSteps);
 
+	  /*! Allocate the memory needed to handle a generic
+	    quadratic program. */
+	  void AllocateMemoryForQP(unsigned int NbVariables);
+
+	  /*! Run the active set iterations from m_Vk.
+	    \param[in] BeginTime Start of the solve used by the time limit.
+	    \return -1 if a negative step has been found. */
+	  int ActiveSetLoop(unsigned int NumberSteps,
+			    double *XkYk,
+			    double BeginTime);
+
 	  /*! \name Projected descent direction methods related 
 	    @{
 	   */
@@ -114,10 +178,17 @@ namespace Optimization
 
 	  /*! @} */
 
-	  /*! Detecting violated constraints */
-	  double ComputeAlpha(vector<unsigned int> &NewActivatedConstraints,
+	  /*! Detecting violated constraints.
+	    \param[out] TheConstraintToActivate the blocking constraint,
+	    -1 if the full step can be done. */
+	  double ComputeAlpha(int &TheConstraintToActivate,
 			      unsigned int NumberSteps);
 
+	  /*! Add a constraint to the active set and update the cholesky
+	    decomposition accordingly.
+	    \return -1 if the constraint could not be added. */
+	  int ActivateConstraint(unsigned int aConstraint);
+
 /* 	  /\*! Store the current ZMP solution for hot start purposes. *\/ */
 /* 	  void StoreCurrentZMPSolution(double *XkYk); */
 
@@ -198,6 +269,32 @@ namespace Optimization
 	  /*! Number of steps previewed */
 	  unsigned int * m_NbSteps;
 
+	  /*! Number of steps used to compute m_iPuPx, -1 if not computed. */
+	  int m_iPuPxNumberSteps;
+
+	  /*! Size of the control vector handled by m_OptCholesky. */
+	  unsigned int m_SizeOfControl;
+
+	  /*! \name Data related to generic quadratic programs.
+	    @{
+	   */
+	  /*! Size of the precomputed block of the Hessian. */
+	  unsigned int m_NbInvariant;
+
+	  /*! Cholesky decomposition of the invariant block and its inverse. */
+	  double *m_LInvariant, *m_iLInvariant;
+
+	  /*! Cholesky decomposition of the whole Hessian and its inverse. */
+	  double *m_LHessian, *m_iLHessian;
+
+	  /*! Linear part of the constraints, constant part of the constraints
+	    and of the cost function in the least distance problem. */
+	  double *m_ALDP, *m_bLDP, *m_cLDP;
+
+	  /*! Capacities of the buffers above. */
+	  unsigned int m_QPSizeOfControl, m_QPNbMaxOfConstraints;
+	  /*! @} */
+
 	  /*! \name Debugging fields 
 	    @{
 	   */
@@ -212,11 +309,14 @@ namespace Optimization
 	   ( specifically this one). */
 	  PatternGeneratorJRL::OptCholesky * m_OptCholesky;
 
-	  /*! List of activated constraints. */
-	  vector<unsigned int> m_ActivatedConstraints;
+	  /*! Preallocated memory: buffers and active sets. */
+	  PLDPWorkspace m_Workspace;
+
+	  /*! Statistics about the last solve. */
+	  PLDPSolveStatistics_t m_Statistics;
 
-	  /*! List of previously activated constraints. */
-	  vector<unsigned int> m_PreviouslyActivatedConstraints;
+	  /*! Name of the file storing informations on each solve. */
+	  string m_InfosFileName;
 
 	  /*! Boolean to perform a hotstart */
 	  bool m_HotStart;
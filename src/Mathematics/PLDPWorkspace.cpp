@@ -0,0 +1,169 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier    Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPWorkspace.cpp
+  \brief Fixed-capacity memory shared by the PLDP solvers.
+*/
+#include <cstring>
+
+#include <Mathematics/PLDPWorkspace.hh>
+
+using namespace Optimization::Solver;
+
+PLDPWorkspace::PLDPWorkspace():
+  m_SizeOfControl(0),
+  m_NbMaxOfConstraints(0),
+  m_Vk(0),
+  m_ZMPSolution(0),
+  m_UnconstrainedDescentDirection(0),
+  m_d(0),
+  m_L(0),
+  m_iL(0),
+  m_v1(0),
+  m_v2(0),
+  m_y(0),
+  m_tmp1(0),
+  m_tmp2(0),
+  m_ConstraintsValueComputed(0),
+  m_ActivatedConstraints(0),
+  m_NbOfActivatedConstraints(0),
+  m_IsActive(0),
+  m_PreviouslyActivatedConstraints(0),
+  m_NbOfPreviouslyActivatedConstraints(0)
+{
+}
+
+PLDPWorkspace::~PLDPWorkspace()
+{
+  FreeMemory();
+}
+
+void PLDPWorkspace::FreeMemory()
+{
+  double ** lDoubleBuffers[11] =
+    { &m_Vk, &m_ZMPSolution, &m_UnconstrainedDescentDirection, &m_d,
+      &m_L, &m_iL, &m_v1, &m_v2, &m_y, &m_tmp1, &m_tmp2 };
+
+  for(unsigned int i=0;i<11;i++)
+    {
+      if (*lDoubleBuffers[i]!=0)
+	delete [] *lDoubleBuffers[i];
+      *lDoubleBuffers[i] = 0;
+    }
+
+  if (m_ConstraintsValueComputed!=0)
+    delete [] m_ConstraintsValueComputed;
+  m_ConstraintsValueComputed = 0;
+
+  if (m_IsActive!=0)
+    delete [] m_IsActive;
+  m_IsActive = 0;
+
+  if (m_ActivatedConstraints!=0)
+    delete [] m_ActivatedConstraints;
+  m_ActivatedConstraints = 0;
+
+  if (m_PreviouslyActivatedConstraints!=0)
+    delete [] m_PreviouslyActivatedConstraints;
+  m_PreviouslyActivatedConstraints = 0;
+
+  m_SizeOfControl = 0;
+  m_NbMaxOfConstraints = 0;
+  m_NbOfActivatedConstraints = 0;
+  m_NbOfPreviouslyActivatedConstraints = 0;
+}
+
+bool PLDPWorkspace::Reserve(unsigned int SizeOfControl,
+			    unsigned int NbMaxOfConstraints)
+{
+  if ((SizeOfControl<=m_SizeOfControl) &&
+      (NbMaxOfConstraints<=m_NbMaxOfConstraints))
+    return false;
+
+  /* Never shrink one capacity while growing the other. */
+  if (SizeOfControl<m_SizeOfControl)
+    SizeOfControl = m_SizeOfControl;
+  if (NbMaxOfConstraints<m_NbMaxOfConstraints)
+    NbMaxOfConstraints = m_NbMaxOfConstraints;
+
+  FreeMemory();
+
+  m_SizeOfControl = SizeOfControl;
+  m_NbMaxOfConstraints = NbMaxOfConstraints;
+
+  m_Vk = new double[m_SizeOfControl];
+  m_ZMPSolution = new double[m_SizeOfControl];
+  m_UnconstrainedDescentDirection = new double[m_SizeOfControl];
+  m_d = new double[m_SizeOfControl];
+  memset(m_Vk,0,m_SizeOfControl*sizeof(double));
+  memset(m_ZMPSolution,0,m_SizeOfControl*sizeof(double));
+  memset(m_UnconstrainedDescentDirection,0,m_SizeOfControl*sizeof(double));
+  memset(m_d,0,m_SizeOfControl*sizeof(double));
+
+  m_L = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
+  m_iL = new double[m_NbMaxOfConstraints*m_NbMaxOfConstraints];
+
+  m_v1 = new double[m_NbMaxOfConstraints];
+  m_v2 = new double[m_NbMaxOfConstraints];
+  m_y = new double[m_NbMaxOfConstraints];
+  m_tmp1 = new double[m_NbMaxOfConstraints];
+  m_tmp2 = new double[m_NbMaxOfConstraints];
+  memset(m_v2,0,m_NbMaxOfConstraints*sizeof(double));
+
+  m_ConstraintsValueComputed = new bool[2*m_NbMaxOfConstraints];
+  memset(m_ConstraintsValueComputed,0,2*m_NbMaxOfConstraints*sizeof(bool));
+
+  m_ActivatedConstraints = new unsigned int[m_NbMaxOfConstraints];
+  m_PreviouslyActivatedConstraints = new unsigned int[m_NbMaxOfConstraints];
+  m_IsActive = new bool[m_NbMaxOfConstraints];
+  memset(m_IsActive,0,m_NbMaxOfConstraints*sizeof(bool));
+
+  return true;
+}
+
+void PLDPWorkspace::ClearActiveSet()
+{
+  /* Only the entries set by the previous solve are reset. */
+  for(unsigned int i=0;i<m_NbOfActivatedConstraints;i++)
+    m_IsActive[m_ActivatedConstraints[i]] = false;
+  m_NbOfActivatedConstraints = 0;
+}
+
+int PLDPWorkspace::AddActiveConstraint(unsigned int aConstraint)
+{
+  if ((aConstraint>=m_NbMaxOfConstraints) ||
+      (m_NbOfActivatedConstraints>=m_NbMaxOfConstraints) ||
+      (m_IsActive[aConstraint]))
+    return -1;
+
+  m_ActivatedConstraints[m_NbOfActivatedConstraints++] = aConstraint;
+  m_IsActive[aConstraint] = true;
+  return 0;
+}
+
+void PLDPWorkspace::AddPreviouslyActiveConstraint(unsigned int aConstraint)
+{
+  if (m_NbOfPreviouslyActivatedConstraints<m_NbMaxOfConstraints)
+    m_PreviouslyActivatedConstraints[m_NbOfPreviouslyActivatedConstraints++] =
+      aConstraint;
+}
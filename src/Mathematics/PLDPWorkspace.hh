@@ -0,0 +1,183 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier    Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPWorkspace.hh
+  \brief Fixed-capacity memory shared by the PLDP solvers.
+
+  All the buffers needed by one call to SolveProblem are allocated
+  once, from the size of the control vector and the maximal number
+  of constraints. The active set is stored as a flat array of indexes
+  together with a mask, so that testing if a constraint is already
+  active does not require to scan the active set.
+*/
+
+#ifndef _PLDP_WORKSPACE_H_
+#define _PLDP_WORKSPACE_H_
+
+namespace Optimization
+{
+  namespace Solver
+    {
+      /*! \brief Statistics about the last call to a PLDP solver. */
+      struct PLDPSolveStatistics_s
+      {
+	/*! Number of iterations of the active set loop. */
+	unsigned int NbOfIterations;
+	/*! Number of constraints of the problem. */
+	unsigned int NbOfConstraints;
+	/*! Number of constraints activated by the hot start. */
+	unsigned int NbOfHotStartConstraints;
+	/*! Number of constraints activated during the iterations. */
+	unsigned int NbOfActivations;
+	/*! Size of the active set at the end of the solve. */
+	unsigned int NbOfActiveConstraints;
+	/*! Time spent in the active set loop (in seconds). */
+	double ComputationTime;
+	/*! True if the loop was stopped by the time limit. */
+	bool TimeLimitReached;
+      };
+      typedef struct PLDPSolveStatistics_s PLDPSolveStatistics_t;
+
+      /*! \brief Preallocated memory for the PLDP solvers. */
+      class PLDPWorkspace
+	{
+	public:
+	  /*! \brief Constructor. No memory is allocated until Reserve is called. */
+	  PLDPWorkspace();
+
+	  /*! \brief Destructor */
+	  ~PLDPWorkspace();
+
+	  /*! \brief Make sure that the buffers can handle a control vector
+	    of size \a SizeOfControl and \a NbMaxOfConstraints constraints.
+	    Memory is reallocated only if the capacity has to grow.
+	    The content of the buffers is lost in this case.
+	    \return true if a reallocation took place. */
+	  bool Reserve(unsigned int SizeOfControl,
+		       unsigned int NbMaxOfConstraints);
+
+	  /*! \name Active set management.
+	    @{ */
+	  /*! \brief Empty the active set. */
+	  void ClearActiveSet();
+
+	  /*! \brief Append \a aConstraint to the active set.
+	    \return -1 if the constraint is out of range or the set is full,
+	    0 otherwise. */
+	  int AddActiveConstraint(unsigned int aConstraint);
+
+	  /*! \brief Remove the last constraint appended to the active set. */
+	  inline void RemoveLastActiveConstraint()
+	  {
+	    if (m_NbOfActivatedConstraints>0)
+	      m_IsActive[m_ActivatedConstraints[--m_NbOfActivatedConstraints]] = false;
+	  }
+
+	  /*! \brief Returns true if \a aConstraint is in the active set. */
+	  inline bool IsActive(unsigned int aConstraint) const
+	  { return m_IsActive[aConstraint]; }
+
+	  /*! \brief Returns the i-th constraint of the active set. */
+	  inline unsigned int ActiveConstraint(unsigned int i) const
+	  { return m_ActivatedConstraints[i]; }
+
+	  /*! \brief Returns the size of the active set. */
+	  inline unsigned int NbOfActiveConstraints() const
+	  { return m_NbOfActivatedConstraints; }
+
+	  /*! \brief Empty the list of constraints kept for the next hot start. */
+	  inline void ClearPreviouslyActiveSet()
+	  { m_NbOfPreviouslyActivatedConstraints = 0; }
+
+	  /*! \brief Store \a aConstraint for the next hot start. */
+	  void AddPreviouslyActiveConstraint(unsigned int aConstraint);
+
+	  /*! \brief Returns the i-th constraint kept for the hot start. */
+	  inline unsigned int PreviouslyActiveConstraint(unsigned int i) const
+	  { return m_PreviouslyActivatedConstraints[i]; }
+
+	  /*! \brief Returns the number of constraints kept for the hot start. */
+	  inline unsigned int NbOfPreviouslyActiveConstraints() const
+	  { return m_NbOfPreviouslyActivatedConstraints; }
+	  /*! @} */
+
+	  /*! \name Buffers of size the control vector.
+	    @{ */
+	  inline double * Vk() { return m_Vk; }
+	  inline double * ZMPSolution() { return m_ZMPSolution; }
+	  inline double * UnconstrainedDescentDirection()
+	  { return m_UnconstrainedDescentDirection; }
+	  inline double * d() { return m_d; }
+	  /*! @} */
+
+	  /*! \name Buffers of size the maximal number of constraints.
+	    @{ */
+	  inline double * L() { return m_L; }
+	  inline double * iL() { return m_iL; }
+	  inline double * v1() { return m_v1; }
+	  inline double * v2() { return m_v2; }
+	  inline double * y() { return m_y; }
+	  inline double * tmp1() { return m_tmp1; }
+	  inline double * tmp2() { return m_tmp2; }
+	  /*! Twice the maximal number of constraints. */
+	  inline bool * ConstraintsValueComputed()
+	  { return m_ConstraintsValueComputed; }
+	  /*! @} */
+
+	  /*! \brief Capacity for the control vector. */
+	  inline unsigned int SizeOfControl() const
+	  { return m_SizeOfControl; }
+
+	  /*! \brief Capacity for the constraints. */
+	  inline unsigned int NbMaxOfConstraints() const
+	  { return m_NbMaxOfConstraints; }
+
+	protected:
+	  /*! \brief Free all the buffers. */
+	  void FreeMemory();
+
+	private:
+	  /*! Capacities. */
+	  unsigned int m_SizeOfControl, m_NbMaxOfConstraints;
+
+	  /*! Buffers related to the control vector. */
+	  double *m_Vk, *m_ZMPSolution, *m_UnconstrainedDescentDirection, *m_d;
+
+	  /*! Buffers related to the constraints. */
+	  double *m_L, *m_iL, *m_v1, *m_v2, *m_y, *m_tmp1, *m_tmp2;
+
+	  /*! Store if the A*Vk values has been computed. */
+	  bool * m_ConstraintsValueComputed;
+
+	  /*! Active set and its mask. */
+	  unsigned int * m_ActivatedConstraints;
+	  unsigned int m_NbOfActivatedConstraints;
+	  bool * m_IsActive;
+
+	  /*! Constraints kept for the hot start. */
+	  unsigned int * m_PreviouslyActivatedConstraints;
+	  unsigned int m_NbOfPreviouslyActivatedConstraints;
+	};
+    }
+}
+#endif /* _PLDP_WORKSPACE_H_ */
@@ -47,6 +47,9 @@ RelativeFeetInequalities::RelativeFeetInequalities( SimplePluginManager *aSPM,
   DSFeetDistance_ = 0.2;
   SecurityMarginX_ = 0.04;
   SecurityMarginY_ = 0.04;
+
+  HullCacheSize_ = 16;
+  HullCacheClock_ = 0;
   
   double DefaultFPosEdgesX[5] = {-0.28, -0.2, 0.0, 0.2, 0.28};
   double DefaultFPosEdgesY[5] = {-0.2, -0.3, -0.4, -0.3, -0.2};
@@ -144,6 +147,9 @@ RelativeFeetInequalities::init_convex_hulls()
   CoMHull_.resize(0, nbIneqCoM);
   CoMHull_.set_inequalities( IneqCoMA_a, IneqCoMB_a, IneqCoMC_a, IneqCoMD_a );
 
+  // The cached hulls have been computed with the previous edges.
+  clear_hull_cache();
+
   return 0;
 
 }
@@ -319,6 +325,65 @@ RelativeFeetInequalities::compute_linear_system ( convex_hull_t & ConvexHull,
 }
 
 
+const convex_hull_t &
+RelativeFeetInequalities::get_linear_system( const support_state_t & Support,
+    const support_state_t & PrwSupport, ineq_e type )
+{
+
+  HullCacheClock_++;
+
+  // The yaw is compared exactly: the previewed states of a step share it.
+  hull_cache_entry_s * Entry_p = 0;
+  for( unsigned i=0; i<HullCache_.size(); i++ )
+    {
+      hull_cache_entry_s & Entry = HullCache_[i];
+      if( Entry.Type == type && Entry.Foot == Support.Foot &&
+          Entry.Phase == Support.Phase && Entry.Yaw == Support.Yaw &&
+          Entry.PrwFoot == PrwSupport.Foot )
+        {
+          Entry.LastUse = HullCacheClock_;
+          return Entry.Hull;
+        }
+      if( Entry_p == 0 || Entry.LastUse < Entry_p->LastUse )
+        Entry_p = &Entry;
+    }
+
+  if( HullCache_.size() < HullCacheSize_ )
+    {
+      HullCache_.push_back( hull_cache_entry_s() );
+      Entry_p = &HullCache_.back();
+    }
+
+  Entry_p->Type = type;
+  Entry_p->Foot = Support.Foot;
+  Entry_p->Phase = Support.Phase;
+  Entry_p->Yaw = Support.Yaw;
+  Entry_p->PrwFoot = PrwSupport.Foot;
+  Entry_p->LastUse = HullCacheClock_;
+
+  unsigned nbEdges = ( type == INEQ_COP ) ? ZMPPosEdges_.LeftSS.X_vec.size() :
+    FootPosEdges_.LeftSS.X_vec.size();
+  convex_hull_t & Hull = Entry_p->Hull;
+  Hull.resize( nbEdges, nbEdges );
+  set_vertices( Hull, Support, type );
+  compute_linear_system( Hull, PrwSupport );
+
+  return Hull;
+
+}
+
+
+void
+RelativeFeetInequalities::clear_hull_cache()
+{
+
+  HullCache_.clear();
+  HullCache_.reserve( HullCacheSize_ );
+  HullCacheClock_ = 0;
+
+}
+
+
 void
 RelativeFeetInequalities::CallMethod( std::string &Method, std::istringstream &Args )
 {
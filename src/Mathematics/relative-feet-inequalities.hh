@@ -93,6 +93,17 @@ namespace PatternGeneratorJRL
     void compute_linear_system ( convex_hull_t & ConvexHull,
         const support_state_t & PrwSupport) const;
 
+    /// \brief Get the linear inequalities of the hull adapted to a support state.
+    /// The previewed orientations only take a few values over the preview window,
+    /// the last computed hulls are kept in a cache indexed by the orientation.
+    ///
+    /// \param[in] Support Support state defining the vertices and their orientation
+    /// \param[in] PrwSupport Previewed support state
+    /// \param[in] type CoP/Feet
+    /// \return Convex hull with the inequalities A_vec, B_vec, D_vec
+    const convex_hull_t & get_linear_system ( const support_state_t & Support,
+        const support_state_t & PrwSupport, ineq_e type );
+
     /// \brief Reimplement the interface of SimplePluginManager
     ///
     /// \param[in] Method: The method to be called.
@@ -120,6 +131,9 @@ namespace PatternGeneratorJRL
     /// return 0
     int init_feet_constraints ();
 
+    /// \brief Empty the cache of rotated hulls
+    void clear_hull_cache ();
+
     //
     // Private members
     //
@@ -152,6 +166,25 @@ namespace PatternGeneratorJRL
     /// \brief Distance between the feet in the double support phase
     double DSFeetDistance_;
 
+    /// \brief Rotated hull and the support states it has been computed for
+    struct hull_cache_entry_s
+    {
+      ineq_e Type;
+      foot_type_e Foot, PrwFoot;
+      PhaseType Phase;
+      double Yaw;
+      /// \brief Last access, the least recently used entry is replaced
+      unsigned long LastUse;
+      convex_hull_t Hull;
+    };
+    std::vector<hull_cache_entry_s> HullCache_;
+
+    /// \brief Maximal number of hulls in the cache
+    unsigned HullCacheSize_;
+
+    /// \brief Number of accesses to the cache
+    unsigned long HullCacheClock_;
+
   };
 }
 #endif                          /* _RELATIVE_FEET_INEQUALITIES_ */
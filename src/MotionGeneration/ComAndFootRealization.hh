@@ -29,6 +29,8 @@
 #ifndef _COM_AND_FOOT_REALIZATION_H_
 #define _COM_AND_FOOT_REALIZATION_H_
 
+#include <vector>
+
 #include <abstract-robot-dynamics/humanoid-dynamic-robot.hh>
 
 #include <SimplePlugin.hh>
@@ -125,6 +127,29 @@ namespace PatternGeneratorJRL
 							 int IterationNumber,
 							 int Stage) =0;
 
+    /*! Compute the robot states for a sequence of CoM and feet postures.
+      The result is the one of ComputePostureForGivenCoMAndFeetPosture
+      called for each sample, but the \a HumanoidDynamicRobot is not updated.
+      @param CoMPositions, CoMSpeeds, CoMAccs, LeftFoot, RightFoot: one vector
+      per sample, following the conventions of ComputePostureForGivenCoMAndFeetPosture.
+      @param CurrentConfiguration: The configuration before the first sample,
+      set to the last configuration.
+      @param Configurations, Velocities, Accelerations: The states of the robot for each sample.
+      @param IterationNumber: Number of iteration of the first sample.
+      @param Stage: indicates which stage is reach by the Pattern Generator.
+    */
+    virtual bool ComputePosturesForGivenCoMAndFeetPostures(std::vector<MAL_VECTOR_TYPE(double) > & CoMPositions,
+							   std::vector<MAL_VECTOR_TYPE(double) > & CoMSpeeds,
+							   std::vector<MAL_VECTOR_TYPE(double) > & CoMAccs,
+							   std::vector<MAL_VECTOR_TYPE(double) > & LeftFoot,
+							   std::vector<MAL_VECTOR_TYPE(double) > & RightFoot,
+							   MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+							   std::vector<MAL_VECTOR_TYPE(double) > & Configurations,
+							   std::vector<MAL_VECTOR_TYPE(double) > & Velocities,
+							   std::vector<MAL_VECTOR_TYPE(double) > & Accelerations,
+							   int IterationNumber,
+							   int Stage) =0;
+
     /*! Returns the waist position associate to the current  
       @} */
 
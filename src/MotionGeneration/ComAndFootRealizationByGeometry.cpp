@@ -34,10 +34,332 @@
 
 #include <Debug.hh>
 #include <MotionGeneration/ComAndFootRealizationByGeometry.hh>
+#include "portability/thread.hh"
+#include <StageProfiler.hh>
 
 
 using namespace PatternGeneratorJRL;
 
+/*! Closed form inverse kinematics of a 6 DoFs leg whose axes are
+  successively yaw, roll, pitch (hip), pitch (knee), pitch and roll (ankle),
+  the leg being straight along -z when all the angles are zero.
+  @param[in] Body_R, Body_P: pose of the waist.
+  @param[in] WaistToHip: position of the hip in the waist frame.
+  @param[in] Foot_R, Foot_P: pose of the ankle.
+  @param[in] A, B: length of the thigh and of the tibia.
+  @param[out] q: angles of the leg. */
+static void ClosedFormLegIK(const double Body_R[3][3], const double Body_P[3],
+			    const double WaistToHip[3],
+			    const double Foot_R[3][3], const double Foot_P[3],
+			    double A, double B, double q[6])
+{
+  // Vector from the ankle to the hip in the ankle frame.
+  double Hip[3], d[3], r[3];
+  for(unsigned int i=0;i<3;i++)
+    Hip[i] = Body_P[i] + Body_R[i][0]*WaistToHip[0]
+      + Body_R[i][1]*WaistToHip[1] + Body_R[i][2]*WaistToHip[2];
+  for(unsigned int i=0;i<3;i++)
+    d[i] = Hip[i] - Foot_P[i];
+  for(unsigned int i=0;i<3;i++)
+    r[i] = Foot_R[0][i]*d[0] + Foot_R[1][i]*d[1] + Foot_R[2][i]*d[2];
+
+  double C = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+
+  // Knee.
+  double c5 = (C*C - A*A - B*B)/(2.0*A*B);
+  if (c5>=1.0)
+    q[3] = 0.0;
+  else if (c5<=-1.0)
+    q[3] = M_PI;
+  else
+    q[3] = acos(c5);
+
+  // Ankle.
+  double q6a = asin((A/C)*sin(M_PI-q[3]));
+  q[5] = atan2(r[1],r[2]);
+  if (q[5]>M_PI/2.0)
+    q[5] -= M_PI;
+  else if (q[5]<-M_PI/2.0)
+    q[5] += M_PI;
+  double lSign = (r[2]>=0.0) ? 1.0 : -1.0;
+  q[4] = -atan2(r[0],lSign*sqrt(r[1]*r[1] + r[2]*r[2])) - q6a;
+
+  // Hip: R = Body_R^T Foot_R Rx(-q[5]) Ry(-q[3]-q[4]).
+  double cx = cos(q[5]), sx = sin(q[5]);
+  double cy = cos(q[3]+q[4]), sy = sin(q[3]+q[4]);
+  double Rfx[3][3], Rfxy[3][3], R[3][3];
+  for(unsigned int i=0;i<3;i++)
+    {
+      Rfx[i][0] = Foot_R[i][0];
+      Rfx[i][1] = cx*Foot_R[i][1] - sx*Foot_R[i][2];
+      Rfx[i][2] = sx*Foot_R[i][1] + cx*Foot_R[i][2];
+
+      Rfxy[i][0] = cy*Rfx[i][0] + sy*Rfx[i][2];
+      Rfxy[i][1] = Rfx[i][1];
+      Rfxy[i][2] = -sy*Rfx[i][0] + cy*Rfx[i][2];
+    }
+  for(unsigned int i=0;i<3;i++)
+    for(unsigned int j=0;j<3;j++)
+      R[i][j] = Body_R[0][i]*Rfxy[0][j] + Body_R[1][i]*Rfxy[1][j]
+	+ Body_R[2][i]*Rfxy[2][j];
+
+  q[0] = atan2(-R[0][1],R[1][1]);
+  double cz = cos(q[0]), sz = sin(q[0]);
+  q[1] = atan2(R[2][1],-R[0][1]*sz + R[1][1]*cz);
+  q[2] = atan2(-R[2][0],R[2][2]);
+}
+
+/*! Solve the 6x6 system M x = b in place by Gaussian elimination
+  with partial pivoting. \return false if M is singular. */
+static bool SolveLinearSystem6(double M[6][6], double b[6], double x[6])
+{
+  for(unsigned int k=0;k<6;k++)
+    {
+      unsigned int lPivot = k;
+      for(unsigned int i=k+1;i<6;i++)
+	if (fabs(M[i][k])>fabs(M[lPivot][k]))
+	  lPivot = i;
+      if (fabs(M[lPivot][k])<1e-12)
+	return false;
+      if (lPivot!=k)
+	{
+	  for(unsigned int j=0;j<6;j++)
+	    { double t = M[k][j]; M[k][j] = M[lPivot][j]; M[lPivot][j] = t; }
+	  double t = b[k]; b[k] = b[lPivot]; b[lPivot] = t;
+	}
+      for(unsigned int i=k+1;i<6;i++)
+	{
+	  double f = M[i][k]/M[k][k];
+	  for(unsigned int j=k;j<6;j++)
+	    M[i][j] -= f*M[k][j];
+	  b[i] -= f*b[k];
+	}
+    }
+  for(int i=5;i>=0;i--)
+    {
+      double r = b[i];
+      for(unsigned int j=i+1;j<6;j++)
+	r -= M[i][j]*x[j];
+      x[i] = r/M[i][i];
+    }
+  return true;
+}
+
+static inline void Cross(const double a[3], const double b[3], double c[3])
+{
+  c[0] = a[1]*b[2] - a[2]*b[1];
+  c[1] = a[2]*b[0] - a[0]*b[2];
+  c[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+/*! Joint velocities and accelerations of a leg solved by ClosedFormLegIK().
+  @param[in] WaistToHip, A, B: geometry of the leg.
+  @param[in] q: angles of the leg.
+  @param[in] dp, w: linear and angular velocities of the ankle
+  with respect to the waist, in the waist frame.
+  @param[in] ddp, dw: linear and angular accelerations of the ankle
+  with respect to the waist, in the waist frame.
+  @param[out] dq, ddq: joint velocities and accelerations.
+  \return false if the leg is in a singular configuration. */
+static bool ClosedFormLegRates(const double WaistToHip[3], double A, double B,
+			       const double q[6],
+			       const double dp[3], const double w[3],
+			       const double ddp[3], const double dw[3],
+			       double dq[6], double ddq[6])
+{
+  // Frames of the joints: Rz(q0) Rx(q1) Ry(q2) Ry(q3) Ry(q4) Rx(q5).
+  double c0 = cos(q[0]), s0 = sin(q[0]);
+  double c1 = cos(q[1]), s1 = sin(q[1]);
+  double c2 = cos(q[2]), s2 = sin(q[2]);
+  double c23 = cos(q[2]+q[3]), s23 = sin(q[2]+q[3]);
+  double c234 = cos(q[2]+q[3]+q[4]), s234 = sin(q[2]+q[3]+q[4]);
+
+  // Columns of R01 = Rz(q0) Rx(q1).
+  double X01[3] = { c0, s0, 0.0 };
+  double Y01[3] = { -s0*c1, c0*c1, s1 };
+  double Z01[3] = { s0*s1, -c0*s1, c1 };
+
+  double z[6][3], o[6][3];
+  for(unsigned int i=0;i<3;i++)
+    {
+      double lZ2 = s2*X01[i] + c2*Z01[i];
+      double lZ23 = s23*X01[i] + c23*Z01[i];
+
+      z[0][i] = (i==2) ? 1.0 : 0.0;
+      z[1][i] = X01[i];
+      z[2][i] = z[3][i] = z[4][i] = Y01[i];
+      // The ankle roll axis is the x axis after the pitch joints.
+      z[5][i] = c234*X01[i] - s234*Z01[i];
+
+      o[0][i] = o[1][i] = o[2][i] = WaistToHip[i];
+      o[3][i] = WaistToHip[i] - A*lZ2;
+      o[4][i] = o[5][i] = o[3][i] - B*lZ23;
+    }
+
+  // Jacobian of the ankle.
+  double J[6][6], p[3], r[3], c[3], b[6];
+  for(unsigned int i=0;i<3;i++)
+    p[i] = o[5][i];
+  for(unsigned int j=0;j<6;j++)
+    {
+      for(unsigned int i=0;i<3;i++)
+	r[i] = p[i] - o[j][i];
+      Cross(z[j],r,c);
+      for(unsigned int i=0;i<3;i++)
+	{
+	  J[i][j] = c[i];
+	  J[i+3][j] = z[j][i];
+	}
+    }
+
+  double M[6][6];
+  for(unsigned int i=0;i<6;i++)
+    for(unsigned int j=0;j<6;j++)
+      M[i][j] = J[i][j];
+  for(unsigned int i=0;i<3;i++)
+    {
+      b[i] = dp[i];
+      b[i+3] = w[i];
+    }
+  if (!SolveLinearSystem6(M,b,dq))
+    return false;
+
+  // Velocity product term dJ/dt dq.
+  double lOmega[3] = {0.0,0.0,0.0}, dz[3], t[3], u[3];
+  double lBias[6] = {0.0,0.0,0.0,0.0,0.0,0.0};
+  for(unsigned int j=0;j<6;j++)
+    {
+      // Derivative of the axis, rotated by the previous joints.
+      Cross(lOmega,z[j],dz);
+
+      // Velocity of the origin of the joint.
+      double lDo[3] = {0.0,0.0,0.0};
+      for(unsigned int k=0;k<j;k++)
+	{
+	  for(unsigned int i=0;i<3;i++)
+	    r[i] = o[j][i] - o[k][i];
+	  Cross(z[k],r,c);
+	  for(unsigned int i=0;i<3;i++)
+	    lDo[i] += c[i]*dq[k];
+	}
+
+      for(unsigned int i=0;i<3;i++)
+	{
+	  r[i] = p[i] - o[j][i];
+	  t[i] = dp[i] - lDo[i];
+	}
+      Cross(dz,r,c);
+      Cross(z[j],t,u);
+      for(unsigned int i=0;i<3;i++)
+	{
+	  lBias[i] += (c[i] + u[i])*dq[j];
+	  lBias[i+3] += dz[i]*dq[j];
+	  lOmega[i] += z[j][i]*dq[j];
+	}
+    }
+
+  for(unsigned int i=0;i<6;i++)
+    for(unsigned int j=0;j<6;j++)
+      M[i][j] = J[i][j];
+  for(unsigned int i=0;i<3;i++)
+    {
+      b[i] = ddp[i] - lBias[i];
+      b[i+3] = dw[i] - lBias[i+3];
+    }
+  return SolveLinearSystem6(M,b,ddq);
+}
+
+/*! Orientation Rz(theta) Ry(omega) with its angular velocity 
+  and acceleration, the angles and their derivatives being in radians. */
+static void OrientationRates(double theta, double omega,
+			     double dtheta, double domega,
+			     double ddtheta, double ddomega,
+			     double R[3][3], double w[3], double dw[3])
+{
+  double ct = cos(theta), st = sin(theta);
+  double co = cos(omega), so = sin(omega);
+
+  R[0][0] = ct*co; R[0][1] = -st; R[0][2] = ct*so;
+  R[1][0] = st*co; R[1][1] = ct;  R[1][2] = st*so;
+  R[2][0] = -so;   R[2][1] = 0.0; R[2][2] = co;
+
+  // w = dtheta z + domega y', with y' = Rz(theta) y.
+  w[0] = -domega*st;
+  w[1] = domega*ct;
+  w[2] = dtheta;
+
+  dw[0] = -ddomega*st - domega*dtheta*ct;
+  dw[1] = ddomega*ct - domega*dtheta*st;
+  dw[2] = ddtheta;
+}
+
+/*! Motion of the point attached at \a l to a frame of orientation \a R,
+  given the motion (p, v, a, w, dw) of the origin of the frame. */
+static void PointRates(const double R[3][3], const double l[3],
+		       const double p[3], const double v[3], const double a[3],
+		       const double w[3], const double dw[3],
+		       double pp[3], double vp[3], double ap[3])
+{
+  double r[3], c[3], d[3];
+  for(unsigned int i=0;i<3;i++)
+    r[i] = R[i][0]*l[0] + R[i][1]*l[1] + R[i][2]*l[2];
+  Cross(w,r,c);
+  Cross(w,c,d);
+  for(unsigned int i=0;i<3;i++)
+    {
+      pp[i] = p[i] + r[i];
+      vp[i] = v[i] + c[i];
+      ap[i] = a[i] + d[i];
+    }
+  Cross(dw,r,c);
+  for(unsigned int i=0;i<3;i++)
+    ap[i] += c[i];
+}
+
+/*! Motion of the ankle frame (Pa, Ra, Va, Wa, Aa, DWa) relative to the
+  waist frame (Pw, Rw, Vw, Ww, Aw, DWw), expressed in the waist frame. */
+static void RelativeRates(const double Rw[3][3], const double Pw[3],
+			  const double Vw[3], const double Aw[3],
+			  const double Ww[3], const double DWw[3],
+			  const double Pa[3], const double Va[3],
+			  const double Aa[3], const double Wa[3],
+			  const double DWa[3],
+			  double dp[3], double w[3], double ddp[3], double dw[3])
+{
+  double lP[3], lV[3], lA[3], lW[3], lDW[3], Om[3], dOm[3];
+  for(unsigned int i=0;i<3;i++)
+    {
+      lP[i] = lV[i] = lA[i] = lW[i] = lDW[i] = Om[i] = dOm[i] = 0.0;
+      for(unsigned int j=0;j<3;j++)
+	{
+	  lP[i] += Rw[j][i]*(Pa[j] - Pw[j]);
+	  lV[i] += Rw[j][i]*(Va[j] - Vw[j]);
+	  lA[i] += Rw[j][i]*(Aa[j] - Aw[j]);
+	  lW[i] += Rw[j][i]*(Wa[j] - Ww[j]);
+	  lDW[i] += Rw[j][i]*(DWa[j] - DWw[j]);
+	  Om[i] += Rw[j][i]*Ww[j];
+	  dOm[i] += Rw[j][i]*DWw[j];
+	}
+    }
+  double c[3], d[3], e[3];
+  Cross(Om,lP,c);
+  for(unsigned int i=0;i<3;i++)
+    dp[i] = lV[i] - c[i];
+  Cross(Om,dp,c);
+  Cross(dOm,lP,d);
+  Cross(Om,lP,e);
+  double f[3];
+  Cross(Om,e,f);
+  for(unsigned int i=0;i<3;i++)
+    ddp[i] = lA[i] - 2.0*c[i] - d[i] - f[i];
+  Cross(Om,lW,c);
+  for(unsigned int i=0;i<3;i++)
+    {
+      w[i] = lW[i];
+      dw[i] = lDW[i] - c[i];
+    }
+}
+
 ComAndFootRealizationByGeometry::
 ComAndFootRealizationByGeometry(PatternGeneratorInterfacePrivate *aPGI)
   : ComAndFootRealization(aPGI)
@@ -48,6 +370,9 @@ ComAndFootRealizationByGeometry(PatternGeneratorInterfacePrivate *aPGI)
   m_ZARM = -1.0;
   m_LeftShoulder = 0;
   m_RightShoulder = 0;
+  m_NbOfPostureThreads = 1;
+  m_ClosedFormLegsIK = false;
+  m_AnalyticalJointRates = false;
 						
   RegisterMethods();
 
@@ -92,10 +417,12 @@ ComAndFootRealizationByGeometry(PatternGeneratorInterfacePrivate *aPGI)
 void ComAndFootRealizationByGeometry::
 RegisterMethods()
 {
-  string aMethodName[3] = {":armparameters",
+  string aMethodName[5] = {":armparameters",
 			   ":UpperBodyMotionParameters",
-			   ":samplingperiod"};
-  for(int i=0;i<3;i++)
+			   ":samplingperiod",
+			   ":posturethreads",
+			   ":jointrates"};
+  for(int i=0;i<5;i++)
     {
       if (!RegisterMethod(aMethodName[i]))
 	{
@@ -300,6 +627,8 @@ Initialization()
 	 << m_LeftLegIndexinConfiguration[4] << " "
 	 << m_LeftLegIndexinConfiguration[5] );
   
+  InitializeClosedFormLegsIK();
+
   ODEBUG("Enter 12.0 ");
   
   MAL_VECTOR_FILL(m_prev_Configuration,0.0);
@@ -309,6 +638,177 @@ Initialization()
 
 }
 
+bool ComAndFootRealizationByGeometry::
+MeasureLegGeometry(CjrlJoint * anAnkle, LegGeometry_s & aLeg)
+{
+  CjrlJoint *waist = getHumanoidDynamicRobot()->waist();
+  std::vector<CjrlJoint *> lChain =
+    getHumanoidDynamicRobot()->jointsBetween(*waist, *anAnkle);
+
+  // The waist followed by the 6 joints of the leg.
+  if (lChain.size()!=7)
+    return false;
+
+  const matrix4d & lWaist = waist->initialPosition();
+  const matrix4d & lHip = lChain[2]->initialPosition();
+  const matrix4d & lKnee = lChain[4]->initialPosition();
+  const matrix4d & lAnkle = lChain[6]->initialPosition();
+
+  double lThigh=0.0, lTibia=0.0;
+  for(unsigned int i=0;i<3;i++)
+    {
+      aLeg.WaistToHip[i] = 0.0;
+      for(unsigned int j=0;j<3;j++)
+	aLeg.WaistToHip[i] += MAL_S4x4_MATRIX_ACCESS_I_J(lWaist,j,i) *
+	  (MAL_S4x4_MATRIX_ACCESS_I_J(lHip,j,3) -
+	   MAL_S4x4_MATRIX_ACCESS_I_J(lWaist,j,3));
+
+      double d = MAL_S4x4_MATRIX_ACCESS_I_J(lKnee,i,3) -
+	MAL_S4x4_MATRIX_ACCESS_I_J(lHip,i,3);
+      lThigh += d*d;
+      d = MAL_S4x4_MATRIX_ACCESS_I_J(lAnkle,i,3) -
+	MAL_S4x4_MATRIX_ACCESS_I_J(lKnee,i,3);
+      lTibia += d*d;
+    }
+  aLeg.ThighLength = sqrt(lThigh);
+  aLeg.TibiaLength = sqrt(lTibia);
+
+  return (aLeg.ThighLength>0.0) && (aLeg.TibiaLength>0.0);
+}
+
+bool ComAndFootRealizationByGeometry::
+LegJointsOfTheClosedForm(CjrlJoint * anAnkle)
+{
+  CjrlJoint *waist = getHumanoidDynamicRobot()->waist();
+  std::vector<CjrlJoint *> lChain =
+    getHumanoidDynamicRobot()->jointsBetween(*waist, *anAnkle);
+  if (lChain.size()!=7)
+    return false;
+
+  // Axes z, x, y, y, y, x of the waist frame, see ClosedFormLegRates().
+  // A rotation joint turns around the x axis of its frame.
+  const unsigned int lAxes[6] = { 2, 0, 1, 1, 1, 0 };
+  const matrix4d & lWaist = waist->initialPosition();
+  const matrix4d & lHip = lChain[1]->initialPosition();
+  for(unsigned int k=0;k<6;k++)
+    {
+      const matrix4d & lJoint = lChain[k+1]->initialPosition();
+      for(unsigned int i=0;i<3;i++)
+	{
+	  double lAxis=0.0, lOffset=0.0;
+	  for(unsigned int j=0;j<3;j++)
+	    {
+	      lAxis += MAL_S4x4_MATRIX_ACCESS_I_J(lWaist,j,i) *
+		MAL_S4x4_MATRIX_ACCESS_I_J(lJoint,j,0);
+	      lOffset += MAL_S4x4_MATRIX_ACCESS_I_J(lWaist,j,i) *
+		(MAL_S4x4_MATRIX_ACCESS_I_J(lJoint,j,3) -
+		 MAL_S4x4_MATRIX_ACCESS_I_J(lHip,j,3));
+	    }
+	  if (fabs(lAxis - ((i==lAxes[k]) ? 1.0 : 0.0))>1e-9)
+	    return false;
+	  // The leg is straight along the z axis of the waist.
+	  if ((i<2) && (fabs(lOffset)>1e-9))
+	    return false;
+	}
+    }
+  return true;
+}
+
+void ComAndFootRealizationByGeometry::
+InitializeClosedFormLegsIK()
+{
+  m_ClosedFormLegsIK = false;
+
+  CjrlHumanoidDynamicRobot * aHDR = getHumanoidDynamicRobot();
+  CjrlJoint *Waist = aHDR->waist();
+  CjrlJoint *Ankles[2] = { aHDR->leftAnkle(), aHDR->rightAnkle() };
+  LegGeometry_s * Legs[2] = { &m_LeftLegGeometry, &m_RightLegGeometry };
+
+  /* The closed form is used only if it gives the same angles
+     than the inverse kinematics of the robot model on a few postures
+     of the ankle with respect to the waist (dx, dy, yaw, pitch). */
+  const unsigned int NbOfPostures = 4;
+  const double Postures[NbOfPostures][4] = { { 0.0,   0.0,   0.0,   0.0},
+					     { 0.05,  0.01,  0.15,  0.0},
+					     {-0.08, -0.02, -0.2,   0.1},
+					     { 0.1,   0.03,  0.3,  -0.1} };
+  double MaxError = 0.0;
+
+  for(unsigned int lLeg=0;lLeg<2;lLeg++)
+    {
+      if ((Ankles[lLeg]==0) ||
+	  (!MeasureLegGeometry(Ankles[lLeg],*Legs[lLeg])))
+	return;
+
+      const LegGeometry_s & aLeg = *Legs[lLeg];
+      for(unsigned int k=0;k<NbOfPostures;k++)
+	{
+	  double Body_R[3][3], Body_P[3]={0.0,0.0,0.0}, Foot_R[3][3], Foot_P[3];
+	  double cb = cos(0.1*k), sb = sin(0.1*k);
+	  double c = cos(Postures[k][2]), s = sin(Postures[k][2]);
+	  double co = cos(Postures[k][3]), so = sin(Postures[k][3]);
+
+	  Body_R[0][0] = cb;  Body_R[0][1] = -sb; Body_R[0][2] = 0.0;
+	  Body_R[1][0] = sb;  Body_R[1][1] = cb;  Body_R[1][2] = 0.0;
+	  Body_R[2][0] = 0.0; Body_R[2][1] = 0.0; Body_R[2][2] = 1.0;
+
+	  Foot_R[0][0] = c*co; Foot_R[0][1] = -s;  Foot_R[0][2] = c*so;
+	  Foot_R[1][0] = s*co; Foot_R[1][1] = c;   Foot_R[1][2] = s*so;
+	  Foot_R[2][0] = -so;  Foot_R[2][1] = 0.0; Foot_R[2][2] = co;
+
+	  // Below the hip, with the knee bent.
+	  double lLocal[3] = { aLeg.WaistToHip[0] + Postures[k][0],
+			       aLeg.WaistToHip[1] + Postures[k][1],
+			       aLeg.WaistToHip[2] -
+			       0.9*(aLeg.ThighLength + aLeg.TibiaLength) };
+	  for(unsigned int i=0;i<3;i++)
+	    Foot_P[i] = Body_R[i][0]*lLocal[0] + Body_R[i][1]*lLocal[1]
+	      + Body_R[i][2]*lLocal[2];
+
+	  matrix4d BodyPose, FootPose;
+	  MAL_S4x4_MATRIX_SET_IDENTITY(BodyPose);
+	  MAL_S4x4_MATRIX_SET_IDENTITY(FootPose);
+	  for(unsigned int i=0;i<3;i++)
+	    {
+	      for(unsigned int j=0;j<3;j++)
+		{
+		  MAL_S4x4_MATRIX_ACCESS_I_J(BodyPose,i,j) = Body_R[i][j];
+		  MAL_S4x4_MATRIX_ACCESS_I_J(FootPose,i,j) = Foot_R[i][j];
+		}
+	      MAL_S4x4_MATRIX_ACCESS_I_J(BodyPose,i,3) = Body_P[i];
+	      MAL_S4x4_MATRIX_ACCESS_I_J(FootPose,i,3) = Foot_P[i];
+	    }
+
+	  MAL_VECTOR_DIM(lq,double,6);
+	  if (!aHDR->getSpecializedInverseKinematics(*Waist,*Ankles[lLeg],
+						     BodyPose,FootPose,lq))
+	    {
+	      // No inverse kinematics in the model (for instance the
+	      // synthetic humanoid): the closed form is the only one.
+	      if ((lLeg==0) && (k==0))
+		m_ClosedFormLegsIK =
+		  MeasureLegGeometry(Ankles[1],*Legs[1]) &&
+		  LegJointsOfTheClosedForm(Ankles[0]) &&
+		  LegJointsOfTheClosedForm(Ankles[1]);
+	      ODEBUG("Closed form inverse kinematics for the legs "
+		     "without robot inverse kinematics: " << m_ClosedFormLegsIK);
+	      return;
+	    }
+
+	  double q[6];
+	  ClosedFormLegIK(Body_R,Body_P,aLeg.WaistToHip,Foot_R,Foot_P,
+			  aLeg.ThighLength,aLeg.TibiaLength,q);
+	  for(unsigned int i=0;i<6;i++)
+	    if (fabs(q[i]-lq[i])>MaxError)
+	      MaxError = fabs(q[i]-lq[i]);
+	}
+    }
+
+  m_ClosedFormLegsIK = (MaxError<1e-6);
+  ODEBUG("Closed form inverse kinematics for the legs: " 
+	 << m_ClosedFormLegsIK << " (error " << MaxError << ")");
+}
+
 ComAndFootRealizationByGeometry::~ComAndFootRealizationByGeometry()
 {
   if (m_WaistPlanner!=0)
@@ -769,6 +1269,54 @@ KinematicsForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
 		     MAL_VECTOR_TYPE(double) & qr,
 		     MAL_S3_VECTOR_TYPE(double) & AbsoluteWaistPosition )
 
+{
+  /* If this is the second call, (stage =1)
+     it is the final desired CoM */
+  if (Stage==1)
+    UpdateFinalDesiredCOMPose(aCoMPosition);
+
+  return ComputeLegsAngles(aCoMPosition,aLeftFoot,aRightFoot,Stage,
+			   ql,qr,AbsoluteWaistPosition);
+}
+
+void ComAndFootRealizationByGeometry::
+UpdateFinalDesiredCOMPose(MAL_VECTOR_TYPE(double) & aCoMPosition)
+{
+  double CosTheta,SinTheta,CosOmega,SinOmega;
+
+  CosTheta = cos(aCoMPosition(5)*M_PI/180.0);
+  SinTheta = sin(aCoMPosition(5)*M_PI/180.0);
+
+  CosOmega = cos(aCoMPosition(4)*M_PI/180.0);
+  SinOmega = sin(aCoMPosition(4)*M_PI/180.0);
+
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,0) = CosTheta*CosOmega;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,1) = -SinTheta;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,2) = CosTheta*SinOmega;
+
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,0) = SinTheta*CosOmega;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,1) = CosTheta;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,2) = SinTheta*SinOmega;
+
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,0) = -SinOmega;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,1)=  0;
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,2) = CosOmega;
+
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,3) = aCoMPosition(0);
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,3) = aCoMPosition(1);
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,3) = aCoMPosition(2);
+  MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 3,3) = 1.0;
+}
+
+bool ComAndFootRealizationByGeometry::
+ComputeLegsAngles(MAL_VECTOR_TYPE(double) & aCoMPosition,
+		  MAL_VECTOR_TYPE(double) & aLeftFoot,
+		  MAL_VECTOR_TYPE(double) & aRightFoot,
+		  int Stage,
+		  MAL_VECTOR_TYPE(double) & ql,
+		  MAL_VECTOR_TYPE(double) & qr,
+		  MAL_S3_VECTOR_TYPE(double) & AbsoluteWaistPosition )
+
 {
 
   // Body attitude
@@ -821,27 +1369,8 @@ KinematicsForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
   ODEBUG(aCoMPosition(2) << 
 	 " Body_P : " << Body_P  << std::endl <<
 	 " aLeftFoot : " << aLeftFoot);
-  /* If this is the second call, (stage =1)
-     it is the final desired CoM */
   if (Stage==1)
     {
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,0) = CosTheta*CosOmega;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,1) = -SinTheta;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,2) = CosTheta*SinOmega;
-
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,0) = SinTheta*CosOmega;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,1) = CosTheta;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,2) = SinTheta*SinOmega;
-
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,0) = -SinOmega;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,1)=  0;
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,2) = CosOmega;
-
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 0,3) = aCoMPosition(0);
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 1,3) = aCoMPosition(1);
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,3) = aCoMPosition(2);
-      MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 3,3) = 1.0;
-
       ODEBUG4(Body_P ,"DebugDataBodyP1.dat");
     }
   else
@@ -867,41 +1396,218 @@ KinematicsForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
 
   ODEBUG4("**************","DebugDataIK.dat");
   /* Should compute now the Waist Position */
-  MAL_S3x3_C_eq_A_by_B(m_ComAndWaistInRefFrame, Body_R, m_DiffBetweenComAndWaist);
+  MAL_S3_VECTOR(ComAndWaistInRefFrame,double);
+  MAL_S3x3_C_eq_A_by_B(ComAndWaistInRefFrame, Body_R, m_DiffBetweenComAndWaist);
 
-  AbsoluteWaistPosition[0] = aCoMPosition(0) + m_ComAndWaistInRefFrame[0];
-  AbsoluteWaistPosition[1] = aCoMPosition(1) + m_ComAndWaistInRefFrame[1];
+  AbsoluteWaistPosition[0] = aCoMPosition(0) + ComAndWaistInRefFrame[0];
+  AbsoluteWaistPosition[1] = aCoMPosition(1) + ComAndWaistInRefFrame[1];
   AbsoluteWaistPosition[2] = aCoMPosition(2) + ToTheHip(2) ;// - 0.705;
 
   return true;
 }
 
+void ComAndFootRealizationByGeometry::
+ClosedFormKinematicsForOneLeg(const double Body_R[3][3],
+			      const double Body_P[3],
+			      MAL_VECTOR_TYPE(double) & aFoot,
+			      int LeftOrRight,
+			      double q[6])
+{
+  double c = cos(aFoot(3)*M_PI/180.0);
+  double s = sin(aFoot(3)*M_PI/180.0);
+  double co = cos(aFoot(4)*M_PI/180.0);
+  double so = sin(aFoot(4)*M_PI/180.0);
+
+  double Foot_R[3][3] = { { c*co, -s,  c*so },
+			  { s*co,  c,  s*so },
+			  {  -so, 0.0,   co } };
+
+  const MAL_S3_VECTOR_TYPE(double) & lAnkle = 
+    (LeftOrRight==1) ? m_AnklePositionLeft : m_AnklePositionRight;
+  const LegGeometry_s & aLeg =
+    (LeftOrRight==1) ? m_LeftLegGeometry : m_RightLegGeometry;
+
+  double Foot_P[3];
+  for(unsigned int i=0;i<3;i++)
+    Foot_P[i] = aFoot(i) + Foot_R[i][0]*lAnkle[0]
+      + Foot_R[i][1]*lAnkle[1] + Foot_R[i][2]*lAnkle[2];
+
+  ClosedFormLegIK(Body_R,Body_P,aLeg.WaistToHip,Foot_R,Foot_P,
+		  aLeg.ThighLength,aLeg.TibiaLength,q);
+}
+
+void ComAndFootRealizationByGeometry::
+ClosedFormKinematicsForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
+			       MAL_VECTOR_TYPE(double) & aLeftFoot,
+			       MAL_VECTOR_TYPE(double) & aRightFoot,
+			       MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+			       MAL_S3_VECTOR_TYPE(double) & AbsoluteWaistPosition)
+{
+  double CosTheta = cos(aCoMPosition(5)*M_PI/180.0);
+  double SinTheta = sin(aCoMPosition(5)*M_PI/180.0);
+  double CosOmega = cos(aCoMPosition(4)*M_PI/180.0);
+  double SinOmega = sin(aCoMPosition(4)*M_PI/180.0);
+
+  double Body_R[3][3] = { { CosTheta*CosOmega, -SinTheta, CosTheta*SinOmega },
+			  { SinTheta*CosOmega,  CosTheta, SinTheta*SinOmega },
+			  {         -SinOmega,       0.0,          CosOmega } };
+  double Body_P[3], ToTheHip[3], q[6];
+
+  // Left leg.
+  for(unsigned int i=0;i<3;i++)
+    {
+      ToTheHip[i] = Body_R[i][0]*m_TranslationToTheLeftHip(0)
+	+ Body_R[i][1]*m_TranslationToTheLeftHip(1)
+	+ Body_R[i][2]*m_TranslationToTheLeftHip(2);
+      Body_P[i] = aCoMPosition(i) + ToTheHip[i];
+    }
+  ClosedFormKinematicsForOneLeg(Body_R,Body_P,aLeftFoot,1,q);
+  for(unsigned int i=0;i<6;i++)
+    CurrentConfiguration[m_LeftLegIndexinConfiguration[i]] = q[i];
+
+  // Right leg.
+  for(unsigned int i=0;i<3;i++)
+    {
+      ToTheHip[i] = Body_R[i][0]*m_TranslationToTheRightHip(0)
+	+ Body_R[i][1]*m_TranslationToTheRightHip(1)
+	+ Body_R[i][2]*m_TranslationToTheRightHip(2);
+      Body_P[i] = aCoMPosition(i) + ToTheHip[i];
+    }
+  ClosedFormKinematicsForOneLeg(Body_R,Body_P,aRightFoot,-1,q);
+  for(unsigned int i=0;i<6;i++)
+    CurrentConfiguration[m_RightLegIndexinConfiguration[i]] = q[i];
+
+  // Waist position, as in ComputeLegsAngles().
+  for(unsigned int i=0;i<2;i++)
+    AbsoluteWaistPosition[i] = aCoMPosition(i) 
+      + Body_R[i][0]*m_DiffBetweenComAndWaist[0]
+      + Body_R[i][1]*m_DiffBetweenComAndWaist[1]
+      + Body_R[i][2]*m_DiffBetweenComAndWaist[2];
+  AbsoluteWaistPosition[2] = aCoMPosition(2) + ToTheHip[2];
+}
+
 bool ComAndFootRealizationByGeometry::
-ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
-					MAL_VECTOR_TYPE(double) & aCoMSpeed,
-					MAL_VECTOR_TYPE(double) & aCoMAcc,
-					MAL_VECTOR_TYPE(double) & aLeftFoot,
-					MAL_VECTOR_TYPE(double) & aRightFoot,
-					MAL_VECTOR_TYPE(double) & CurrentConfiguration,
-					MAL_VECTOR_TYPE(double) & CurrentVelocity,
-					MAL_VECTOR_TYPE(double) & CurrentAcceleration,
-					int IterationNumber,
-					int Stage)
+ClosedFormRatesForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
+			  MAL_VECTOR_TYPE(double) & aLeftFoot,
+			  MAL_VECTOR_TYPE(double) & aRightFoot,
+			  MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+			  MAL_VECTOR_TYPE(double) & CurrentVelocity,
+			  MAL_VECTOR_TYPE(double) & CurrentAcceleration)
 {
-  
-  MAL_VECTOR(lqr,double);
-  MAL_VECTOR(lql,double);
+  if ((!m_ClosedFormLegsIK) ||
+      (MAL_VECTOR_SIZE(aCoMPosition)<18) ||
+      (MAL_VECTOR_SIZE(aLeftFoot)<15) ||
+      (MAL_VECTOR_SIZE(aRightFoot)<15))
+    return false;
+
+  const double d2r = M_PI/180.0;
+
+  // Motion of the CoM frame, its orientation is the one of the waist.
+  double Rw[3][3], Ww[3], DWw[3], Pc[3], Vc[3], Ac[3];
+  OrientationRates(aCoMPosition(5)*d2r, aCoMPosition(4)*d2r,
+		   aCoMPosition(11)*d2r, aCoMPosition(10)*d2r,
+		   aCoMPosition(17)*d2r, aCoMPosition(16)*d2r,
+		   Rw, Ww, DWw);
+  for(unsigned int i=0;i<3;i++)
+    {
+      Pc[i] = aCoMPosition(i);
+      Vc[i] = aCoMPosition(6+i);
+      Ac[i] = aCoMPosition(12+i);
+    }
+
+  double dq[2][6], ddq[2][6];
+  for(unsigned int lLeg=0;lLeg<2;lLeg++)
+    {
+      MAL_VECTOR_TYPE(double) & aFoot = (lLeg==0) ? aLeftFoot : aRightFoot;
+      const MAL_S3_VECTOR_TYPE(double) & lToTheHip = 
+	(lLeg==0) ? m_TranslationToTheLeftHip : m_TranslationToTheRightHip;
+      const MAL_S3_VECTOR_TYPE(double) & lAnkle = 
+	(lLeg==0) ? m_AnklePositionLeft : m_AnklePositionRight;
+      const LegGeometry_s & aLeg = 
+	(lLeg==0) ? m_LeftLegGeometry : m_RightLegGeometry;
+      const std::vector<int> & lIndexes = 
+	(lLeg==0) ? m_LeftLegIndexinConfiguration : m_RightLegIndexinConfiguration;
+
+      // Waist, as used by ClosedFormKinematicsForTheLegs().
+      double l[3] = { lToTheHip(0), lToTheHip(1), lToTheHip(2) };
+      double Pw[3], Vw[3], Aw[3];
+      PointRates(Rw,l,Pc,Vc,Ac,Ww,DWw,Pw,Vw,Aw);
+
+      // Ankle.
+      double Rf[3][3], Wf[3], DWf[3], Pf[3], Vf[3], Af[3];
+      OrientationRates(aFoot(3)*d2r, aFoot(4)*d2r,
+		       aFoot(8)*d2r, aFoot(9)*d2r,
+		       aFoot(13)*d2r, aFoot(14)*d2r,
+		       Rf, Wf, DWf);
+      for(unsigned int i=0;i<3;i++)
+	{
+	  Pf[i] = aFoot(i);
+	  Vf[i] = aFoot(5+i);
+	  Af[i] = aFoot(10+i);
+	  l[i] = lAnkle[i];
+	}
+      double Pa[3], Va[3], Aa[3];
+      PointRates(Rf,l,Pf,Vf,Af,Wf,DWf,Pa,Va,Aa);
+
+      double dp[3], w[3], ddp[3], dw[3], q[6];
+      RelativeRates(Rw,Pw,Vw,Aw,Ww,DWw,Pa,Va,Aa,Wf,DWf,dp,w,ddp,dw);
+      for(unsigned int i=0;i<6;i++)
+	q[i] = CurrentConfiguration[lIndexes[i]];
+
+      if (!ClosedFormLegRates(aLeg.WaistToHip,aLeg.ThighLength,aLeg.TibiaLength,
+			      q,dp,w,ddp,dw,dq[lLeg],ddq[lLeg]))
+	return false;
+    }
+
+  for(unsigned int i=0;i<6;i++)
+    {
+      CurrentVelocity[m_LeftLegIndexinConfiguration[i]] = dq[0][i];
+      CurrentAcceleration[m_LeftLegIndexinConfiguration[i]] = ddq[0][i];
+      CurrentVelocity[m_RightLegIndexinConfiguration[i]] = dq[1][i];
+      CurrentAcceleration[m_RightLegIndexinConfiguration[i]] = ddq[1][i];
+    }
+  return true;
+}
 
+bool ComAndFootRealizationByGeometry::
+ComputeConfigurationForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
+					      MAL_VECTOR_TYPE(double) & aLeftFoot,
+					      MAL_VECTOR_TYPE(double) & aRightFoot,
+					      MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+					      int Stage)
+{
   MAL_S3_VECTOR(AbsoluteWaistPosition,double);
 
   // Kinematics for the legs.
-  KinematicsForTheLegs(aCoMPosition,
-		       aLeftFoot,
-		       aRightFoot,
-		       Stage,
-		       lql,
-		       lqr,
-		       AbsoluteWaistPosition);
+  if (m_ClosedFormLegsIK)
+    {
+      ClosedFormKinematicsForTheLegs(aCoMPosition,
+				     aLeftFoot,
+				     aRightFoot,
+				     CurrentConfiguration,
+				     AbsoluteWaistPosition);
+    }
+  else
+    {
+      MAL_VECTOR(lqr,double);
+      MAL_VECTOR(lql,double);
+
+      ComputeLegsAngles(aCoMPosition,
+			aLeftFoot,
+			aRightFoot,
+			Stage,
+			lql,
+			lqr,
+			AbsoluteWaistPosition);
+
+      for(unsigned int i=0;i<MAL_VECTOR_SIZE(lqr);i++)
+	CurrentConfiguration[m_RightLegIndexinConfiguration[i]] = lqr[i];
+
+      for(unsigned int i=0;i<MAL_VECTOR_SIZE(lql);i++)
+	CurrentConfiguration[m_LeftLegIndexinConfiguration[i]] = lql[i];
+
+      ODEBUG("lql: "<<lql<< " lqr: " <<lqr);
+    }
   /// NOW IT IS ABOUT THE UPPER BODY... ////
   MAL_VECTOR_DIM(qArmr,double,6);
   MAL_VECTOR_DIM(qArml,double,6);
@@ -975,18 +1681,40 @@ ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
   for(int i=3;i<6;i++)
     CurrentConfiguration[i] = aCoMPosition(i)*M_PI/180.0;
 
-  for(unsigned int i=0;i<MAL_VECTOR_SIZE(lqr);i++)
-    CurrentConfiguration[m_RightLegIndexinConfiguration[i]] = lqr[i];
-
-  for(unsigned int i=0;i<MAL_VECTOR_SIZE(lql);i++)
-    CurrentConfiguration[m_LeftLegIndexinConfiguration[i]] = lql[i];
-
   for(unsigned int i=0;i<MAL_VECTOR_SIZE(qArmr);i++)
     CurrentConfiguration[m_RightArmIndexinConfiguration[i]] = qArmr[i];
 
   for(unsigned int i=0;i<MAL_VECTOR_SIZE(qArml);i++)
     CurrentConfiguration[m_LeftArmIndexinConfiguration[i]] = qArml[i];
 
+  return true;
+}
+
+bool ComAndFootRealizationByGeometry::
+ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
+					MAL_VECTOR_TYPE(double) & aCoMSpeed,
+					MAL_VECTOR_TYPE(double) & aCoMAcc,
+					MAL_VECTOR_TYPE(double) & aLeftFoot,
+					MAL_VECTOR_TYPE(double) & aRightFoot,
+					MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+					MAL_VECTOR_TYPE(double) & CurrentVelocity,
+					MAL_VECTOR_TYPE(double) & CurrentAcceleration,
+					int IterationNumber,
+					int Stage)
+{
+  StageTimer aStageTimer(StageProfiler::INVERSE_KINEMATICS);
+
+  /* If this is the second call, (stage =1)
+     it is the final desired CoM */
+  if (Stage==1)
+    UpdateFinalDesiredCOMPose(aCoMPosition);
+
+  ComputeConfigurationForGivenCoMAndFeetPosture(aCoMPosition,
+						aLeftFoot,
+						aRightFoot,
+						CurrentConfiguration,
+						Stage);
+
   // Update the speed values.
   /* If this is the first call ( stage = 0)
      we should update the current stored values.  */
@@ -1033,7 +1761,6 @@ ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
     }
   else if (Stage==1)
     {
-      ODEBUG("lql: "<<lql<< " lqr: " <<lqr);
       if (IterationNumber>0)
 	{
 	  /* Compute the speed */
@@ -1062,6 +1789,19 @@ ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
       m_prev_Velocity1 = CurrentVelocity;
     }
 
+  /* The legs velocities and accelerations do not depend
+     on the previous samples if the derivatives of the postures are given. */
+  if ((m_AnalyticalJointRates) &&
+      (ClosedFormRatesForTheLegs(aCoMPosition,aLeftFoot,aRightFoot,
+				 CurrentConfiguration,
+				 CurrentVelocity,CurrentAcceleration)))
+    {
+      if (Stage==0)
+	m_prev_Velocity = CurrentVelocity;
+      else if (Stage==1)
+	m_prev_Velocity1 = CurrentVelocity;
+    }
+
 
   for(int i=0;i<6;i++)
     CurrentVelocity[i] = aCoMSpeed(i);
@@ -1072,15 +1812,6 @@ ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
   ODEBUG( "CurrentVelocity :" << endl << CurrentVelocity);
   ODEBUG4("SamplingPeriod " << getSamplingPeriod(),"LegsSpeed.dat");
 
-  string aDebugFileName;
-
-  ODEBUG4( (1.0/M_PI)*180.0*lql[0] << " " <<
-	   (1.0/M_PI)*180.0*lql[1] << " " <<
-	   (1.0/M_PI)*180.0*lql[2] << " " <<
-	   (1.0/M_PI)*180.0*lql[3] << " " <<
-	   (1.0/M_PI)*180.0*lql[4] << " " <<
-	   (1.0/M_PI)*180.0*lql[5],(char *)aDebugFileName.c_str());
-
   ODEBUG4(CurrentVelocity,"DebugDataVelocity.dat");
 
   ODEBUG4( aCoMPosition[0]
@@ -1090,6 +1821,184 @@ ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
   return true;
 }
 
+void ComAndFootRealizationByGeometry::
+ComputePosturesOfBatch(void * aBatch)
+{
+  PostureBatch_s * lBatch = (PostureBatch_s *)aBatch;
+  for(unsigned int k=lBatch->Begin;k<lBatch->End;k++)
+    lBatch->Realization->
+      ComputeConfigurationForGivenCoMAndFeetPosture((*lBatch->CoMPositions)[k],
+						    (*lBatch->LeftFoot)[k],
+						    (*lBatch->RightFoot)[k],
+						    (*lBatch->Configurations)[k],
+						    lBatch->Stage);
+}
+
+bool ComAndFootRealizationByGeometry::
+ComputePosturesForGivenCoMAndFeetPostures(std::vector<MAL_VECTOR_TYPE(double) > & CoMPositions,
+					  std::vector<MAL_VECTOR_TYPE(double) > & CoMSpeeds,
+					  std::vector<MAL_VECTOR_TYPE(double) > & CoMAccs,
+					  std::vector<MAL_VECTOR_TYPE(double) > & LeftFoot,
+					  std::vector<MAL_VECTOR_TYPE(double) > & RightFoot,
+					  MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+					  std::vector<MAL_VECTOR_TYPE(double) > & Configurations,
+					  std::vector<MAL_VECTOR_TYPE(double) > & Velocities,
+					  std::vector<MAL_VECTOR_TYPE(double) > & Accelerations,
+					  int IterationNumber,
+					  int Stage)
+{
+  StageTimer aStageTimer(StageProfiler::INVERSE_KINEMATICS);
+
+  unsigned int NbOfSamples = CoMPositions.size();
+  if ((CoMSpeeds.size()!=NbOfSamples) ||
+      (CoMAccs.size()!=NbOfSamples) ||
+      (LeftFoot.size()!=NbOfSamples) ||
+      (RightFoot.size()!=NbOfSamples))
+    {
+      ODEBUG3("The sizes of the batch of postures do not match.");
+      return false;
+    }
+
+  Configurations.resize(NbOfSamples);
+  Velocities.resize(NbOfSamples);
+  Accelerations.resize(NbOfSamples);
+  if (NbOfSamples==0)
+    return true;
+
+  unsigned int NbDofs = MAL_VECTOR_SIZE(CurrentConfiguration);
+
+  /* The last sample gives the final desired CoM, before the
+     stepping over mode modifies its pose. */
+  if (Stage==1)
+    UpdateFinalDesiredCOMPose(CoMPositions[NbOfSamples-1]);
+
+  /* Configurations. */
+  if (GetStepStackHandler()->GetWalkMode()==2)
+    {
+      /* The waist yaw of each sample is computed from the previous one. */
+      for(unsigned int k=0;k<NbOfSamples;k++)
+	{
+	  ComputeConfigurationForGivenCoMAndFeetPosture(CoMPositions[k],
+							LeftFoot[k],
+							RightFoot[k],
+							CurrentConfiguration,
+							Stage);
+	  Configurations[k] = CurrentConfiguration;
+	}
+    }
+  else
+    {
+      for(unsigned int k=0;k<NbOfSamples;k++)
+	Configurations[k] = CurrentConfiguration;
+
+      unsigned int NbOfThreads = m_NbOfPostureThreads;
+      if (NbOfThreads>NbOfSamples)
+	NbOfThreads = NbOfSamples;
+      if (NbOfThreads==0)
+	NbOfThreads = 1;
+
+      /* The calling thread computes the first part. */
+      std::vector<PostureBatch_s> lBatches(NbOfThreads);
+      for(unsigned int i=0;i<NbOfThreads;i++)
+	{
+	  lBatches[i].Realization = this;
+	  lBatches[i].CoMPositions = &CoMPositions;
+	  lBatches[i].LeftFoot = &LeftFoot;
+	  lBatches[i].RightFoot = &RightFoot;
+	  lBatches[i].Configurations = &Configurations;
+	  lBatches[i].Begin = (i*NbOfSamples)/NbOfThreads;
+	  lBatches[i].End = ((i+1)*NbOfSamples)/NbOfThreads;
+	  lBatches[i].Stage = Stage;
+	}
+
+      Thread * lThreads = new Thread[NbOfThreads];
+      for(unsigned int i=1;i<NbOfThreads;i++)
+	{
+	  if (lThreads[i].Start(ComputePosturesOfBatch,&lBatches[i])<0)
+	    {
+	      ODEBUG3("Unable to start the posture thread " << i);
+	      ComputePosturesOfBatch(&lBatches[i]);
+	    }
+	}
+      ComputePosturesOfBatch(&lBatches[0]);
+      for(unsigned int i=1;i<NbOfThreads;i++)
+	lThreads[i].Join();
+      delete [] lThreads;
+
+      CurrentConfiguration = Configurations[NbOfSamples-1];
+    }
+
+  /* Velocities and accelerations by finite differences,
+     the first sample is chained with the previous call. */
+  MAL_VECTOR_TYPE(double) * lprevConfiguration = 0, * lprevVelocity = 0;
+  if (Stage==0)
+    {
+      lprevConfiguration = &m_prev_Configuration;
+      lprevVelocity = &m_prev_Velocity;
+    }
+  else if (Stage==1)
+    {
+      lprevConfiguration = &m_prev_Configuration1;
+      lprevVelocity = &m_prev_Velocity1;
+    }
+
+  double ldt = getSamplingPeriod();
+  for(unsigned int k=0;k<NbOfSamples;k++)
+    {
+      MAL_VECTOR_RESIZE(Velocities[k],NbDofs);
+      MAL_VECTOR_RESIZE(Accelerations[k],NbDofs);
+      MAL_VECTOR_FILL(Velocities[k],0.0);
+      MAL_VECTOR_FILL(Accelerations[k],0.0);
+    }
+
+  for(unsigned int k=0;k<NbOfSamples;k++)
+    {
+      int lIteration = IterationNumber + (int)k;
+      if ((lprevConfiguration!=0) && (lIteration>0))
+	{
+	  const MAL_VECTOR_TYPE(double) & q0 =
+	    (k==0) ? *lprevConfiguration : Configurations[k-1];
+	  const MAL_VECTOR_TYPE(double) & q1 = Configurations[k];
+	  MAL_VECTOR_TYPE(double) & dq = Velocities[k];
+	  for(unsigned int i=6;i<NbDofs;i++)
+	    dq[i] = (q1[i] - q0[i])/ldt;
+
+	  if (lIteration>1)
+	    {
+	      const MAL_VECTOR_TYPE(double) & dq0 =
+		(k==0) ? *lprevVelocity : Velocities[k-1];
+	      MAL_VECTOR_TYPE(double) & ddq = Accelerations[k];
+	      for(unsigned int i=6;i<NbDofs;i++)
+		ddq[i] = (dq[i] - dq0[i])/ldt;
+	    }
+	}
+
+      /* As in ComputePostureForGivenCoMAndFeetPosture(), before the
+	 velocity is used for the acceleration of the next sample. */
+      if (m_AnalyticalJointRates)
+	ClosedFormRatesForTheLegs(CoMPositions[k],LeftFoot[k],RightFoot[k],
+				  Configurations[k],
+				  Velocities[k],Accelerations[k]);
+    }
+
+  if (lprevConfiguration!=0)
+    {
+      *lprevConfiguration = Configurations[NbOfSamples-1];
+      *lprevVelocity = Velocities[NbOfSamples-1];
+    }
+
+  for(unsigned int k=0;k<NbOfSamples;k++)
+    {
+      for(int i=0;i<6;i++)
+	{
+	  Velocities[k][i] = CoMSpeeds[k](i);
+	  Accelerations[k][i] = CoMAccs[k](i);
+	}
+    }
+
+  return true;
+}
+
 int ComAndFootRealizationByGeometry::
 EvaluateStartingCoM(MAL_VECTOR(&BodyAngles,double),
 		    MAL_S3_VECTOR(&aStartingCOMPosition,double),
@@ -1282,6 +2191,21 @@ CallMethod(string &Method, istringstream &istrm)
       istrm >> ldt;
       setSamplingPeriod(ldt);
     }
+  else if (Method==":posturethreads")
+    {
+      istrm >> m_NbOfPostureThreads;
+    }
+  else if (Method==":jointrates")
+    {
+      string lMode;
+      istrm >> lMode;
+      if (lMode=="analytical")
+	m_AnalyticalJointRates = true;
+      else if (lMode=="finitedifferences")
+	m_AnalyticalJointRates = false;
+      else
+	ODEBUG3("Unknown mode for :jointrates " << lMode);
+    }
 }
 
 MAL_S4x4_MATRIX_TYPE(double) ComAndFootRealizationByGeometry::
@@ -31,6 +31,8 @@
 #define _COM_AND_FOOT_REALIZATION_BY_GEOMETRY_H_
 
 
+#include <vector>
+
 #include <jrl/walkgen/pgtypes.hh>
 #include <MotionGeneration/ComAndFootRealization.hh> 
 #include <MotionGeneration/StepOverPlanner.hh>
@@ -90,7 +92,14 @@ namespace PatternGeneratorJRL
       @param[in] IterationNumber Number of iteration.
       @param[in] Stage indicates which stage is reach by the Pattern Generator. If this is the 
       last stage, we store some information.
-      
+
+      The velocities and accelerations are obtained by finite differences with
+      the previous call. With the command ":jointrates analytical", those of 
+      the legs are computed from the closed form Jacobian of the legs if 
+      \a CoMPosition is followed by its first and second derivatives 
+      (18 values, angles in degrees) and the feet vectors as well 
+      (x,y,z,theta,omega and their derivatives, 15 values). 
+      Each sample is then independent for the legs.
     */
     bool ComputePostureForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) &CoMPosition,
 						 MAL_VECTOR_TYPE(double) & aCoMSpeed,
@@ -103,6 +112,42 @@ namespace PatternGeneratorJRL
 						 int IterationNumber,
 						 int Stage);    
 
+    /*! Compute the robot states for a sequence of CoM and feet postures,
+      typically a whole trajectory generated off-line.
+      The configurations of the samples do not depend on each other,
+      they are computed by \a m_NbOfPostureThreads threads (set by the
+      command :posturethreads). This assumes that the specialized inverse
+      kinematics of the robot is re-entrant, the default is to use only the
+      calling thread. The velocities and accelerations are then computed by
+      finite differences over the whole sequence, starting from the values
+      kept by the previous call for the same stage. The result is the same
+      as calling ComputePostureForGivenCoMAndFeetPosture() for each sample,
+      except that the robot model is not updated.
+      In the stepping over mode (walk mode 2) the configuration of a sample
+      depends on the previous one and the samples are computed sequentially.
+      @param[in] CoMPositions, CoMSpeeds, CoMAccs, LeftFoot, RightFoot:
+      one vector per sample, following the conventions of
+      ComputePostureForGivenCoMAndFeetPosture().
+      @param[in,out] CurrentConfiguration: the joints which are not
+      set by this object are copied from this vector. It is set to
+      the last configuration on return.
+      @param[out] Configurations, Velocities, Accelerations: the states of
+      the robot, resized to the number of samples.
+      @param[in] IterationNumber Number of iteration of the first sample.
+      @param[in] Stage indicates which stage is reach by the Pattern Generator.
+    */
+    bool ComputePosturesForGivenCoMAndFeetPostures(std::vector<MAL_VECTOR_TYPE(double) > & CoMPositions,
+						   std::vector<MAL_VECTOR_TYPE(double) > & CoMSpeeds,
+						   std::vector<MAL_VECTOR_TYPE(double) > & CoMAccs,
+						   std::vector<MAL_VECTOR_TYPE(double) > & LeftFoot,
+						   std::vector<MAL_VECTOR_TYPE(double) > & RightFoot,
+						   MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+						   std::vector<MAL_VECTOR_TYPE(double) > & Configurations,
+						   std::vector<MAL_VECTOR_TYPE(double) > & Velocities,
+						   std::vector<MAL_VECTOR_TYPE(double) > & Accelerations,
+						   int IterationNumber,
+						   int Stage);
+
     /*! \name Initialization of the walking. 
       @{
      */
@@ -276,6 +321,103 @@ namespace PatternGeneratorJRL
     /* Register methods. */
     void RegisterMethods();
 
+    /*! Compute the legs angles and the waist position for a given
+      posture of the CoM and of the feet. Contrary to KinematicsForTheLegs()
+      no member is modified, so it can be called from several threads.
+      The parameters are the same than for KinematicsForTheLegs(). */
+    bool ComputeLegsAngles(MAL_VECTOR_TYPE(double) & aCoMPosition,
+			   MAL_VECTOR_TYPE(double) & aLeftFoot,
+			   MAL_VECTOR_TYPE(double) & aRightFoot,
+			   int Stage,
+			   MAL_VECTOR_TYPE(double) & ql,
+			   MAL_VECTOR_TYPE(double) & qr,
+			   MAL_S3_VECTOR_TYPE(double) & AbsoluteWaistPosition);
+
+    /*! \brief Geometry of a leg, measured on the initial position 
+      of the robot. */
+    struct LegGeometry_s
+    {
+      /*! \brief Position of the hip in the waist frame. */
+      double WaistToHip[3];
+      /*! \brief Length of the thigh and of the tibia. */
+      double ThighLength, TibiaLength;
+    };
+
+    /*! Measure the geometry of the leg ending with \a anAnkle.
+      \return false if the leg has not 6 joints. */
+    bool MeasureLegGeometry(CjrlJoint * anAnkle, LegGeometry_s & aLeg);
+
+    /*! \return true if the joints of the leg ending with \a anAnkle
+      are the ones of the closed form: hip yaw, roll and pitch, knee,
+      ankle pitch and roll, with the knee and the ankle below the hip. */
+    bool LegJointsOfTheClosedForm(CjrlJoint * anAnkle);
+
+    /*! Measure the legs and enable the closed form inverse kinematics
+      if it gives the same angles than the robot model. When the model
+      has no inverse kinematics, it is enabled if the joints of the
+      legs are the ones of the closed form. */
+    void InitializeClosedFormLegsIK();
+
+    /*! Closed form inverse kinematics of one leg for the waist pose
+      (\a Body_R, \a Body_P) and the foot posture \a aFoot
+      (x,y,z, theta, omega). \a LeftOrRight is 1 for the left leg
+      and -1 for the right one. */
+    void ClosedFormKinematicsForOneLeg(const double Body_R[3][3],
+				       const double Body_P[3],
+				       MAL_VECTOR_TYPE(double) & aFoot,
+				       int LeftOrRight,
+				       double q[6]);
+
+    /*! Same as ComputeLegsAngles() with the closed form inverse kinematics,
+      the angles are directly stored in \a CurrentConfiguration. 
+      Nothing is allocated. */
+    void ClosedFormKinematicsForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
+				       MAL_VECTOR_TYPE(double) & aLeftFoot,
+				       MAL_VECTOR_TYPE(double) & aRightFoot,
+				       MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+				       MAL_S3_VECTOR_TYPE(double) & AbsoluteWaistPosition);
+
+    /*! Store the pose of the CoM as the final desired CoM pose. */
+    void UpdateFinalDesiredCOMPose(MAL_VECTOR_TYPE(double) & aCoMPosition);
+
+    /*! Compute the configuration (legs, arms and waist) realizing
+      a given posture of the CoM and of the feet. 
+      The other joints of \a CurrentConfiguration are left unchanged. */
+    bool ComputeConfigurationForGivenCoMAndFeetPosture(MAL_VECTOR_TYPE(double) & aCoMPosition,
+						       MAL_VECTOR_TYPE(double) & aLeftFoot,
+						       MAL_VECTOR_TYPE(double) & aRightFoot,
+						       MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+						       int Stage);
+
+    /*! Velocities and accelerations of the legs joints computed from the
+      closed form Jacobian of the legs, for the angles of the legs stored
+      in \a CurrentConfiguration. \a aCoMPosition should be followed by
+      its first and second derivatives (18 values), and the feet vectors
+      as well (15 values).
+      \return false if the derivatives are not given, if the closed form
+      is not available or if a leg is singular, the velocities and
+      accelerations being then left unchanged. */
+    bool ClosedFormRatesForTheLegs(MAL_VECTOR_TYPE(double) & aCoMPosition,
+				   MAL_VECTOR_TYPE(double) & aLeftFoot,
+				   MAL_VECTOR_TYPE(double) & aRightFoot,
+				   MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+				   MAL_VECTOR_TYPE(double) & CurrentVelocity,
+				   MAL_VECTOR_TYPE(double) & CurrentAcceleration);
+
+    /*! \brief Part of a batch of postures computed by one thread. */
+    struct PostureBatch_s
+    {
+      ComAndFootRealizationByGeometry * Realization;
+      std::vector<MAL_VECTOR_TYPE(double) > * CoMPositions, * LeftFoot, * RightFoot;
+      std::vector<MAL_VECTOR_TYPE(double) > * Configurations;
+      unsigned int Begin, End;
+      int Stage;
+    };
+
+    /*! Compute the configurations of one part of a batch,
+      the argument is a PostureBatch_s. */
+    static void ComputePosturesOfBatch(void * aBatch);
+
   private:
 
     /*! \name Objects for stepping over. 
@@ -349,10 +491,6 @@ namespace PatternGeneratorJRL
       i.e. not reevaluated while walking. */
     MAL_S3_VECTOR(m_DiffBetweenComAndWaist,double);
 
-    /*! Difference between the CoM and the Waist 
-      in the CoM reference frame. */
-    MAL_S3_VECTOR(m_ComAndWaistInRefFrame,double);
-
     
     /*! Maximal distance along the X axis for the hand motion */
     double m_Xmax;
@@ -387,6 +525,22 @@ namespace PatternGeneratorJRL
     /*! Gain factor for the arm motion heuristic. */
     double m_GainFactor;
 
+    /*! Number of threads computing a batch of postures. */
+    unsigned int m_NbOfPostureThreads;
+
+    /*! \name Closed form inverse kinematics of the legs.
+      @{ */
+    /*! \brief True if the closed form gives the same angles
+      than the inverse kinematics of the robot model. */
+    bool m_ClosedFormLegsIK;
+    /*! \brief Geometry of the legs. */
+    LegGeometry_s m_LeftLegGeometry, m_RightLegGeometry;
+    /*! \brief If true the velocities and accelerations of the legs
+      are computed from the derivatives of the postures instead of 
+      finite differences (command :jointrates). */
+    bool m_AnalyticalJointRates;
+    /*! @} */
+
     /*! Buffer of current Upper Body motion. */
     std::vector<double> m_UpperBodyMotion;
 
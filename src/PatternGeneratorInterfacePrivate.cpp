@@ -31,6 +31,7 @@
  */
 /* \doc This object is the interface to the walking gait
    generation architecture. */
+#include <algorithm>
 #include <fstream>
 #include <time.h>
 #include <fenv.h>
@@ -95,6 +96,7 @@ namespace PatternGeneratorJRL {
     m_DOF = m_HumanoidDynamicRobot->numberDof();
 
     m_SamplingPeriod = m_PC->SamplingPeriod();
+    m_InitialSamplingPeriod = m_SamplingPeriod;
     m_PreviewControlTime = m_PC->PreviewControlTime();
     if(m_SamplingPeriod==0)
       m_NL = 0;
@@ -174,6 +176,15 @@ namespace PatternGeneratorJRL {
     m_ZMPInitialPointSet = false;
 
     RegisterPluginMethods();
+    RegisterTypedCommands();
+
+    // Record the session from the start if asked by the environment.
+    string lRecordFileName = CommandStreamRecorder::FileNameFromEnvironment();
+    if (lRecordFileName.size()>0)
+      {
+	m_CommandStreamRecorder = new CommandStreamRecorder();
+	m_CommandStreamRecorder->Open(lRecordFileName);
+      }
   }
 
   void PatternGeneratorInterfacePrivate::AllowFPE()
@@ -183,7 +194,7 @@ namespace PatternGeneratorJRL {
 
   void PatternGeneratorInterfacePrivate::RegisterPluginMethods()
   {
-    std::string aMethodName[15] =
+    std::string aMethodName[19] =
       {":LimitsFeasibility",
        ":ZMPShiftParameters",
        ":TimeDistributionParameters",
@@ -198,9 +209,13 @@ namespace PatternGeneratorJRL {
        ":samplingperiod",
        ":HerdtOnline",
        ":setVelReference",
-       ":setCoMPerturbationForce"};
+       ":setCoMPerturbationForce",
+       ":outputdirectory",
+       ":tracing",
+       ":dumptrace",
+       ":recordcommands"};
 
-    for(int i=0;i<15;i++)
+    for(int i=0;i<19;i++)
       {
 	if (!SimplePlugin::RegisterMethod(aMethodName[i]))
 	  {
@@ -213,6 +228,34 @@ namespace PatternGeneratorJRL {
       }
 
   }
+  void PatternGeneratorInterfacePrivate::RegisterTypedCommands()
+  {
+    TypedCommand_s aTypedCommand;
+    aTypedCommand.NoArgument = 0;
+    aTypedCommand.Scalar = 0;
+    aTypedCommand.VelocityReference = 0;
+    aTypedCommand.PerturbationForce = 0;
+    m_TypedCommands.clear();
+    m_TypedCommands.resize(m_Methods.size(),aTypedCommand);
+
+    CommandHandle lCmd;
+    if ((lCmd=ResolveCommand(":StopOnLineStepSequencing"))>=0)
+      m_TypedCommands[lCmd].NoArgument =
+	&PatternGeneratorInterfacePrivate::StopOnLineStepSequencing;
+    if ((lCmd=ResolveCommand(":HerdtOnline"))>=0)
+      m_TypedCommands[lCmd].NoArgument =
+	&PatternGeneratorInterfacePrivate::m_HerdtOnline;
+    if ((lCmd=ResolveCommand(":samplingperiod"))>=0)
+      m_TypedCommands[lCmd].Scalar =
+	&PatternGeneratorInterfacePrivate::m_SetSamplingPeriod;
+    if ((lCmd=ResolveCommand(":setVelReference"))>=0)
+      m_TypedCommands[lCmd].VelocityReference =
+	&PatternGeneratorInterfacePrivate::m_SetVelReference;
+    if ((lCmd=ResolveCommand(":setCoMPerturbationForce"))>=0)
+      m_TypedCommands[lCmd].PerturbationForce =
+	&PatternGeneratorInterfacePrivate::m_SetCoMPerturbationForce;
+  }
+
   void PatternGeneratorInterfacePrivate::ObjectsInstanciation()
   {
     // Create fundamental objects to make the WPG runs.
@@ -237,18 +280,15 @@ namespace PatternGeneratorJRL {
     // ZMP reference and Foot trajectory planner (Preview control method from Kajita2003)
     m_ZMPD = new ZMPDiscretization(this,"",m_HumanoidDynamicRobot);
 
-    // ZMP and CoM generation using the method proposed in Wieber2006.
-    m_ZMPQP = new ZMPQPWithConstraint(this,"",m_HumanoidDynamicRobot);
-
-    // ZMP and CoM generation using the method proposed in Dimitrov2008.
-    m_ZMPCQPFF = new ZMPConstrainedQPFastFormulation(this,"",m_HumanoidDynamicRobot);
-
-    // ZMP and CoM generation using the method proposed in Herdt2010.
-    m_ZMPVRQP = new ZMPVelocityReferencedQP(this,"",m_HumanoidDynamicRobot);
-
-    // ZMP and CoM generation using the analytical method proposed in Morisawa2007.
-    m_ZMPM = new AnalyticalMorisawaCompact(this);
-    m_ZMPM->SetHumanoidSpecificities(m_HumanoidDynamicRobot);
+    // The other algorithms are created by InstanciateAlgorithm()
+    // when they are selected.
+    m_ZMPQP = 0;
+    m_ZMPCQPFF = 0;
+    m_ZMPVRQP = 0;
+    m_ZMPM = 0;
+    m_CommandStamp = 0;
+    m_TraceRecorder = 0;
+    m_CommandStreamRecorder = 0;
 
     // Preview control for a 3D Linear inverse pendulum
     m_PC = new PreviewControl(this,OptimalControllerSolver::MODE_WITHOUT_INITIALPOS,true);
@@ -276,11 +316,8 @@ namespace PatternGeneratorJRL {
 						&m_RightFootPositions);
 
 
-    m_CoMAndFootOnlyStrategy = new CoMAndFootOnlyStrategy(this);
-    m_CoMAndFootOnlyStrategy->SetBufferPositions(&m_ZMPPositions,
-						 &m_COMBuffer,
-						 &m_LeftFootPositions,
-						 &m_RightFootPositions);
+    // Created with the first algorithm using it.
+    m_CoMAndFootOnlyStrategy = 0;
 
     // Defa`<ult handler :DoubleStagePreviewControl.
     m_GlobalStrategyManager = m_DoubleStagePCStrategy;
@@ -299,37 +336,11 @@ namespace PatternGeneratorJRL {
 					      m_ComAndFootRealization,
 					      m_StepStackHandler);
 
-    m_CoMAndFootOnlyStrategy->InitInterObjects(m_HumanoidDynamicRobot,
-					       m_ComAndFootRealization,
-					       m_StepStackHandler);
-
     // Initialize the ZMP trajectory generator.
     m_ZMPD->SetSamplingPeriod(m_PC->SamplingPeriod());
     m_ZMPD->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
     //m_ZMPD->SetPreviewControl(m_PC);
 
-    m_ZMPQP->SetSamplingPeriod(m_PC->SamplingPeriod());
-    m_ZMPQP->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-    //m_ZMPQP->SetPreviewControl(m_PC);
-
-    m_ZMPCQPFF->SetSamplingPeriod(m_PC->SamplingPeriod());
-    m_ZMPCQPFF->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-    m_ZMPCQPFF->SetPreviewControl(m_PC);
-
-    m_ZMPVRQP->SetSamplingPeriod(m_PC->SamplingPeriod());
-
-    m_ZMPVRQP->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-    //m_ZMPVRQP->SetPreviewControl(m_PC);
-    //m_ZMPCQPFF->SetSamplingPeriod(m_PC->SamplingPeriod());
-    //m_ZMPCQPFF->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-    m_ZMPVRQP->SetSamplingPeriod(m_PC->SamplingPeriod());
-
-    m_ZMPVRQP->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-
-    m_ZMPM->SetSamplingPeriod(m_PC->SamplingPeriod());
-    m_ZMPM->SetTimeWindowPreviewControl(m_PC->PreviewControlTime());
-    m_ZMPM->SetFeetTrajectoryGenerator(m_FeetTrajectoryGenerator);
-
     // The motion generator based on a Kineoworks pathway is given here.
     m_GMFKW->SetPreviewControl(m_PC);
 
@@ -355,6 +366,158 @@ namespace PatternGeneratorJRL {
     // End of the initialization of the fundamental object.
   }
 
+  void PatternGeneratorInterfacePrivate::InstanciateCoMAndFootOnlyStrategy()
+  {
+    if (m_CoMAndFootOnlyStrategy!=0)
+      return;
+
+    m_CoMAndFootOnlyStrategy = new CoMAndFootOnlyStrategy(this);
+    m_CoMAndFootOnlyStrategy->SetBufferPositions(&m_ZMPPositions,
+						 &m_COMBuffer,
+						 &m_LeftFootPositions,
+						 &m_RightFootPositions);
+    m_CoMAndFootOnlyStrategy->InitInterObjects(m_HumanoidDynamicRobot,
+					       m_ComAndFootRealization,
+					       m_StepStackHandler);
+  }
+
+  void PatternGeneratorInterfacePrivate::InstanciateAlgorithm(int anAlgorithm)
+  {
+    // The plugins registered from now on are the ones of the algorithm.
+    vector<unsigned int> lNbPlugins(m_Methods.size());
+    for(unsigned int i=0;i<m_Methods.size();i++)
+      lNbPlugins[i] = m_Methods[i].Plugins.size();
+
+    // The sampling period is the one the algorithms would have been
+    // created with in the constructor, the commands which changed it
+    // since then are replayed.
+    switch(anAlgorithm)
+      {
+      case ZMPCOM_WIEBER_2006:
+	if (m_ZMPQP!=0)
+	  return;
+	// ZMP and CoM generation using the method proposed in Wieber2006.
+	m_ZMPQP = new ZMPQPWithConstraint(this,"",m_HumanoidDynamicRobot);
+	m_ZMPQP->SetSamplingPeriod(m_InitialSamplingPeriod);
+	m_ZMPQP->SetTimeWindowPreviewControl(m_PreviewControlTime);
+	break;
+
+      case ZMPCOM_DIMITROV_2008:
+	if (m_ZMPCQPFF!=0)
+	  return;
+	// ZMP and CoM generation using the method proposed in Dimitrov2008.
+	m_ZMPCQPFF = new ZMPConstrainedQPFastFormulation(this,"",m_HumanoidDynamicRobot);
+	m_ZMPCQPFF->SetSamplingPeriod(m_InitialSamplingPeriod);
+	m_ZMPCQPFF->SetTimeWindowPreviewControl(m_PreviewControlTime);
+	m_ZMPCQPFF->SetPreviewControl(m_PC);
+	break;
+
+      case ZMPCOM_HERDT_2010:
+	InstanciateCoMAndFootOnlyStrategy();
+	if (m_ZMPVRQP!=0)
+	  return;
+	// ZMP and CoM generation using the method proposed in Herdt2010.
+	m_ZMPVRQP = new ZMPVelocityReferencedQP(this,"",m_HumanoidDynamicRobot);
+	m_ZMPVRQP->SetSamplingPeriod(m_InitialSamplingPeriod);
+	m_ZMPVRQP->SetTimeWindowPreviewControl(m_PreviewControlTime);
+	break;
+
+      case ZMPCOM_MORISAWA_2007:
+	InstanciateCoMAndFootOnlyStrategy();
+	if (m_ZMPM!=0)
+	  return;
+	// ZMP and CoM generation using the analytical method proposed in Morisawa2007.
+	m_ZMPM = new AnalyticalMorisawaCompact(this);
+	m_ZMPM->SetHumanoidSpecificities(m_HumanoidDynamicRobot);
+	m_ZMPM->SetSamplingPeriod(m_InitialSamplingPeriod);
+	m_ZMPM->SetTimeWindowPreviewControl(m_PreviewControlTime);
+	m_ZMPM->SetFeetTrajectoryGenerator(m_FeetTrajectoryGenerator);
+	break;
+
+      default:
+	return;
+      }
+
+    ReplayCommands(lNbPlugins);
+    if (!AlgorithmsToInstanciate())
+      m_CommandRecords.clear();
+  }
+
+  ZMPVelocityReferencedQP * PatternGeneratorInterfacePrivate::VelocityReferencedQP()
+  {
+    if (m_ZMPVRQP==0)
+      InstanciateAlgorithm(ZMPCOM_HERDT_2010);
+    return m_ZMPVRQP;
+  }
+
+  bool PatternGeneratorInterfacePrivate::AlgorithmsToInstanciate() const
+  {
+    return (m_ZMPQP==0) || (m_ZMPCQPFF==0) ||
+      (m_ZMPVRQP==0) || (m_ZMPM==0);
+  }
+
+  void PatternGeneratorInterfacePrivate::RecordCommand(const string &aName,
+						       const string &anArgs)
+  {
+    if (!AlgorithmsToInstanciate())
+      return;
+    // Only the last call is kept: the commands of the algorithms
+    // are setting parameters.
+    CommandRecord_s & aRecord = m_CommandRecords[aName];
+    aRecord.Stamp = m_CommandStamp++;
+    aRecord.Arguments = anArgs;
+  }
+
+  void PatternGeneratorInterfacePrivate::RecordCommand(const string &aName,
+						       istringstream &strm)
+  {
+    if (!AlgorithmsToInstanciate())
+      return;
+    // The arguments are copied in the slot of the command,
+    // whose capacity is reused from one call to the next.
+    CommandRecord_s & aRecord = m_CommandRecords[aName];
+    aRecord.Stamp = m_CommandStamp++;
+    streampos lPosition = strm.tellg();
+    streamsize lSize = (lPosition<0) ? 0 : strm.rdbuf()->in_avail();
+    if (lSize<=0)
+      {
+	aRecord.Arguments.clear();
+	return;
+      }
+    aRecord.Arguments.resize(lSize);
+    strm.rdbuf()->sgetn(&aRecord.Arguments[0],lSize);
+    strm.seekg(lPosition);
+  }
+
+  void PatternGeneratorInterfacePrivate::ReplayCommands(const vector<unsigned int> &aNbPlugins)
+  {
+    vector<pair<unsigned long int, string> > lCommands;
+    for(map<string, CommandRecord_s, ltstr>::const_iterator it=m_CommandRecords.begin();
+	it!=m_CommandRecords.end();it++)
+      lCommands.push_back(make_pair(it->second.Stamp,it->first));
+    sort(lCommands.begin(),lCommands.end());
+
+    for(unsigned int i=0;i<lCommands.size();i++)
+      {
+	string lName = lCommands[i].second;
+	int lHandle = ResolveMethod(lName);
+	if (lHandle<0)
+	  continue;
+
+	const string & lArgs = m_CommandRecords[lName].Arguments;
+	vector<SimplePlugin *> & lPlugins = m_Methods[lHandle].Plugins;
+	unsigned int lFirst = 0;
+	if (lHandle<(int)aNbPlugins.size())
+	  lFirst = aNbPlugins[lHandle];
+	for(unsigned int j=lFirst;j<lPlugins.size();j++)
+	  {
+	    ODEBUG("Replay " << lName << " " << lArgs);
+	    istringstream strm(lArgs);
+	    lPlugins[j]->CallMethod(lName,strm);
+	  }
+      }
+  }
+
   PatternGeneratorInterfacePrivate::~PatternGeneratorInterfacePrivate()
   {
 
@@ -408,6 +571,11 @@ namespace PatternGeneratorJRL {
     if (m_CoMAndFootOnlyStrategy!=0)
       delete m_CoMAndFootOnlyStrategy;
 
+    if (m_TraceRecorder!=0)
+      delete m_TraceRecorder;
+
+    if (m_CommandStreamRecorder!=0)
+      delete m_CommandStreamRecorder;
 
   }
 
@@ -504,13 +672,13 @@ namespace PatternGeneratorJRL {
   void PatternGeneratorInterfacePrivate::setVelReference(istringstream &strm)
   {
     // Read the data inside strm.
-    m_ZMPVRQP->Reference(strm);
+    VelocityReferencedQP()->Reference(strm);
   }
  
   void PatternGeneratorInterfacePrivate::setCoMPerturbationForce(istringstream &strm)
   {
     // Read the data inside strm.
-    m_ZMPVRQP->setCoMPerturbationForce(strm);
+    VelocityReferencedQP()->setCoMPerturbationForce(strm);
   }
 
 
@@ -539,7 +707,7 @@ namespace PatternGeneratorJRL {
 			  InitRightFootAbsPos);
 
     deque<RelativeFootPosition> RelativeFootPositions;
-    m_ZMPVRQP->SetCurrentTime(m_InternalClock);
+    VelocityReferencedQP()->SetCurrentTime(m_InternalClock);
 
     m_ZMPVRQP->InitOnLine(m_ZMPPositions,
 			  m_COMBuffer,
@@ -1033,12 +1201,164 @@ namespace PatternGeneratorJRL {
     strm >> aCmd;
 
     ODEBUG("PARSECMD");
+    RecordCommandStream(aCmd,strm);
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    CommandHandle lCmd = ResolveCommand(aCmd);
+    // Nobody registered this command yet, it may be meant
+    // for an algorithm which is not created.
+    if (lCmd<0)
+      RecordCommand(aCmd,strm);
+    return ParseCmd(lCmd,strm);
+  }
+
+  int PatternGeneratorInterfacePrivate::ParseCmd(CommandHandle aCmd,
+						 istringstream &strm)
+  {
+    ScopedOutputDirectory aSOD(m_OutputDirectory);
+    ScopedTelemetryLogger aSTL(m_TelemetryLogger);
+    if ((aCmd>=0) && (aCmd<(int)m_Methods.size()))
+      {
+	RecordCommandStream(m_Methods[aCmd].Name,strm);
+	RecordCommand(m_Methods[aCmd].Name,strm);
+      }
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
     if (SimplePluginManager::CallMethod(aCmd,strm))
       {
 	ODEBUG("Method " << aCmd << " found and handled.");
       }
     return 0;
   }
+
+  CommandHandle PatternGeneratorInterfacePrivate::ResolveCommand(const string &aCmd)
+  {
+    return ResolveMethod(aCmd);
+  }
+
+  const PatternGeneratorInterfacePrivate::TypedCommand_s *
+  PatternGeneratorInterfacePrivate::TypedCommand(CommandHandle aCmd) const
+  {
+    if ((aCmd<0) || (aCmd>=(int)m_TypedCommands.size()))
+      return 0;
+    return &m_TypedCommands[aCmd];
+  }
+
+  bool PatternGeneratorInterfacePrivate::SharedCommand(CommandHandle aCmd) const
+  {
+    return m_Methods[aCmd].Plugins.size()>1;
+  }
+
+  void PatternGeneratorInterfacePrivate::ForwardCommand(CommandHandle aCmd,
+							const string &anArgs)
+  {
+    RecordCommand(m_Methods[aCmd].Name,anArgs);
+    istringstream strm(anArgs);
+    SimplePluginManager::CallMethod(aCmd,strm,this);
+  }
+
+  bool PatternGeneratorInterfacePrivate::CallCommand(CommandHandle aCmd)
+  {
+    const TypedCommand_s * aTC = TypedCommand(aCmd);
+    if ((aTC==0) || (aTC->NoArgument==0))
+      return false;
+    RecordCommandStream(m_Methods[aCmd].Name,"");
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    (this->*aTC->NoArgument)();
+    if (SharedCommand(aCmd))
+      ForwardCommand(aCmd,"");
+    return true;
+  }
+
+  bool PatternGeneratorInterfacePrivate::CallCommand(CommandHandle aCmd,
+						     double aValue)
+  {
+    const TypedCommand_s * aTC = TypedCommand(aCmd);
+    if ((aTC==0) || (aTC->Scalar==0))
+      return false;
+    // The arguments are formatted only to be recorded or forwarded.
+    string lArgs;
+    if ((m_CommandStreamRecorder!=0) || SharedCommand(aCmd))
+      {
+	ostringstream oss;
+	oss.precision(17);
+	oss << aValue;
+	lArgs = oss.str();
+	RecordCommandStream(m_Methods[aCmd].Name,lArgs);
+      }
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    (this->*aTC->Scalar)(aValue);
+    if (SharedCommand(aCmd))
+      ForwardCommand(aCmd,lArgs);
+    return true;
+  }
+
+  bool PatternGeneratorInterfacePrivate::CallCommand(CommandHandle aCmd,
+						     const VelocityReferenceArguments &anArg)
+  {
+    const TypedCommand_s * aTC = TypedCommand(aCmd);
+    if ((aTC==0) || (aTC->VelocityReference==0))
+      return false;
+    // The arguments are formatted only to be recorded or forwarded.
+    string lArgs;
+    if ((m_CommandStreamRecorder!=0) || SharedCommand(aCmd))
+      {
+	ostringstream oss;
+	oss.precision(17);
+	oss << anArg.x << " " << anArg.y << " " << anArg.yaw;
+	lArgs = oss.str();
+	RecordCommandStream(m_Methods[aCmd].Name,lArgs);
+      }
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    (this->*aTC->VelocityReference)(anArg);
+    if (SharedCommand(aCmd))
+      ForwardCommand(aCmd,lArgs);
+    return true;
+  }
+
+  bool PatternGeneratorInterfacePrivate::CallCommand(CommandHandle aCmd,
+						     const PerturbationForceArguments &anArg)
+  {
+    const TypedCommand_s * aTC = TypedCommand(aCmd);
+    if ((aTC==0) || (aTC->PerturbationForce==0))
+      return false;
+    // The arguments are formatted only to be recorded or forwarded.
+    string lArgs;
+    if ((m_CommandStreamRecorder!=0) || SharedCommand(aCmd))
+      {
+	ostringstream oss;
+	oss.precision(17);
+	oss << anArg.x << " " << anArg.y;
+	lArgs = oss.str();
+	RecordCommandStream(m_Methods[aCmd].Name,lArgs);
+      }
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    (this->*aTC->PerturbationForce)(anArg);
+    if (SharedCommand(aCmd))
+      ForwardCommand(aCmd,lArgs);
+    return true;
+  }
+
+  void PatternGeneratorInterfacePrivate::m_SetSamplingPeriod(double aSamplingPeriod)
+  {
+    m_SamplingPeriod = aSamplingPeriod;
+  }
+
+  void PatternGeneratorInterfacePrivate::m_HerdtOnline()
+  {
+    m_InternalClock = 0.0;
+    initOnlineHerdt();
+    printf("Online \n");
+    //ODEBUG4("InitOnLine","DebugHerdt.txt");
+  }
+
+  void PatternGeneratorInterfacePrivate::m_SetVelReference(const VelocityReferenceArguments &anArg)
+  {
+    VelocityReferencedQP()->Reference(anArg.x,anArg.y,anArg.yaw);
+  }
+
+  void PatternGeneratorInterfacePrivate::m_SetCoMPerturbationForce(const PerturbationForceArguments &anArg)
+  {
+    VelocityReferencedQP()->setCoMPerturbationForce(anArg.x,anArg.y);
+  }
   void PatternGeneratorInterfacePrivate::ChangeOnLineStep(istringstream &strm,double &newtime)
   {
     if (m_AlgorithmforZMPCOM==ZMPCOM_MORISAWA_2007)
@@ -1067,7 +1387,7 @@ namespace PatternGeneratorJRL {
       {
 	double sp;
 	strm >> sp;
-	m_SamplingPeriod = sp;
+	m_SetSamplingPeriod(sp);
       }
 
     else if (aCmd==":LimitsFeasibility")
@@ -1101,12 +1421,7 @@ namespace PatternGeneratorJRL {
       }
 
     else if (aCmd==":HerdtOnline")
-      {
-	m_InternalClock = 0.0;
-	initOnlineHerdt();
-	printf("Online \n");
-	//ODEBUG4("InitOnLine","DebugHerdt.txt");
-      }
+      m_HerdtOnline();
     else if (aCmd==":setCoMPerturbationForce")
       {
 	setCoMPerturbationForce(strm);
@@ -1119,6 +1434,12 @@ namespace PatternGeneratorJRL {
       m_SetAlgoForZMPTraj(strm);
     }
 
+    else if (aCmd==":outputdirectory")
+      {
+	strm >> m_OutputDirectory;
+	ODEBUG("OutputDirectory: " << m_OutputDirectory);
+      }
+
     else if (aCmd==":SetAutoFirstStep")
       {
 	std::string lAutoFirstStep;
@@ -1130,6 +1451,92 @@ namespace PatternGeneratorJRL {
 	ODEBUG("SetAutoFirstStep: " << m_AutoFirstStep);
       }
 
+    else if (aCmd==":tracing")
+      m_SetTracing(strm);
+
+    else if (aCmd==":dumptrace")
+      m_DumpTrace(strm);
+
+    else if (aCmd==":recordcommands")
+      m_RecordCommands(strm);
+
+  }
+
+  void PatternGeneratorInterfacePrivate::m_SetTracing(istringstream &strm)
+  {
+    string lTracing;
+    strm >> lTracing;
+    if (lTracing=="on")
+      {
+	if (m_TraceRecorder==0)
+	  m_TraceRecorder = new TraceRecorder();
+	m_StageProfiler.SetTraceRecorder(m_TraceRecorder);
+      }
+    else if (lTracing=="off")
+      m_StageProfiler.SetTraceRecorder(0);
+    ODEBUG("Tracing: " << lTracing);
+  }
+
+  void PatternGeneratorInterfacePrivate::m_DumpTrace(istringstream &strm)
+  {
+    if (m_TraceRecorder==0)
+      {
+	cerr << "No trace to dump, use :tracing on first." << endl;
+	return;
+      }
+
+    string lFileName;
+    strm >> lFileName;
+    if (lFileName.size()==0)
+      lFileName = "walkgen-trace.json";
+    if (lFileName[0]!='/')
+      lFileName = OutputFileName(lFileName);
+    m_TraceRecorder->Dump(lFileName);
+  }
+
+  void PatternGeneratorInterfacePrivate::m_RecordCommands(istringstream &strm)
+  {
+    string lFileName;
+    strm >> lFileName;
+    if (lFileName=="off")
+      {
+	// The recorder is kept: this call is in one of its scopes.
+	if (m_CommandStreamRecorder!=0)
+	  m_CommandStreamRecorder->Close();
+	return;
+      }
+
+    if (lFileName.size()==0)
+      lFileName = "walkgen-commands.bin";
+    if (lFileName[0]!='/')
+      lFileName = OutputFileName(lFileName);
+    if (m_CommandStreamRecorder==0)
+      m_CommandStreamRecorder = new CommandStreamRecorder();
+    m_CommandStreamRecorder->Open(lFileName,m_CurrentActuatedJointValues);
+  }
+
+  void PatternGeneratorInterfacePrivate::RecordCommandStream(const string &aName,
+							     const string &anArgs)
+  {
+    if ((m_CommandStreamRecorder==0) ||
+	(aName==":recordcommands"))
+      return;
+    if (anArgs.size()==0)
+      m_CommandStreamRecorder->RecordCommand(aName);
+    else
+      m_CommandStreamRecorder->RecordCommand(aName + " " + anArgs);
+  }
+
+  void PatternGeneratorInterfacePrivate::RecordCommandStream(const string &aName,
+							     istringstream &strm)
+  {
+    if (m_CommandStreamRecorder==0)
+      return;
+    streampos lPosition = strm.tellg();
+    if (lPosition<0)
+      RecordCommandStream(aName,string());
+    else
+      RecordCommandStream(aName,strm.str().substr(lPosition));
   }
 
   void PatternGeneratorInterfacePrivate::m_SetAlgoForZMPTraj(istringstream &strm)
@@ -1139,6 +1546,7 @@ namespace PatternGeneratorJRL {
     ODEBUG("ZMPTrajAlgo: " << ZMPTrajAlgo);
     if (ZMPTrajAlgo=="PBW")
       {
+	InstanciateAlgorithm(ZMPCOM_WIEBER_2006);
 	m_AlgorithmforZMPCOM = ZMPCOM_WIEBER_2006;
 	m_GlobalStrategyManager = m_DoubleStagePCStrategy;
       }
@@ -1149,18 +1557,21 @@ namespace PatternGeneratorJRL {
       }
     else if (ZMPTrajAlgo=="Morisawa")
       {
+	InstanciateAlgorithm(ZMPCOM_MORISAWA_2007);
 	m_AlgorithmforZMPCOM = ZMPCOM_MORISAWA_2007;
 	m_GlobalStrategyManager = m_CoMAndFootOnlyStrategy;
 	m_CoMAndFootOnlyStrategy->SetTheLimitOfTheBuffer(m_ZMPM->ReturnOptimalTimeToRegenerateAStep());
       }
     else if (ZMPTrajAlgo=="Dimitrov")
       {
+	InstanciateAlgorithm(ZMPCOM_DIMITROV_2008);
 	m_AlgorithmforZMPCOM = ZMPCOM_DIMITROV_2008;
 	m_GlobalStrategyManager = m_DoubleStagePCStrategy;
 	cout << "DIMITROV" << endl;
       }
     else if (ZMPTrajAlgo=="Herdt")
       {
+	InstanciateAlgorithm(ZMPCOM_HERDT_2010);
 	m_AlgorithmforZMPCOM = ZMPCOM_HERDT_2010;
 	m_GlobalStrategyManager = m_CoMAndFootOnlyStrategy;
 	m_CoMAndFootOnlyStrategy->SetTheLimitOfTheBuffer(0);
@@ -1253,6 +1664,19 @@ namespace PatternGeneratorJRL {
 
   {
 
+    ScopedOutputDirectory aSOD(m_OutputDirectory);
+    ScopedStageProfiler aSSP(m_StageProfiler);
+    ScopedTelemetryLogger aSTL(m_TelemetryLogger);
+    StageTimer aControlLoopTimer(StageProfiler::CONTROL_LOOP);
+
+    ApplyInboxCommands();
+
+    // The commands applied by the inbox are recorded,
+    // not the ones called during the step.
+    CommandStreamRecorder::Scope aRecorderScope(m_CommandStreamRecorder);
+    if (m_CommandStreamRecorder!=0)
+      m_CommandStreamRecorder->NextTick();
+
     m_InternalClock+=m_SamplingPeriod;
 
     if ((!m_ShouldBeRunning) ||
@@ -1374,14 +1798,13 @@ namespace PatternGeneratorJRL {
     m_CurrentWaistState.y[1]  = CurrentVelocity[1];
     m_CurrentWaistState.z[1]  = CurrentVelocity[2];
 
-    ODEBUG4("CurrentWaistState: "
-	    << m_CurrentWaistState.x[0] << " "
-	    << m_CurrentWaistState.y[0] << " "
-	    << m_CurrentWaistState.z[0] << " "
-	    << m_CurrentWaistState.roll[0] << " "
-	    << m_CurrentWaistState.pitch[0] << " "
-	    << m_CurrentWaistState.yaw[0],
-	    "DebugDataWaist.dat" );
+    ODEBUG4TELEMETRY(m_CurrentWaistState.x[0]
+		     << m_CurrentWaistState.y[0]
+		     << m_CurrentWaistState.z[0]
+		     << m_CurrentWaistState.roll[0]
+		     << m_CurrentWaistState.pitch[0]
+		     << m_CurrentWaistState.yaw[0],
+		     "DebugDataWaist.dat" );
     bool UpdateAbsMotionOrNot = false;
 
     //    if ((u=(m_count - (m_ZMPPositions.size()-2*m_NL)))>=0)
@@ -1513,6 +1936,94 @@ namespace PatternGeneratorJRL {
     return m_Running;
   }
 
+  unsigned int PatternGeneratorInterfacePrivate::RunNStepsOfTheControlLoop(unsigned int N,
+									   ControlLoopBuffers &aBuffers)
+  {
+    if ((int)MAL_VECTOR_SIZE(m_BatchConfiguration)!=m_DOF)
+      {
+	MAL_VECTOR_RESIZE(m_BatchConfiguration,m_DOF);
+	MAL_VECTOR_RESIZE(m_BatchVelocity,m_DOF);
+	MAL_VECTOR_RESIZE(m_BatchAcceleration,m_DOF);
+	MAL_VECTOR_FILL(m_BatchConfiguration,0.0);
+	MAL_VECTOR_FILL(m_BatchVelocity,0.0);
+	MAL_VECTOR_FILL(m_BatchAcceleration,0.0);
+      }
+    if (MAL_VECTOR_SIZE(m_BatchZMPTarget)!=3)
+      {
+	MAL_VECTOR_RESIZE(m_BatchZMPTarget,3);
+	MAL_VECTOR_FILL(m_BatchZMPTarget,0.0);
+      }
+
+    unsigned int i;
+    for(i=0;i<N;i++)
+      {
+	// Qualified call: no virtual dispatch inside the loop.
+	if (!PatternGeneratorInterfacePrivate::
+	    RunOneStepOfTheControlLoop(m_BatchConfiguration,
+				       m_BatchVelocity,
+				       m_BatchAcceleration,
+				       m_BatchZMPTarget,
+				       m_BatchCOMState,
+				       m_BatchLeftFoot,
+				       m_BatchRightFoot))
+	  break;
+	StoreBatchStep(i,aBuffers);
+      }
+    return i;
+  }
+
+  void PatternGeneratorInterfacePrivate::StoreBatchStep(unsigned int i,
+							ControlLoopBuffers &aBuffers)
+  {
+    unsigned int lNbDofs = aBuffers.NbDofs;
+    if (lNbDofs>MAL_VECTOR_SIZE(m_BatchConfiguration))
+      lNbDofs = MAL_VECTOR_SIZE(m_BatchConfiguration);
+
+    if (aBuffers.Configurations!=0)
+      {
+	double * lRow = aBuffers.Configurations + i*aBuffers.NbDofs;
+	for(unsigned int j=0;j<lNbDofs;j++)
+	  lRow[j] = m_BatchConfiguration(j);
+      }
+    if (aBuffers.Velocities!=0)
+      {
+	double * lRow = aBuffers.Velocities + i*aBuffers.NbDofs;
+	for(unsigned int j=0;j<lNbDofs;j++)
+	  lRow[j] = m_BatchVelocity(j);
+      }
+    if (aBuffers.Accelerations!=0)
+      {
+	double * lRow = aBuffers.Accelerations + i*aBuffers.NbDofs;
+	for(unsigned int j=0;j<lNbDofs;j++)
+	  lRow[j] = m_BatchAcceleration(j);
+      }
+
+    for(unsigned int j=0;j<3;j++)
+      if (aBuffers.ZMP[j]!=0)
+	aBuffers.ZMP[j][i] = m_BatchZMPTarget(j);
+
+    const double lCoM[6] =
+      { m_BatchCOMState.x[0], m_BatchCOMState.y[0], m_BatchCOMState.z[0],
+	m_BatchCOMState.yaw[0], m_BatchCOMState.pitch[0], m_BatchCOMState.roll[0] };
+    for(unsigned int j=0;j<6;j++)
+      if (aBuffers.CoM[j]!=0)
+	aBuffers.CoM[j][i] = lCoM[j];
+
+    const double lLeftFoot[5] =
+      { m_BatchLeftFoot.x, m_BatchLeftFoot.y, m_BatchLeftFoot.z,
+	m_BatchLeftFoot.theta, m_BatchLeftFoot.omega };
+    const double lRightFoot[5] =
+      { m_BatchRightFoot.x, m_BatchRightFoot.y, m_BatchRightFoot.z,
+	m_BatchRightFoot.theta, m_BatchRightFoot.omega };
+    for(unsigned int j=0;j<5;j++)
+      {
+	if (aBuffers.LeftFoot[j]!=0)
+	  aBuffers.LeftFoot[j][i] = lLeftFoot[j];
+	if (aBuffers.RightFoot[j]!=0)
+	  aBuffers.RightFoot[j][i] = lRightFoot[j];
+      }
+  }
+
 
 
   void PatternGeneratorInterfacePrivate::m_SetTimeDistrParameters(istringstream &strm)
@@ -1555,6 +2066,12 @@ namespace PatternGeneratorJRL {
       {
 	m_CurrentActuatedJointValues[i] = lCurrentJointValues(i);
       }
+
+    if ((m_CommandStreamRecorder!=0) &&
+	(m_CurrentActuatedJointValues.size()>0))
+      m_CommandStreamRecorder->RecordValues(RECORD_JOINT_VALUES,
+					    &m_CurrentActuatedJointValues[0],
+					    m_CurrentActuatedJointValues.size());
   }
 
 
@@ -1623,6 +2140,11 @@ namespace PatternGeneratorJRL {
 
   void PatternGeneratorInterfacePrivate::AddOnLineStep(double X, double Y, double Theta)
   {
+    if (m_CommandStreamRecorder!=0)
+      {
+	double lValues[3] = { X, Y, Theta };
+	m_CommandStreamRecorder->RecordValues(RECORD_ADD_ONLINE_STEP,lValues,3);
+      }
     m_NewStep = true;
     m_NewStepX = X;
     m_NewStepY = Y;
@@ -1783,19 +2305,123 @@ namespace PatternGeneratorJRL {
 							      double y,
 							      double yaw)
   {
-    m_ZMPVRQP->Reference(x,y,yaw);
+    if (m_CommandStreamRecorder!=0)
+      {
+	double lValues[3] = { x, y, yaw };
+	m_CommandStreamRecorder->RecordValues(RECORD_VELOCITY_REFERENCE,lValues,3);
+      }
+    VelocityReferencedQP()->Reference(x,y,yaw);
   }
 
   void PatternGeneratorInterfacePrivate::setCoMPerturbationForce(double x,
 							      double y)
   {
-    m_ZMPVRQP->setCoMPerturbationForce(x,y);
+    if (m_CommandStreamRecorder!=0)
+      {
+	double lValues[2] = { x, y };
+	m_CommandStreamRecorder->RecordValues(RECORD_PERTURBATION_FORCE,lValues,2);
+      }
+    VelocityReferencedQP()->setCoMPerturbationForce(x,y);
+  }
+
+  void PatternGeneratorInterfacePrivate::PostVelocityReference(double x,
+							       double y,
+							       double yaw)
+  {
+    m_CommandInbox.PostVelocityReference(x,y,yaw);
+  }
+
+  bool PatternGeneratorInterfacePrivate::PostCoMPerturbationForce(double x,
+								  double y)
+  {
+    CommandInbox::Command_s aCommand;
+    aCommand.Type = CommandInbox::PERTURBATION_FORCE;
+    aCommand.Values[0] = x;
+    aCommand.Values[1] = y;
+    aCommand.Values[2] = 0.0;
+    return m_CommandInbox.Push(aCommand);
+  }
+
+  bool PatternGeneratorInterfacePrivate::PostOnLineStepChange(double x,
+							      double y,
+							      double theta)
+  {
+    CommandInbox::Command_s aCommand;
+    aCommand.Type = CommandInbox::ONLINE_STEP_CHANGE;
+    aCommand.Values[0] = x;
+    aCommand.Values[1] = y;
+    aCommand.Values[2] = theta;
+    return m_CommandInbox.Push(aCommand);
+  }
+
+  void PatternGeneratorInterfacePrivate::GetStageLatencies(vector<StageLatency> &aLatencies) const
+  {
+    aLatencies.resize(StageProfiler::NB_STAGES);
+    for(unsigned int i=0;i<StageProfiler::NB_STAGES;i++)
+      {
+	const LatencyHistogram & aHistogram = m_StageProfiler.Histogram(i);
+	aLatencies[i].Name = StageProfiler::StageName(i);
+	aLatencies[i].NbOfSamples = aHistogram.NbOfSamples();
+	aLatencies[i].Median = 1e-9*aHistogram.Percentile(0.5);
+	aLatencies[i].Percentile99 = 1e-9*aHistogram.Percentile(0.99);
+	aLatencies[i].Maximum = 1e-9*aHistogram.Maximum();
+      }
+  }
+
+  void PatternGeneratorInterfacePrivate::ResetStageLatencies()
+  {
+    m_StageProfiler.Reset();
+  }
+
+  void PatternGeneratorInterfacePrivate::GetBufferSizes(BufferSizes &aSizes) const
+  {
+    aSizes.ZMPPositions = m_ZMPPositions.size();
+    aSizes.COMBuffer = m_COMBuffer.size();
+    aSizes.LeftFootPositions = m_LeftFootPositions.size();
+    aSizes.RightFootPositions = m_RightFootPositions.size();
+    aSizes.FootAbsolutePositions = m_FootAbsolutePositions.size();
+  }
+
+  void PatternGeneratorInterfacePrivate::ApplyInboxCommands()
+  {
+    double x,y,yaw;
+    if (m_CommandInbox.PopVelocityReference(x,y,yaw))
+      setVelocityReference(x,y,yaw);
+
+    CommandInbox::Command_s aCommand;
+    while(m_CommandInbox.Pop(aCommand))
+      {
+	if (aCommand.Type==CommandInbox::PERTURBATION_FORCE)
+	  setCoMPerturbationForce(aCommand.Values[0],aCommand.Values[1]);
+	else if ((aCommand.Type==CommandInbox::ONLINE_STEP_CHANGE) &&
+		 (m_AlgorithmforZMPCOM==ZMPCOM_MORISAWA_2007))
+	  {
+	    FootAbsolutePosition aFAP;
+	    memset(&aFAP,0,sizeof(aFAP));
+	    aFAP.x = aCommand.Values[0];
+	    aFAP.y = aCommand.Values[1];
+	    aFAP.theta = aCommand.Values[2];
+	    double newtime;
+	    ChangeOnLineStep((double)m_ZMPM->GetTSingleSupport(),aFAP,newtime);
+	  }
+      }
   }
 
   int PatternGeneratorInterfacePrivate::ChangeOnLineStep(double time,
 							 FootAbsolutePosition & aFootAbsolutePosition,
 							 double &newtime)
   {
+    if (m_CommandStreamRecorder!=0)
+      {
+	double lValues[7] = { time,
+			      aFootAbsolutePosition.x,
+			      aFootAbsolutePosition.y,
+			      aFootAbsolutePosition.z,
+			      aFootAbsolutePosition.theta,
+			      aFootAbsolutePosition.omega,
+			      aFootAbsolutePosition.omega2 };
+	m_CommandStreamRecorder->RecordValues(RECORD_CHANGE_ONLINE_STEP,lValues,7);
+      }
     /* Compute the index of the interval which will be modified. */
     if (m_AlgorithmforZMPCOM==ZMPCOM_MORISAWA_2007)
       {
@@ -1826,7 +2452,8 @@ namespace PatternGeneratorJRL {
       {
 	ODEBUG("ZMPCOM_WIEBER_2006 " << m_ZMPPositions.size() );
 	m_COMBuffer.clear();
-	m_ZMPM->SetCurrentTime(m_InternalClock);
+	if (m_ZMPM!=0)
+	  m_ZMPM->SetCurrentTime(m_InternalClock);
 	m_ZMPQP->GetZMPDiscretization(m_ZMPPositions,
 				      m_COMBuffer,
 				      lRelativeFootPositions,
@@ -1856,7 +2483,8 @@ namespace PatternGeneratorJRL {
       {
 	ODEBUG("ZMPCOM_HERDT_2010 " << m_ZMPPositions.size() );
 	m_COMBuffer.clear();
-	m_ZMPM->SetCurrentTime(m_InternalClock);
+	if (m_ZMPM!=0)
+	  m_ZMPM->SetCurrentTime(m_InternalClock);
 	m_ZMPVRQP->GetZMPDiscretization(m_ZMPPositions,
 					m_COMBuffer,
 					lRelativeFootPositions,
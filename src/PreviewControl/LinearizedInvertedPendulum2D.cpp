@@ -216,12 +216,12 @@ int LinearizedInvertedPendulum2D::Interpolation(deque<COMState> &COMStates,
 	m_C(0,1) * aCOMPos.y[1] + m_C(0,2) * aCOMPos.y[2];
       
             
-      ODEBUG4(aCOMPos.x[0] << " " << aCOMPos.x[1] << " " << aCOMPos.x[2] << " " <<
-	      aCOMPos.y[0] << " " << aCOMPos.y[1] << " " << aCOMPos.y[2] << " " <<
-	      aCOMPos.yaw << " " <<
-	      aZMPPos.px << " " << aZMPPos.py <<  " " << aZMPPos.theta << " " <<
-	      CX << " " << CY << " " <<
-	      lkSP << " " << m_T , "DebugInterpol.dat");
+      ODEBUG4TELEMETRY(aCOMPos.x[0] << aCOMPos.x[1] << aCOMPos.x[2] <<
+		       aCOMPos.y[0] << aCOMPos.y[1] << aCOMPos.y[2] <<
+		       aCOMPos.yaw[0] <<
+		       aZMPPos.px << aZMPPos.py << aZMPPos.theta <<
+		       CX << CY <<
+		       lkSP << m_T , "DebugInterpol.dat");
     }
   return 0;
 }
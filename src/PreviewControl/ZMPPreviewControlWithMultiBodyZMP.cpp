@@ -39,6 +39,7 @@
 #include <Debug.hh>
 
 #include <PreviewControl/ZMPPreviewControlWithMultiBodyZMP.hh>
+#include <StageProfiler.hh>
 
 using namespace PatternGeneratorJRL;
 
@@ -120,9 +121,61 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    // New scheme for WPG v3.0
    // We call the object in charge of generating the whole body
    // motion  ( for a given CoM and Feet points)  before applying the second filter.
-   MAL_VECTOR_DIM(aCOMState,double,6);
-   MAL_VECTOR_DIM(aCOMSpeed,double,6);
-   MAL_VECTOR_DIM(aCOMAcc,double,6);
+   MAL_VECTOR(aCOMState,double);
+   MAL_VECTOR(aCOMSpeed,double);
+   MAL_VECTOR(aCOMAcc,double);
+   MAL_VECTOR(aLeftFootPosition,double);
+   MAL_VECTOR(aRightFootPosition,double);
+
+   PostureVectors(acomp,aLeftFAP,aRightFAP,
+		  aCOMState,aCOMSpeed,aCOMAcc,
+		  aLeftFootPosition,aRightFootPosition);
+
+   /* Get the current configuration vector */
+   CurrentConfiguration = m_HumanoidDynamicRobot->currentConfiguration();
+
+   /* Get the current velocity vector */
+   CurrentVelocity = m_HumanoidDynamicRobot->currentVelocity();
+
+   /* Get the current acceleration vector */
+   CurrentAcceleration = m_HumanoidDynamicRobot->currentAcceleration();
+
+   m_ComAndFootRealization->ComputePostureForGivenCoMAndFeetPosture(aCOMState, aCOMSpeed, aCOMAcc,
+								    aLeftFootPosition,
+								    aRightFootPosition,
+								    CurrentConfiguration,
+								    CurrentVelocity,
+								    CurrentAcceleration,
+								    IterationNumber,
+								    StageOfTheAlgorithm);
+
+   if (StageOfTheAlgorithm==0)
+     {
+       /* Update the current configuration vector */
+       m_HumanoidDynamicRobot->currentConfiguration(CurrentConfiguration);
+
+       /* Update the current velocity vector */
+       m_HumanoidDynamicRobot->currentVelocity(CurrentVelocity);
+
+       /* Update the current acceleration vector */
+       m_HumanoidDynamicRobot->currentAcceleration(CurrentAcceleration);
+     }
+ }
+
+ void ZMPPreviewControlWithMultiBodyZMP::PostureVectors(COMState &acomp,
+							FootAbsolutePosition &aLeftFAP,
+							FootAbsolutePosition &aRightFAP,
+							MAL_VECTOR_TYPE(double) &aCOMState,
+							MAL_VECTOR_TYPE(double) &aCOMSpeed,
+							MAL_VECTOR_TYPE(double) &aCOMAcc,
+							MAL_VECTOR_TYPE(double) &aLeftFootPosition,
+							MAL_VECTOR_TYPE(double) &aRightFootPosition)
+ {
+   /* The postures are followed by their derivatives,
+      used for the analytical joint rates of the legs. */
+   MAL_VECTOR_RESIZE(aCOMState,18);
+   MAL_VECTOR_RESIZE(aCOMSpeed,6);
+   MAL_VECTOR_RESIZE(aCOMAcc,6);
 
    aCOMState(0) = acomp.x[0];
    aCOMState(1) = acomp.y[0];
@@ -131,6 +184,16 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    aCOMState(4) = acomp.pitch[0];
    aCOMState(5) = acomp.yaw[0];
 
+   for(unsigned int i=1;i<3;i++)
+     {
+       aCOMState(6*i)   = acomp.x[i];
+       aCOMState(6*i+1) = acomp.y[i];
+       aCOMState(6*i+2) = acomp.z[i];
+       aCOMState(6*i+3) = acomp.roll[i];
+       aCOMState(6*i+4) = acomp.pitch[i];
+       aCOMState(6*i+5) = acomp.yaw[i];
+     }
+
    aCOMSpeed(0) = acomp.x[1];
    aCOMSpeed(1) = acomp.y[1];
    aCOMSpeed(2) = acomp.z[1];
@@ -145,8 +208,8 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    aCOMAcc(4) = acomp.roll[2];
    aCOMAcc(5) = acomp.roll[2];
 
-   MAL_VECTOR_DIM(aLeftFootPosition,double,5);
-   MAL_VECTOR_DIM(aRightFootPosition,double,5);
+   MAL_VECTOR_RESIZE(aLeftFootPosition,15);
+   MAL_VECTOR_RESIZE(aRightFootPosition,15);
 
    aLeftFootPosition(0) = aLeftFAP.x;
    aLeftFootPosition(1) = aLeftFAP.y;
@@ -160,35 +223,29 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    aRightFootPosition(3) = aRightFAP.theta;
    aRightFootPosition(4) = aRightFAP.omega;
 
-   /* Get the current configuration vector */
-   CurrentConfiguration = m_HumanoidDynamicRobot->currentConfiguration();
-
-   /* Get the current velocity vector */
-   CurrentVelocity = m_HumanoidDynamicRobot->currentVelocity();
-
-   /* Get the current acceleration vector */
-   CurrentAcceleration = m_HumanoidDynamicRobot->currentAcceleration();
-
-   m_ComAndFootRealization->ComputePostureForGivenCoMAndFeetPosture(aCOMState, aCOMSpeed, aCOMAcc,
-								    aLeftFootPosition,
-								    aRightFootPosition,
-								    CurrentConfiguration,
-								    CurrentVelocity,
-								    CurrentAcceleration,
-								    IterationNumber,
-								    StageOfTheAlgorithm);
-
-   if (StageOfTheAlgorithm==0)
-     {
-       /* Update the current configuration vector */
-       m_HumanoidDynamicRobot->currentConfiguration(CurrentConfiguration);
-
-       /* Update the current velocity vector */
-       m_HumanoidDynamicRobot->currentVelocity(CurrentVelocity);
-
-       /* Update the current acceleration vector */
-       m_HumanoidDynamicRobot->currentAcceleration(CurrentAcceleration);
-     }
+   aLeftFootPosition(5) = aLeftFAP.dx;
+   aLeftFootPosition(6) = aLeftFAP.dy;
+   aLeftFootPosition(7) = aLeftFAP.dz;
+   aLeftFootPosition(8) = aLeftFAP.dtheta;
+   aLeftFootPosition(9) = aLeftFAP.domega;
+
+   aRightFootPosition(5) = aRightFAP.dx;
+   aRightFootPosition(6) = aRightFAP.dy;
+   aRightFootPosition(7) = aRightFAP.dz;
+   aRightFootPosition(8) = aRightFAP.dtheta;
+   aRightFootPosition(9) = aRightFAP.domega;
+
+   aLeftFootPosition(10) = aLeftFAP.ddx;
+   aLeftFootPosition(11) = aLeftFAP.ddy;
+   aLeftFootPosition(12) = aLeftFAP.ddz;
+   aLeftFootPosition(13) = aLeftFAP.ddtheta;
+   aLeftFootPosition(14) = aLeftFAP.ddomega;
+
+   aRightFootPosition(10) = aRightFAP.ddx;
+   aRightFootPosition(11) = aRightFAP.ddy;
+   aRightFootPosition(12) = aRightFAP.ddz;
+   aRightFootPosition(13) = aRightFAP.ddtheta;
+   aRightFootPosition(14) = aRightFAP.ddomega;
  }
 
  /* Removed lqr and lql, now they should be set automatically by
@@ -208,19 +265,19 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    FootAbsolutePosition aLeftFAP = m_FIFOLeftFootPosition[m_NL];
    FootAbsolutePosition aRightFAP = m_FIFORightFootPosition[m_NL];
 
-   ODEBUG4SIMPLE(m_FIFOZMPRefPositions[0].px << " " <<
-		 m_FIFOZMPRefPositions[0].py << " " <<
-		 m_FIFOZMPRefPositions[0].pz << " " <<
-		 acompos.x[0] << " " <<
-		 acompos.y[0] << " " <<
-		 acompos.z[0] << " " <<
-		 aLeftFAP.x << " " <<
-		 aLeftFAP.y << " " <<
-		 aLeftFAP.z << " " <<
-		 aRightFAP.x << " " <<
-		 aRightFAP.y << " " <<
-		 aRightFAP.z,
-		 "ZMPPCWMZOGSOC.dat");
+   ODEBUG4TELEMETRY(m_FIFOZMPRefPositions[0].px <<
+		    m_FIFOZMPRefPositions[0].py <<
+		    m_FIFOZMPRefPositions[0].pz <<
+		    acompos.x[0] <<
+		    acompos.y[0] <<
+		    acompos.z[0] <<
+		    aLeftFAP.x <<
+		    aLeftFAP.y <<
+		    aLeftFAP.z <<
+		    aRightFAP.x <<
+		    aRightFAP.y <<
+		    aRightFAP.z,
+		    "ZMPPCWMZOGSOC.dat");
    
    CallToComAndFootRealization(acompos,aLeftFAP,aRightFAP,
 			       CurrentConfiguration,
@@ -237,18 +294,18 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
 
    SecondStageOfControl(refandfinalCOMState);
 
-   ODEBUG4SIMPLE(refandfinalCOMState.x[0] << 
-		 " " << refandfinalCOMState.y[0] <<
-		 " " << refandfinalCOMState.z[0] <<
-		 " " << aLeftFAP.x <<
-		 " " << aLeftFAP.y <<
-		 " " << aLeftFAP.z << 
-		 " " << aLeftFAP.stepType << 
-		 " " << aRightFAP.x <<
-		 " " << aRightFAP.y <<
-		 " " << aRightFAP.z << 
-		 " " << aRightFAP.stepType
-		 , "2ndStage.dat");
+   ODEBUG4TELEMETRY(refandfinalCOMState.x[0] <<
+		    refandfinalCOMState.y[0] <<
+		    refandfinalCOMState.z[0] <<
+		    aLeftFAP.x <<
+		    aLeftFAP.y <<
+		    aLeftFAP.z <<
+		    aLeftFAP.stepType <<
+		    aRightFAP.x <<
+		    aRightFAP.y <<
+		    aRightFAP.z <<
+		    aRightFAP.stepType
+		    , "2ndStage.dat");
 
    if (m_StageStrategy!=ZMPCOM_TRAJECTORY_FIRST_STAGE_ONLY)
      {
@@ -287,20 +344,20 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 2,3) = refandfinalCOMState.z[0];
    MAL_S4x4_MATRIX_ACCESS_I_J(m_FinalDesiredCOMPose, 3,3) = 1.0;
 
-   ODEBUG4SIMPLE(CurrentConfiguration[6]<< " " <<
-		 CurrentConfiguration[7]<< " " <<
-		 CurrentConfiguration[8]<< " " <<
-		 CurrentConfiguration[9]<< " " <<
-		 CurrentConfiguration[10]<< " " <<
-		 CurrentConfiguration[11]<< " " <<
-		 CurrentConfiguration[12]<< " " <<
-		 CurrentConfiguration[13]<< " " <<
-		 CurrentConfiguration[14]<< " " <<
-		 CurrentConfiguration[15]<< " " <<
-		 CurrentConfiguration[16]<< " " <<
-		 CurrentConfiguration[17]<< " " <<
-		 CurrentConfiguration[18]<< " ",
-		 "DebugDataqrql.txt");
+   ODEBUG4TELEMETRY(CurrentConfiguration[6] <<
+		    CurrentConfiguration[7] <<
+		    CurrentConfiguration[8] <<
+		    CurrentConfiguration[9] <<
+		    CurrentConfiguration[10] <<
+		    CurrentConfiguration[11] <<
+		    CurrentConfiguration[12] <<
+		    CurrentConfiguration[13] <<
+		    CurrentConfiguration[14] <<
+		    CurrentConfiguration[15] <<
+		    CurrentConfiguration[16] <<
+		    CurrentConfiguration[17] <<
+		    CurrentConfiguration[18],
+		    "DebugDataqrql.txt");
    m_NumberOfIterations++;
 
    return 1;
@@ -447,6 +504,8 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
 
  int ZMPPreviewControlWithMultiBodyZMP::EvaluateMultiBodyZMP(int /* StartingIteration */)
  {
+   StageTimer aStageTimer(StageProfiler::MULTIBODY_ZMP);
+
    string sComputeZMP("ComputeBackwardDynamics");
    string sZMPtrue("true");
 
@@ -515,15 +574,26 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
 		   COMStates,
 		   LeftFootPositions,
 		   RightFootPositions);
-   for(unsigned int i=0;i<m_NL;i++)
-     SetupIterativePhase(ZMPRefPositions,
-			 COMStates,
-			 LeftFootPositions,
-			 RightFootPositions,
-			 CurrentConfiguration,
-			 CurrentVelocity,
-			 CurrentAcceleration,
-			 i);
+   /* Without the second stage the postures do not need
+      the multibody ZMP, and are realized all at once. */
+   if (m_StageStrategy==ZMPCOM_TRAJECTORY_FIRST_STAGE_ONLY)
+     SetupIterativePhasesOfFirstStage(ZMPRefPositions,
+				      COMStates,
+				      LeftFootPositions,
+				      RightFootPositions,
+				      CurrentConfiguration,
+				      CurrentVelocity,
+				      CurrentAcceleration);
+   else
+     for(unsigned int i=0;i<m_NL;i++)
+       SetupIterativePhase(ZMPRefPositions,
+			   COMStates,
+			   LeftFootPositions,
+			   RightFootPositions,
+			   CurrentConfiguration,
+			   CurrentVelocity,
+			   CurrentAcceleration,
+			   i);
    ODEBUG4("<========================================>","ZMPPCWMZOGSOC.dat");
    return 0;
  }
@@ -631,19 +701,19 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    FootAbsolutePosition aLeftFAP = m_FIFOLeftFootPosition[localindex];
    FootAbsolutePosition aRightFAP = m_FIFORightFootPosition[localindex];
 
-   ODEBUG4SIMPLE(m_FIFOZMPRefPositions[0].px << " " <<
-		 m_FIFOZMPRefPositions[0].py << " " <<
-		 m_FIFOZMPRefPositions[0].pz << " " <<
-		 acompos.x[0] << " " <<
-		 acompos.y[0] << " " <<
-		 acompos.z[0] << " " <<
-		 aLeftFAP.x << " " <<
-		 aLeftFAP.y << " " <<
-		 aLeftFAP.z << " " <<
-		 aRightFAP.x << " " <<
-		 aRightFAP.y << " " <<
-		 aRightFAP.z,
-		 "ZMPPCWMZOGSOC.dat");
+   ODEBUG4TELEMETRY(m_FIFOZMPRefPositions[0].px <<
+		    m_FIFOZMPRefPositions[0].py <<
+		    m_FIFOZMPRefPositions[0].pz <<
+		    acompos.x[0] <<
+		    acompos.y[0] <<
+		    acompos.z[0] <<
+		    aLeftFAP.x <<
+		    aLeftFAP.y <<
+		    aLeftFAP.z <<
+		    aRightFAP.x <<
+		    aRightFAP.y <<
+		    aRightFAP.z,
+		    "ZMPPCWMZOGSOC.dat");
 
    CallToComAndFootRealization(m_FIFOCOMStates[localindex],
 			       m_FIFORightFootPosition[localindex],
@@ -662,6 +732,82 @@ void ZMPPreviewControlWithMultiBodyZMP::SetPreviewControl(PreviewControl *aPC)
    m_NumberOfIterations++;
    return 0;
  }
+ int ZMPPreviewControlWithMultiBodyZMP::
+ SetupIterativePhasesOfFirstStage(deque<ZMPPosition> &ZMPRefPositions,
+				  deque<COMState> &COMStates,
+				  deque<FootAbsolutePosition> &LeftFootPositions,
+				  deque<FootAbsolutePosition> &RightFootPositions,
+				  MAL_VECTOR_TYPE(double) & CurrentConfiguration,
+				  MAL_VECTOR_TYPE(double) & CurrentVelocity,
+				  MAL_VECTOR_TYPE(double) & CurrentAcceleration)
+ {
+   if (m_NL==0)
+     return 0;
+
+   vector<MAL_VECTOR_TYPE(double) > lCoMPositions(m_NL), lCoMSpeeds(m_NL), lCoMAccs(m_NL);
+   vector<MAL_VECTOR_TYPE(double) > lLeftFoot(m_NL), lRightFoot(m_NL);
+
+   /* The preview control is done sample after sample. */
+   for(unsigned int localindex=0;localindex<m_NL;localindex++)
+     {
+       FirstStageOfControl(LeftFootPositions[localindex],
+			   RightFootPositions[localindex],
+			   COMStates[localindex]);
+       COMState acompos = m_FIFOCOMStates[localindex];
+       FootAbsolutePosition aLeftFAP = m_FIFOLeftFootPosition[localindex];
+       FootAbsolutePosition aRightFAP = m_FIFORightFootPosition[localindex];
+
+       ODEBUG4TELEMETRY(m_FIFOZMPRefPositions[0].px <<
+			m_FIFOZMPRefPositions[0].py <<
+			m_FIFOZMPRefPositions[0].pz <<
+			acompos.x[0] <<
+			acompos.y[0] <<
+			acompos.z[0] <<
+			aLeftFAP.x <<
+			aLeftFAP.y <<
+			aLeftFAP.z <<
+			aRightFAP.x <<
+			aRightFAP.y <<
+			aRightFAP.z,
+			"ZMPPCWMZOGSOC.dat");
+
+       /* The feet are given in the same order as in SetupIterativePhase. */
+       PostureVectors(m_FIFOCOMStates[localindex],
+		      m_FIFORightFootPosition[localindex],
+		      m_FIFOLeftFootPosition[localindex],
+		      lCoMPositions[localindex],
+		      lCoMSpeeds[localindex],
+		      lCoMAccs[localindex],
+		      lLeftFoot[localindex],
+		      lRightFoot[localindex]);
+
+       m_FIFOZMPRefPositions.push_back(ZMPRefPositions[localindex+1+m_NL]);
+     }
+
+   vector<MAL_VECTOR_TYPE(double) > lConfigurations, lVelocities, lAccelerations;
+   CurrentConfiguration = m_HumanoidDynamicRobot->currentConfiguration();
+   m_ComAndFootRealization->
+     ComputePosturesForGivenCoMAndFeetPostures(lCoMPositions,lCoMSpeeds,lCoMAccs,
+					       lLeftFoot,lRightFoot,
+					       CurrentConfiguration,
+					       lConfigurations,
+					       lVelocities,
+					       lAccelerations,
+					       m_NumberOfIterations,
+					       0);
+
+   /* The robot is left in the state of the last sample. */
+   CurrentConfiguration = lConfigurations.back();
+   CurrentVelocity = lVelocities.back();
+   CurrentAcceleration = lAccelerations.back();
+   m_HumanoidDynamicRobot->currentConfiguration(CurrentConfiguration);
+   m_HumanoidDynamicRobot->currentVelocity(CurrentVelocity);
+   m_HumanoidDynamicRobot->currentAcceleration(CurrentAcceleration);
+
+   m_NumberOfIterations += m_NL;
+   return 0;
+ }
+
  void ZMPPreviewControlWithMultiBodyZMP::CreateExtraCOMBuffer(deque<COMState> &m_ExtraCOMBuffer,
 							      deque<ZMPPosition> &m_ExtraZMPBuffer,
 							      deque<ZMPPosition> &m_ExtraZMPRefBuffer)
@@ -406,6 +406,22 @@ namespace PatternGeneratorJRL
 			      MAL_VECTOR_TYPE(double) & CurrentVelocity,
 			      MAL_VECTOR_TYPE(double) & CurrentAcceleration,
 			      int localindex);
+
+      /*! Feed the 2 preview windows when only the first stage is used.
+	The preview control is done sample after sample, as in SetupIterativePhase,
+	but the postures of the m_NL samples are realized by a single call to
+	ComAndFootRealization::ComputePosturesForGivenCoMAndFeetPostures(),
+	since the multibody ZMP is not needed.
+	The parameters are the ones of SetupIterativePhase, the state vectors
+	are the ones of the last sample.
+      */
+      int SetupIterativePhasesOfFirstStage(deque<ZMPPosition> &ZMPRefPositions,
+					   deque<COMState> &COMStates,
+					   deque<FootAbsolutePosition> &LeftFootPositions,
+					   deque<FootAbsolutePosition> &RightFootPositions,
+					   MAL_VECTOR_TYPE(double) &CurrentConfiguration,
+					   MAL_VECTOR_TYPE(double) & CurrentVelocity,
+					   MAL_VECTOR_TYPE(double) & CurrentAcceleration);
       
       
       /*! Create an extra COM buffer with a first preview round to be 
@@ -482,6 +498,18 @@ namespace PatternGeneratorJRL
 				       int IterationNumber,
 				       int StageOfTheAlgorithm);
 
+      /*! Build the vectors given to the CoM And Foot Realization object
+	for a CoM state and the poses of the feet. The postures are
+	followed by their first and second derivatives. */
+      void PostureVectors(COMState &acomp,
+			  FootAbsolutePosition &aLeftFAP,
+			  FootAbsolutePosition &aRightFAP,
+			  MAL_VECTOR_TYPE(double) &aCOMState,
+			  MAL_VECTOR_TYPE(double) &aCOMSpeed,
+			  MAL_VECTOR_TYPE(double) &aCOMAcc,
+			  MAL_VECTOR_TYPE(double) &aLeftFootPosition,
+			  MAL_VECTOR_TYPE(double) &aRightFootPosition);
+
 
       
       /*! Set the link to the preview control. */
@@ -72,6 +72,19 @@ void SimplePluginManager::UnregisterPlugin(SimplePlugin* aSimplePlugin)
       else 
 	it_SP++;
     }
+
+  // The handles stay valid, only the plugin is removed.
+  for(unsigned int i=0;i<m_Methods.size();i++)
+    {
+      std::vector<SimplePlugin *> & lPlugins = m_Methods[i].Plugins;
+      for(unsigned int j=0;j<lPlugins.size();)
+	{
+	  if (lPlugins[j]==aSimplePlugin)
+	    lPlugins.erase(lPlugins.begin()+j);
+	  else
+	    j++;
+	}
+    }
   
 }
 
@@ -98,29 +111,59 @@ bool SimplePluginManager::RegisterMethod(string &MethodName, SimplePlugin *aSP)
 
   m_SimplePlugins.insert(pair < string, SimplePlugin * > (MethodName,aSP));
 
+  std::map<std::string, int, ltstr>::iterator it_MH =
+    m_MethodHandles.find(MethodName);
+  if (it_MH==m_MethodHandles.end())
+    {
+      Method_s aMethod;
+      aMethod.Name = MethodName;
+      m_Methods.push_back(aMethod);
+      it_MH = m_MethodHandles.insert(pair<string,int>(MethodName,
+						       m_Methods.size()-1)).first;
+    }
+  m_Methods[it_MH->second].Plugins.push_back(aSP);
+
   ODEBUG("Registered method " << MethodName << " for plugin " << aSP << endl);
   //  Print();
   return true;  
 }
 
+int SimplePluginManager::ResolveMethod(const string &MethodName) const
+{
+  std::map<std::string, int, ltstr>::const_iterator it_MH =
+    m_MethodHandles.find(MethodName);
+  if (it_MH==m_MethodHandles.end())
+    return -1;
+  return it_MH->second;
+}
+
 /*! \name Call the method from the Method name. */
 bool SimplePluginManager::CallMethod(string &MethodName, istringstream &istrm)
 {
-  pair <std::multimap<std::string, SimplePlugin * , ltstr>::iterator,
-    std::multimap<std::string, SimplePlugin * , ltstr>::iterator >
-    RangeOfPlugins  = m_SimplePlugins.equal_range(MethodName);
-  
-  
-  std::multimap<std::string, SimplePlugin * , ltstr>::iterator CurrentPlugin;
-
-  
-  unsigned int NbPlugins=0;
-  for (CurrentPlugin = RangeOfPlugins.first;
-       CurrentPlugin != RangeOfPlugins.second;++NbPlugins,
-	 ++CurrentPlugin) ;
-  
+  int aHandle = ResolveMethod(MethodName);
   ODEBUG4("Size of SimplePlugins: " << m_SimplePlugins.size() 
-	  << " Found for " << MethodName << " : " << NbPlugins, "PgDebug.txt");
+	  << " Found for " << MethodName << " : " << aHandle, "PgDebug.txt");
+  if (aHandle<0)
+    return false;
+  return CallMethod(aHandle,istrm);
+}
+
+bool SimplePluginManager::CallMethod(int aHandle, istringstream &istrm,
+				     SimplePlugin * anExcludedPlugin)
+{
+  if ((aHandle<0) || (aHandle>=(int)m_Methods.size()))
+    return false;
+
+  Method_s & aMethod = m_Methods[aHandle];
+  unsigned int NbPlugins = aMethod.Plugins.size();
+
+  // A single plugin reads directly the stream.
+  if ((NbPlugins==1) && (aMethod.Plugins[0]!=anExcludedPlugin))
+    {
+      aMethod.Plugins[0]->CallMethod(aMethod.Name,istrm);
+      return true;
+    }
+
   bool FoundAPlugin = false;
 
   stringbuf *pbuf;
@@ -137,18 +180,18 @@ bool SimplePluginManager::CallMethod(string &MethodName, istringstream &istrm)
   
   pbuf->pubsetbuf(aBuffer,size);
 
-  for (CurrentPlugin = RangeOfPlugins.first;
-       CurrentPlugin != RangeOfPlugins.second;
-       ++CurrentPlugin)
+  for(unsigned int i=0;i<NbPlugins;i++)
     {
+      SimplePlugin * aSP = aMethod.Plugins[i];
+      if (aSP==anExcludedPlugin)
+	continue;
       istringstream iss(aBuffer);
-      SimplePlugin * aSP = CurrentPlugin->second;
-      ODEBUG4("Found the method " << MethodName 
+      ODEBUG4("Found the method " << aMethod.Name 
 	      << " for plugin :" << aSP << endl
 	      << " Buffer: " << aBuffer,"PgDebug.txt"); 
       if (aSP!=0)
 	{
-	  aSP->CallMethod(MethodName,iss);
+	  aSP->CallMethod(aMethod.Name,iss);
 	  FoundAPlugin = true;
 	}
       else
@@ -32,7 +32,9 @@
 
 #include <string.h>
 
+#include <deque>
 #include <map>
+#include <vector>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -56,7 +58,7 @@ namespace PatternGeneratorJRL
 
     struct ltstr
     {
-      bool operator()(const std::string s1, const std::string s2) const
+      bool operator()(const std::string &s1, const std::string &s2) const
       {
 	return strcmp(s1.c_str(), s2.c_str()) < 0;
       }
@@ -68,6 +70,23 @@ namespace PatternGeneratorJRL
     /*! Set of plugins sorted by names */
     std::multimap<std::string, SimplePlugin *, ltstr>  m_SimplePlugins;
 
+    /*! \brief A method and the plugins which registered it,
+      indexed by the handle of the method. */
+    struct Method_s
+    {
+      std::string Name;
+      std::vector<SimplePlugin *> Plugins;
+    };
+
+    /*! Table of the methods, a handle is an index in this table
+      and stays valid until the manager is destroyed.
+      A plugin may be created while a method is called,
+      the deque keeps the called method in place. */
+    std::deque<Method_s> m_Methods;
+
+    /*! Handles of the methods sorted by names. */
+    std::map<std::string, int, ltstr> m_MethodHandles;
+
   public: 
     
     /*! \brief Pointer towards the PGI which is handling this object. */
@@ -89,6 +108,19 @@ namespace PatternGeneratorJRL
     /*! \name Call the method from the Method name. */
     bool CallMethod(std::string &MethodName, std::istringstream &istrm);
 
+    /*! \brief Returns the handle of a method, -1 if no plugin
+      registered it. The handle can be kept to call the method
+      without looking up its name. */
+    int ResolveMethod(const std::string &MethodName) const;
+
+    /*! \brief Call the method from its handle.
+      @param aHandle Handle given by ResolveMethod().
+      @param istrm Arguments of the method.
+      @param anExcludedPlugin Plugin which is not called.
+      \return false if no plugin has been called. */
+    bool CallMethod(int aHandle, std::istringstream &istrm,
+		    SimplePlugin * anExcludedPlugin=0);
+
     /*! \name Operator to display in cout. */
     void Print();
     
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#include <limits.h>
+
+#include <StageProfiler.hh>
+
+using namespace PatternGeneratorJRL;
+
+LatencyHistogram::LatencyHistogram()
+{
+  Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+  for(unsigned int i=0;i<NB_BUCKETS;i++)
+    AtomicStore(m_Counts[i],0);
+  AtomicStore(m_NbOfSamples,0);
+  AtomicStore(m_Maximum,0);
+}
+
+unsigned int LatencyHistogram::Bucket(long long aDuration)
+{
+  if (aDuration<(long long)NB_SUB_BUCKETS)
+    return aDuration<0 ? 0 : (unsigned int)aDuration;
+
+  // Rank of the highest bit, at least 4.
+  unsigned int lExponent = 4;
+  while ((lExponent<4+NB_EXPONENTS) && ((aDuration>>(lExponent+1))!=0))
+    lExponent++;
+  if (lExponent>=4+NB_EXPONENTS)
+    return NB_BUCKETS-1;
+
+  unsigned int lSubBucket =
+    (unsigned int)(aDuration>>(lExponent-4)) & (NB_SUB_BUCKETS-1);
+  return NB_SUB_BUCKETS*(lExponent-3) + lSubBucket;
+}
+
+long long LatencyHistogram::UpperBound(unsigned int aBucket)
+{
+  if (aBucket<NB_SUB_BUCKETS)
+    return aBucket;
+  unsigned int lExponent = aBucket/NB_SUB_BUCKETS + 3;
+  long long lSubBucket = aBucket%NB_SUB_BUCKETS;
+  return ((NB_SUB_BUCKETS+lSubBucket+1)<<(lExponent-4)) - 1;
+}
+
+void LatencyHistogram::Record(long long aDuration)
+{
+  if (aDuration<0)
+    aDuration = 0;
+  if (aDuration>LONG_MAX)
+    aDuration = LONG_MAX;
+
+  AtomicIncrement(m_Counts[Bucket(aDuration)]);
+  AtomicIncrement(m_NbOfSamples);
+
+  long lMaximum = AtomicLoad(m_Maximum);
+  while ((aDuration>lMaximum) &&
+	 (!AtomicCompareAndSwap(m_Maximum,lMaximum,(long)aDuration)))
+    lMaximum = AtomicLoad(m_Maximum);
+}
+
+unsigned long int LatencyHistogram::NbOfSamples() const
+{
+  return (unsigned long int)AtomicLoad(m_NbOfSamples);
+}
+
+long long LatencyHistogram::Maximum() const
+{
+  return AtomicLoad(m_Maximum);
+}
+
+long long LatencyHistogram::Percentile(double aRatio) const
+{
+  // The buckets are read once: a sample recorded meanwhile
+  // is either counted or not.
+  long lCounts[NB_BUCKETS];
+  double lTotal = 0.0;
+  for(unsigned int i=0;i<NB_BUCKETS;i++)
+    {
+      lCounts[i] = AtomicLoad(m_Counts[i]);
+      lTotal += lCounts[i];
+    }
+  if (lTotal==0.0)
+    return 0;
+
+  double lRank = aRatio*lTotal;
+  if (lRank<1.0)
+    lRank = 1.0;
+
+  double lCumulated = 0.0;
+  long long lMaximum = Maximum();
+  for(unsigned int i=0;i<NB_BUCKETS;i++)
+    {
+      lCumulated += lCounts[i];
+      if (lCumulated>=lRank)
+	{
+	  long long r = UpperBound(i);
+	  return r<lMaximum ? r : lMaximum;
+	}
+    }
+  return lMaximum;
+}
+
+const char * StageProfiler::StageName(unsigned int aStage)
+{
+  static const char * lNames[NB_STAGES] =
+    { "ControlLoop",
+      "SupportPreview",
+      "OrientationPreview",
+      "DynamicsUpdate",
+      "ConstraintBuild",
+      "QPSolve",
+      "Interpolation",
+      "InverseKinematics",
+      "MultiBodyZMP" };
+  if (aStage>=NB_STAGES)
+    return "";
+  return lNames[aStage];
+}
+
+void StageProfiler::Reset()
+{
+  for(unsigned int i=0;i<NB_STAGES;i++)
+    m_Histograms[i].Reset();
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file StageProfiler.hh
+  \brief Latency histograms of the stages of the control loop.
+
+  Each instance of the pattern generator owns a StageProfiler and
+  installs it in the current thread while the control loop runs.
+  The stages are timed with a StageTimer where they are computed,
+  which does nothing when no profiler is installed. When a
+  TraceRecorder is given to the profiler, the stages are also
+  recorded one by one.
+*/
+
+#ifndef _STAGE_PROFILER_H_
+#define _STAGE_PROFILER_H_
+
+#include "portability/atomic.hh"
+#include "portability/monotonictime.hh"
+#include "portability/threadlocal.hh"
+#include "TraceRecorder.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Histogram of durations with a fixed memory.
+
+    The buckets are log-linear: the durations below 16 ns have their
+    own bucket, above each power of two is split in 16 buckets,
+    so the relative error is below 6.25%. The durations above
+    2^40 ns (18 minutes) fall in the last bucket.
+
+    Recording does not lock, it can be done by one thread while
+    other threads read the histogram. */
+  class LatencyHistogram
+  {
+  public:
+    /*! Number of buckets for one power of two. */
+    static const unsigned int NB_SUB_BUCKETS = 16;
+
+    /*! Number of powers of two above NB_SUB_BUCKETS. */
+    static const unsigned int NB_EXPONENTS = 36;
+
+    static const unsigned int NB_BUCKETS =
+      NB_SUB_BUCKETS + NB_SUB_BUCKETS*NB_EXPONENTS;
+
+    LatencyHistogram();
+
+    /*! \brief Forget all the samples. */
+    void Reset();
+
+    /*! \brief Add a duration in nano-seconds. */
+    void Record(long long aDuration);
+
+    /*! \brief Number of durations recorded. */
+    unsigned long int NbOfSamples() const;
+
+    /*! \brief Duration in nano-seconds below which \a aRatio
+      of the samples are, given as the upper bound of a bucket.
+      0 if there is no sample. */
+    long long Percentile(double aRatio) const;
+
+    /*! \brief Largest duration in nano-seconds. */
+    long long Maximum() const;
+
+    /*! \brief Bucket of a duration. */
+    static unsigned int Bucket(long long aDuration);
+
+    /*! \brief Largest duration of a bucket. */
+    static long long UpperBound(unsigned int aBucket);
+
+  private:
+    AtomicCounter m_Counts[NB_BUCKETS];
+    AtomicCounter m_NbOfSamples;
+    AtomicCounter m_Maximum;
+  };
+
+  /*! \brief One latency histogram per stage of the control loop. */
+  class StageProfiler
+  {
+  public:
+    enum Stage_e
+      {
+	CONTROL_LOOP,
+	SUPPORT_PREVIEW,
+	ORIENTATION_PREVIEW,
+	DYNAMICS_UPDATE,
+	CONSTRAINT_BUILD,
+	QP_SOLVE,
+	INTERPOLATION,
+	INVERSE_KINEMATICS,
+	MULTIBODY_ZMP,
+	NB_STAGES
+      };
+
+    /*! \brief Name of a stage, as given by the public interface. */
+    static const char * StageName(unsigned int aStage);
+
+    StageProfiler():
+      m_TraceRecorder(0)
+    {}
+
+    /*! \brief Add a stage from \a aBegin to \a anEnd in nano-seconds. */
+    void Record(unsigned int aStage, long long aBegin, long long anEnd)
+    {
+      m_Histograms[aStage].Record(anEnd-aBegin);
+      if (m_TraceRecorder!=0)
+	m_TraceRecorder->Record(StageName(aStage),aBegin,anEnd);
+    }
+
+    /*! \brief Add an instantaneous event to the trace, if any.
+      \a aName must be a static string. */
+    void Mark(const char * aName)
+    {
+      if (m_TraceRecorder!=0)
+	m_TraceRecorder->Mark(aName,MonotonicTime());
+    }
+
+    /*! \brief Record the stages in \a aTraceRecorder as well,
+      none if it is 0. */
+    void SetTraceRecorder(TraceRecorder * aTraceRecorder)
+    { m_TraceRecorder = aTraceRecorder; }
+
+    const LatencyHistogram & Histogram(unsigned int aStage) const
+    { return m_Histograms[aStage]; }
+
+    /*! \brief Forget the samples of all the stages. */
+    void Reset();
+
+    /*! \brief Profiler of the current thread, 0 if there is none. */
+    static StageProfiler * & Current()
+    {
+      static JRL_WALKGEN_THREAD_LOCAL StageProfiler * r = 0;
+      return r;
+    }
+
+  private:
+    LatencyHistogram m_Histograms[NB_STAGES];
+    TraceRecorder * m_TraceRecorder;
+  };
+
+  /*! \brief Install a profiler in the current thread
+    for the life time of the object. */
+  class ScopedStageProfiler
+  {
+  public:
+    explicit ScopedStageProfiler(StageProfiler & aProfiler):
+      m_Previous(StageProfiler::Current())
+    { StageProfiler::Current() = &aProfiler; }
+    ~ScopedStageProfiler()
+    { StageProfiler::Current() = m_Previous; }
+  private:
+    StageProfiler * m_Previous;
+  };
+
+  /*! \brief Time consecutive stages with the profiler of the
+    current thread. Starting a stage stops the previous one,
+    the last one is stopped by the destructor. */
+  class StageTimer
+  {
+  public:
+    StageTimer():
+      m_Profiler(StageProfiler::Current()),
+      m_Stage(-1),
+      m_Start(0)
+    {}
+
+    explicit StageTimer(unsigned int aStage):
+      m_Profiler(StageProfiler::Current()),
+      m_Stage(-1),
+      m_Start(0)
+    { Start(aStage); }
+
+    ~StageTimer()
+    { Stop(); }
+
+    void Start(unsigned int aStage)
+    {
+      if (m_Profiler==0)
+	return;
+      long long lNow = MonotonicTime();
+      if (m_Stage>=0)
+	m_Profiler->Record(m_Stage,m_Start,lNow);
+      m_Stage = aStage;
+      m_Start = lNow;
+    }
+
+    void Stop()
+    {
+      if (m_Stage<0)
+	return;
+      m_Profiler->Record(m_Stage,m_Start,MonotonicTime());
+      m_Stage = -1;
+    }
+
+  private:
+    StageProfiler * m_Profiler;
+    int m_Stage;
+    long long m_Start;
+  };
+}
+#endif /* _STAGE_PROFILER_H_ */
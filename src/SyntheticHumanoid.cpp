@@ -0,0 +1,483 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file SyntheticHumanoid.cpp
+  \brief Build a humanoid robot through a robot dynamics object factory.
+
+  The masses of the segments are fractions of the total mass taken from
+  the anthropometric tables of D. A. Winter, "Biomechanics and Motor
+  Control of Human Movement". The inertia of a segment is the one of
+  a box of its length.
+*/
+
+#include <math.h>
+
+#include <vector>
+
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+
+namespace PatternGeneratorJRL
+{
+  namespace
+  {
+    /*! Axes of the joints, a rotation joint turns around
+      the x axis of its frame. */
+    enum Axis_e { ROLL=0, PITCH=1, YAW=2 };
+
+    const Axis_e LegAxes[6] = { YAW, ROLL, PITCH, PITCH, PITCH, ROLL };
+    const Axis_e ArmAxes[7] = { PITCH, ROLL, YAW, PITCH, YAW, PITCH, ROLL };
+    const Axis_e BodyAxes[3] = { YAW, PITCH, ROLL };
+
+    /*! Fractions of the total mass. */
+    const double PelvisMass = 0.142;
+    const double TrunkMass = 0.355;
+    const double HeadMass = 0.081;
+    const double UpperArmMass = 0.028;
+    const double ForearmMass = 0.016;
+    const double HandMass = 0.006;
+    const double ThighMass = 0.1;
+    const double ShankMass = 0.0465;
+    const double FootMass = 0.0145;
+
+    /*! Width of the boxes giving the inertia of the segments. */
+    const double SegmentWidth = 0.1;
+
+    /*! Axis of the arm joint \a i: shoulder, elbow and wrist,
+      the additional joints are put on the wrist. */
+    Axis_e ArmAxis(unsigned int i)
+    {
+      return (i<7) ? ArmAxes[i] : ArmAxes[4+(i-7)%3];
+    }
+
+    /*! Add the joints of the robot to the factory's objects. */
+    class SyntheticHumanoidBuilder
+    {
+    public:
+      SyntheticHumanoidBuilder(CjrlRobotDynamicsObjectFactory & aFactory):
+	m_Factory(aFactory)
+      {}
+
+      /*! \brief Create a rotation joint at \a aPosition,
+	carrying a segment of mass \a aMass and of length \a aLength
+	whose center of mass is at \a aPosition + \a aCoM.
+	\return 0 if the factory failed. */
+      CjrlJoint * AddJoint(CjrlJoint * aParent, Axis_e anAxis,
+			   const double aPosition[3],
+			   double aMass, const double aCoM[3],
+			   double aLength,
+			   double aLowerBound=-M_PI, double anUpperBound=M_PI);
+
+      /*! \brief Create the free flyer at \a aPosition. */
+      CjrlJoint * AddFreeFlyer(const double aPosition[3],
+			       double aMass, const double aCoM[3],
+			       double aLength);
+
+      /*! Actuated joints in the order of their creation. */
+      vector<CjrlJoint *> m_ActuatedJoints;
+
+    private:
+      /*! Link a body to \a aJoint whose frame maps x on \a anAxis. */
+      bool LinkBody(CjrlJoint * aJoint, Axis_e anAxis,
+		    double aMass, const double aCoM[3], double aLength);
+
+      CjrlRobotDynamicsObjectFactory & m_Factory;
+    };
+
+    CjrlJoint * SyntheticHumanoidBuilder::AddFreeFlyer(const double aPosition[3],
+							double aMass,
+							const double aCoM[3],
+							double aLength)
+    {
+      MAL_S4x4_MATRIX(lFrame,double);
+      MAL_S4x4_MATRIX_SET_IDENTITY(lFrame);
+      for(unsigned int i=0;i<3;i++)
+	MAL_S4x4_MATRIX_ACCESS_I_J(lFrame,i,3) = aPosition[i];
+
+      CjrlJoint * aJoint = m_Factory.createJointFreeflyer(lFrame);
+      if ((aJoint==0) ||
+	  (!LinkBody(aJoint,ROLL,aMass,aCoM,aLength)))
+	return 0;
+      return aJoint;
+    }
+
+    CjrlJoint * SyntheticHumanoidBuilder::AddJoint(CjrlJoint * aParent,
+						    Axis_e anAxis,
+						    const double aPosition[3],
+						    double aMass,
+						    const double aCoM[3],
+						    double aLength,
+						    double aLowerBound,
+						    double anUpperBound)
+    {
+      // The columns of the frame are the axes anAxis,
+      // anAxis+1 and anAxis+2 of the world.
+      MAL_S4x4_MATRIX(lFrame,double);
+      MAL_S4x4_MATRIX_SET_IDENTITY(lFrame);
+      for(unsigned int i=0;i<3;i++)
+	{
+	  for(unsigned int j=0;j<3;j++)
+	    MAL_S4x4_MATRIX_ACCESS_I_J(lFrame,i,j) =
+	      (i==(anAxis+j)%3) ? 1.0 : 0.0;
+	  MAL_S4x4_MATRIX_ACCESS_I_J(lFrame,i,3) = aPosition[i];
+	}
+
+      CjrlJoint * aJoint = m_Factory.createJointRotation(lFrame);
+      if ((aJoint==0) ||
+	  (!LinkBody(aJoint,anAxis,aMass,aCoM,aLength)))
+	return 0;
+
+      aJoint->lowerBound(0,aLowerBound);
+      aJoint->upperBound(0,anUpperBound);
+      aJoint->lowerVelocityBound(0,-3.0);
+      aJoint->upperVelocityBound(0,3.0);
+
+      aParent->addChildJoint(*aJoint);
+      m_ActuatedJoints.push_back(aJoint);
+      return aJoint;
+    }
+
+    bool SyntheticHumanoidBuilder::LinkBody(CjrlJoint * aJoint, Axis_e anAxis,
+					     double aMass, const double aCoM[3],
+					     double aLength)
+    {
+      CjrlBody * aBody = m_Factory.createBody();
+      if (aBody==0)
+	return false;
+
+      // Box along the z axis of the world.
+      double lInertia[3];
+      lInertia[0] = lInertia[1] =
+	aMass*(aLength*aLength + SegmentWidth*SegmentWidth)/12.0;
+      lInertia[2] = aMass*SegmentWidth*SegmentWidth/6.0;
+
+      // The axis i of the body frame is the axis anAxis+i of the world.
+      MAL_S3_VECTOR(lCoM,double);
+      MAL_S3x3_MATRIX(lInertiaMatrix,double);
+      for(unsigned int i=0;i<3;i++)
+	{
+	  MAL_S3_VECTOR_ACCESS(lCoM,i) = aCoM[(anAxis+i)%3];
+	  for(unsigned int j=0;j<3;j++)
+	    MAL_S3x3_MATRIX_ACCESS_I_J(lInertiaMatrix,i,j) =
+	      (i==j) ? lInertia[(anAxis+i)%3] : 0.0;
+	}
+
+      aBody->mass(aMass);
+      aBody->localCenterOfMass(lCoM);
+      aBody->inertiaMatrix(lInertiaMatrix);
+      aJoint->setLinkedBody(*aBody);
+      return true;
+    }
+
+    /*! Arm starting at \a aShoulder, returns the wrist. */
+    CjrlJoint * AddArm(SyntheticHumanoidBuilder & aBuilder,
+		       CjrlJoint * aChest, const double aShoulder[3],
+		       const SyntheticHumanoidParameters & aParameters)
+    {
+      const double M = aParameters.Mass;
+      const double lNone[3] = { 0.0, 0.0, 0.0 };
+      const double lUpperArmCoM[3] = { 0.0, 0.0,
+				       -0.5*aParameters.UpperArmLength };
+      const double lForearmCoM[3] = { 0.0, 0.0,
+				      -0.5*aParameters.ForearmLength };
+      const double lHandCoM[3] = { 0.0, 0.0, -0.05 };
+      double lElbow[3] = { aShoulder[0], aShoulder[1],
+			   aShoulder[2] - aParameters.UpperArmLength };
+      double lWrist[3] = { lElbow[0], lElbow[1],
+			   lElbow[2] - aParameters.ForearmLength };
+
+      unsigned int lNbOfJoints = aParameters.NbOfArmJoints;
+      if (lNbOfJoints<5)
+	lNbOfJoints = 5;
+
+      CjrlJoint * aJoint = aChest;
+      for(unsigned int i=0;(i<lNbOfJoints) && (aJoint!=0);i++)
+	{
+	  if (i<2)
+	    aJoint = aBuilder.AddJoint(aJoint,ArmAxis(i),aShoulder,
+				       0.0,lNone,0.0);
+	  else if (i==2)
+	    aJoint = aBuilder.AddJoint(aJoint,ArmAxis(i),aShoulder,
+				       UpperArmMass*M,lUpperArmCoM,
+				       aParameters.UpperArmLength);
+	  else if (i==3)
+	    aJoint = aBuilder.AddJoint(aJoint,ArmAxis(i),lElbow,
+				       ForearmMass*M,lForearmCoM,
+				       aParameters.ForearmLength);
+	  else if (i+1<lNbOfJoints)
+	    aJoint = aBuilder.AddJoint(aJoint,ArmAxis(i),lWrist,
+				       0.0,lNone,0.0);
+	  else
+	    aJoint = aBuilder.AddJoint(aJoint,ArmAxis(i),lWrist,
+				       HandMass*M,lHandCoM,0.1);
+	}
+      return aJoint;
+    }
+
+    /*! Leg starting at \a aHip, returns the ankle. */
+    CjrlJoint * AddLeg(SyntheticHumanoidBuilder & aBuilder,
+		       CjrlJoint * aWaist, const double aHip[3],
+		       bool aLeftLeg,
+		       const SyntheticHumanoidParameters & aParameters)
+    {
+      const double M = aParameters.Mass;
+      const double lNone[3] = { 0.0, 0.0, 0.0 };
+      const double lThighCoM[3] = { 0.0, 0.0, -0.5*aParameters.ThighLength };
+      const double lShankCoM[3] = { 0.0, 0.0, -0.5*aParameters.TibiaLength };
+      const double lFootCoM[3] = { 0.0, 0.0, -0.5*aParameters.AnkleHeight };
+      double lKnee[3] = { aHip[0], aHip[1], aHip[2] - aParameters.ThighLength };
+      double lAnkle[3] = { lKnee[0], lKnee[1],
+			   lKnee[2] - aParameters.TibiaLength };
+
+      // Bounds of the hip yaw used to plan the orientation of the feet.
+      double lHipYawLower = aLeftLeg ? -M_PI/6.0 : -M_PI/4.0;
+      double lHipYawUpper = aLeftLeg ? M_PI/4.0 : M_PI/6.0;
+
+      CjrlJoint * aJoint =
+	aBuilder.AddJoint(aWaist,LegAxes[0],aHip,0.0,lNone,0.0,
+			  lHipYawLower,lHipYawUpper);
+      if (aJoint!=0)
+	aJoint = aBuilder.AddJoint(aJoint,LegAxes[1],aHip,0.0,lNone,0.0);
+      if (aJoint!=0)
+	aJoint = aBuilder.AddJoint(aJoint,LegAxes[2],aHip,
+				   ThighMass*M,lThighCoM,
+				   aParameters.ThighLength);
+      if (aJoint!=0)
+	aJoint = aBuilder.AddJoint(aJoint,LegAxes[3],lKnee,
+				   ShankMass*M,lShankCoM,
+				   aParameters.TibiaLength);
+      if (aJoint!=0)
+	aJoint = aBuilder.AddJoint(aJoint,LegAxes[4],lAnkle,0.0,lNone,0.0);
+      if (aJoint!=0)
+	aJoint = aBuilder.AddJoint(aJoint,LegAxes[5],lAnkle,
+				   FootMass*M,lFootCoM,
+				   aParameters.AnkleHeight);
+      return aJoint;
+    }
+
+    /*! Foot of \a anAnkle, whose frame is the one of the world. */
+    CjrlFoot * CreateFoot(CjrlRobotDynamicsObjectFactory & aFactory,
+			  CjrlJoint * anAnkle,
+			  const SyntheticHumanoidParameters & aParameters)
+    {
+      CjrlFoot * aFoot = aFactory.createFoot(anAnkle);
+      if (aFoot==0)
+	return 0;
+
+      MAL_S3_VECTOR(lAnklePosition,double);
+      MAL_S3_VECTOR_ACCESS(lAnklePosition,0) = 0.0;
+      MAL_S3_VECTOR_ACCESS(lAnklePosition,1) = 0.0;
+      MAL_S3_VECTOR_ACCESS(lAnklePosition,2) = aParameters.AnkleHeight;
+      aFoot->setSoleSize(aParameters.FootLength,aParameters.FootWidth);
+      aFoot->setAnklePositionInLocalFrame(lAnklePosition);
+      return aFoot;
+    }
+  }
+
+  SyntheticHumanoidParameters_s::SyntheticHumanoidParameters_s():
+    Mass(58.0),
+    HipWidth(0.12),
+    ThighLength(0.3),
+    TibiaLength(0.3),
+    AnkleHeight(0.105),
+    FootLength(0.24),
+    FootWidth(0.14),
+    ChestHeight(0.35),
+    ShoulderHeight(0.18),
+    ShoulderWidth(0.5),
+    UpperArmLength(0.25),
+    ForearmLength(0.25),
+    NeckHeight(0.03),
+    NbOfChestJoints(2),
+    NbOfNeckJoints(2),
+    NbOfArmJoints(7)
+  {
+  }
+
+  unsigned int SyntheticHumanoidParameters_s::NbOfActuatedJoints() const
+  {
+    unsigned int lNbOfChestJoints = (NbOfChestJoints<1) ? 1 : NbOfChestJoints;
+    unsigned int lNbOfArmJoints = (NbOfArmJoints<5) ? 5 : NbOfArmJoints;
+    return 12 + lNbOfChestJoints + NbOfNeckJoints + 2*lNbOfArmJoints;
+  }
+
+  CjrlHumanoidDynamicRobot *
+  createSyntheticHumanoid(CjrlRobotDynamicsObjectFactory & aFactory,
+			  const SyntheticHumanoidParameters & aParameters)
+  {
+    const SyntheticHumanoidParameters & P = aParameters;
+    const double M = P.Mass;
+    const double lNone[3] = { 0.0, 0.0, 0.0 };
+
+    CjrlHumanoidDynamicRobot * aHDR = aFactory.createHumanoidDynamicRobot();
+    if (aHDR==0)
+      return 0;
+
+    // The soles are on the ground when the legs are straight.
+    const double lWaistHeight = P.ThighLength + P.TibiaLength + P.AnkleHeight;
+    const double lChestHeight = lWaistHeight + P.ChestHeight;
+    const double lShoulderHeight = lChestHeight + P.ShoulderHeight;
+
+    SyntheticHumanoidBuilder aBuilder(aFactory);
+
+    double lWaist[3] = { 0.0, 0.0, lWaistHeight };
+    CjrlJoint * aWaist = aBuilder.AddFreeFlyer(lWaist,PelvisMass*M,lNone,
+					       P.ChestHeight);
+    if (aWaist==0)
+      {
+	delete aHDR;
+	return 0;
+      }
+    aHDR->rootJoint(*aWaist);
+
+    // Legs, the right one first as on HRP-2.
+    double lRightHip[3] = { 0.0, -0.5*P.HipWidth, lWaistHeight };
+    double lLeftHip[3] = { 0.0, 0.5*P.HipWidth, lWaistHeight };
+    CjrlJoint * aRightAnkle = AddLeg(aBuilder,aWaist,lRightHip,false,P);
+    CjrlJoint * aLeftAnkle = AddLeg(aBuilder,aWaist,lLeftHip,true,P);
+
+    // Chest, the trunk is carried by its last joint.
+    // Without neck the head is part of the trunk.
+    unsigned int lNbOfChestJoints = (P.NbOfChestJoints<1) ? 1 : P.NbOfChestJoints;
+    double lChest[3] = { 0.0, 0.0, lChestHeight };
+    double lTrunkMass = TrunkMass*M, lTrunkCoM[3] = { 0.0, 0.0,
+						       0.5*P.ShoulderHeight };
+    if (P.NbOfNeckJoints==0)
+      {
+	double lHeadHeight = P.ShoulderHeight + P.NeckHeight + 0.1;
+	lTrunkCoM[2] = (TrunkMass*lTrunkCoM[2] + HeadMass*lHeadHeight)/
+	  (TrunkMass + HeadMass);
+	lTrunkMass += HeadMass*M;
+      }
+    CjrlJoint * aChest = aWaist;
+    for(unsigned int i=0;(i<lNbOfChestJoints) && (aChest!=0);i++)
+      {
+	if (i+1<lNbOfChestJoints)
+	  aChest = aBuilder.AddJoint(aChest,BodyAxes[i%3],lChest,
+				     0.0,lNone,0.0);
+	else
+	  aChest = aBuilder.AddJoint(aChest,BodyAxes[i%3],lChest,
+				     lTrunkMass,lTrunkCoM,P.ShoulderHeight);
+      }
+
+    // Neck, the head is carried by its last joint.
+    double lNeck[3] = { 0.0, 0.0, lShoulderHeight + P.NeckHeight };
+    const double lHeadCoM[3] = { 0.0, 0.0, 0.1 };
+    CjrlJoint * aHead = aChest;
+    for(unsigned int i=0;(i<P.NbOfNeckJoints) && (aHead!=0);i++)
+      {
+	if (i+1<P.NbOfNeckJoints)
+	  aHead = aBuilder.AddJoint(aHead,BodyAxes[i%3],lNeck,0.0,lNone,0.0);
+	else
+	  aHead = aBuilder.AddJoint(aHead,BodyAxes[i%3],lNeck,
+				    HeadMass*M,lHeadCoM,0.2);
+      }
+
+    // Arms.
+    CjrlJoint * aRightWrist = 0, * aLeftWrist = 0;
+    if (aChest!=0)
+      {
+	double lRightShoulder[3] = { 0.0, -0.5*P.ShoulderWidth, lShoulderHeight };
+	double lLeftShoulder[3] = { 0.0, 0.5*P.ShoulderWidth, lShoulderHeight };
+	aRightWrist = AddArm(aBuilder,aChest,lRightShoulder,P);
+	aLeftWrist = AddArm(aBuilder,aChest,lLeftShoulder,P);
+      }
+
+    if ((aRightAnkle==0) || (aLeftAnkle==0) || (aHead==0) ||
+	(aRightWrist==0) || (aLeftWrist==0))
+      {
+	ODEBUG3("Unable to create the joints of the synthetic humanoid");
+	delete aHDR;
+	return 0;
+      }
+
+    aHDR->setActuatedJoints(aBuilder.m_ActuatedJoints);
+    aHDR->waist(aWaist);
+    aHDR->chest(aChest);
+    aHDR->rightAnkle(aRightAnkle);
+    aHDR->leftAnkle(aLeftAnkle);
+    aHDR->rightWrist(aRightWrist);
+    aHDR->leftWrist(aLeftWrist);
+    if (P.NbOfNeckJoints>0)
+      aHDR->gazeJoint(aHead);
+
+    CjrlFoot * aRightFoot = CreateFoot(aFactory,aRightAnkle,P);
+    CjrlFoot * aLeftFoot = CreateFoot(aFactory,aLeftAnkle,P);
+    CjrlHand * aRightHand = aFactory.createHand(aRightWrist);
+    CjrlHand * aLeftHand = aFactory.createHand(aLeftWrist);
+    if ((aRightFoot==0) || (aLeftFoot==0) ||
+	(aRightHand==0) || (aLeftHand==0))
+      {
+	ODEBUG3("Unable to create the feet and hands of the synthetic humanoid");
+	delete aHDR;
+	return 0;
+      }
+    aHDR->rightFoot(aRightFoot);
+    aHDR->leftFoot(aLeftFoot);
+    aHDR->rightHand(aRightHand);
+    aHDR->leftHand(aLeftHand);
+
+    if (!aHDR->initialize())
+      {
+	ODEBUG3("Unable to initialize the synthetic humanoid");
+	delete aHDR;
+	return 0;
+      }
+    return aHDR;
+  }
+
+  void syntheticHumanoidHalfSitting(const SyntheticHumanoidParameters & aParameters,
+				    MAL_VECTOR_TYPE(double) & aHalfSitting)
+  {
+    const double d2r = M_PI/180.0;
+    const double lLeg[6] = { 0.0, 0.0, -26.0, 50.0, -24.0, 0.0 };
+    const double lArm[7] = { 15.0, 10.0, 0.0, -30.0, 0.0, 0.0, 10.0 };
+
+    unsigned int lNbOfChestJoints =
+      (aParameters.NbOfChestJoints<1) ? 1 : aParameters.NbOfChestJoints;
+    unsigned int lNbOfArmJoints =
+      (aParameters.NbOfArmJoints<5) ? 5 : aParameters.NbOfArmJoints;
+
+    MAL_VECTOR_RESIZE(aHalfSitting,aParameters.NbOfActuatedJoints());
+    MAL_VECTOR_FILL(aHalfSitting,0.0);
+
+    unsigned int k=0;
+    for(unsigned int lSide=0;lSide<2;lSide++)
+      for(unsigned int i=0;i<6;i++)
+	aHalfSitting(k++) = lLeg[i]*d2r;
+    k += lNbOfChestJoints + aParameters.NbOfNeckJoints;
+
+    // The roll of the shoulders moves the arms away from the body.
+    for(unsigned int lSide=0;lSide<2;lSide++)
+      for(unsigned int i=0;i<lNbOfArmJoints;i++)
+	{
+	  double lAngle = (i<7) ? lArm[i]*d2r : 0.0;
+	  if ((i==1) && (lSide==0))
+	    lAngle = -lAngle;
+	  aHalfSitting(k++) = lAngle;
+	}
+  }
+}
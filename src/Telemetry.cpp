@@ -0,0 +1,301 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! Binary telemetry file. It starts with TELEMETRY_MAGIC, followed by:
+  - 'C', the identifier (unsigned short), the length of the name
+  (unsigned short) and the name, for each channel before its first record,
+  - 'R', the identifier of the channel (unsigned short), the number of
+  values (unsigned short) and the values (double), for each record.
+  The numbers are in the byte order of the robot. */
+
+#include <map>
+
+#include <Debug.hh>
+#include <Telemetry.hh>
+
+using namespace PatternGeneratorJRL;
+
+static const char TELEMETRY_MAGIC[8] = {'J','R','L','T','L','M','0','1'};
+
+TelemetryLogger::TelemetryLogger(unsigned int aCapacity):
+  m_EnqueuePosition(0),
+  m_DequeuePosition(0),
+  m_NbOfDroppedRecords(0),
+  m_Running(0),
+  m_Opened(0),
+  m_NbOfWrittenChannels(0)
+{
+  unsigned long lSize = 2;
+  while (lSize<aCapacity)
+    lSize*=2;
+  m_Mask = lSize-1;
+}
+
+TelemetryLogger::~TelemetryLogger()
+{
+  Close();
+}
+
+TelemetryLogger & TelemetryLogger::Instance()
+{
+  static TelemetryLogger r;
+  return r;
+}
+
+TelemetryLogger & TelemetryLogger::Current()
+{
+  TelemetryLogger * r = Installed();
+  if (r==0)
+    r = &Instance();
+  if ((AtomicLoad(r->m_Opened)==0) &&
+      (AtomicCompareAndSwap(r->m_Opened,0,1)))
+    r->Open(OutputFileName("telemetry.bin"));
+  return *r;
+}
+
+std::vector<std::string> & TelemetryLogger::Channels()
+{
+  static std::vector<std::string> r;
+  return r;
+}
+
+Mutex & TelemetryLogger::ChannelsMutex()
+{
+  static Mutex r;
+  return r;
+}
+
+bool TelemetryLogger::Open(const std::string & aFileName)
+{
+  ScopedLock aLock(m_FileMutex);
+  if (m_File.is_open())
+    return false;
+  AtomicStore(m_Opened,1);
+
+  m_File.open(aFileName.c_str(),std::ofstream::out | std::ofstream::binary);
+  if (!m_File.is_open())
+    {
+      std::cerr << "Unable to open " << aFileName << std::endl;
+      return false;
+    }
+  m_File.write(TELEMETRY_MAGIC,sizeof(TELEMETRY_MAGIC));
+  m_NbOfWrittenChannels = 0;
+
+  // The queue is allocated only by the loggers which write a file.
+  m_Cells.resize(m_Mask+1);
+  for(unsigned long i=0;i<=m_Mask;i++)
+    m_Cells[i].Sequence = i;
+  AtomicStore(m_EnqueuePosition,0);
+  m_DequeuePosition = 0;
+
+  AtomicStore(m_Running,1);
+  if (m_Writer.Start(Run,this)<0)
+    {
+      AtomicStore(m_Running,0);
+      m_File.close();
+      return false;
+    }
+  return true;
+}
+
+void TelemetryLogger::Close()
+{
+  if (!m_Writer.Joinable())
+    return;
+  AtomicStore(m_Running,0);
+  m_Writer.Join();
+
+  ScopedLock aLock(m_FileMutex);
+  m_File.close();
+}
+
+int TelemetryLogger::Channel(const std::string & aName)
+{
+  ScopedLock aLock(ChannelsMutex());
+  std::vector<std::string> & lChannels = Channels();
+  for(unsigned int i=0;i<lChannels.size();i++)
+    if (lChannels[i]==aName)
+      return i;
+  lChannels.push_back(aName);
+  return lChannels.size()-1;
+}
+
+bool TelemetryLogger::Log(int aChannel, const TelemetryRecord & aRecord)
+{
+  if ((aChannel<0) || (AtomicLoad(m_Running)==0))
+    return false;
+
+  unsigned long lPosition = AtomicLoad(m_EnqueuePosition);
+  Cell_s * aCell;
+  for(;;)
+    {
+      aCell = &m_Cells[lPosition & m_Mask];
+      long lDiff = (long)(AtomicLoad(aCell->Sequence) - lPosition);
+      if (lDiff==0)
+	{
+	  if (AtomicCompareAndSwap(m_EnqueuePosition,
+				   lPosition,lPosition+1))
+	    break;
+	  lPosition = AtomicLoad(m_EnqueuePosition);
+	}
+      else if (lDiff<0)
+	{
+	  // The writer is late, the record is lost.
+	  AtomicIncrement(m_NbOfDroppedRecords);
+	  return false;
+	}
+      else
+	lPosition = AtomicLoad(m_EnqueuePosition);
+    }
+
+  aCell->Channel = aChannel;
+  aCell->Record = aRecord;
+  AtomicStore(aCell->Sequence,lPosition+1);
+  return true;
+}
+
+unsigned long TelemetryLogger::NbOfDroppedRecords() const
+{
+  return (unsigned long)AtomicLoad(m_NbOfDroppedRecords);
+}
+
+void TelemetryLogger::WriteChannels()
+{
+  ScopedLock aLock(ChannelsMutex());
+  const std::vector<std::string> & lChannels = Channels();
+  for(;m_NbOfWrittenChannels<lChannels.size();m_NbOfWrittenChannels++)
+    {
+      const std::string & aName = lChannels[m_NbOfWrittenChannels];
+      unsigned short lHeader[2];
+      lHeader[0] = (unsigned short)m_NbOfWrittenChannels;
+      lHeader[1] = (unsigned short)aName.size();
+      m_File.put('C');
+      m_File.write((const char *)lHeader,sizeof(lHeader));
+      m_File.write(aName.c_str(),aName.size());
+    }
+}
+
+bool TelemetryLogger::WriteRecords()
+{
+  bool r = false;
+  for(;;)
+    {
+      Cell_s & aCell = m_Cells[m_DequeuePosition & m_Mask];
+      long lDiff = (long)(AtomicLoad(aCell.Sequence) - (m_DequeuePosition+1));
+      if (lDiff<0)
+	break;
+
+      if ((unsigned int)aCell.Channel>=m_NbOfWrittenChannels)
+	WriteChannels();
+
+      unsigned short lHeader[2];
+      lHeader[0] = (unsigned short)aCell.Channel;
+      lHeader[1] = (unsigned short)aCell.Record.NbOfValues();
+      m_File.put('R');
+      m_File.write((const char *)lHeader,sizeof(lHeader));
+      m_File.write((const char *)aCell.Record.Values(),
+		   lHeader[1]*sizeof(double));
+
+      AtomicStore(aCell.Sequence,m_DequeuePosition+m_Mask+1);
+      m_DequeuePosition++;
+      r = true;
+    }
+  if (r)
+    m_File.flush();
+  return r;
+}
+
+void TelemetryLogger::Run(void * aLogger)
+{
+  TelemetryLogger * aTL = (TelemetryLogger *)aLogger;
+  while (AtomicLoad(aTL->m_Running)!=0)
+    {
+      if (!aTL->WriteRecords())
+	Thread::Pause(10);
+    }
+  aTL->WriteRecords();
+}
+
+bool TelemetryLogger::ConvertToText(const std::string & aFileName,
+				    const std::string & aDirectory)
+{
+  std::ifstream aif(aFileName.c_str(),std::ifstream::in | std::ifstream::binary);
+  char lMagic[sizeof(TELEMETRY_MAGIC)];
+  aif.read(lMagic,sizeof(lMagic));
+  if ((!aif.good()) ||
+      (std::string(lMagic,sizeof(lMagic))!=
+       std::string(TELEMETRY_MAGIC,sizeof(TELEMETRY_MAGIC))))
+    return false;
+
+  std::map<unsigned short, std::ofstream *> lFiles;
+  std::vector<double> lValues;
+  char lType;
+  unsigned short lHeader[2];
+  bool r = true;
+  while (aif.get(lType))
+    {
+      aif.read((char *)lHeader,sizeof(lHeader));
+      if (lType=='C')
+	{
+	  std::string lName(lHeader[1],' ');
+	  aif.read(&lName[0],lHeader[1]);
+	  std::string lPath = lName;
+	  if (aDirectory.size()>0)
+	    lPath = aDirectory + "/" + lName;
+	  if (lFiles[lHeader[0]]==0)
+	    lFiles[lHeader[0]] = new std::ofstream(lPath.c_str(),
+						    std::ofstream::out);
+	}
+      else if (lType=='R')
+	{
+	  lValues.resize(lHeader[1]);
+	  if (lHeader[1]>0)
+	    aif.read((char *)&lValues[0],lHeader[1]*sizeof(double));
+	  if (!aif.good())
+	    break;
+	  std::ofstream * aof = lFiles[lHeader[0]];
+	  if (aof==0)
+	    {
+	      r = false;
+	      continue;
+	    }
+	  for(unsigned int i=0;i<lValues.size();i++)
+	    {
+	      if (i>0)
+		*aof << " ";
+	      *aof << lValues[i];
+	    }
+	  *aof << "\n";
+	}
+      else
+	{
+	  r = false;
+	  break;
+	}
+    }
+
+  for(std::map<unsigned short, std::ofstream *>::iterator it=lFiles.begin();
+      it!=lFiles.end();it++)
+    delete it->second;
+  return r;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file Telemetry.hh
+  \brief Numerical debugging data written by a background thread.
+
+  The control loop logs records of numbers in named channels with
+  ODEBUG4TELEMETRY. The records are queued without lock nor
+  allocation, and a background thread writes them in a binary file.
+  Each pattern generator has its own logger, installed in the thread
+  which calls it as the output directory, so two instances running
+  at the same time write in their own file.
+  walkgen-telemetry2dat converts this file into one text file
+  per channel, with the layout of ODEBUG4SIMPLE: the values of
+  a record separated by spaces on one line.
+*/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "portability/atomic.hh"
+#include "portability/thread.hh"
+#include "portability/threadlocal.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Values logged at once in a channel. */
+  class TelemetryRecord
+  {
+  public:
+    /*! \brief The values above are ignored. */
+    static const unsigned int MAX_VALUES = 64;
+
+    TelemetryRecord():
+      m_NbOfValues(0)
+    {}
+
+    TelemetryRecord & operator<<(double aValue)
+    {
+      if (m_NbOfValues<MAX_VALUES)
+	m_Values[m_NbOfValues++] = aValue;
+      return *this;
+    }
+
+    unsigned int NbOfValues() const
+    { return m_NbOfValues; }
+
+    const double * Values() const
+    { return m_Values; }
+
+  private:
+    unsigned int m_NbOfValues;
+    double m_Values[MAX_VALUES];
+  };
+
+  /*! \brief Queue of records written in a file by a background thread.
+
+    Any thread can log, the queue is the bounded queue with many
+    producers of CommandInbox. When it is full the records are dropped
+    and counted, so that the control loop never waits for the disk.
+    The identifiers of the channels are shared by all the loggers of
+    the process, the queue is allocated when the file is opened.
+  */
+  class TelemetryLogger
+  {
+  public:
+    /*! \brief Constructor.
+      @param aCapacity Maximal number of queued records,
+      rounded to the next power of two. */
+    explicit TelemetryLogger(unsigned int aCapacity=4096);
+
+    /*! \brief Write the queued records and close the file. */
+    ~TelemetryLogger();
+
+    /*! \brief Logger of the threads in which none is installed. */
+    static TelemetryLogger & Instance();
+
+    /*! \brief Logger installed in the current thread, 0 if none. */
+    static TelemetryLogger * & Installed()
+    {
+      static JRL_WALKGEN_THREAD_LOCAL TelemetryLogger * r = 0;
+      return r;
+    }
+
+    /*! \brief Logger of ODEBUG4TELEMETRY in the current thread,
+      Instance() if none is installed. The first call opens
+      telemetry.bin in the output directory of the current thread. */
+    static TelemetryLogger & Current();
+
+    /*! \brief Start writing the records in \a aFileName.
+      \return false if the file could not be opened,
+      or if a file is already open. */
+    bool Open(const std::string & aFileName);
+
+    /*! \brief Write the queued records and close the file. */
+    void Close();
+
+    /*! \brief Identifier of the channel \a aName, created if needed.
+      The identifier is the same for all the loggers. This locks
+      a mutex, the identifier should be kept by the caller. */
+    static int Channel(const std::string & aName);
+
+    /*! \brief Queue \a aRecord in \a aChannel.
+      \return false if the queue is full or if no file is open. */
+    bool Log(int aChannel, const TelemetryRecord & aRecord);
+
+    /*! \brief Number of records which have been dropped. */
+    unsigned long NbOfDroppedRecords() const;
+
+    /*! \brief Write one text file per channel of the binary file
+      \a aFileName in \a aDirectory.
+      \return false if \a aFileName is not a telemetry file. */
+    static bool ConvertToText(const std::string & aFileName,
+			      const std::string & aDirectory);
+
+  private:
+    struct Cell_s
+    {
+      AtomicCounter Sequence;
+      int Channel;
+      TelemetryRecord Record;
+    };
+
+    /*! \brief Write the queued records.
+      \return false if there was none. */
+    bool WriteRecords();
+
+    /*! \brief Write the channels created since the last call. */
+    void WriteChannels();
+
+    /*! \brief Names of the channels of the process. */
+    static std::vector<std::string> & Channels();
+    static Mutex & ChannelsMutex();
+
+    /*! \brief Loop of the background thread. */
+    static void Run(void * aLogger);
+
+    std::vector<Cell_s> m_Cells;
+    unsigned long m_Mask;
+    AtomicCounter m_EnqueuePosition;
+    unsigned long m_DequeuePosition;
+    AtomicCounter m_NbOfDroppedRecords;
+
+    /*! Non zero while the background thread runs. */
+    AtomicCounter m_Running;
+    /*! Non zero once a file has been opened, or tried to. */
+    AtomicCounter m_Opened;
+
+    Mutex m_FileMutex;
+    unsigned int m_NbOfWrittenChannels;
+
+    std::ofstream m_File;
+    Thread m_Writer;
+
+    /* Not copyable. */
+    TelemetryLogger(const TelemetryLogger &);
+    TelemetryLogger & operator=(const TelemetryLogger &);
+  };
+
+  /*! \brief Install a logger in the current thread
+    for the life time of the object. */
+  class ScopedTelemetryLogger
+  {
+  public:
+    explicit ScopedTelemetryLogger(TelemetryLogger & aLogger):
+      m_Previous(TelemetryLogger::Installed())
+    { TelemetryLogger::Installed() = &aLogger; }
+    ~ScopedTelemetryLogger()
+    { TelemetryLogger::Installed() = m_Previous; }
+  private:
+    TelemetryLogger * m_Previous;
+  };
+}
+#endif /* _TELEMETRY_H_ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file Telemetry2Dat.cpp
+  \brief Write the channels of a telemetry file in the .dat files
+  read by the scripts of src/gnufiles.
+
+  Usage: walkgen-telemetry2dat telemetry.bin [directory]
+*/
+
+#include <iostream>
+
+#include <Telemetry.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main(int argc, char *argv[])
+{
+  if ((argc!=2) && (argc!=3))
+    {
+      cerr << "Usage: " << argv[0] << " telemetry.bin [directory]" << endl;
+      return -1;
+    }
+
+  string lDirectory;
+  if (argc==3)
+    lDirectory = argv[2];
+  if (!TelemetryLogger::ConvertToText(argv[1],lDirectory))
+    {
+      cerr << "Unable to convert " << argv[1] << endl;
+      return -1;
+    }
+  return 0;
+}
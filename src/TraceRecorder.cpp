@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! Chrome trace of the control loop, the format is described in
+  "The Trace Event Format" of the Chromium project. */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <TraceRecorder.hh>
+
+using namespace PatternGeneratorJRL;
+
+/*! Source of the rows of the recorders. */
+static AtomicCounter gs_NbOfRecorders = 0;
+
+TraceRecorder::TraceRecorder(unsigned int aCapacity):
+  m_NbOfEvents(0)
+{
+  unsigned long lSize = 2;
+  while (lSize<aCapacity)
+    lSize*=2;
+  m_Mask = lSize-1;
+
+  Event_s anEvent;
+  anEvent.Name = "";
+  anEvent.Begin = 0;
+  anEvent.End = -1;
+  m_Events.resize(lSize,anEvent);
+
+  m_ThreadId = AtomicIncrement(gs_NbOfRecorders);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  m_Writer.Join();
+}
+
+void TraceRecorder::Snapshot(std::vector<Event_s> & Events) const
+{
+  unsigned long lSize = m_Mask+1;
+  unsigned long lLast = (unsigned long)AtomicLoad(m_NbOfEvents);
+  unsigned long lNbOfEvents = lLast<lSize ? lLast : lSize;
+
+  Events.resize(lNbOfEvents);
+  for(unsigned long i=0;i<lNbOfEvents;i++)
+    Events[i] = m_Events[(lLast-lNbOfEvents+i) & m_Mask];
+
+  // The events written meanwhile have overwritten the oldest ones,
+  // including the one being written now.
+  AtomicBarrier();
+  unsigned long lWritten =
+    (unsigned long)AtomicLoad(m_NbOfEvents) - lLast + 1;
+  if (lNbOfEvents+lWritten>lSize)
+    {
+      unsigned long lOverwritten = lNbOfEvents+lWritten-lSize;
+      if (lOverwritten>lNbOfEvents)
+	lOverwritten = lNbOfEvents;
+      Events.erase(Events.begin(),Events.begin()+lOverwritten);
+    }
+}
+
+bool TraceRecorder::WriteChromeTrace(const std::string & aFileName,
+				     const std::vector<Event_s> & Events,
+				     long aThreadId)
+{
+  std::ofstream aof(aFileName.c_str(),std::ofstream::out);
+  if (!aof.is_open())
+    return false;
+
+  aof << std::fixed << std::setprecision(3);
+  aof << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+  aof << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+      << aThreadId
+      << ",\"args\":{\"name\":\"PatternGenerator " << aThreadId << "\"}}";
+
+  // Time stamps and durations in micro-seconds.
+  for(unsigned int i=0;i<Events.size();i++)
+    {
+      const Event_s & anEvent = Events[i];
+      aof << "," << std::endl
+	  << "{\"name\":\"" << anEvent.Name
+	  << "\",\"cat\":\"walkgen\",\"pid\":0,\"tid\":" << aThreadId
+	  << ",\"ts\":" << 1e-3*(double)anEvent.Begin;
+      if (anEvent.End<0)
+	aof << ",\"ph\":\"i\",\"s\":\"t\"}";
+      else
+	aof << ",\"ph\":\"X\",\"dur\":"
+	    << 1e-3*(double)(anEvent.End-anEvent.Begin) << "}";
+    }
+  aof << std::endl << "]}" << std::endl;
+  aof.close();
+  return !aof.fail();
+}
+
+void TraceRecorder::WriteDump(void * aRecorder)
+{
+  TraceRecorder * aTR = (TraceRecorder *)aRecorder;
+  if (!WriteChromeTrace(aTR->m_DumpFileName,aTR->m_DumpEvents,
+			aTR->m_ThreadId))
+    std::cerr << "Unable to write the trace in "
+	      << aTR->m_DumpFileName << std::endl;
+}
+
+bool TraceRecorder::Dump(const std::string & aFileName)
+{
+  m_Writer.Join();
+  Snapshot(m_DumpEvents);
+  m_DumpFileName = aFileName;
+  if (m_Writer.Start(WriteDump,this)<0)
+    {
+      WriteDump(this);
+      return false;
+    }
+  return true;
+}
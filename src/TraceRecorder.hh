@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TraceRecorder.hh
+  \brief Ring buffer of the stages of the control loop,
+  written on demand in the Chrome trace format.
+*/
+
+#ifndef _TRACE_RECORDER_H_
+#define _TRACE_RECORDER_H_
+
+#include <string>
+#include <vector>
+
+#include "portability/atomic.hh"
+#include "portability/thread.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Last events of the control loop of one pattern generator.
+
+    The events are written by the thread running the control loop
+    in a ring buffer allocated once, without lock nor allocation.
+    Dump() copies the ring buffer and writes the copy in a
+    background thread, in the JSON format read by chrome://tracing
+    and by Perfetto. The events which may have been overwritten
+    during the copy are dropped.
+  */
+  class TraceRecorder
+  {
+  public:
+    /*! \brief An event, the name must be a static string. */
+    struct Event_s
+    {
+      const char * Name;
+      /*! Begin and end in nano-seconds, End is negative
+	for an instantaneous event. */
+      long long Begin;
+      long long End;
+    };
+
+    /*! \brief Constructor.
+      @param aCapacity Number of events kept,
+      rounded to the next power of two. */
+    explicit TraceRecorder(unsigned int aCapacity=32768);
+
+    /*! \brief Wait for the end of the last dump. */
+    ~TraceRecorder();
+
+    /*! \brief Add a stage from \a aBegin to \a anEnd. */
+    void Record(const char * aName, long long aBegin, long long anEnd)
+    {
+      long lIndex = m_NbOfEvents;
+      Event_s & anEvent = m_Events[lIndex & m_Mask];
+      anEvent.Name = aName;
+      anEvent.Begin = aBegin;
+      anEvent.End = anEnd;
+      AtomicStore(m_NbOfEvents,lIndex+1);
+    }
+
+    /*! \brief Add an instantaneous event at \a aTime. */
+    void Mark(const char * aName, long long aTime)
+    { Record(aName,aTime,-1); }
+
+    /*! \brief Write the events in \a aFileName.
+      The file is written by a background thread, this only waits
+      for the previous dump.
+      \return false if the writing thread could not be started. */
+    bool Dump(const std::string & aFileName);
+
+    /*! \brief Copy the events still in the ring buffer,
+      from the oldest to the latest. */
+    void Snapshot(std::vector<Event_s> & Events) const;
+
+    /*! \brief Write \a Events in the Chrome trace format.
+      @param aThreadId Identifier of the row of the events.
+      \return false if the file could not be opened. */
+    static bool WriteChromeTrace(const std::string & aFileName,
+				 const std::vector<Event_s> & Events,
+				 long aThreadId);
+
+  private:
+    static void WriteDump(void * aRecorder);
+
+    std::vector<Event_s> m_Events;
+    unsigned long m_Mask;
+    AtomicCounter m_NbOfEvents;
+
+    /*! Row of this recorder in the traces. */
+    long m_ThreadId;
+
+    /*! Last dump. */
+    Thread m_Writer;
+    std::string m_DumpFileName;
+    std::vector<Event_s> m_DumpEvents;
+
+    /* Not copyable. */
+    TraceRecorder(const TraceRecorder &);
+    TraceRecorder & operator=(const TraceRecorder &);
+  };
+}
+#endif /* _TRACE_RECORDER_H_ */
@@ -30,28 +30,7 @@
    ICRA 2007, 3989--39994
 */
 
-#define ODEBUG2(x)
-#define ODEBUG3(x) cerr << "AnalyticalMorisawa :" << x << endl
-#define RESETDEBUG5(y) { ofstream DebugFile; DebugFile.open(y,ofstream::out); DebugFile.close();}
-#define ODEBUG5(x,y) { ofstream DebugFile; DebugFile.open(y,ofstream::app); DebugFile << "PGI: " << x << endl; DebugFile.close();}
-#if 0
-#define ODEBUG(x) cerr << "AnalyticalMorisawa :" <<  x << endl
-#else
-#define ODEBUG(x)
-#endif
-
-#if 0
-#define RESETDEBUG4(y) { ofstream DebugFile; DebugFile.open(y,ofstream::out); DebugFile.close();}
-#define ODEBUG4(x,y) { ofstream DebugFile; DebugFile.open(y,ofstream::app); \
-    DebugFile << "PGI: " << x << endl; DebugFile.close();}
-#define _DEBUG_4_ACTIVATED_ 1
-#else
-#define RESETDEBUG4(y)
-#define ODEBUG4(x,y)
-#endif
-
-#define ODEBUG6(x,y)
-
+#include <Debug.hh>
 #include <fstream>
 #include <ZMPRefTrajectoryGeneration/AnalyticalMorisawaAbstract.hh>
 
@@ -234,7 +234,7 @@ namespace PatternGeneratorJRL
     if (m_VerboseLevel>=2)
       {
 	std::ofstream ofs;
-	ofs.open("YMatrix.dat",ofstream::out);
+	ofs.open(OutputFileName("YMatrix.dat").c_str(),ofstream::out);
 	ofs.precision(10);
       
 	for(unsigned int i=0;i<MAL_VECTOR_SIZE(m_y);i++)
@@ -341,7 +341,7 @@ namespace PatternGeneratorJRL
     if (m_VerboseLevel>=2)
       {
 	std::ofstream ofs;
-	ofs.open("YMatrix.dat",ofstream::out);
+	ofs.open(OutputFileName("YMatrix.dat").c_str(),ofstream::out);
 	ofs.precision(10);
       
 	for(unsigned int i=0;i<MAL_VECTOR_SIZE(m_y);i++)
@@ -928,7 +928,7 @@ namespace PatternGeneratorJRL
     if (m_VerboseLevel>=2)
       {
 	std::ofstream ofs;
-	ofs.open("WCompactMatrix.dat",ofstream::out);
+	ofs.open(OutputFileName("WCompactMatrix.dat").c_str(),ofstream::out);
 	ofs.precision(10);
       
 	for(unsigned int i=0;i<MAL_VECTOR_SIZE(m_w);i++)
@@ -1147,7 +1147,7 @@ namespace PatternGeneratorJRL
     if (m_VerboseLevel>=2)
       {
 	std::ofstream ofs;
-	ofs.open("ZCompactMatrix.dat",ofstream::out);
+	ofs.open(OutputFileName("ZCompactMatrix.dat").c_str(),ofstream::out);
 	ofs.precision(10);
 	for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(m_Z);i++)
 	  {
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#include <iostream>
+
+#include <ZMPRefTrajectoryGeneration/ConstraintWindowPipeline.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+ConstraintWindow_s::ConstraintWindow_s():
+  StartingTime(0.0),
+  Status(0),
+  NbOfConstraints(0),
+  NextNumberOfRemovedConstraints(0),
+  DPu(0),
+  Ax(0), Ay(0), B(0),
+  Sample(0),
+  ZMPRef(0),
+  m_N(0)
+{
+}
+
+ConstraintWindow_s::~ConstraintWindow_s()
+{
+  delete [] DPu;
+  delete [] Ax;
+  delete [] Ay;
+  delete [] B;
+  delete [] Sample;
+  delete [] ZMPRef;
+}
+
+void ConstraintWindow_s::Allocate(unsigned int N)
+{
+  if (N==m_N)
+    return;
+
+  delete [] DPu;
+  delete [] Ax;
+  delete [] Ay;
+  delete [] B;
+  delete [] Sample;
+  delete [] ZMPRef;
+
+  // The memory is bounded to 8 constraints per
+  // support foot (double support case).
+  DPu = new double[(8*N+1)*2*N];
+  Ax = new double[8*N];
+  Ay = new double[8*N];
+  B = new double[8*N];
+  Sample = new unsigned int[8*N];
+  SimilarConstraints.resize(8*N);
+  ZMPRef = new double[2*N];
+  m_N = N;
+}
+
+ConstraintWindowPipeline::ConstraintWindowPipeline(ConstraintWindowBuilder * aBuilder,
+						   unsigned int N,
+						   unsigned int NbOfThreads,
+						   unsigned int Depth):
+  m_Builder(aBuilder),
+  m_N(N),
+  m_T(0.0),
+  m_ComHeight(0.0),
+  m_Queue(0),
+  m_NbOfThreads(NbOfThreads),
+  m_NbOfRunningThreads(0),
+  m_NextToBuild(0),
+  m_NextToConsume(0),
+  m_Stop(false),
+  m_Threads(0)
+{
+  // Each thread needs at least one free slot.
+  m_Depth = Depth;
+  if (m_Depth<m_NbOfThreads+1)
+    m_Depth = m_NbOfThreads+1;
+
+  m_Windows = new ConstraintWindow_t[m_Depth];
+  for(unsigned int i=0;i<m_Depth;i++)
+    m_Windows[i].Allocate(N);
+  m_Ready.resize(m_Depth,false);
+
+  if (m_NbOfThreads>0)
+    m_Threads = new Thread[m_NbOfThreads];
+}
+
+ConstraintWindowPipeline::~ConstraintWindowPipeline()
+{
+  Stop();
+  delete [] m_Threads;
+  delete [] m_Windows;
+}
+
+void ConstraintWindowPipeline::Start(const vector<double> & StartingTimes,
+				     double T,
+				     double Com_Height,
+				     deque<LinearConstraintInequality_t *> &
+				     QueueOfLConstraintInequalities)
+{
+  Stop();
+
+  m_StartingTimes = StartingTimes;
+  m_T = T;
+  m_ComHeight = Com_Height;
+  m_Queue = &QueueOfLConstraintInequalities;
+  m_NextToBuild = 0;
+  m_NextToConsume = 0;
+  m_Stop = false;
+  for(unsigned int i=0;i<m_Depth;i++)
+    m_Ready[i] = false;
+
+  for(unsigned int i=0;i<m_NbOfThreads;i++)
+    {
+      if (m_Threads[i].Start(ConstraintWindowPipeline::Worker,this)<0)
+	{
+	  ODEBUG3("Unable to start the constraint builder thread " << i);
+	  break;
+	}
+      m_NbOfRunningThreads++;
+    }
+}
+
+void ConstraintWindowPipeline::Stop()
+{
+  {
+    ScopedLock aLock(m_Mutex);
+    m_Stop = true;
+    m_SlotFree.Broadcast();
+  }
+  for(unsigned int i=0;i<m_NbOfRunningThreads;i++)
+    m_Threads[i].Join();
+  m_NbOfRunningThreads = 0;
+}
+
+ConstraintWindow_t * ConstraintWindowPipeline::Next()
+{
+  if (m_NextToConsume>=m_StartingTimes.size())
+    return 0;
+
+  unsigned int lSlot = m_NextToConsume % m_Depth;
+
+  if (m_NbOfRunningThreads==0)
+    {
+      BuildWindow(m_NextToConsume);
+      return &m_Windows[lSlot];
+    }
+
+  ScopedLock aLock(m_Mutex);
+  while(!m_Ready[lSlot])
+    m_WindowReady.Wait(m_Mutex);
+  return &m_Windows[lSlot];
+}
+
+void ConstraintWindowPipeline::Release()
+{
+  ScopedLock aLock(m_Mutex);
+  m_Ready[m_NextToConsume % m_Depth] = false;
+  m_NextToConsume++;
+  m_SlotFree.Broadcast();
+}
+
+void ConstraintWindowPipeline::Worker(void * aPipeline)
+{
+  ((ConstraintWindowPipeline *)aPipeline)->WorkerLoop();
+}
+
+void ConstraintWindowPipeline::WorkerLoop()
+{
+  m_Mutex.Lock();
+  while(true)
+    {
+      // Wait for the slot of the next window to be released.
+      while((!m_Stop) &&
+	    (m_NextToBuild<m_StartingTimes.size()) &&
+	    (m_NextToBuild>=m_NextToConsume+m_Depth))
+	m_SlotFree.Wait(m_Mutex);
+
+      if ((m_Stop) ||
+	  (m_NextToBuild>=m_StartingTimes.size()))
+	break;
+
+      unsigned int lIndex = m_NextToBuild++;
+      m_Mutex.Unlock();
+
+      BuildWindow(lIndex);
+
+      m_Mutex.Lock();
+      m_Ready[lIndex % m_Depth] = true;
+      m_WindowReady.Broadcast();
+    }
+  m_Mutex.Unlock();
+}
+
+void ConstraintWindowPipeline::BuildWindow(unsigned int anIndex)
+{
+  ConstraintWindow_t & aWindow = m_Windows[anIndex % m_Depth];
+  aWindow.StartingTime = m_StartingTimes[anIndex];
+  aWindow.Status = m_Builder->BuildConstraintWindow(m_N,m_T,m_ComHeight,
+						    *m_Queue,aWindow);
+}
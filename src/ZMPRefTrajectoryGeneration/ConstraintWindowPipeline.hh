@@ -0,0 +1,192 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ConstraintWindowPipeline.hh
+  \brief Build the constraints of the offline QP formulations
+  several preview windows ahead of the solver.
+
+  For the offline ZMP QP formulations, the linear part of the constraints
+  (DPu) and the reference of the ZMP only depend on the starting time
+  of the preview window. Only the constant part (DPx) depends on the
+  state of the CoM, and so on the solution of the previous window.
+  The state independent part is computed by worker threads while
+  the main thread solves the current window.
+*/
+
+#ifndef _CONSTRAINT_WINDOW_PIPELINE_H_
+#define _CONSTRAINT_WINDOW_PIPELINE_H_
+
+#include <vector>
+#include <deque>
+
+#include <jrl/walkgen/pgtypes.hh>
+#include "portability/thread.hh"
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief State independent part of the constraints of one
+    preview window. The constraints are
+    \f$ DPu\, U + DPx \geq 0 \f$ where constraint \f$ c \f$
+    applies to the sample \f$ Sample[c] \f$ of the window and
+    \f$ DPx[c] = Ax[c]\, P_x(Sample[c]) x^x_k
+    + Ay[c]\, P_x(Sample[c]) x^y_k + B[c] \f$. */
+  struct ConstraintWindow_s
+  {
+    /*! Starting time of the window. */
+    double StartingTime;
+
+    /*! Negative if the window could not be built. */
+    int Status;
+
+    /*! Number of constraints of the window. */
+    unsigned int NbOfConstraints;
+
+    /*! Number of constraints related to the first sample. */
+    unsigned int NextNumberOfRemovedConstraints;
+
+    /*! Linear part of the constraints stored column-wise
+      with a leading dimension of NbOfConstraints+1,
+      for up to 8 constraints per sample. */
+    double * DPu;
+
+    /*! Data needed to compute the constant part of each constraint. */
+    double * Ax, * Ay, * B;
+    unsigned int * Sample;
+
+    /*! Similar constraints as defined by the support polygons. */
+    std::vector<int> SimilarConstraints;
+
+    /*! ZMP reference along X (first N values) and Y. */
+    double * ZMPRef;
+
+    ConstraintWindow_s();
+    ~ConstraintWindow_s();
+
+    /*! Allocate the buffers for a preview window of \a N samples. */
+    void Allocate(unsigned int N);
+
+  private:
+    /*! Size of the preview window the buffers are allocated for. */
+    unsigned int m_N;
+
+    /* Not copyable. */
+    ConstraintWindow_s(const ConstraintWindow_s &);
+    ConstraintWindow_s & operator=(const ConstraintWindow_s &);
+  };
+  typedef struct ConstraintWindow_s ConstraintWindow_t;
+
+  /*! \brief Interface of the objects filling the constraint windows. */
+  class ConstraintWindowBuilder
+  {
+  public:
+    virtual ~ConstraintWindowBuilder() {}
+
+    /*! \brief Fill \a aWindow for the preview window starting at
+      aWindow.StartingTime. This method is called concurrently from
+      several threads: it should only read the state of the builder
+      and \a QueueOfLConstraintInequalities.
+      \return A negative value if the window can not be built. */
+    virtual int BuildConstraintWindow(unsigned int N, double T,
+				      double Com_Height,
+				      std::deque<LinearConstraintInequality_t *> &
+				      QueueOfLConstraintInequalities,
+				      ConstraintWindow_t & aWindow) = 0;
+  };
+
+  /*! \brief Producer/consumer pipeline over the constraint windows.
+    Windows are consumed in order through Next() and Release(),
+    up to \a Depth windows are prepared in advance. */
+  class ConstraintWindowPipeline
+  {
+  public:
+    /*! \brief Constructor.
+      @param[in] aBuilder Object filling the windows.
+      @param[in] N Size of the preview window.
+      @param[in] NbOfThreads Number of worker threads,
+      0 builds the windows synchronously in Next().
+      @param[in] Depth Number of windows in the ring buffer. */
+    ConstraintWindowPipeline(ConstraintWindowBuilder * aBuilder,
+			     unsigned int N,
+			     unsigned int NbOfThreads,
+			     unsigned int Depth);
+
+    /*! \brief Destructor: stops the worker threads. */
+    ~ConstraintWindowPipeline();
+
+    /*! \brief Start building the windows starting at \a StartingTimes.
+      The queue of constraints should not be modified before Stop()
+      is called. */
+    void Start(const std::vector<double> & StartingTimes,
+	       double T,
+	       double Com_Height,
+	       std::deque<LinearConstraintInequality_t *> &
+	       QueueOfLConstraintInequalities);
+
+    /*! \brief Returns the next window, waiting for it if necessary.
+      \return 0 when all the windows have been consumed. */
+    ConstraintWindow_t * Next();
+
+    /*! \brief Give back the window returned by the last call to Next(). */
+    void Release();
+
+    /*! \brief Stop and join the worker threads. */
+    void Stop();
+
+    /*! \brief Number of worker threads really started. */
+    unsigned int GetNbOfThreads() const
+    { return m_NbOfRunningThreads; }
+
+  protected:
+    /*! Worker thread entry point. */
+    static void Worker(void * aPipeline);
+
+    /*! Loop of the worker threads. */
+    void WorkerLoop();
+
+    /*! Fill window \a anIndex in its slot. */
+    void BuildWindow(unsigned int anIndex);
+
+  private:
+    ConstraintWindowBuilder * m_Builder;
+    unsigned int m_N;
+    double m_T, m_ComHeight;
+    std::deque<LinearConstraintInequality_t *> * m_Queue;
+    std::vector<double> m_StartingTimes;
+
+    unsigned int m_NbOfThreads, m_NbOfRunningThreads;
+    unsigned int m_Depth;
+
+    /*! Ring buffer of windows and their readiness. */
+    ConstraintWindow_t * m_Windows;
+    std::vector<bool> m_Ready;
+
+    /*! Index of the next window to build and to consume. */
+    unsigned int m_NextToBuild, m_NextToConsume;
+    bool m_Stop;
+
+    Mutex m_Mutex;
+    ConditionVariable m_WindowReady, m_SlotFree;
+    Thread * m_Threads;
+  };
+}
+#endif /* _CONSTRAINT_WINDOW_PIPELINE_H_ */
@@ -97,9 +97,9 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginMan
   
   InitConstants();
 
-  // PLDP Solver needs iPu and Px.
+  m_NbOfConstraintThreads = 2;
 
-  m_SimilarConstraints.resize(8*m_QP_N);
+  // PLDP Solver needs iPu and Px.
 
   if (m_FastFormulationMode==PLDP)
     m_PLDPSolver = new Optimization::Solver::PLDPSolver(m_QP_N,
@@ -225,19 +225,19 @@ int ZMPConstrainedQPFastFormulation::InitializeMatrixPbConstants()
   if (m_FullDebug>2)
     {
       ofstream aof;
-      aof.open("VPx.dat");
+      aof.open(OutputFileName("VPx.dat").c_str());
       aof << m_VPx;
       aof.close();
       
-      aof.open("m_PPx.dat");
+      aof.open(OutputFileName("m_PPx.dat").c_str());
       aof << m_PPx;
       aof.close();
       
-      aof.open("VPu.dat");
+      aof.open(OutputFileName("VPu.dat").c_str());
       aof << m_VPu;
       aof.close();
       
-      aof.open("PPu.dat");
+      aof.open(OutputFileName("PPu.dat").c_str());
       aof << m_PPu;
       aof.close();
     }
@@ -343,7 +343,7 @@ int ZMPConstrainedQPFastFormulation::ValidationConstraints(double * & DPx,double
   if (m_FullDebug>2)
     {
       ofstream aof;
-      aof.open("StorePx.dat",ofstream::out);
+      aof.open(OutputFileName("StorePx.dat").c_str(),ofstream::out);
       
       for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(vnlStorePx);i++)
 	{
@@ -358,7 +358,7 @@ int ZMPConstrainedQPFastFormulation::ValidationConstraints(double * & DPx,double
       
       char lBuffer[1024];
       sprintf(lBuffer,"StoreX.dat");
-      aof.open(lBuffer,ofstream::out);
+      aof.open(OutputFileName(lBuffer).c_str(),ofstream::out);
       
       for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(vnlStoreX);i++)
 	{
@@ -370,7 +370,7 @@ int ZMPConstrainedQPFastFormulation::ValidationConstraints(double * & DPx,double
 	}
       aof.close();
       
-      aof.open("Cnb.dat",ofstream::out);
+      aof.open(OutputFileName("Cnb.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<MAL_VECTOR_SIZE(ConstraintNb);i++)
 	{
 	  aof << ConstraintNb[i]<<endl;
@@ -418,7 +418,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"localQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -428,7 +428,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
       aof.close(); 
       
       sprintf(Buffer,"localLQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -438,7 +438,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
       aof.close(); 
 
       sprintf(Buffer,"localiLQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -483,7 +483,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
       char Buffer[1024];
 
       sprintf(Buffer,"LQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<2*m_QP_N;j++)
@@ -493,7 +493,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
       aof.close(); 
       
       sprintf(Buffer,"iLQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<2*m_QP_N;j++)
@@ -534,7 +534,8 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
 
   // Initialization of the matrice regarding the quadratic
   // part of the objective function.
-  m_Q=new double[4*m_QP_N*m_QP_N]; 
+  if (m_Q==0)
+    m_Q=new double[4*m_QP_N*m_QP_N]; 
   memset(m_Q,0,4*m_QP_N*m_QP_N*sizeof(double));
   for(unsigned int i=0;i<2*m_QP_N;i++)
     m_Q[i*2*m_QP_N+i] = 1.0;
@@ -545,7 +546,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"Q.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<2*m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<2*m_QP_N;j++)
@@ -581,7 +582,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
     ofstream aof;
     char Buffer[1024];
     sprintf(Buffer,"OptB.dat");
-    aof.open(Buffer,ofstream::out);
+    aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
     for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(m_OptB);i++)
       {
 	for(unsigned int j=0;j<MAL_MATRIX_NB_COLS(m_OptB)-1;j++)
@@ -598,7 +599,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
     ofstream aof;
     char Buffer[1024];
     sprintf(Buffer,"OptC.dat");
-    aof.open(Buffer,ofstream::out);
+    aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
     for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(m_OptC);i++)
       {
 	for(unsigned int j=0;j<MAL_MATRIX_NB_COLS(m_OptC)-1;j++)
@@ -684,7 +685,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfConstraintMatrices()
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"PuCst.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -694,7 +695,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfConstraintMatrices()
       aof.close();
 
       sprintf(Buffer,"tmpPuCst.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -704,7 +705,7 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfConstraintMatrices()
       aof.close();
 
       sprintf(Buffer,"tmpiLQ.dat");
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<m_QP_N;i++)
 	{
 	  for(unsigned int j=0;j<m_QP_N;j++)
@@ -720,18 +721,91 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfConstraintMatrices()
 }
 
 
+void ZMPConstrainedQPFastFormulation::PrepareConstantsCache(ConstantMatricesCache & aCache)
+{
+  // Version of the layout of the cached matrices.
+  aCache.AddToKey(1.0);
+  aCache.AddToKey(m_QP_T);
+  aCache.AddToKey(m_QP_N);
+  aCache.AddToKey(m_ComHeight);
+  aCache.AddToKey(m_Alpha);
+  aCache.AddToKey(m_Beta);
+  aCache.AddToKey(m_FastFormulationMode);
+
+  if (m_Q==0)
+    m_Q=new double[4*m_QP_N*m_QP_N]; 
+  if (m_Pu==0)
+    m_Pu = new double[m_QP_N*m_QP_N];
+  MAL_MATRIX_RESIZE(m_OptB,2*m_QP_N,6);
+  MAL_MATRIX_RESIZE(m_OptC,2*m_QP_N,2*m_QP_N);
+
+  if ((m_FastFormulationMode==QLDANDLQ) ||
+      (m_FastFormulationMode==PLDP))
+    {
+      MAL_MATRIX_RESIZE(m_LQ,2*m_QP_N,2*m_QP_N);
+      MAL_MATRIX_RESIZE(m_iLQ,2*m_QP_N,2*m_QP_N);
+    }
+
+  if (m_FastFormulationMode==PLDP)
+    MAL_MATRIX_RESIZE(m_iPu,m_QP_N,m_QP_N);
+
+  RegisterConstantArrays(aCache);
+}
+
+void ZMPConstrainedQPFastFormulation::RegisterConstantArrays(ConstantMatricesCache & aCache)
+{
+  aCache.ClearArrays();
+
+  aCache.AddArray(m_Q,4*m_QP_N*m_QP_N);
+  aCache.AddArray(m_Pu,m_QP_N*m_QP_N);
+  aCache.AddArray(MAL_RET_MATRIX_DATABLOCK(m_OptB),2*m_QP_N*6);
+  aCache.AddArray(MAL_RET_MATRIX_DATABLOCK(m_OptC),4*m_QP_N*m_QP_N);
+
+  if ((m_FastFormulationMode==QLDANDLQ) ||
+      (m_FastFormulationMode==PLDP))
+    {
+      aCache.AddArray(MAL_RET_MATRIX_DATABLOCK(m_LQ),4*m_QP_N*m_QP_N);
+      aCache.AddArray(MAL_RET_MATRIX_DATABLOCK(m_iLQ),4*m_QP_N*m_QP_N);
+    }
+
+  if (m_FastFormulationMode==PLDP)
+    aCache.AddArray(MAL_RET_MATRIX_DATABLOCK(m_iPu),m_QP_N*m_QP_N);
+}
+
 int ZMPConstrainedQPFastFormulation::InitConstants()
 {
   int r;
   if ((r=InitializeMatrixPbConstants())<0)
     return r;
 
+  // The objective function and the constraints only depend 
+  // on the parameters of the problem: try first to reload them.
+  ConstantMatricesCache aCache(ConstantMatricesCache::DefaultDirectory(),
+			       "ZMPConstrainedQPFastFormulation");
+  if (aCache.IsEnabled())
+    {
+      PrepareConstantsCache(aCache);
+      if (aCache.Load()==0)
+	return 0;
+    }
+
   if ((r=BuildingConstantPartOfTheObjectiveFunction())<0)
     return r;
   
   if ((r=BuildingConstantPartOfConstraintMatrices())<0)
     return r;
 
+  if (aCache.IsEnabled())
+    {
+      // The builders reallocate the matrices: the arrays
+      // registered before are not valid anymore.
+      RegisterConstantArrays(aCache);
+      if (aCache.Save()<0)
+	{
+	  ODEBUG3("Unable to store the constant matrices in " 
+		  << aCache.FileName());
+	}
+    }
   return 0;
 }
 
@@ -756,30 +830,17 @@ const double & ZMPConstrainedQPFastFormulation::GetBeta() const
 }
 
 
-int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,double * &DPu, 
-							     unsigned N, double T,
-							     double StartingTime,
-							     deque<LinearConstraintInequality_t *> & 
-							     QueueOfLConstraintInequalities,
-							     double , //Com_Height,
-							     unsigned int &NbOfConstraints,
-							     MAL_VECTOR(& xk,double),
-							     MAL_VECTOR(& ZMPRef,double),
-							     unsigned int &NextNumberOfRemovedConstraints)
+int ZMPConstrainedQPFastFormulation::BuildConstraintWindow(unsigned N, double T,
+							   double , //Com_Height,
+							   deque<LinearConstraintInequality_t *> &
+							   QueueOfLConstraintInequalities,
+							   ConstraintWindow_t & aWindow)
 {
   // Discretize the problem.
   ODEBUG(" N:" << N << " T: " << T);
   
-  // Creates the matrices.
-  // The memory will be bounded to 8 constraints per
-  // support foot (double support case).
-  // Will be probably all the time smaller.
-  if (DPx==0)
-    DPx = new double[8*N+1];
-
-  if (DPu==0)
-    DPu = new double[(8*N+1)*2*N];
-
+  double StartingTime = aWindow.StartingTime;
+  double * DPu = aWindow.DPu;
   memset(DPu,0,(8*N+1)*2*N*sizeof(double));
 
   deque<LinearConstraintInequality_t *>::iterator LCI_it, store_it;
@@ -803,21 +864,6 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
       return -1;
     }
       
-  if (m_FullDebug>2)
-    {
-      char Buffer[1024];
-      sprintf(Buffer,"PXD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer);
-      ODEBUG6("xk:" << xk << " Starting time: " <<StartingTime ,Buffer );
-      char Buffer2[1024];
-      sprintf(Buffer2,"PXxD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer2);
-      
-      char Buffer3[1024];
-      sprintf(Buffer3,"PXyD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer3);
-    }
-  
   // Compute first the number of constraint.
   unsigned int IndexConstraint=0;
   for(unsigned int i=0;i<N;i++)
@@ -833,18 +879,14 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
 	}
       IndexConstraint += MAL_MATRIX_NB_ROWS((*LCI_it)->A);
     }  
-  NbOfConstraints = IndexConstraint;
+  unsigned int NbOfConstraints = IndexConstraint;
+  aWindow.NbOfConstraints = NbOfConstraints;
   
-  MAL_MATRIX(lD,double);
-  MAL_MATRIX_RESIZE(lD,NbOfConstraints,2*N);
-
-  MAL_VECTOR_DIM(lb,double,NbOfConstraints);
-
   LCI_it = store_it;
 
   // Store the number of constraint to be generated for the first 
   // slot of time control of the algorithm.
-  NextNumberOfRemovedConstraints = MAL_MATRIX_NB_ROWS((*LCI_it)->A);
+  aWindow.NextNumberOfRemovedConstraints = MAL_MATRIX_NB_ROWS((*LCI_it)->A);
 
   IndexConstraint = 0;
   ODEBUG("Starting Matrix to build the constraints. ");
@@ -857,36 +899,24 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
 	{
 	  LCI_it++;
 	}
-      ZMPRef[i] = (*LCI_it)->Center(0);
-      ZMPRef[i+N] = (*LCI_it)->Center(1);
+      if (LCI_it==QueueOfLConstraintInequalities.end())
+	break;
+
+      aWindow.ZMPRef[i] = (*LCI_it)->Center(0);
+      aWindow.ZMPRef[i+N] = (*LCI_it)->Center(1);
 
 
       // For each constraint.
       for(unsigned j=0;j<MAL_MATRIX_NB_ROWS((*LCI_it)->A);j++)
 	{
+	  // The constant part depends on the state, 
+	  // it is computed by ComputeConstraintsCstPart().
+	  aWindow.Ax[IndexConstraint] = (*LCI_it)->A(j,0);
+	  aWindow.Ay[IndexConstraint] = (*LCI_it)->A(j,1);
+	  aWindow.B[IndexConstraint] = (*LCI_it)->B(j,0);
+	  aWindow.Sample[IndexConstraint] = i;
 
-	  // Verification of constraints.
-	  DPx[IndexConstraint] = 
-	    // X Axis * A
-	    (xk[0] * m_Px(i,0)+
-	     xk[1] * m_Px(i,1)+ 
-	     xk[2] * m_Px(i,2))
-	    * (*LCI_it)->A(j,0)
-	     + 
-	     // Y Axis * A
-	    ( xk[3] * m_Px(i,0)+
-	      xk[4] * m_Px(i,1)+ 
-	      xk[5] * m_Px(i,2))	  
-	    * (*LCI_it)->A(j,1)
-	     // Constante part of the constraint
-	    + (*LCI_it)->B(j,0);
-
-	  ODEBUG6(DPx[IndexConstraint] << " " << (*LCI_it)->A(j,0)  << " "
-		  << (*LCI_it)->A[j][1] << " " << (*LCI_it)->B(j,0) ,Buffer);
-	  ODEBUG6(1 << " " <<    T *(i+1) << " " <<    (i+1)*(i+1)*T*T/2 - Com_Height/9.81,Buffer2);
-	  ODEBUG6(1 << " " <<    T *(i+1) << " " <<    (i+1)*(i+1)*T*T/2 - Com_Height/9.81,Buffer3);
-
-	  m_SimilarConstraints[IndexConstraint]=(*LCI_it)->SimilarConstraints[j];
+	  aWindow.SimilarConstraints[IndexConstraint]=(*LCI_it)->SimilarConstraints[j];
 
 	  if (m_FastFormulationMode==QLD)
 	    {
@@ -922,103 +952,46 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
 
     }
   
-  ODEBUG6("Index Constraint :"<< IndexConstraint,Buffer);
-  static double localtime = -m_QP_T;
-  localtime+=m_QP_T;
+  ODEBUG("IndexConstraint:"<<IndexConstraint << " StartingTime :" << StartingTime);
 
-  ODEBUG("IndexConstraint:"<<IndexConstraint << " localTime :" << localtime);
+  return 0;
+}
 
-  //  if (localtime>=1.96)
-  if (0)
+void ZMPConstrainedQPFastFormulation::ComputeConstraintsCstPart(const ConstraintWindow_t & aWindow,
+								MAL_VECTOR(& xk,double),
+								double * DPx)
+{
+  for(unsigned int c=0;c<aWindow.NbOfConstraints;c++)
     {
-      ODEBUG3("localtime: " <<localtime);
-      ofstream aof;
-
-      char Buffer[1024];
-      sprintf(Buffer,"DPu.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<IndexConstraint;i++)
-	{
-	  for(unsigned int j=0;j<2*N;j++)
-	    aof << DPu[j*(NbOfConstraints+1)+i] << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"DPx.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<IndexConstraint;j++)
-	aof << DPx[j] << " " ;
-      aof << endl;
-      aof.close();
-
-      sprintf(Buffer,"CZMPRef.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<2*N;j++)
-	aof << ZMPRef[j] << " " ;
-      aof << endl;
-      aof.close();
-
-      sprintf(Buffer,"lD.dat");
-      aof.open(Buffer,ofstream::out);
-      ODEBUG3(MAL_MATRIX_NB_ROWS(lD) << " " << MAL_MATRIX_NB_COLS(lD) << " " );
-      for(unsigned int lj=0;lj<MAL_MATRIX_NB_ROWS(lD);lj++)
-	{
-	  for(unsigned int k=0;k<MAL_MATRIX_NB_COLS(lD);k++)
-	    aof << lD(lj,k) << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"lb.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<IndexConstraint;j++)
-	aof << lb(j) << " " ;
-      aof << endl;
-      aof.close();
-      
-      //      exit(0);
-    } 
+      unsigned int i = aWindow.Sample[c];
+      DPx[c] = 
+	// X Axis * A
+	(xk[0] * m_Px(i,0)+
+	 xk[1] * m_Px(i,1)+ 
+	 xk[2] * m_Px(i,2))
+	* aWindow.Ax[c]
+	+ 
+	// Y Axis * A
+	( xk[3] * m_Px(i,0)+
+	  xk[4] * m_Px(i,1)+ 
+	  xk[5] * m_Px(i,2))	  
+	* aWindow.Ay[c]
+	// Constante part of the constraint
+	+ aWindow.B[c];
+    }
 
-  //  if (m_FullDebug>0)
-  if (0)
+  if (m_FullDebug>2)
     {
-      
       ofstream aof;
-      char Buffer[1024];      
-      sprintf(Buffer,"PuCst_%f.dat",StartingTime);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << m_Pu[j+i*m_QP_N] << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"D_%f.dat",StartingTime);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<2*m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<NbOfConstraints;j++)
-	    aof << lD(i,j) << " " ;
-	  aof << endl;
-	}
+      char Buffer[1024];
+      sprintf(Buffer,"PXD_%f.dat", aWindow.StartingTime);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      aof << "xk:" << xk << " Starting time: " << aWindow.StartingTime << endl;
+      for(unsigned int c=0;c<aWindow.NbOfConstraints;c++)
+	aof << DPx[c] << " " << aWindow.Ax[c] << " " 
+	    << aWindow.Ay[c] << " " << aWindow.B[c] << endl;
       aof.close();
-
-      if (0)
-	{
-	  sprintf(Buffer,"DPX_%f.dat", StartingTime);
-	  aof.open(Buffer,ofstream::out);
-	  for(unsigned int i=0;i<IndexConstraint;i++)
-	    {
-	      aof << DPx[i] << endl ;
-	    }
-	  aof.close();
-	}
     }
-
-  return 0;
 }
 
 int ZMPConstrainedQPFastFormulation::DumpProblem(double * Q,
@@ -1034,7 +1007,7 @@ int ZMPConstrainedQPFastFormulation::DumpProblem(double * Q,
 
   char Buffer[1024];
   sprintf(Buffer,"Problem_%f.dat",Time);
-  aof.open(Buffer,ofstream::out);
+  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 
   // Dumping Q.
   aof << "Q:"<< endl;
@@ -1105,7 +1078,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 									  unsigned int N)
 {
 
-  double *DPx=0,*DPu=0;
+  double *DPx=new double[8*N+1],*DPu=0;
   unsigned int NbOfConstraints=8*N; // Nb of constraints to be taken into account
   // for each iteration
 
@@ -1186,11 +1159,27 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	  << " T: " << T << " N: " << N << " interval " << interval);
   unsigned int NumberOfRemovedConstraints =0,
     NextNumberOfRemovedConstraints =0;
+
+  // The constraints of the next windows are built 
+  // while the current one is solved.
+  vector<double> StartingTimes;
   for(double StartingTime=0.0;
       StartingTime<QueueOfLConstraintInequalities.back()->EndingTime-
 	N*T;
-      StartingTime+=T,li++)
+      StartingTime+=T)
+    StartingTimes.push_back(StartingTime);
+
+  ConstraintWindowPipeline aPipeline(this,N,
+				     m_NbOfConstraintThreads,
+				     2*m_NbOfConstraintThreads+2);
+  aPipeline.Start(StartingTimes,T,m_ComHeight,
+		  QueueOfLConstraintInequalities);
+
+  // The work buffers are released below whatever the outcome.
+  int lStatus = 0;
+  for(li=0;li<(int)StartingTimes.size();li++)
     {
+      double StartingTime = StartingTimes[li];
       gettimeofday(&start,0);
       
       // Read the current state of the 2D Linearized Inverted Pendulum.
@@ -1211,16 +1200,23 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 		  xk[1] << " " << xk[4] << " " <<
 		  xk[2] << " " << xk[5] << " ", "Check2DLIPM_PLDP.dat");
 	}
-      // Build the related matrices.
-      BuildConstraintMatrices(DPx,DPu,
-			      N,T,
-			      StartingTime,
-			      QueueOfLConstraintInequalities,
-			      m_ComHeight,
-			      NbOfConstraints,
-			      xk,
-			      ZMPRef,
-			      NextNumberOfRemovedConstraints);
+      // Get the related matrices.
+      ConstraintWindow_t * aWindow = aPipeline.Next();
+      if (aWindow->Status<0)
+	{
+	  cout << "Unable to build the constraints at time: " 
+	       << StartingTime << endl;
+	  lStatus = -1;
+	  break;
+	}
+      DPu = aWindow->DPu;
+      NbOfConstraints = aWindow->NbOfConstraints;
+      NextNumberOfRemovedConstraints = aWindow->NextNumberOfRemovedConstraints;
+      for(unsigned int i=0;i<2*N;i++)
+	ZMPRef[i] = aWindow->ZMPRef[i];
+
+      // Only the constant part depends on the current state.
+      ComputeConstraintsCstPart(*aWindow,xk,DPx);
       
 
       m = NbOfConstraints;
@@ -1239,7 +1235,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	  ofstream aof;
 	  char Buffer[1024];
 	  sprintf(Buffer,"ZMPRef_%f.dat",StartingTime);
-	  aof.open(Buffer,ofstream::out);
+	  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	  for(unsigned int i=0;i<2*N;i++)
 	    {
 	      aof << ZMPRef[i] << endl;
@@ -1262,7 +1258,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	      ofstream aof;
 	      char Buffer[1024];
 	      sprintf(Buffer,"D_%f.dat",StartingTime);
-	      aof.open(Buffer,ofstream::out);
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	      for(unsigned int i=0;i<2*N;i++)
 		{
 		  aof << OptD[i] << endl;
@@ -1333,7 +1329,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 					   DPx,
 					   MAL_RET_VECTOR_DATABLOCK(ZMPRef),
 					   MAL_RET_VECTOR_DATABLOCK(xk),X,
-					   m_SimilarConstraints,
+					   aWindow->SimilarConstraints,
 					   NumberOfRemovedConstraints,
 					   StartingSequence);
 	  StartingSequence = false;
@@ -1418,7 +1414,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	ofstream aof;
 	char Buffer[1024];
 	sprintf(Buffer,"X_%f.dat",StartingTime);
-	aof.open(Buffer,ofstream::out);
+	aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	for(unsigned int i=0;i<2*N;i++)
 	  {
 	    aof << X[i] << endl;
@@ -1436,10 +1432,13 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	     " Virtual time to simulate: " << QueueOfLConstraintInequalities.back()->EndingTime - StartingTime << 
 	     "Computation Time " << CurrentCPUTime << " " << TotalAmountOfCPUTime);
 
+      aPipeline.Release();
     }
+  aPipeline.Stop();
   
   /*  cout << "Size of PX: " << MAL_MATRIX_NB_ROWS(vnlStorePx) << " " 
       << MAL_MATRIX_NB_COLS(vnlStorePx) << " " << endl; */
+  delete [] DPx;
   delete [] D;
   delete [] XL;
   delete [] XU;
@@ -1459,7 +1458,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
     }
   QueueOfLConstraintInequalities.clear();
   
-  return 0;
+  return lStatus;
 }
 
 
@@ -1501,7 +1500,7 @@ void ZMPConstrainedQPFastFormulation::GetZMPDiscretization(deque<ZMPPosition> &
   if (m_FullDebug>0)
     {
       ofstream aof;
-      aof.open("DebugDimitrovZMP.dat",ofstream::out);
+      aof.open(OutputFileName("DebugDimitrovZMP.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<ZMPPositions.size();i++)
 	{
 	  aof << ZMPPositions[i].px << " " << ZMPPositions[i].py << endl;
@@ -1535,6 +1534,12 @@ void ZMPConstrainedQPFastFormulation::CallMethod(std::string & Method, std::istr
 	  strm >> m_QP_N;
 	  cout << "Preview window for the QP " << m_QP_N << endl;
 	}
+      else if (PBWCmd=="THREADS")
+	{
+	  strm >> m_NbOfConstraintThreads;
+	  cout << "Threads building the constraints " 
+	       << m_NbOfConstraintThreads << endl;
+	}
     }
 
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
@@ -33,13 +33,16 @@
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
 #include <Mathematics/FootConstraintsAsLinearSystem.hh>
 #include <Mathematics/OptCholesky.hh>
+#include <Mathematics/ConstantMatricesCache.hh>
 #include <Mathematics/PLDPSolver.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
+#include <ZMPRefTrajectoryGeneration/ConstraintWindowPipeline.hh>
 
 namespace PatternGeneratorJRL
 {
   class ZMPDiscretization;
-  class  ZMPConstrainedQPFastFormulation : public ZMPRefTrajectoryGeneration
+  class  ZMPConstrainedQPFastFormulation : public ZMPRefTrajectoryGeneration,
+    public ConstraintWindowBuilder
   {
     
   public:
@@ -135,22 +138,35 @@ namespace PatternGeneratorJRL
 
 
     /*! \brief Call the two previous methods 
+      unless the matrices can be loaded from the cache given
+      by the environment variable JRL_WALKGEN_CACHE_DIR.
       \return A negative value in case of a problem 0 otherwise.
      */
     int InitConstants();
+
+    /*! \brief Set the key of \a aCache from the parameters of the problem,
+      and register the constant matrices (resized accordingly). */
+    void PrepareConstantsCache(ConstantMatricesCache & aCache);
+
+    /*! \brief Register the current storage of the constant matrices
+      in \a aCache, replacing the arrays registered before. */
+    void RegisterConstantArrays(ConstantMatricesCache & aCache);
       
     
-    /*! Build the necessary matrices for the QP problem under linear inequality constraints. */
-    int BuildConstraintMatrices(double * &Px, double * &DPu,
-				unsigned N, double T,
-				double StartingTime,
-				deque<LinearConstraintInequality_t *> 
-				& QueueOfLConstraintInequalities,
-				double Com_Height,
-				unsigned int &NbOfConstraints,
-				MAL_VECTOR(&xk,double),
-				MAL_VECTOR(&ZMPRef,double),
-				unsigned int &NextNumberOfRemovedConstraints);
+    /*! Build the part of the matrices for the QP problem under linear 
+      inequality constraints which does not depend on the state of the CoM.
+      This method is called by the threads of the constraint pipeline. */
+    int BuildConstraintWindow(unsigned N, double T,
+			      double Com_Height,
+			      deque<LinearConstraintInequality_t *> 
+			      & QueueOfLConstraintInequalities,
+			      ConstraintWindow_t & aWindow);
+
+    /*! Compute the constant part of the constraints of \a aWindow
+      for the current state \a xk. */
+    void ComputeConstraintsCstPart(const ConstraintWindow_t & aWindow,
+				   MAL_VECTOR(&xk,double),
+				   double * DPx);
 
     /*! \brief Build the constant part of the constraint matrices. */
     int BuildingConstantPartOfConstraintMatrices();
@@ -254,6 +270,22 @@ namespace PatternGeneratorJRL
     /*! Set \f$\beta\f$ */
     void SetBeta(const double &);
     
+    /*! @}*/
+
+    /*! \name Constant matrices of the problem
+      @{
+    */
+    const MAL_MATRIX_TYPE(double) & GetOptB() const
+    { return m_OptB; }
+
+    const MAL_MATRIX_TYPE(double) & GetOptC() const
+    { return m_OptC; }
+
+    const MAL_MATRIX_TYPE(double) & GetiLQ() const
+    { return m_iLQ; }
+
+    const MAL_MATRIX_TYPE(double) & GetiPu() const
+    { return m_iPu; }
     /*! @}*/
     /* @} */
     
@@ -347,6 +379,9 @@ namespace PatternGeneratorJRL
     /*! Primal Least square Distance Problem solver */
     Optimization::Solver::PLDPSolver * m_PLDPSolver;
 
+    /*! Number of threads building the constraints ahead of the solver. */
+    unsigned int m_NbOfConstraintThreads;
+
     /*! @} */
     
     int DumpProblem(double * Q,
@@ -357,9 +392,6 @@ namespace PatternGeneratorJRL
 		    double * XL,
 		    double * XU,
 		    double Time);
-      
-    /*! Vector of similar constraints. */
-    vector<int> m_SimilarConstraints;
   };
 }
 
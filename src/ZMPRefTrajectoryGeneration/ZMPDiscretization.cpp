@@ -259,45 +259,20 @@ void ZMPDiscretization::InitializeFilter()
   for(int i=0;i<n+1;i++)
     m_ZMPFilterWindow[i]/= sum;
 
+  // FilterOutValues looks ahead two samples.
+  m_ZMPRefFilter.SetWindow(m_ZMPFilterWindow,2);
+
 }
 
 void ZMPDiscretization::FilterZMPRef(deque<ZMPPosition> &ZMPPositionsX,
 				     deque<ZMPPosition> &ZMPPositionsY)
 {
-  int n=0;
-  double T=0.050; // Arbritraty fixed from Kajita's San matlab files.
-  deque<double> window;
-
   ZMPPositionsY.resize(ZMPPositionsX.size());
-  // Creates window.
-  assert(m_SamplingPeriod > 0);
-  n = (int)floor(T/m_SamplingPeriod);
 
   // Filter ZMPref.
-
-  // First part of the filter.
-  for(int i=0;i<n+1;i++)
-    {
-      ZMPPositionsY[i] = ZMPPositionsX[i];
-    }
-
-  for(unsigned int i=n+1;i<ZMPPositionsX.size();i++)
-    {
-      double ltmp[2]={0,0};
-      for(unsigned int j=0;j<m_ZMPFilterWindow.size();j++)
-	{
-	  ltmp[0] += m_ZMPFilterWindow[j]*ZMPPositionsX[i-j].px;
-	  ltmp[1] += m_ZMPFilterWindow[j]*ZMPPositionsX[i-j].py;
-	}
-
-      ZMPPositionsY[i].px = ltmp[0];
-      ZMPPositionsY[i].py = ltmp[1];
-      ZMPPositionsY[i].theta = ZMPPositionsX[i].theta;
-      ZMPPositionsY[i].time = ZMPPositionsX[i].time;
-      ZMPPositionsY[i].stepType = ZMPPositionsX[i].stepType;
-	
-    }
-    
+  m_ZMPRefFilter.Reset();
+  for(unsigned int i=0;i<ZMPPositionsX.size();i++)
+    m_ZMPRefFilter.Filter(ZMPPositionsX[i],ZMPPositionsY[i]);
 }
 
 
@@ -1024,7 +999,7 @@ void ZMPDiscretization::DumpReferences(deque<ZMPPosition> & FinalZMPPositions,
 {
  
 
-  ofstream dbg_aof("DebugZMPRefPos.dat",ofstream::app);
+  ofstream dbg_aof(OutputFileName("DebugZMPRefPos.dat").c_str(),ofstream::app);
   for(unsigned int i=0;i<ZMPPositions.size();i++)
     {
       dbg_aof << ZMPPositions[i].px << " "
@@ -1032,7 +1007,7 @@ void ZMPDiscretization::DumpReferences(deque<ZMPPosition> & FinalZMPPositions,
     }
   dbg_aof.close();
   
-  dbg_aof.open("DebugFinalZMPRefPos.dat",ofstream::app);
+  dbg_aof.open(OutputFileName("DebugFinalZMPRefPos.dat").c_str(),ofstream::app);
   for(unsigned int i=0;i<FinalZMPPositions.size();i++)
     {
       dbg_aof << FinalZMPPositions[i].px << " "
@@ -1046,63 +1021,8 @@ void ZMPDiscretization::FilterOutValues(deque<ZMPPosition> &ZMPPositions,
 					deque<ZMPPosition> &FinalZMPPositions,
 					bool InitStep)
 {
-  unsigned int lshift=2;
   // Filter out the ZMP values.
-  for(unsigned int i=0;i<ZMPPositions.size();i++)
-    {
-      double ltmp[3]={0,0,0};
-
-      int o= FinalZMPPositions.size()-1-lshift;
-      for(unsigned int j=0;j<m_ZMPFilterWindow.size();j++)
-	{
-	  int r;
-	  r=i-j+lshift;
-	  if (r<0)
-	    {
-	      
-	      if (InitStep)
-		{
-		  ltmp[0] += m_ZMPFilterWindow[j]*ZMPPositions[lshift].px;
-		  ltmp[1] += m_ZMPFilterWindow[j]*ZMPPositions[lshift].py;
-		  ltmp[2] += m_ZMPFilterWindow[j]*ZMPPositions[lshift].pz;
-		}
-	      else
-		{
-		  if (-r<o)
-		    {
-		      ltmp[0] += m_ZMPFilterWindow[j]*FinalZMPPositions[o+r].px;
-		      ltmp[1] += m_ZMPFilterWindow[j]*FinalZMPPositions[o+r].py;
-		      ltmp[2] += m_ZMPFilterWindow[j]*FinalZMPPositions[o+r].pz;
-		    }
-		  else
-		    {
-		      ltmp[0] += m_ZMPFilterWindow[j]*FinalZMPPositions[0].px;
-		      ltmp[1] += m_ZMPFilterWindow[j]*FinalZMPPositions[0].py;
-		      ltmp[2] += m_ZMPFilterWindow[j]*FinalZMPPositions[0].pz;
-		    }
-		}
-	    }
-	  else
-	    {
-	      if (r>=(int)ZMPPositions.size())
-		r = ZMPPositions.size()-1;
-
-	      ltmp[0] += m_ZMPFilterWindow[j]*ZMPPositions[r].px;
-	      ltmp[1] += m_ZMPFilterWindow[j]*ZMPPositions[r].py;
-	      ltmp[2] += m_ZMPFilterWindow[j]*ZMPPositions[r].pz;
-	    }
-	}
-      
-      ZMPPosition aZMPPos;
-      aZMPPos.px = ltmp[0];
-      aZMPPos.py = ltmp[1];
-      aZMPPos.pz = ltmp[2];
-      aZMPPos.theta = ZMPPositions[i].theta;
-      aZMPPos.time = ZMPPositions[i].time;
-      aZMPPos.stepType = ZMPPositions[i].stepType;
-           
-      FinalZMPPositions.push_back(aZMPPos);
-    }
+  m_ZMPRefFilter.FilterOutValues(ZMPPositions,FinalZMPPositions,InitStep);
   ODEBUG("ZMPPosition.back=( " <<ZMPPositions.back().px << " , " << ZMPPositions.back().py << " )");
   ODEBUG("FinalZMPPosition.back=( " <<FinalZMPPositions.back().px << " , " << FinalZMPPositions.back().py << " )");
   ODEBUG("FinalZMPPositions.size()="<<FinalZMPPositions.size());
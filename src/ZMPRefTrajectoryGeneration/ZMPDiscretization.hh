@@ -53,6 +53,7 @@ using namespace::std;
 #include <jrl/walkgen/pgtypes.hh>
 #include <PreviewControl/PreviewControl.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
+#include <ZMPRefTrajectoryGeneration/ZMPRefFilter.hh>
 #include <FootTrajectoryGeneration/FootTrajectoryGenerationStandard.hh>
 
 namespace PatternGeneratorJRL
@@ -224,7 +225,9 @@ namespace PatternGeneratorJRL
 				  deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
 				  deque<FootAbsolutePosition> &RightFootAbsolutePositions);
 
-      /*! Filter out the ZMP values and put them at the back FinalZMPPositions. */
+      /*! Filter out the ZMP values and put them at the back FinalZMPPositions.
+	The filtering is done by m_ZMPRefFilter, which keeps the previously
+	filtered values. */
       void FilterOutValues(deque<ZMPPosition> &ZMPPositions,
 			   deque<ZMPPosition> &FinalZMPPositions,
 			   bool InitPhase);
@@ -291,6 +294,9 @@ namespace PatternGeneratorJRL
 
       /* ! Window for the filtering of the ZMP positions.. */
       std::vector<double> m_ZMPFilterWindow;
+
+      /* ! Streaming filter using m_ZMPFilterWindow. */
+      ZMPRefFilter m_ZMPRefFilter;
       
       /* ! Keep a stack of two steps as a reference before sending them to the 
       external queues. */
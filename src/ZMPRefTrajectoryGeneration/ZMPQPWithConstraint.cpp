@@ -79,6 +79,7 @@ ZMPQPWithConstraint::ZMPQPWithConstraint(SimplePluginManager *lSPM,
 
   m_SamplingPeriod = 0.005;
 
+  m_NbOfConstraintThreads = 2;
 }
 
 ZMPQPWithConstraint::~ZMPQPWithConstraint()
@@ -105,7 +106,7 @@ int ZMPQPWithConstraint::ComputeLinearSystem(vector<CH_Point> aVecOfPoints,
   if (1)
     {
       ofstream aof;
-      aof.open("Constraints.dat",ofstream::app);
+      aof.open(OutputFileName("Constraints.dat").c_str(),ofstream::app);
       for(unsigned int i=0;i<n-1;i++)
 	{
 	  aof << aVecOfPoints[i].col << " " <<  aVecOfPoints[i].row << " "
@@ -501,29 +502,17 @@ int ZMPQPWithConstraint::BuildLinearConstraintInequalities(deque<FootAbsolutePos
   return 0;
 }
 
-int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu, 
-					 unsigned N, double T,
-					 double StartingTime,
-					 deque<LinearConstraintInequality_t *> & QueueOfLConstraintInequalities,
-					 double Com_Height,
-					 unsigned int &NbOfConstraints,
-					 MAL_VECTOR(& xk,double))
+int ZMPQPWithConstraint::BuildConstraintWindow(unsigned N, double T,
+					       double Com_Height,
+					       deque<LinearConstraintInequality_t *> & QueueOfLConstraintInequalities,
+					       ConstraintWindow_t & aWindow)
 {
   // Discretize the problem.
   ODEBUG(" N:" << N << " T: " << T);
   
-  // Creates the matrices.
-  // The memory will be bounded to 8 constraints per
-  // support foot (double support case).
-  // Will be probably all the time smaller.
-  if (Px==0)
-    Px = new double[8*N+1];
-
-  if (Pu==0)
-    Pu = new double[(8*N+1)*2*N];
-
+  double StartingTime = aWindow.StartingTime;
+  double * Pu = aWindow.DPu;
   memset(Pu,0,(8*N+1)*2*N*sizeof(double));
-  //memset(Px,0,(8*N+1)*sizeof(double));
 
   deque<LinearConstraintInequality_t *>::iterator LCI_it, store_it;
   LCI_it = QueueOfLConstraintInequalities.begin();
@@ -546,21 +535,6 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
       return -1;
     }
       
-  if (0)
-    {
-      char Buffer[1024];
-      sprintf(Buffer,"PXD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer);
-      ODEBUG6("xk:" << xk << " Starting time: " <<StartingTime ,Buffer );
-      char Buffer2[1024];
-      sprintf(Buffer2,"PXxD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer2);
-      
-      char Buffer3[1024];
-      sprintf(Buffer3,"PXyD_%f.dat", StartingTime);
-      RESETDEBUG4(Buffer3);
-    }
-  
   // Compute first the number of constraint.
   unsigned int IndexConstraint=0;
   for(unsigned int i=0;i<N;i++)
@@ -576,7 +550,9 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 	}
       IndexConstraint += MAL_MATRIX_NB_ROWS((*LCI_it)->A);
     }  
-  NbOfConstraints = IndexConstraint;
+  unsigned int NbOfConstraints = IndexConstraint;
+  aWindow.NbOfConstraints = NbOfConstraints;
+  aWindow.NextNumberOfRemovedConstraints = MAL_MATRIX_NB_ROWS((*store_it)->A);
 
   LCI_it = store_it;
   IndexConstraint = 0;
@@ -593,29 +569,20 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 
       if (LCI_it==QueueOfLConstraintInequalities.end())
 	{
+	  break;
 	}
 
       // For each constraint.
       for(unsigned j=0;j<MAL_MATRIX_NB_ROWS((*LCI_it)->A);j++)
 	{
-	  Px[IndexConstraint] = 
-	    // X Axis * A
-	    (xk[0] +
-	     xk[1] * T *(i+1) + 
-	     xk[2]*((i+1)*(i+1)*T*T/2 - Com_Height/9.81))
-	    * (*LCI_it)->A(j,0)
-	     + 
-	     // Y Axis * A
-	    ( xk[3]+ xk[4]* T * (i+1) + 
-	       xk[5]*((i+1)*(i+1)*T*T/2 - Com_Height/9.81))	  
-	    * (*LCI_it)->A(j,1)
-	     // Constante part of the constraint
-	    + (*LCI_it)->B(j,0);
-
-	  ODEBUG6(Px[IndexConstraint] << " " << (*LCI_it)->A(j,0)  << " "
-		  << (*LCI_it)->A[j][1] << " " << (*LCI_it)->B(j,0) ,Buffer);
-	  ODEBUG6(1 << " " <<    T *(i+1) << " " <<    (i+1)*(i+1)*T*T/2 - Com_Height/9.81,Buffer2);
-	  ODEBUG6(1 << " " <<    T *(i+1) << " " <<    (i+1)*(i+1)*T*T/2 - Com_Height/9.81,Buffer3);
+	  // The constant part depends on the state, 
+	  // it is computed by ComputeConstraintsCstPart().
+	  aWindow.Ax[IndexConstraint] = (*LCI_it)->A(j,0);
+	  aWindow.Ay[IndexConstraint] = (*LCI_it)->A(j,1);
+	  aWindow.B[IndexConstraint] = (*LCI_it)->B(j,0);
+	  aWindow.Sample[IndexConstraint] = i;
+	  aWindow.SimilarConstraints[IndexConstraint]=(*LCI_it)->SimilarConstraints[j];
+
 	  for(unsigned k=0;k<=i;k++)
 	    {
 	      // X axis
@@ -635,13 +602,13 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 	}
 
     }
-  ODEBUG6("Index Constraint :"<< IndexConstraint,Buffer);
+  ODEBUG("Index Constraint :"<< IndexConstraint);
   if (0)
     {
       ofstream aof;
       char Buffer[1024];
       sprintf(Buffer,"Pu_%f.dat", StartingTime);
-      aof.open(Buffer,ofstream::out);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
       for(unsigned int i=0;i<IndexConstraint;i++)
 	{
 	  for(unsigned int j=0;j<2*N;j++)
@@ -649,17 +616,47 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 	  aof << endl;
 	}
       aof.close();
-      
-      sprintf(Buffer,"PX_%f.dat", StartingTime);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<IndexConstraint;i++)
+    }
+
+  return 0;
+}
+
+void ZMPQPWithConstraint::ComputeConstraintsCstPart(const ConstraintWindow_t & aWindow,
+						    double T,
+						    double Com_Height,
+						    MAL_VECTOR(& xk,double),
+						    double * Px)
+{
+  for(unsigned int c=0;c<aWindow.NbOfConstraints;c++)
+    {
+      unsigned int i = aWindow.Sample[c];
+      Px[c] = 
+	// X Axis * A
+	(xk[0] +
+	 xk[1] * T *(i+1) + 
+	 xk[2]*((i+1)*(i+1)*T*T/2 - Com_Height/9.81))
+	* aWindow.Ax[c]
+	+ 
+	// Y Axis * A
+	( xk[3]+ xk[4]* T * (i+1) + 
+	  xk[5]*((i+1)*(i+1)*T*T/2 - Com_Height/9.81))	  
+	* aWindow.Ay[c]
+	// Constante part of the constraint
+	+ aWindow.B[c];
+    }
+
+  if (0)
+    {
+      ofstream aof;
+      char Buffer[1024];
+      sprintf(Buffer,"PX_%f.dat", aWindow.StartingTime);
+      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
+      for(unsigned int i=0;i<aWindow.NbOfConstraints;i++)
 	{
 	  aof << Px[i] << endl ;
 	}
       aof.close();
     }
-
-  return 0;
 }
 
 int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
@@ -677,7 +674,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   //  unsigned int N = 100;
   //  double ComHeight=0.814;
   double ComHeight=0.80;
-  double *Px=0,*Pu=0;
+  double *Px=new double[8*N+1],*Pu=0;
   unsigned int NbOfConstraints=8*N; // Nb of constraints to be taken into account
   // for each iteration
   MAL_VECTOR(xk,double);MAL_VECTOR(Buk,double);MAL_VECTOR(zk,double);
@@ -772,19 +769,19 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   if (0)
     {
       ofstream aof;
-      aof.open("VPx.dat");
+      aof.open(OutputFileName("VPx.dat").c_str());
       aof << VPx;
       aof.close();
       
-      aof.open("PPx.dat");
+      aof.open(OutputFileName("PPx.dat").c_str());
       aof << PPx;
       aof.close();
       
-      aof.open("VPu.dat");
+      aof.open(OutputFileName("VPu.dat").c_str());
       aof << VPu;
       aof.close();
       
-      aof.open("PPu.dat");
+      aof.open(OutputFileName("PPu.dat").c_str());
       aof << PPu;
       aof.close();
     }
@@ -947,7 +944,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	  ofstream aof;
 	  char Buffer[1024];
 	  sprintf(Buffer,"C.dat");
-	  aof.open(Buffer,ofstream::out);
+	  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	  for(unsigned int i=0;i<2*N;i++)
 	    {
 	      for(unsigned int j=0;j<2*N-1;j++)
@@ -972,7 +969,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
     ofstream aof;
     char Buffer[1024];
     sprintf(Buffer,"OptB.dat");
-    aof.open(Buffer,ofstream::out);
+    aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
     for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(OptB);i++)
       {
 	for(unsigned int j=0;j<MAL_MATRIX_NB_COLS(OptB)-1;j++)
@@ -991,7 +988,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
     ofstream aof;
     char Buffer[1024];
     sprintf(Buffer,"OptC.dat");
-    aof.open(Buffer,ofstream::out);
+    aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
     for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(OptC);i++)
       {
 	for(unsigned int j=0;j<MAL_MATRIX_NB_COLS(OptC)-1;j++)
@@ -1012,20 +1009,42 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   ODEBUG("Ending time: " << QueueOfLConstraintInequalities.back()->EndingTime);
   ODEBUG("Loop: 0.0 " << QueueOfLConstraintInequalities.back()->EndingTime- N*T << " " 
 	  << " T: " << T << " N: " << N << " interval " << interval);
+
+  // The constraints of the next windows are built 
+  // while the current one is solved.
+  vector<double> StartingTimes;
   for(double StartingTime=0.0;
       StartingTime<QueueOfLConstraintInequalities.back()->EndingTime-
 	N*T;
-      StartingTime+=T,li++)
+      StartingTime+=T)
+    StartingTimes.push_back(StartingTime);
+
+  ConstraintWindowPipeline aPipeline(this,N,
+				     m_NbOfConstraintThreads,
+				     2*m_NbOfConstraintThreads+2);
+  aPipeline.Start(StartingTimes,T,ComHeight,
+		  QueueOfLConstraintInequalities);
+
+  // The work buffers are released below whatever the outcome.
+  int lStatus = 0;
+  for(li=0;li<(int)StartingTimes.size();li++)
     {
+      double StartingTime = StartingTimes[li];
       gettimeofday(&start,0);
-      // Build the related matrices.
-      BuildMatricesPxPu(Px,Pu,
-			N,T,
-			StartingTime,
-			QueueOfLConstraintInequalities,
-			ComHeight,
-			NbOfConstraints,
-			xk);
+      // Get the related matrices.
+      ConstraintWindow_t * aWindow = aPipeline.Next();
+      if (aWindow->Status<0)
+	{
+	  cout << "Unable to build the constraints at time: " 
+	       << StartingTime << endl;
+	  lStatus = -1;
+	  break;
+	}
+      Pu = aWindow->DPu;
+      NbOfConstraints = aWindow->NbOfConstraints;
+
+      // Only the constant part depends on the current state.
+      ComputeConstraintsCstPart(*aWindow,T,ComHeight,xk,Px);
       
 
       m = NbOfConstraints;
@@ -1048,7 +1067,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	  ofstream aof;
 	  char Buffer[1024];
 	  sprintf(Buffer,"ZMPRef_%f.dat",StartingTime);
-	  aof.open(Buffer,ofstream::out);
+	  aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	  for(unsigned int i=0;i<2*N;i++)
 	    {
 	      aof << ZMPRef[i] << endl;
@@ -1070,7 +1089,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	      ofstream aof;
 	      char Buffer[1024];
 	      sprintf(Buffer,"D_%f.dat",StartingTime);
-	      aof.open(Buffer,ofstream::out);
+	      aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	      for(unsigned int i=0;i<2*N;i++)
 		{
 		  aof << OptD[i] << endl;
@@ -1136,7 +1155,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	ofstream aof;
 	char Buffer[1024];
 	sprintf(Buffer,"X_%f.dat",StartingTime);
-	aof.open(Buffer,ofstream::out);
+	aof.open(OutputFileName(Buffer).c_str(),ofstream::out);
 	for(unsigned int i=0;i<2*N;i++)
 	  {
 	    aof << X[i] << endl;
@@ -1271,12 +1290,14 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	     " Virtual time to simulate: " << QueueOfLConstraintInequalities.back()->EndingTime - StartingTime << 
 	     "Computation Time " << CurrentCPUTime << " " << TotalAmountOfCPUTime);
 
+      aPipeline.Release();
     }
+  aPipeline.Stop();
 
   if (0)
     {
       ofstream aof;
-      aof.open("StorePx.dat",ofstream::out);
+      aof.open(OutputFileName("StorePx.dat").c_str(),ofstream::out);
       
       for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(vnlStorePx);i++)
 	{
@@ -1291,7 +1312,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
       
       char lBuffer[1024];
       sprintf(lBuffer,"StoreX.dat");
-      aof.open(lBuffer,ofstream::out);
+      aof.open(OutputFileName(lBuffer).c_str(),ofstream::out);
       
       for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(vnlStoreX);i++)
 	{
@@ -1303,7 +1324,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	}
       aof.close();
       
-      aof.open("Cnb.dat",ofstream::out);
+      aof.open(OutputFileName("Cnb.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<MAL_VECTOR_SIZE(ConstraintNb);i++)
 	{
 	  aof << ConstraintNb[i]<<endl;
@@ -1313,6 +1334,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   
   /*  cout << "Size of PX: " << MAL_MATRIX_NB_ROWS(vnlStorePx) << " " 
       << MAL_MATRIX_NB_COLS(vnlStorePx) << " " << endl; */
+  delete [] Px;
   delete C;
   delete D;
   delete XL;
@@ -1333,7 +1355,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
     }
   QueueOfLConstraintInequalities.clear();
   
-  return 0;
+  return lStatus;
 }
 
 
@@ -1375,7 +1397,7 @@ void ZMPQPWithConstraint::GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions
   if (1)
     {
       ofstream aof;
-      aof.open("DebugPBWZMP.dat",ofstream::out);
+      aof.open(OutputFileName("DebugPBWZMP.dat").c_str(),ofstream::out);
       for(unsigned int i=0;i<ZMPPositions.size();i++)
 	{
 	  aof << ZMPPositions[i].px << " " << ZMPPositions[i].py << endl;
@@ -1409,6 +1431,12 @@ void ZMPQPWithConstraint::CallMethod(std::string & Method, std::istringstream &s
 	  strm >> m_QP_N;
 	  cout << "Preview window for the QP " << m_QP_N << endl;
 	}
+      else if (PBWCmd=="THREADS")
+	{
+	  strm >> m_NbOfConstraintThreads;
+	  cout << "Threads building the constraints " 
+	       << m_NbOfConstraintThreads << endl;
+	}
     }
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
 }
@@ -32,11 +32,13 @@
 
 #include <Mathematics/ConvexHull.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
+#include <ZMPRefTrajectoryGeneration/ConstraintWindowPipeline.hh>
 
 namespace PatternGeneratorJRL
 {
   class ZMPDiscretization;
-  class  ZMPQPWithConstraint : public ZMPRefTrajectoryGeneration
+  class  ZMPQPWithConstraint : public ZMPRefTrajectoryGeneration,
+    public ConstraintWindowBuilder
   {
     
   public:
@@ -111,15 +113,22 @@ namespace PatternGeneratorJRL
 					     double T,
 					     unsigned int N);
     
-    /*! Build the necessary matrices for the QP problem under linear inequality constraints. */
-    int BuildMatricesPxPu(double * &Px, double * &Pu,
-			  unsigned N, double T,
-			  double StartingTime,
-			  deque<LinearConstraintInequality_t *> 
-			  & QueueOfLConstraintInequalities,
-			  double Com_Height,
-			  unsigned int &NbOfConstraints,
-			  MAL_VECTOR(&xk,double));
+    /*! Build the part of the matrices for the QP problem under linear 
+      inequality constraints which does not depend on the state of the CoM.
+      This method is called by the threads of the constraint pipeline. */
+    int BuildConstraintWindow(unsigned N, double T,
+			      double Com_Height,
+			      deque<LinearConstraintInequality_t *> 
+			      & QueueOfLConstraintInequalities,
+			      ConstraintWindow_t & aWindow);
+
+    /*! Compute the constant part of the constraints of \a aWindow
+      for the current state \a xk. */
+    void ComputeConstraintsCstPart(const ConstraintWindow_t & aWindow,
+				   double T,
+				   double Com_Height,
+				   MAL_VECTOR(&xk,double),
+				   double * Px);
     
     /*! This method helps to build a linear system for constraining the ZMP. */
     int ComputeLinearSystem(std::vector<CH_Point> aVecOfPoints,
@@ -226,6 +235,9 @@ namespace PatternGeneratorJRL
     /*! Preview window */
     unsigned int m_QP_N;
 
+    /*! Number of threads building the constraints ahead of the solver. */
+    unsigned int m_NbOfConstraintThreads;
+
   };
 }
 
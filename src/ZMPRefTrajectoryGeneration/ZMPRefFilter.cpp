@@ -0,0 +1,200 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#include <ZMPRefTrajectoryGeneration/ZMPRefFilter.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+ZMPRefFilter::ZMPRefFilter():
+  m_Head(0),
+  m_NbOfSamples(0),
+  m_LookAhead(0),
+  m_FilteredHead(0),
+  m_NbOfFilteredValues(0)
+{
+}
+
+void ZMPRefFilter::SetWindow(const vector<double> & aWindow,
+			     unsigned int LookAhead)
+{
+  m_Window = aWindow;
+  m_LookAhead = LookAhead;
+  m_History.resize(4*m_Window.size());
+  m_FilteredValues.resize(6*m_Window.size());
+  Reset();
+}
+
+void ZMPRefFilter::Reset()
+{
+  m_Head = 0;
+  m_NbOfSamples = 0;
+  for(unsigned int i=0;i<m_History.size();i++)
+    m_History[i] = 0.0;
+
+  m_FilteredHead = 0;
+  m_NbOfFilteredValues = 0;
+  for(unsigned int i=0;i<m_FilteredValues.size();i++)
+    m_FilteredValues[i] = 0.0;
+}
+
+void ZMPRefFilter::Filter(const ZMPPosition & aZMPPosition,
+			  ZMPPosition & FilteredZMPPosition)
+{
+  unsigned int n = m_Window.size();
+  FilteredZMPPosition = aZMPPosition;
+  if (n==0)
+    return;
+
+  // Store the new sample in front of the previous ones.
+  m_Head = (m_Head==0) ? n-1 : m_Head-1;
+  double * lNewSample = &m_History[2*m_Head];
+  lNewSample[0] = lNewSample[2*n] = aZMPPosition.px;
+  lNewSample[1] = lNewSample[2*n+1] = aZMPPosition.py;
+  m_NbOfSamples++;
+
+  if (m_NbOfSamples<=n)
+    return;
+
+  double ltmp[2]={0,0};
+  const double * lSample = lNewSample;
+  for(unsigned int j=0;j<n;j++)
+    {
+      ltmp[0] += m_Window[j]*lSample[0];
+      ltmp[1] += m_Window[j]*lSample[1];
+      lSample+=2;
+    }
+  FilteredZMPPosition.px = ltmp[0];
+  FilteredZMPPosition.py = ltmp[1];
+}
+
+void ZMPRefFilter::Filter(const deque<ZMPPosition> & ZMPPositions,
+			  unsigned int First,
+			  deque<ZMPPosition> & FilteredZMPPositions)
+{
+  for(unsigned int i=First;i<ZMPPositions.size();i++)
+    {
+      ZMPPosition aZMPPos;
+      Filter(ZMPPositions[i],aZMPPos);
+      FilteredZMPPositions.push_back(aZMPPos);
+    }
+}
+
+void ZMPRefFilter::FilterOutValues(const deque<ZMPPosition> & ZMPPositions,
+				   deque<ZMPPosition> & FinalZMPPositions,
+				   bool InitStep)
+{
+  unsigned int n = m_Window.size();
+  unsigned int lNbOfNewValues = ZMPPositions.size();
+  if (lNbOfNewValues==0)
+    return;
+
+  if (InitStep)
+    {
+      m_FilteredHead = 0;
+      m_NbOfFilteredValues = 0;
+    }
+
+  // Contiguous copy of the new samples.
+  m_NewValues.resize(3*lNbOfNewValues);
+  for(unsigned int i=0;i<lNbOfNewValues;i++)
+    {
+      m_NewValues[3*i] = ZMPPositions[i].px;
+      m_NewValues[3*i+1] = ZMPPositions[i].py;
+      m_NewValues[3*i+2] = ZMPPositions[i].pz;
+    }
+
+  // Value used before the first new sample at the initial step.
+  unsigned int lInitSample = m_LookAhead<lNbOfNewValues ? 
+    m_LookAhead : lNbOfNewValues-1;
+
+  for(unsigned int i=0;i<lNbOfNewValues;i++)
+    {
+      double ltmp[3]={0,0,0};
+      unsigned int j=0;
+
+      // New samples, the look ahead stops at the last one.
+      for(;(j<n) && (j<=i+m_LookAhead);j++)
+	{
+	  unsigned int r = i+m_LookAhead-j;
+	  if (r>=lNbOfNewValues)
+	    r = lNbOfNewValues-1;
+	  const double * lValue = &m_NewValues[3*r];
+	  ltmp[0] += m_Window[j]*lValue[0];
+	  ltmp[1] += m_Window[j]*lValue[1];
+	  ltmp[2] += m_Window[j]*lValue[2];
+	}
+
+      // Samples before the new part.
+      int o = FinalZMPPositions.size()-1-m_LookAhead;
+      for(;j<n;j++)
+	{
+	  int r = i-j+m_LookAhead;
+	  double lOldValue[3];
+	  const double * lValue = lOldValue;
+	  if ((InitStep) || (FinalZMPPositions.size()==0))
+	    lValue = &m_NewValues[3*lInitSample];
+	  else
+	    {
+	      const ZMPPosition * aZMPPos = &FinalZMPPositions[0];
+	      if (-r<o)
+		{
+		  // Filtered value j-i periods before the last one.
+		  unsigned int lBack = j-i;
+		  if (lBack<m_NbOfFilteredValues)
+		    lValue = &m_FilteredValues[3*(m_FilteredHead+lBack)];
+		  else
+		    aZMPPos = &FinalZMPPositions[o+r];
+		}
+	      if (lValue==lOldValue)
+		{
+		  lOldValue[0] = aZMPPos->px;
+		  lOldValue[1] = aZMPPos->py;
+		  lOldValue[2] = aZMPPos->pz;
+		}
+	    }
+	  ltmp[0] += m_Window[j]*lValue[0];
+	  ltmp[1] += m_Window[j]*lValue[1];
+	  ltmp[2] += m_Window[j]*lValue[2];
+	}
+
+      ZMPPosition aZMPPos;
+      aZMPPos.px = ltmp[0];
+      aZMPPos.py = ltmp[1];
+      aZMPPos.pz = ltmp[2];
+      aZMPPos.theta = ZMPPositions[i].theta;
+      aZMPPos.time = ZMPPositions[i].time;
+      aZMPPos.stepType = ZMPPositions[i].stepType;
+      FinalZMPPositions.push_back(aZMPPos);
+
+      // Keep the filtered value in front of the previous ones.
+      if (n==0)
+	continue;
+      m_FilteredHead = (m_FilteredHead==0) ? n-1 : m_FilteredHead-1;
+      double * lNewValue = &m_FilteredValues[3*m_FilteredHead];
+      lNewValue[0] = lNewValue[3*n] = ltmp[0];
+      lNewValue[1] = lNewValue[3*n+1] = ltmp[1];
+      lNewValue[2] = lNewValue[3*n+2] = ltmp[2];
+      m_NbOfFilteredValues++;
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ZMPRefFilter.hh
+  \brief Streaming filter of the ZMP reference trajectory.
+*/
+
+#ifndef _ZMP_REF_FILTER_H_
+#define _ZMP_REF_FILTER_H_
+
+#include <vector>
+#include <deque>
+
+#include <jrl/walkgen/pgtypes.hh>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Filter the ZMP positions by a finite window,
+    one sample at a time.
+
+    The last samples are kept in a ring buffer, so that the samples
+    can be filtered as they are appended to the trajectory.
+    The positions along X and Y are stored side by side and filtered
+    together. The samples are summed from the most recent one, as
+    ZMPDiscretization::FilterZMPRef used to do on the whole trajectory.
+
+    FilterOutValues is the filter used by ZMPDiscretization when
+    the trajectory is extended: it looks ahead a few samples in the
+    new part of the trajectory, and takes the older samples among the
+    values it filtered previously. These are kept in a second ring buffer.
+  */
+  class ZMPRefFilter
+  {
+  public:
+    /*! \brief Default constructor, with an empty window. */
+    ZMPRefFilter();
+
+    /*! \brief Set the window of the filter, and reset the history.
+      aWindow[j] is the weight of the sample j periods before.
+      \param LookAhead: Number of samples FilterOutValues looks ahead. */
+    void SetWindow(const std::vector<double> & aWindow,
+		   unsigned int LookAhead=0);
+
+    /*! \brief Forget the samples previously filtered. */
+    void Reset();
+
+    /*! \brief Filter the next sample of the trajectory.
+      As long as the history does not contain one sample more than
+      the window, the sample is not modified. Otherwise only px and
+      py are filtered. */
+    void Filter(const ZMPPosition & aZMPPosition,
+		ZMPPosition & FilteredZMPPosition);
+
+    /*! \brief Filter the samples of \a ZMPPositions starting
+      from \a First, and put them at the back of \a FilteredZMPPositions. */
+    void Filter(const std::deque<ZMPPosition> & ZMPPositions,
+		unsigned int First,
+		std::deque<ZMPPosition> & FilteredZMPPositions);
+
+    /*! \brief Filter the new part of the trajectory \a ZMPPositions
+      and put it at the back of \a FinalZMPPositions.
+      The weight j applies to the sample j-LookAhead periods before,
+      the look ahead is bounded by the last new sample.
+      The samples before the new part are the previously filtered
+      values, or, if \a InitStep is true, the sample LookAhead of the
+      new part. px, py and pz are filtered, the other fields are
+      copied from the new samples. */
+    void FilterOutValues(const std::deque<ZMPPosition> & ZMPPositions,
+			 std::deque<ZMPPosition> & FinalZMPPositions,
+			 bool InitStep);
+
+    /*! \brief Number of samples filtered since the last reset. */
+    unsigned long int NbOfSamples() const
+    { return m_NbOfSamples; }
+
+  private:
+    /*! Window of the filter. */
+    std::vector<double> m_Window;
+
+    /*! Ring buffer of the (x,y) positions. Each sample is
+      stored twice, at m_Head and m_Head+size of the window,
+      so that the window always reads a contiguous block
+      starting with the most recent sample. */
+    std::vector<double> m_History;
+
+    /*! Position of the most recent sample in the ring buffer. */
+    unsigned int m_Head;
+
+    /*! Number of samples filtered since the last reset. */
+    unsigned long int m_NbOfSamples;
+
+    /*! Number of samples FilterOutValues looks ahead. */
+    unsigned int m_LookAhead;
+
+    /*! Ring buffer of the (x,y,z) values filtered by FilterOutValues,
+      stored twice as in m_History. */
+    std::vector<double> m_FilteredValues;
+
+    /*! Position of the most recent filtered value. */
+    unsigned int m_FilteredHead;
+
+    /*! Number of values filtered by FilterOutValues since the last reset. */
+    unsigned long int m_NbOfFilteredValues;
+
+    /*! Contiguous copy of the (x,y,z) new samples. */
+    std::vector<double> m_NewValues;
+  };
+}
+#endif /* _ZMP_REF_FILTER_H_ */
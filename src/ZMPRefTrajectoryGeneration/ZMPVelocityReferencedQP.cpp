@@ -46,6 +46,7 @@
 #include <Mathematics/qld.hh>
 #include <privatepgtypes.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPVelocityReferencedQP.hh>
+#include <StageProfiler.hh>
 
 #include <Debug.hh>
 using namespace std;
@@ -56,7 +57,7 @@ using namespace PatternGeneratorJRL;
 ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
     string , CjrlHumanoidDynamicRobot *aHS) :
     ZMPRefTrajectoryGeneration(SPM),
-    Robot_(0),SupportFSM_(0),OrientPrw_(0),VRQPGenerator_(0),IntermedData_(0),RFI_(0),Problem_(),Solution_()
+    Robot_(0),SupportFSM_(0),OrientPrw_(0),VRQPGenerator_(0),IntermedData_(0),RFI_(0),Problem_(),Solution_(),Solver_(QLD)
 {
   Running_ = false;
   TimeBuffer_ = 0.04;
@@ -118,11 +119,12 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
   VRQPGenerator_->Ponderation( 0.00001, JERK_MIN );
 
   // Register method to handle
-  const unsigned int NbMethods = 3;
+  const unsigned int NbMethods = 4;
   string aMethodName[NbMethods] =
       {":previewcontroltime",
           ":numberstepsbeforestop",
-          ":stoppg"};
+          ":stoppg",
+          ":qpsolver"};
 
   for(unsigned int i=0;i<NbMethods;i++)
     {
@@ -204,6 +206,20 @@ void ZMPVelocityReferencedQP::CallMethod(std::string & Method, std::istringstrea
     {
       EndingPhase_ = true;
     }
+  if (Method==":qpsolver")
+    {
+      string SolverName;
+      strm >> SolverName;
+      if (SolverName=="QLD")
+        Solver_ = QLD;
+      else if (SolverName=="LSSOL")
+        Solver_ = LSSOL;
+      else if (SolverName=="PLDP")
+        Solver_ = PLDP;
+      else
+        std::cerr << "Unknown QP solver " << SolverName << std::endl;
+      Problem_.precompute_invariant_part( Solver_ );
+    }
 
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
 
@@ -314,6 +330,7 @@ ZMPVelocityReferencedQP::InitOnLine(deque<ZMPPosition> & FinalZMPTraj_deq,
   Problem_.nbInvariantRows(2*QP_N_);
   Problem_.nbInvariantCols(2*QP_N_);
   VRQPGenerator_->build_invariant_part( Problem_ );
+  Problem_.precompute_invariant_part( Solver_ );
 
   return 0;
 }
@@ -359,11 +376,17 @@ ZMPVelocityReferencedQP::OnLine(double time,
 
       // PREVIEW SUPPORT STATES FOR THE WHOLE PREVIEW WINDOW:
       // ----------------------------------------------------
+      StageTimer aStageTimer(StageProfiler::SUPPORT_PREVIEW);
       VRQPGenerator_->preview_support_states( time, SupportFSM_,
           FinalLeftFootTraj_deq, FinalRightFootTraj_deq, Solution_.SupportStates_deq );
+      if (Solution_.SupportStates_deq.size() &&
+          Solution_.SupportStates_deq[0].StateChanged &&
+          StageProfiler::Current()!=0)
+        StageProfiler::Current()->Mark("NewStep");
 
       // COMPUTE ORIENTATIONS OF FEET FOR WHOLE PREVIEW PERIOD:
       // ------------------------------------------------------
+      aStageTimer.Start(StageProfiler::ORIENTATION_PREVIEW);
       OrientPrw_->preview_orientations( time, VelRef_,
           SupportFSM_->StepPeriod(),
           FinalLeftFootTraj_deq, FinalRightFootTraj_deq,
@@ -372,12 +395,16 @@ ZMPVelocityReferencedQP::OnLine(double time,
 
       // UPDATE THE DYNAMICS:
       // --------------------
+      aStageTimer.Start(StageProfiler::DYNAMICS_UPDATE);
       Robot_->update( Solution_.SupportStates_deq,
           FinalLeftFootTraj_deq, FinalRightFootTraj_deq );
 
 
       // COMPUTE REFERENCE IN THE GLOBAL FRAME:
       // --------------------------------------
+      // The variant part of the objective is counted
+      // with the constraints.
+      aStageTimer.Start(StageProfiler::CONSTRAINT_BUILD);
       VRQPGenerator_->compute_global_reference( Solution_ );
 
 
@@ -393,9 +420,11 @@ ZMPVelocityReferencedQP::OnLine(double time,
 
       // SOLVE PROBLEM:
       // --------------
-      if (Solution_.useWarmStart)
+      aStageTimer.Start(StageProfiler::QP_SOLVE);
+      // PLDP is a primal method and needs a feasible initial solution.
+      if (Solution_.useWarmStart || Solver_ == PLDP)
     	  VRQPGenerator_->compute_warm_start( Solution_ );//TODO: Move to update_problem or build_constraints?
-      Problem_.solve( QLD, Solution_, NONE );
+      Problem_.solve( Solver_, Solution_, NONE );
       if(Solution_.Fail>0)
       {
           Problem_.dump( time );
@@ -404,6 +433,7 @@ ZMPVelocityReferencedQP::OnLine(double time,
 
       // INTERPOLATE THE NEXT COMPUTED COM STATE:
       // ----------------------------------------
+      aStageTimer.Start(StageProfiler::INTERPOLATION);
       unsigned currentIndex = FinalCOMTraj_deq.size();
       FinalCOMTraj_deq.resize( (unsigned)(QP_T_/m_SamplingPeriod)+currentIndex );
       FinalZMPTraj_deq.resize( (unsigned)(QP_T_/m_SamplingPeriod)+currentIndex );
@@ -198,6 +198,9 @@ namespace PatternGeneratorJRL
     /// \brief Previewed Solution
     solution_t Solution_;
 
+    /// \brief Solver of the final optimization problem
+    solver_e Solver_;
+
 
 
 
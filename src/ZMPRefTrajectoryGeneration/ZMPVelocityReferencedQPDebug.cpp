@@ -63,11 +63,11 @@ void ZMPVelocityReferencedQP::debugConstructor()
   if(m_FullDebug>2)
     {
       ofstream aof;
-      aof.open("/tmp/Trunk.dat",ofstream::out);
+      aof.open(OutputFileName("Trunk.dat","/tmp").c_str(),ofstream::out);
       aof.close();
-      aof.open("/tmp/time.dat",ofstream::out);
+      aof.open(OutputFileName("time.dat","/tmp").c_str(),ofstream::out);
       aof.close();
-      aof.open("/tmp/FootPositionsT.dat",ofstream::out);
+      aof.open(OutputFileName("FootPositionsT.dat","/tmp").c_str(),ofstream::out);
       aof.close();
     }
 }
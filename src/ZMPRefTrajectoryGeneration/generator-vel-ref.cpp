@@ -233,8 +233,7 @@ void
 GeneratorVelRef::initialize_matrices()
 {
 
-  linear_inequality_t & IneqCoP = IntermedData_->Inequalities( INEQ_COP );
-  initialize_matrices( IneqCoP );
+  IneqCoP_.resize( 4*N_ );
   linear_inequality_t & IneqCoM = IntermedData_->Inequalities( INEQ_COM );
   initialize_matrices( IneqCoM );
 
@@ -282,30 +281,32 @@ GeneratorVelRef::initialize_matrices( linear_inequality_t & Inequalities)
 
 
 void 
-GeneratorVelRef::build_inequalities_cop(linear_inequality_t & Inequalities,
+GeneratorVelRef::build_inequalities_cop(sampled_inequalities_t & Inequalities,
     const std::deque<support_state_t> & SupportStates_deq) const
 {
 
   deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
 
   const unsigned nbEdges = 4;
-  const unsigned nbIneq = 4;
-  convex_hull_t CoPHull( nbEdges, nbIneq );
-  RFI_->set_vertices( CoPHull, *prwSS_it, INEQ_COP );
+  Inequalities.resize( nbEdges*N_ );
+  // The vertices are adapted to a new support state only
+  const support_state_t * VerticesSupport = &(*prwSS_it);
 
   ++prwSS_it;//Point at the first previewed instant
   for( unsigned i=0; i<N_; i++ )
     {
       if( prwSS_it->StateChanged )
-        RFI_->set_vertices( CoPHull, *prwSS_it, INEQ_COP );
+        VerticesSupport = &(*prwSS_it);
 
-      RFI_->compute_linear_system( CoPHull, *prwSS_it );
+      const convex_hull_t & CoPHull =
+        RFI_->get_linear_system( *VerticesSupport, *prwSS_it, INEQ_COP );
 
       for( unsigned j = 0; j < nbEdges; j++ )
         {
-          Inequalities.D.X_mat.push_back( i*nbEdges+j, i, CoPHull.A_vec[j] );
-          Inequalities.D.Y_mat.push_back( i*nbEdges+j, i, CoPHull.B_vec[j] );
-          Inequalities.Dc_vec( i*nbEdges+j ) = CoPHull.D_vec[j];
+          Inequalities.X_vec[i*nbEdges+j] = CoPHull.A_vec[j];
+          Inequalities.Y_vec[i*nbEdges+j] = CoPHull.B_vec[j];
+          Inequalities.Dc_vec[i*nbEdges+j] = CoPHull.D_vec[j];
+          Inequalities.Sample_vec[i*nbEdges+j] = i;
         }
 
       ++prwSS_it;
@@ -321,8 +322,6 @@ GeneratorVelRef::build_inequalities_feet( linear_inequality_t & Inequalities,
 
   // Arrays for the generated set of inequalities
   const unsigned nbEdges = 5;
-  const unsigned nbIneq = 5;
-  convex_hull_t FeetHull( nbEdges, nbIneq );
 
   unsigned nbSteps = SupportStates_deq.back().StepNumber;
   Inequalities.resize(nbEdges*nbSteps,nbSteps, false);
@@ -334,11 +333,9 @@ GeneratorVelRef::build_inequalities_feet( linear_inequality_t & Inequalities,
       //foot positioning constraints
       if( prwSS_it->StateChanged && prwSS_it->StepNumber>0 && prwSS_it->Phase != DS)
         {
-          prwSS_it--;//Take the support state before
-          RFI_->set_vertices( FeetHull, *prwSS_it, INEQ_FEET );
-          prwSS_it++;
-
-          RFI_->compute_linear_system( FeetHull, *prwSS_it );
+          //The vertices are defined by the support state before
+          const convex_hull_t & FeetHull =
+            RFI_->get_linear_system( *(prwSS_it-1), *prwSS_it, INEQ_FEET );
 
           for( unsigned j = 0; j < nbEdges; j++ )
             {
@@ -391,59 +388,55 @@ GeneratorVelRef::build_inequalities_com(linear_inequality_t & Inequalities,
 
 
 void
-GeneratorVelRef::build_constraints_cop(const linear_inequality_t & IneqCoP,
+GeneratorVelRef::build_constraints_cop(const sampled_inequalities_t & IneqCoP,
     unsigned int NbStepsPreviewed, QPProblem & Pb)
 {
 
   unsigned int NbConstraints = Pb.NbConstraints();
 
-  // -D*U
-  compute_term  ( MM_, -1.0, IneqCoP.D.X_mat, Robot_->DynamicsCoPJerk().U       );
-  Pb.add_term_to( MATRIX_DU, MM_, NbConstraints, 0                              );
-  compute_term  ( MM_, -1.0, IneqCoP.D.Y_mat, Robot_->DynamicsCoPJerk().U       );
-  Pb.add_term_to( MATRIX_DU, MM_, NbConstraints, N_                             );
+  const boost_ublas::matrix<double> & U = Robot_->DynamicsCoPJerk().U;
+  const boost_ublas::matrix<double> & S = Robot_->DynamicsCoPJerk().S;
+  const IntermedQPMat::state_variant_t & State = IntermedData_->State();
+  const boost_ublas::matrix<double> & V = State.V;
+
+  // Each row only depends on its sample,
+  // the blocks are filled row by row from the rows of U, V and S.
+  const unsigned nbRows = IneqCoP.X_vec.size();
+  const unsigned nbSteps = V.size2();
+  const unsigned nbCols = 2*N_+NbStepsPreviewed+nbSteps;
+  DUBlock_.assign( nbRows*nbCols, 0.0 );
+  DSBlock_.resize( nbRows, false );
 
+  // S*x, S*y
+  MV_ = MAL_RET_A_by_B( S, State.CoM.x );
+  MV2_ = MAL_RET_A_by_B( S, State.CoM.y );
 
-  // +D*V
-  compute_term  ( MM_, 1.0, IneqCoP.D.X_mat, IntermedData_->State().V 			);
-  // +  Robot_->LeftFoot().Dynamics(COP).U + Robot_->RightFoot().Dynamics(COP).U        );
-  Pb.add_term_to( MATRIX_DU, MM_, NbConstraints, 2*N_                                   );
-  compute_term  ( MM_, 1.0, IneqCoP.D.Y_mat, IntermedData_->State().V  			);
-  // +  Robot_->LeftFoot().Dynamics(COP).U + Robot_->RightFoot().Dynamics(COP).U        );
-  Pb.add_term_to( MATRIX_DU, MM_, NbConstraints, 2*N_+NbStepsPreviewed                  );
+  for( unsigned r = 0; r < nbRows; r++ )
+    {
+      const unsigned i = IneqCoP.Sample_vec[r];
+      const double Dx = IneqCoP.X_vec[r], Dy = IneqCoP.Y_vec[r];
 
-  //constant part
-  // +dc
-  Pb.add_term_to( VECTOR_DS,IneqCoP.Dc_vec, NbConstraints               );
-
-  // -D*S_z*x
-  compute_term  ( MV_, -1.0, IneqCoP.D.X_mat, Robot_->DynamicsCoPJerk().S, IntermedData_->State().CoM.x         );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                                );
-  /*
-   * Usefull for multibody dynamics
-   *
-  compute_term  ( MV_, -1.0, IneqCoP.D.x, Robot_->LeftFoot().Dynamics(COP).S, Robot_->LeftFoot().State().X   );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                  );
-  compute_term  ( MV_, -1.0, IneqCoP.D.x, Robot_->RightFoot().Dynamics(COP).S, Robot_->RightFoot().State().X );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                  );
-   */
-  compute_term  ( MV_, -1.0, IneqCoP.D.Y_mat,  Robot_->DynamicsCoPJerk().S, IntermedData_->State().CoM.y        );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                                );
-  /*
-   * Usefull for multibody dynamics
-   *
-  compute_term  ( MV_, -1.0, IneqCoP.D.y, Robot_->LeftFoot().Dynamics(COP).S, Robot_->LeftFoot().State().Y   );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                  );
-  compute_term  ( MV_, -1.0, IneqCoP.D.y, Robot_->RightFoot().Dynamics(COP).S, Robot_->RightFoot().State().Y );
-  Pb.add_term_to( VECTOR_DS, MV_,  NbConstraints                                                  );
-   */
-
-  // +D*Vc*FP
-  compute_term  ( MV_, 1.0, IneqCoP.D.X_mat, IntermedData_->State().VcX    );
-  Pb.add_term_to( VECTOR_DS, MV_, NbConstraints                            );
-  compute_term  ( MV_, 1.0, IneqCoP.D.Y_mat, IntermedData_->State().VcY    );
-  Pb.add_term_to( VECTOR_DS, MV_, NbConstraints                            );
+      // -D*U
+      for( unsigned k = 0; k < N_; k++ )
+        {
+          DUBlock_[r+k*nbRows] = -Dx*U(i,k);
+          DUBlock_[r+(N_+k)*nbRows] = -Dy*U(i,k);
+        }
+      // +D*V
+      for( unsigned k = 0; k < nbSteps; k++ )
+        {
+          DUBlock_[r+(2*N_+k)*nbRows] += Dx*V(i,k);
+          DUBlock_[r+(2*N_+NbStepsPreviewed+k)*nbRows] += Dy*V(i,k);
+        }
+
+      // +dc -D*S_z*x +D*Vc*FP
+      DSBlock_(r) = IneqCoP.Dc_vec[r]
+        - Dx*MV_(i) - Dy*MV2_(i)
+        + Dx*State.VcX(i) + Dy*State.VcY(i);
+    }
 
+  Pb.add_term_to( MATRIX_DU, &DUBlock_[0], nbRows, nbCols, NbConstraints, 0 );
+  Pb.add_term_to( VECTOR_DS, DSBlock_, NbConstraints );
 
 }
 
@@ -565,9 +558,8 @@ GeneratorVelRef::build_constraints( QPProblem & Pb, const solution_t & Solution
   // Polygonal constraints:
   // ----------------------
   //CoP constraints
-  linear_inequality_t & IneqCoP = IntermedData_->Inequalities( INEQ_COP );
-  build_inequalities_cop( IneqCoP, Solution.SupportStates_deq );
-  build_constraints_cop( IneqCoP, nbStepsPreviewed, Pb );
+  build_inequalities_cop( IneqCoP_, Solution.SupportStates_deq );
+  build_constraints_cop( IneqCoP_, nbStepsPreviewed, Pb );
 
   //Foot constraints
   linear_inequality_t & IneqFeet = IntermedData_->Inequalities( INEQ_FEET );
@@ -723,8 +715,8 @@ GeneratorVelRef::compute_warm_start( solution_t & Solution )
         }
 
       // Set the ZMP at the center of the foot
-      zx(i-1) = currentSupport.X;
-      zy(i-1) = currentSupport.Y;
+      zx(i) = currentSupport.X;
+      zy(i) = currentSupport.Y;
 
       prwSS_it++;
     }
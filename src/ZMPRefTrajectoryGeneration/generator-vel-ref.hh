@@ -133,9 +133,9 @@ namespace PatternGeneratorJRL
 
     /// \brief Generate a queue of inequalities with respect to the centers of the feet
     ///
-    /// \param[out] Inequalities
+    /// \param[out] Inequalities One set of edges per previewed sample
     /// \param[in] SupportStates_deq
-    void build_inequalities_cop(linear_inequality_t & Inequalities,
+    void build_inequalities_cop(sampled_inequalities_t & Inequalities,
         const std::deque<support_state_t> & SupportStates_deq) const;
 
     /// \brief Generate a queue of inequality constraints on
@@ -159,7 +159,7 @@ namespace PatternGeneratorJRL
     /// \param[in] IneqCop
     /// \param[in] NbStepsPreviewed
     /// \param[out] Pb
-    void build_constraints_cop( const linear_inequality_t & IneqCoP, unsigned int NbStepsPreviewed,
+    void build_constraints_cop( const sampled_inequalities_t & IneqCoP, unsigned int NbStepsPreviewed,
         QPProblem & Pb );
 
     /// \brief Compute feet constraints corresponding to the set of inequalities
@@ -231,8 +231,14 @@ namespace PatternGeneratorJRL
     boost_ublas::matrix<double> MM_;
     boost_ublas::vector<double> MV_;
     boost_ublas::vector<double> MV2_;
+    /// \brief Blocks of the CoP constraints, DU stored column-wise
+    std::vector<double> DUBlock_;
+    boost_ublas::vector<double> DSBlock_;
     /// \}
 
+    /// \brief CoP inequalities of the previewed samples
+    sampled_inequalities_t IneqCoP_;
+
 
   };
 }
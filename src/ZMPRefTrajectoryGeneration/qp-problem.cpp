@@ -40,6 +40,7 @@
 #include <exception>
 
 #include <ZMPRefTrajectoryGeneration/qp-problem.hh>
+#include <Debug.hh>
 
 #ifdef LSSOL_FOUND
 # include <lssol/lssol.h>
@@ -56,7 +57,8 @@ QPProblem::QPProblem():
       iout_(0),ifail_(0), iprint_(0),
       lwar_(0), liwar_(0), eps_(0),
       NbVariables_(0), NbConstraints_(0),NbEqConstraints_(0),
-      nbInvariantRows_(0),nbInvariantCols_(0)
+      nbInvariantRows_(0),nbInvariantCols_(0),
+      PLDPSolver_(0)
 
 {
   NbVariables_ = 0;
@@ -97,6 +99,20 @@ QPProblem::~QPProblem()
 void
 QPProblem::release_memory()
 {
+  if (istate_!=0x0)
+    {
+      delete [] istate_;
+      delete [] kx_;
+      delete [] b_;
+      delete [] clamda_;
+      istate_ = 0x0;
+    }
+
+  if (PLDPSolver_!=0)
+    {
+      delete PLDPSolver_;
+      PLDPSolver_ = 0;
+    }
 }
 
 
@@ -270,6 +286,11 @@ QPProblem::solve( solver_e Solver, solution_t & Result, const tests_e & tests )
 
   switch(Solver)
   {
+  case PLDP:
+    if( solve_pldp( Result, tests ) == 0 )
+      break;
+    // Otherwise fall back on QLD.
+    /* fall through */
   case QLD:
 
     ql0001_(&m_, &me_, &mmax_, &n_, &nmax_, &mnn_,
@@ -407,9 +428,71 @@ QPProblem::solve( solver_e Solver, solution_t & Result, const tests_e & tests )
 }
 
 
-void
-QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
-    unsigned int row,  unsigned int col )
+int
+QPProblem::precompute_invariant_part( solver_e Solver )
+{
+
+  if( Solver != PLDP )
+    return 0;
+
+  // The invariant part is made of the jerks along x and y.
+  unsigned NbInvariant = nbInvariantCols_;
+  if( (NbInvariant == 0) || (NbInvariant%2 != 0) ||
+      (Q_.NbRows_ < NbInvariant) || (Q_.NbCols_ < NbInvariant) )
+    return -1;
+
+  if( PLDPSolver_ != 0 )
+    delete PLDPSolver_;
+  PLDPSolver_ = new Optimization::Solver::PLDPSolverHerdt( NbInvariant/2, 0, 0, 0, 0 );
+  PLDPSolver_->SetLimitedComputationTime( -1.0 );
+
+  return PLDPSolver_->PrecomputeInvariantPart( Q_.Array_, Q_.NbRows_, NbInvariant );
+
+}
+
+
+int
+QPProblem::solve_pldp( solution_t & Result, const tests_e & tests )
+{
+
+  if( (me_ > 0) || (Result.initialSolution.size() != (unsigned)n_) )
+    return -1;
+
+  if( (PLDPSolver_ == 0) && (precompute_invariant_part( PLDP ) < 0) )
+    return -1;
+
+  // The first rows of DU,DS are empty
+  if( PLDPSolver_->SolveProblem( Q_dense_.Array_, n_, D_.Array_,
+      DU_dense_.Array_+1, mmax_, DS_.Array_+1,
+      n_, NbConstraints_, &Result.initialSolution(0), X_.Array_ ) < 0 )
+    return -1;
+
+  for(int i = 0; i < n_; i++)
+    {
+      Result.Solution_vec(i) = X_.Array_[i];
+      Result.LBoundsLagr_vec(i) = 0;
+      Result.UBoundsLagr_vec(i) = 0;
+    }
+  for(int i = 0; i < m_; i++)
+    {
+      Result.ConstrLagr_vec(i) = 0;
+    }
+  Result.Fail = 0;
+  Result.Print = 0;
+
+  if (tests==ITT || tests==ALL){
+      std::cout << "nb iterations : "
+          << PLDPSolver_->GetStatistics().NbOfIterations << std::endl;
+  }
+
+  return 0;
+
+}
+
+
+QPProblem::array_s<double> *
+QPProblem::prepare_term( qp_element_e Type, unsigned int NbRows, unsigned int NbCols,
+    unsigned int & row,  unsigned int col )
 {
 
   array_s<double> * Array_p = 0;
@@ -418,13 +501,13 @@ QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
   {
   case MATRIX_Q:
     Array_p = &Q_;
-    NbVariables_ = (col+Mat.size2()>NbVariables_) ? col+Mat.size2() : NbVariables_;
+    NbVariables_ = (col+NbCols>NbVariables_) ? col+NbCols : NbVariables_;
     break;
 
   case MATRIX_DU:
     Array_p = &DU_;
-    NbConstraints_ = ( row+Mat.size1() > NbConstraints_ ) ? row+Mat.size1() : NbConstraints_;
-    NbVariables_ = ( col+Mat.size2() > NbVariables_ ) ? col+Mat.size2() : NbVariables_;
+    NbConstraints_ = ( row+NbRows > NbConstraints_ ) ? row+NbRows : NbConstraints_;
+    NbVariables_ = ( col+NbCols > NbVariables_ ) ? col+NbCols : NbVariables_;
     row++;//The first rows of DU,DS are empty
     break;
 
@@ -436,7 +519,7 @@ QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
     break;
   case VECTOR_DS:
     Array_p = &DS_;
-    NbConstraints_ = (row+Mat.size1()>NbConstraints_) ? row+Mat.size1() : NbConstraints_;
+    NbConstraints_ = (row+NbRows>NbConstraints_) ? row+NbRows : NbConstraints_;
     row++;//The first rows of DU,DS are empty
     break;
   }
@@ -461,6 +544,18 @@ QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
   if( warsize> war_.NbRows_ )
       war_.resize( warsize, 1, true );
 
+  return Array_p;
+
+}
+
+
+void
+QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
+    unsigned int row,  unsigned int col )
+{
+
+  array_s<double> * Array_p = prepare_term( Type, Mat.size1(), Mat.size2(), row, col );
+
   double * p = Array_p->Array_;
   boost_ublas::matrix<double>::const_iterator1 row_it = Mat.begin1();
   boost_ublas::matrix<double>::const_iterator2 col_it = Mat.begin2();
@@ -482,6 +577,24 @@ QPProblem::add_term_to( qp_element_e Type, const MAL_MATRIX (&Mat, double),
 }
 
 
+void
+QPProblem::add_term_to( qp_element_e Type, const double * Block,
+    unsigned int NbRows, unsigned int NbCols, unsigned int row,  unsigned int col )
+{
+
+  array_s<double> * Array_p = prepare_term( Type, NbRows, NbCols, row, col );
+
+  for( unsigned j = 0; j < NbCols; j++ )
+    {
+      double * p_it = &Array_p->Array_[row+(col+j)*Array_p->NbRows_];
+      const double * Block_it = &Block[j*NbRows];
+      for( unsigned i = 0; i < NbRows; i++ )
+        p_it[i] += Block_it[i];
+    }
+
+}
+
+
 void
 QPProblem::add_term_to( qp_element_e Type, const MAL_VECTOR (&Vec, double),
     unsigned row, unsigned col )
@@ -667,9 +780,9 @@ void
 QPProblem::dump( double Time )
 {
   char Buffer[1024];
-  sprintf(Buffer, "/tmp/Problem_%f.dat", Time);
+  sprintf(Buffer, "Problem_%f.dat", Time);
   std::ofstream aof;
-  aof.open(Buffer, std::ofstream::out);
+  aof.open(OutputFileName(Buffer,"/tmp").c_str(), std::ofstream::out);
   dump_problem(aof);
   aof.close();
 }
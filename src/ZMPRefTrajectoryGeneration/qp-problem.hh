@@ -31,6 +31,7 @@
 
 #include <jrl/mal/matrixabstractlayer.hh>
 #include <Mathematics/qld.hh>
+#include <Mathematics/PLDPSolverHerdt.hh>
 #include <privatepgtypes.hh>
 #include <PreviewControl/rigid-body-system.hh>
 #include <PreviewControl/rigid-body.hh>
@@ -80,6 +81,17 @@ namespace PatternGeneratorJRL
     void add_term_to( qp_element_e Type, const boost_ublas::vector<double> & Vec,
         unsigned Row, unsigned Col = 0 );
 
+    /// \brief Add a block stored column-wise to the final optimization problem
+    ///
+    /// \param[in] Type Target matrix type
+    /// \param[in] Block Added block, NbRows is its leading dimension
+    /// \param[in] NbRows Number of rows of the block
+    /// \param[in] NbCols Number of columns of the block
+    /// \param[in] Row First row inside the target
+    /// \param[in] Col First column inside the target
+    void add_term_to( qp_element_e Type, const double * Block,
+        unsigned int NbRows, unsigned int NbCols, unsigned int Row, unsigned int Col );
+
     /// \brief Dump current problem on disk.
     void dump( const char * Filename );
     void dump( double Time );
@@ -109,6 +121,16 @@ namespace PatternGeneratorJRL
     /// \param[in] Tests
     void solve( solver_e Solver, solution_t & Result, const tests_e & Tests = NONE );
 
+    /// \brief Prepare the solver for the invariant part of the hessian
+    ///
+    /// For PLDP, the cholesky decomposition of the upper left block
+    /// of size nbInvariantCols is computed once and for all.
+    /// Has to be called after the invariant part has been built.
+    ///
+    /// \param[in] Solver
+    /// \return -1 if the invariant part can not be handled by the solver
+    int precompute_invariant_part( solver_e Solver );
+
     /// \name Accessors and mutators
     /// \{
     inline void NbVariables( unsigned int NbVariables )
@@ -145,6 +167,16 @@ namespace PatternGeneratorJRL
     /// \brief Release memory.
     void release_memory();
 
+    /// \brief Solve the problem with PLDP
+    ///
+    /// The initial solution of Result has to be feasible.
+    /// Equality constraints and bounds are not handled.
+    ///
+    /// \param[out] Result
+    /// \param[in] Tests
+    /// \return -1 if the problem could not be solved
+    int solve_pldp( solution_t & Result, const tests_e & Tests );
+
     /// \brief Allocate memory.
     /// Called when setting the dimensions of the problem.
     ///
@@ -272,6 +304,23 @@ namespace PatternGeneratorJRL
       };
     };
 
+    //
+    //Private methods
+    //
+  private:
+
+    /// \brief Update the dimensions of the problem for a new term
+    /// and allocate the memory if needed.
+    ///
+    /// \param[in] Type Target matrix type
+    /// \param[in] NbRows Number of rows of the term
+    /// \param[in] NbCols Number of columns of the term
+    /// \param[in,out] Row First row inside the target, shifted for DU and DS
+    /// \param[in] Col First column inside the target
+    /// \return The target array
+    array_s<double> * prepare_term( qp_element_e Type, unsigned int NbRows,
+        unsigned int NbCols, unsigned int & Row, unsigned int Col );
+
     //
     //Private members
     //
@@ -315,6 +364,9 @@ namespace PatternGeneratorJRL
     /// \brief First row and column of variant Hessian part
     unsigned nbInvariantRows_, nbInvariantCols_;
 
+    /// \brief Primal least distance problem solver
+    Optimization::Solver::PLDPSolverHerdt * PLDPSolver_;
+
   };
 
 }
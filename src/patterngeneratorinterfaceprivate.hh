@@ -57,6 +57,10 @@
 #include <FootTrajectoryGeneration/LeftAndRightFootTrajectoryGenerationMultiple.hh>
 
 #include <StepStackHandler.hh>
+#include <CommandInbox.hh>
+#include <StageProfiler.hh>
+#include <CommandStreamRecorder.hh>
+#include <Telemetry.hh>
 
 #include <SimplePluginManager.hh>
 #include <SimplePlugin.hh>
@@ -238,6 +242,12 @@ namespace PatternGeneratorJRL
 				    FootAbsolutePosition &RightFootPosition,
 				    ZMPPosition &ZMPRefPos,
 				    COMPosition &COMRefPos);
+
+    /*! \brief Run \a N steps of the global control loop
+      into buffers owned by the caller. */
+    unsigned int RunNStepsOfTheControlLoop(unsigned int N,
+					   ControlLoopBuffers &aBuffers);
+
     /*! @} */
 
     /*! Set the current joint values of the robot.
@@ -339,6 +349,18 @@ namespace PatternGeneratorJRL
     /*! \brief Set the inter object relationship. */
     void InterObjectRelationInitialization();
 
+    /*! \brief Create the objects needed by an algorithm
+      for ZMP and CoM trajectories, if they do not exist yet.
+      The commands they missed are replayed to them.
+      @param anAlgorithm One of the ZMPCOM_* constants. */
+    void InstanciateAlgorithm(int anAlgorithm);
+
+    /*! \brief Create the simple strategy if it does not exist yet. */
+    void InstanciateCoMAndFootOnlyStrategy();
+
+    /*! \brief Velocity referenced QP, created if needed. */
+    ZMPVelocityReferencedQP * VelocityReferencedQP();
+
     /*! @}*/
 
     /*! \brief Set the initial ZMP reference point. */
@@ -357,6 +379,20 @@ namespace PatternGeneratorJRL
     /*! \brief This method register a method to a specific object which derivates from SimplePlugin class. */
     bool RegisterMethod(string &MethodName, SimplePlugin *aSP);
 
+    /*! \brief Returns the handle of a command, -1 if the command is unknown. */
+    CommandHandle ResolveCommand(const std::string &aCmd);
+
+    /*! \brief Parse the arguments of a resolved command. */
+    int ParseCmd(CommandHandle aCmd, std::istringstream &strm);
+
+    /*! \brief Call a resolved command with typed arguments. */
+    bool CallCommand(CommandHandle aCmd);
+    bool CallCommand(CommandHandle aCmd, double aValue);
+    bool CallCommand(CommandHandle aCmd,
+		     const VelocityReferenceArguments &anArg);
+    bool CallCommand(CommandHandle aCmd,
+		     const PerturbationForceArguments &anArg);
+
     /*! @} */
 
 
@@ -391,6 +427,24 @@ namespace PatternGeneratorJRL
     void setCoMPerturbationForce(double x,
 			      double y);
 
+    /*! \name Commands from another thread than the control loop.
+      @{
+     */
+    void PostVelocityReference(double x, double y, double yaw);
+    bool PostCoMPerturbationForce(double x, double y);
+    bool PostOnLineStepChange(double x, double y, double theta);
+    /*! @} */
+
+    /*! \name Latencies of the stages of the control loop.
+      @{
+     */
+    void GetStageLatencies(std::vector<StageLatency> &aLatencies) const;
+    void ResetStageLatencies();
+    /*! @} */
+
+    /*! \brief Get the size of the buffers of positions. */
+    void GetBufferSizes(BufferSizes &aSizes) const;
+
   protected:
 
     /*! \name Methods for interpreter. 
@@ -426,6 +480,19 @@ namespace PatternGeneratorJRL
     /*! \brief Realize a sequence of steps. */
     virtual void m_StepSequence(std::istringstream &strm);
 
+    /*! \brief Start (on) or stop (off) recording the stages
+      of the control loop for :dumptrace. */
+    virtual void m_SetTracing(std::istringstream &strm);
+
+    /*! \brief Write the recorded stages in the Chrome trace format,
+      in the file given as argument (walkgen-trace.json by default). */
+    virtual void m_DumpTrace(std::istringstream &strm);
+
+    /*! \brief Start recording the commands in the file given as
+      argument, or stop with off. The replay is exact only if the
+      recording starts before any other command. */
+    virtual void m_RecordCommands(std::istringstream &strm);
+
 
   private:
 
@@ -442,7 +509,8 @@ namespace PatternGeneratorJRL
     /*! Objects to generate a ZMP profile from
       the step of stacks. They provide a buffer for
       the ZMP position to be used every dt
-      in the control loop. @{ */
+      in the control loop. Except m_ZMPD, they are 0 until
+      their algorithm is selected. @{ */
 
     /*! Kajita's heuristic: the center of the convex hull. */
     ZMPDiscretization * m_ZMPD;
@@ -459,6 +527,10 @@ namespace PatternGeneratorJRL
     /*! ZMP and CoM trajectories generation from an analytical formulation */
     AnalyticalMorisawaCompact * m_ZMPM;
 
+    /*! Sampling period of the preview control when this object
+      has been created, given to the algorithms created later on. */
+    double m_InitialSamplingPeriod;
+
     /*! Specified ZMP starting point. */
     MAL_S3_VECTOR_TYPE( double) m_ZMPInitialPoint;
 
@@ -520,7 +592,8 @@ namespace PatternGeneratorJRL
     /*! \brief Double stage preview control strategy */
     DoubleStagePreviewControlStrategy * m_DoubleStagePCStrategy;
 
-    /*! \brief Simple strategy just output CoM and Foot position. */
+    /*! \brief Simple strategy just output CoM and Foot position,
+      0 until an algorithm using it is selected. */
     CoMAndFootOnlyStrategy * m_CoMAndFootOnlyStrategy;
 
     /*! \brief General handler. */
@@ -702,6 +775,134 @@ namespace PatternGeneratorJRL
     /*! \brief Register the methods handled by the SimplePlugin part of this object. */
     void RegisterPluginMethods();
 
+    /*! \name State of RunNStepsOfTheControlLoop(), kept between calls
+      to avoid temporaries.
+      @{
+     */
+    MAL_VECTOR(m_BatchConfiguration,double);
+    MAL_VECTOR(m_BatchVelocity,double);
+    MAL_VECTOR(m_BatchAcceleration,double);
+    MAL_VECTOR(m_BatchZMPTarget,double);
+    COMState m_BatchCOMState;
+    FootAbsolutePosition m_BatchLeftFoot, m_BatchRightFoot;
+    /*! @} */
+
+    /*! \brief Store the state of the batch at tick \a i. */
+    void StoreBatchStep(unsigned int i, ControlLoopBuffers &aBuffers);
+
+    /*! \brief Directory of the files written by this instance,
+      the working directory if empty. */
+    std::string m_OutputDirectory;
+
+    /*! \brief Commands posted by other threads. */
+    CommandInbox m_CommandInbox;
+
+    /*! \brief Latencies of the stages, installed in the thread
+      running the control loop. */
+    StageProfiler m_StageProfiler;
+
+    /*! \brief Telemetry of this instance, installed in the threads
+      calling it. It writes in the output directory of the instance. */
+    TelemetryLogger m_TelemetryLogger;
+
+    /*! \brief Last stages of the control loop,
+      created by the first :tracing on. */
+    TraceRecorder * m_TraceRecorder;
+
+    /*! \brief Commands received, created by :recordcommands
+      or by JRL_WALKGEN_RECORD_COMMANDS. */
+    CommandStreamRecorder * m_CommandStreamRecorder;
+
+    /*! \brief Record a command line, unless it is :recordcommands.
+      @param aName Name of the command.
+      @param anArgs Its arguments. */
+    void RecordCommandStream(const std::string &aName, const std::string &anArgs);
+
+    /*! \brief Same as above from the remaining of \a strm,
+      which is not consumed. */
+    void RecordCommandStream(const std::string &aName, std::istringstream &strm);
+
+    /*! \brief Apply the commands posted since the last step
+      of the control loop. */
+    void ApplyInboxCommands();
+
+    /*! \name Typed commands.
+      @{
+     */
+    /*! \brief Handlers of a command for each type of arguments,
+      0 if the command does not take this type. */
+    struct TypedCommand_s
+    {
+      void (PatternGeneratorInterfacePrivate::*NoArgument)();
+      void (PatternGeneratorInterfacePrivate::*Scalar)(double);
+      void (PatternGeneratorInterfacePrivate::*VelocityReference)
+      (const VelocityReferenceArguments &);
+      void (PatternGeneratorInterfacePrivate::*PerturbationForce)
+      (const PerturbationForceArguments &);
+    };
+
+    /*! \brief Typed handlers indexed by the handles of the commands. */
+    std::vector<TypedCommand_s> m_TypedCommands;
+
+    /*! \brief Fill m_TypedCommands, once the methods are registered. */
+    void RegisterTypedCommands();
+
+    /*! \brief Returns the typed handlers of a command, 0 if there is none. */
+    const TypedCommand_s * TypedCommand(CommandHandle aCmd) const;
+
+    /*! \brief Returns true if other plugins registered the command. */
+    bool SharedCommand(CommandHandle aCmd) const;
+
+    /*! \brief Forward a typed command already handled by this object
+      to the other plugins which registered it. */
+    void ForwardCommand(CommandHandle aCmd, const std::string &anArgs);
+    /*! @} */
+
+    /*! \name Commands for the algorithms not created yet.
+      @{
+     */
+    /*! \brief Arguments of the last call of a command. */
+    struct CommandRecord_s
+    {
+      /*! Rank of the call among all the recorded calls. */
+      unsigned long int Stamp;
+      std::string Arguments;
+    };
+
+    /*! \brief Last call of each command, sorted by names. */
+    std::map<std::string, CommandRecord_s, ltstr> m_CommandRecords;
+
+    /*! \brief Rank of the next recorded call. */
+    unsigned long int m_CommandStamp;
+
+    /*! \brief Returns true if an algorithm has not been created yet. */
+    bool AlgorithmsToInstanciate() const;
+
+    /*! \brief Store the arguments of a command if an algorithm
+      may still need them. */
+    void RecordCommand(const std::string &aName, const std::string &anArgs);
+
+    /*! \brief Same as above from the remaining of \a strm,
+      which is not consumed. */
+    void RecordCommand(const std::string &aName, std::istringstream &strm);
+
+    /*! \brief Call the recorded commands, in the order of their last call,
+      on the plugins registered since \a aNbPlugins has been taken.
+      @param aNbPlugins Number of plugins of each method before the
+      creation of the algorithm. */
+    void ReplayCommands(const std::vector<unsigned int> &aNbPlugins);
+    /*! @} */
+
+    /*! \name Handlers of the typed commands.
+      @{
+     */
+
+    void m_SetSamplingPeriod(double aSamplingPeriod);
+    void m_HerdtOnline();
+    void m_SetVelReference(const VelocityReferenceArguments &anArg);
+    void m_SetCoMPerturbationForce(const PerturbationForceArguments &anArg);
+    /*! @} */
+
     /*! \brief Start FPE trapping. */
     void AllowFPE();
 
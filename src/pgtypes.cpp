@@ -68,6 +68,23 @@ namespace PatternGeneratorJRL
 
   }
 
+  ControlLoopBuffers_s::ControlLoopBuffers_s():
+    NbDofs(0),
+    Configurations(0),
+    Velocities(0),
+    Accelerations(0)
+  {
+    for(unsigned int i=0;i<3;i++)
+      ZMP[i] = 0;
+    for(unsigned int i=0;i<6;i++)
+      CoM[i] = 0;
+    for(unsigned int i=0;i<5;i++)
+      {
+        LeftFoot[i] = 0;
+        RightFoot[i] = 0;
+      }
+  }
+
   std::ostream & operator<<(std::ostream &os,
                             const COMState_s & acs)
   {
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+#ifndef JRL_WALKGEN_PORTABILITY_ATOMIC_HH
+# define JRL_WALKGEN_PORTABILITY_ATOMIC_HH
+
+// This deals with atomic operations portability issues.
+// All the operations are full memory barriers.
+# ifdef WIN32
+#  include <Windows.h>
+# endif // WIN32
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Integer which is shared between threads. */
+  typedef volatile long AtomicCounter;
+
+  /*! \brief Full memory barrier. */
+  inline void AtomicBarrier()
+  {
+# ifdef WIN32
+    MemoryBarrier();
+# else
+    __sync_synchronize();
+# endif // WIN32
+  }
+
+  /*! \brief Read \a aCounter, the following memory accesses
+    are not done before. */
+  inline long AtomicLoad(const AtomicCounter & aCounter)
+  {
+    long r = aCounter;
+    AtomicBarrier();
+    return r;
+  }
+
+  /*! \brief Write \a aCounter, the previous memory accesses
+    are done before. */
+  inline void AtomicStore(AtomicCounter & aCounter, long aValue)
+  {
+    AtomicBarrier();
+    aCounter = aValue;
+  }
+
+  /*! \brief Add one to \a aCounter.
+    \return The new value. */
+  inline long AtomicIncrement(AtomicCounter & aCounter)
+  {
+# ifdef WIN32
+    return InterlockedIncrement(&aCounter);
+# else
+    return __sync_add_and_fetch(&aCounter,1);
+# endif // WIN32
+  }
+
+  /*! \brief Set \a aCounter to \a aNewValue if it is equal to
+    \a anOldValue.
+    \return true if the value has been set. */
+  inline bool AtomicCompareAndSwap(AtomicCounter & aCounter,
+				   long anOldValue, long aNewValue)
+  {
+# ifdef WIN32
+    return InterlockedCompareExchange(&aCounter,aNewValue,anOldValue)
+      ==anOldValue;
+# else
+    return __sync_bool_compare_and_swap(&aCounter,anOldValue,aNewValue);
+# endif // WIN32
+  }
+}
+#endif //! JRL_WALKGEN_PORTABILITY_ATOMIC_HH
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#ifndef JRL_WALKGEN_PORTABILITY_MONOTONICTIME_HH
+# define JRL_WALKGEN_PORTABILITY_MONOTONICTIME_HH
+
+// This deals with monotonic clocks portability issues.
+// Contrary to gettimeofday, the clock is not changed by the
+// adjustments of the system time.
+# ifdef WIN32
+#  include <Windows.h>
+# else
+#  include <time.h>
+# endif // WIN32
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Time in nano-seconds since an arbitrary origin,
+    to be used for durations only. */
+  inline long long MonotonicTime()
+  {
+# ifdef WIN32
+    static LARGE_INTEGER lFrequency = {{0,0}};
+    if (lFrequency.QuadPart==0)
+      QueryPerformanceFrequency(&lFrequency);
+    LARGE_INTEGER lCounter;
+    QueryPerformanceCounter(&lCounter);
+    return (long long)((double)lCounter.QuadPart*1e9/
+		       (double)lFrequency.QuadPart);
+# else
+    struct timespec lTime;
+    clock_gettime(CLOCK_MONOTONIC,&lTime);
+    return (long long)lTime.tv_sec*1000000000LL + lTime.tv_nsec;
+# endif // WIN32
+  }
+
+  /*! \brief CPU time in nano-seconds used by the calling thread.
+    Unlike MonotonicTime() it does not count the time during which
+    the thread is preempted. */
+  inline long long ThreadCPUTime()
+  {
+# ifdef WIN32
+    FILETIME lCreation, lExit, lKernel, lUser;
+    GetThreadTimes(GetCurrentThread(),&lCreation,&lExit,&lKernel,&lUser);
+    ULARGE_INTEGER lKernel100ns, lUser100ns;
+    lKernel100ns.LowPart = lKernel.dwLowDateTime;
+    lKernel100ns.HighPart = lKernel.dwHighDateTime;
+    lUser100ns.LowPart = lUser.dwLowDateTime;
+    lUser100ns.HighPart = lUser.dwHighDateTime;
+    return (long long)(lKernel100ns.QuadPart + lUser100ns.QuadPart)*100LL;
+# elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec lTime;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID,&lTime);
+    return (long long)lTime.tv_sec*1000000000LL + lTime.tv_nsec;
+# else
+    // CPU time of the process.
+    return (long long)clock()*(1000000000LL/CLOCKS_PER_SEC);
+# endif // WIN32
+  }
+}
+#endif //! JRL_WALKGEN_PORTABILITY_MONOTONICTIME_HH
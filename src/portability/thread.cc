@@ -0,0 +1,176 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#include "portability/thread.hh"
+
+#ifndef WIN32
+# include <sched.h>
+# include <time.h>
+#endif // WIN32
+
+using namespace PatternGeneratorJRL;
+
+#ifdef WIN32
+
+Mutex::Mutex()
+{ InitializeCriticalSection(&m_Mutex); }
+
+Mutex::~Mutex()
+{ DeleteCriticalSection(&m_Mutex); }
+
+void Mutex::Lock()
+{ EnterCriticalSection(&m_Mutex); }
+
+void Mutex::Unlock()
+{ LeaveCriticalSection(&m_Mutex); }
+
+ConditionVariable::ConditionVariable()
+{ InitializeConditionVariable(&m_Condition); }
+
+ConditionVariable::~ConditionVariable()
+{ }
+
+void ConditionVariable::Wait(Mutex & aMutex)
+{ SleepConditionVariableCS(&m_Condition,&aMutex.m_Mutex,INFINITE); }
+
+void ConditionVariable::Signal()
+{ WakeConditionVariable(&m_Condition); }
+
+void ConditionVariable::Broadcast()
+{ WakeAllConditionVariable(&m_Condition); }
+
+DWORD WINAPI Thread::Run(LPVOID anArgument)
+{
+  Thread * aThread = (Thread *)anArgument;
+  aThread->m_Function(aThread->m_Argument);
+  return 0;
+}
+
+int Thread::Start(Function_t aFunction, void * anArgument)
+{
+  if (m_Joinable)
+    return -1;
+  m_Function = aFunction;
+  m_Argument = anArgument;
+  m_Thread = CreateThread(0,0,Thread::Run,this,0,0);
+  if (m_Thread==0)
+    return -1;
+  m_Joinable = true;
+  return 0;
+}
+
+void Thread::Join()
+{
+  if (!m_Joinable)
+    return;
+  WaitForSingleObject(m_Thread,INFINITE);
+  CloseHandle(m_Thread);
+  m_Joinable = false;
+}
+
+void Thread::YieldCpu()
+{ SwitchToThread(); }
+
+void Thread::Pause(unsigned int aMilliSeconds)
+{ Sleep(aMilliSeconds); }
+
+#else // WIN32
+
+Mutex::Mutex()
+{ pthread_mutex_init(&m_Mutex,0); }
+
+Mutex::~Mutex()
+{ pthread_mutex_destroy(&m_Mutex); }
+
+void Mutex::Lock()
+{ pthread_mutex_lock(&m_Mutex); }
+
+void Mutex::Unlock()
+{ pthread_mutex_unlock(&m_Mutex); }
+
+ConditionVariable::ConditionVariable()
+{ pthread_cond_init(&m_Condition,0); }
+
+ConditionVariable::~ConditionVariable()
+{ pthread_cond_destroy(&m_Condition); }
+
+void ConditionVariable::Wait(Mutex & aMutex)
+{ pthread_cond_wait(&m_Condition,&aMutex.m_Mutex); }
+
+void ConditionVariable::Signal()
+{ pthread_cond_signal(&m_Condition); }
+
+void ConditionVariable::Broadcast()
+{ pthread_cond_broadcast(&m_Condition); }
+
+void * Thread::Run(void * anArgument)
+{
+  Thread * aThread = (Thread *)anArgument;
+  aThread->m_Function(aThread->m_Argument);
+  return 0;
+}
+
+int Thread::Start(Function_t aFunction, void * anArgument)
+{
+  if (m_Joinable)
+    return -1;
+  m_Function = aFunction;
+  m_Argument = anArgument;
+  if (pthread_create(&m_Thread,0,Thread::Run,this)!=0)
+    return -1;
+  m_Joinable = true;
+  return 0;
+}
+
+void Thread::Join()
+{
+  if (!m_Joinable)
+    return;
+  pthread_join(m_Thread,0);
+  m_Joinable = false;
+}
+
+void Thread::YieldCpu()
+{ sched_yield(); }
+
+void Thread::Pause(unsigned int aMilliSeconds)
+{
+  struct timespec lDuration;
+  lDuration.tv_sec = aMilliSeconds/1000;
+  lDuration.tv_nsec = (aMilliSeconds%1000)*1000000L;
+  nanosleep(&lDuration,0);
+}
+
+#endif // WIN32
+
+Thread::Thread():
+  m_Function(0),
+  m_Argument(0),
+  m_Joinable(false)
+{
+}
+
+Thread::~Thread()
+{
+  Join();
+}
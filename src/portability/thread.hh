@@ -0,0 +1,144 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+#ifndef JRL_WALKGEN_PORTABILITY_THREAD_HH
+# define JRL_WALKGEN_PORTABILITY_THREAD_HH
+
+// This deals with threads portability issues.
+# ifdef WIN32
+#  include <Windows.h>
+# else
+#  include <pthread.h>
+# endif // WIN32
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Non recursive mutex. */
+  class Mutex
+  {
+  public:
+    Mutex();
+    ~Mutex();
+    void Lock();
+    void Unlock();
+
+  private:
+    friend class ConditionVariable;
+# ifdef WIN32
+    CRITICAL_SECTION m_Mutex;
+# else
+    pthread_mutex_t m_Mutex;
+# endif // WIN32
+
+    /* Not copyable. */
+    Mutex(const Mutex &);
+    Mutex & operator=(const Mutex &);
+  };
+
+  /*! \brief Lock a mutex for the life time of the object. */
+  class ScopedLock
+  {
+  public:
+    explicit ScopedLock(Mutex & aMutex): m_Mutex(aMutex)
+    { m_Mutex.Lock(); }
+    ~ScopedLock()
+    { m_Mutex.Unlock(); }
+
+  private:
+    Mutex & m_Mutex;
+
+    /* Not copyable. */
+    ScopedLock(const ScopedLock &);
+    ScopedLock & operator=(const ScopedLock &);
+  };
+
+  /*! \brief Condition variable associated with a Mutex. */
+  class ConditionVariable
+  {
+  public:
+    ConditionVariable();
+    ~ConditionVariable();
+    /*! The mutex has to be locked by the caller. */
+    void Wait(Mutex & aMutex);
+    void Signal();
+    void Broadcast();
+
+  private:
+# ifdef WIN32
+    CONDITION_VARIABLE m_Condition;
+# else
+    pthread_cond_t m_Condition;
+# endif // WIN32
+
+    /* Not copyable. */
+    ConditionVariable(const ConditionVariable &);
+    ConditionVariable & operator=(const ConditionVariable &);
+  };
+
+  /*! \brief Thread running a function until it returns. */
+  class Thread
+  {
+  public:
+    typedef void (*Function_t)(void *);
+
+    Thread();
+    /*! Join the thread if it is still running. */
+    ~Thread();
+
+    /*! \brief Start \a aFunction(\a anArgument) in a new thread.
+      \return -1 if the thread could not be created. */
+    int Start(Function_t aFunction, void * anArgument);
+
+    /*! \brief Wait for the end of the thread. */
+    void Join();
+
+    /*! \brief Let another thread run on the processor. */
+    static void YieldCpu();
+
+    /*! \brief Suspend the calling thread for \a aMilliSeconds. */
+    static void Pause(unsigned int aMilliSeconds);
+
+    /*! \brief Returns true if the thread has been started
+      and not joined yet. */
+    bool Joinable() const
+    { return m_Joinable; }
+
+  private:
+# ifdef WIN32
+    static DWORD WINAPI Run(LPVOID anArgument);
+    HANDLE m_Thread;
+# else
+    static void * Run(void * anArgument);
+    pthread_t m_Thread;
+# endif // WIN32
+    Function_t m_Function;
+    void * m_Argument;
+    bool m_Joinable;
+
+    /* Not copyable. */
+    Thread(const Thread &);
+    Thread & operator=(const Thread &);
+  };
+}
+#endif //! JRL_WALKGEN_PORTABILITY_THREAD_HH
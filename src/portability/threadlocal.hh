@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+#ifndef JRL_WALKGEN_PORTABILITY_THREADLOCAL_HH
+# define JRL_WALKGEN_PORTABILITY_THREADLOCAL_HH
+
+// This deals with thread local storage portability issues.
+// Only plain old data with a constant initializer can be stored.
+# ifdef WIN32
+#  define JRL_WALKGEN_THREAD_LOCAL __declspec(thread)
+# else
+#  define JRL_WALKGEN_THREAD_LOCAL __thread
+# endif // WIN32
+
+#endif //! JRL_WALKGEN_PORTABILITY_THREADLOCAL_HH
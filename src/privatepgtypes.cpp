@@ -306,6 +306,18 @@ namespace PatternGeneratorJRL
   }
 
 
+  void
+  sampled_inequalities_t::resize( unsigned NbRows )
+  {
+
+    X_vec.resize(NbRows);
+    Y_vec.resize(NbRows);
+    Dc_vec.resize(NbRows);
+    Sample_vec.resize(NbRows);
+
+  }
+
+
   solution_t::solution_t():
       NbVariables(0),NbConstraints(0),Fail(0),Print(0),
       Solution_vec(0),SupportOrientations_deq(0),SupportStates_deq(0),
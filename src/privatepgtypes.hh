@@ -109,7 +109,8 @@ namespace PatternGeneratorJRL
   enum solver_e
   {
     QLD,
-    LSSOL
+    LSSOL,
+    PLDP
   };
 
   enum tests_e
@@ -287,6 +288,18 @@ namespace PatternGeneratorJRL
     void resize( int NbRows, int NbCols, bool Preserve );
   };
 
+  /// \brief Linear inequalities bearing on one sample each,
+  /// stored as a structure of arrays:
+  /// X_vec[i]*x(Sample_vec[i]) + Y_vec[i]*y(Sample_vec[i]) + Dc_vec[i] > 0
+  struct sampled_inequalities_t
+  {
+    std::vector<double> X_vec, Y_vec, Dc_vec;
+    std::vector<unsigned> Sample_vec;
+
+    /// \brief Resize all elements
+    void resize( unsigned NbRows );
+  };
+
   /// \brief Support state of the robot at a certain point in time
   struct support_state_t
   {
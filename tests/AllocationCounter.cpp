@@ -0,0 +1,94 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file AllocationCounter.cpp
+  \brief Global operators new and delete counting the heap blocks.
+*/
+
+#include <stdlib.h>
+
+#include <new>
+
+#include "portability/atomic.hh"
+#include "AllocationCounter.hh"
+
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  AtomicCounter NbOfNew = 0;
+  AtomicCounter NbOfDelete = 0;
+
+  void * CountedAllocation(std::size_t aSize)
+  {
+    void * p = malloc(aSize==0 ? 1 : aSize);
+    if (p==0)
+      throw std::bad_alloc();
+    AtomicIncrement(NbOfNew);
+    return p;
+  }
+
+  void CountedFree(void * p)
+  {
+    if (p==0)
+      return;
+    AtomicIncrement(NbOfDelete);
+    free(p);
+  }
+}
+
+void * operator new(std::size_t aSize)
+{
+  return CountedAllocation(aSize);
+}
+
+void * operator new[](std::size_t aSize)
+{
+  return CountedAllocation(aSize);
+}
+
+void operator delete(void * p) throw()
+{
+  CountedFree(p);
+}
+
+void operator delete[](void * p) throw()
+{
+  CountedFree(p);
+}
+
+namespace PatternGeneratorJRL
+{
+  namespace TestSuite
+  {
+    long NbOfLiveAllocations()
+    {
+      return AtomicLoad(NbOfNew) - AtomicLoad(NbOfDelete);
+    }
+
+    long NbOfAllocations()
+    {
+      return AtomicLoad(NbOfNew);
+    }
+  }
+}
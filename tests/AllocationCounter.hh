@@ -0,0 +1,45 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file AllocationCounter.hh
+  \brief Count of the heap blocks of the test program.
+
+  AllocationCounter.cpp replaces the global operators new and delete,
+  it should be compiled only in the tests which need the count.
+*/
+
+#ifndef _ALLOCATION_COUNTER_UTESTING_H_
+#define _ALLOCATION_COUNTER_UTESTING_H_
+
+namespace PatternGeneratorJRL
+{
+  namespace TestSuite
+  {
+    /*! \brief Number of blocks allocated by new and not yet deleted. */
+    long NbOfLiveAllocations();
+
+    /*! \brief Number of calls to new since the start of the program. */
+    long NbOfAllocations();
+  }
+}
+#endif /* _ALLOCATION_COUNTER_UTESTING_H_ */
@@ -0,0 +1,625 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file BenchmarkGenerators.cpp
+  \brief Time the computations of the trajectory generators
+  on synthetic inputs, without robot file.
+
+  The control loop of the pattern generator is timed for each
+  algorithm on the synthetic humanoid, the other cases call the
+  generators directly. Each case measures the duration of one call
+  with a LatencyHistogram. The results are displayed in a table and
+  written in a JSON file (one object per case, durations in
+  nano-seconds) to be compared between two versions.
+
+  Usage: BenchmarkGenerators [NbOfRepetitions] [BenchmarkGenerators.json]
+*/
+
+#include <stdlib.h>
+
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/dynamics/dynamicsfactory.hh>
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <SimplePluginManager.hh>
+#include <StageProfiler.hh>
+#include <Mathematics/OptCholesky.hh>
+#include <Mathematics/PLDPSolver.hh>
+#include <Mathematics/PolynomeFoot.hh>
+#include <PreviewControl/PreviewControl.hh>
+#include <ZMPRefTrajectoryGeneration/AnalyticalMorisawaCompact.hh>
+
+#include "CommonTools.hh"
+#include "ZMPQPProblem.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+using namespace Optimization::Solver;
+
+namespace
+{
+  /* Parameters of the walk. */
+  const double SamplingPeriod = 0.005;
+  const double TSingle = 0.7;
+  const double TDouble = 0.1;
+  const double StepLength = 0.2;
+  const double FeetDistance = 0.19;
+  const double StepHeight = 0.05;
+  const double CoMHeight = 0.814;
+  const unsigned int NbOfSteps = 8;
+
+  /* Durations of the calls of one computation. */
+  class BenchmarkCase
+  {
+  public:
+    explicit BenchmarkCase(const string & aName):
+      m_Name(aName),
+      m_TotalTime(0),
+      m_Start(0)
+    {}
+
+    /* Start timing a call. */
+    void Start()
+    { m_Start = MonotonicTime(); }
+
+    /* Stop timing a call. */
+    void Stop()
+    {
+      long long lDuration = MonotonicTime()-m_Start;
+      m_Histogram.Record(lDuration);
+      m_TotalTime += lDuration;
+    }
+
+    const string & Name() const
+    { return m_Name; }
+
+    const LatencyHistogram & Histogram() const
+    { return m_Histogram; }
+
+    double Mean() const
+    {
+      unsigned long int n = m_Histogram.NbOfSamples();
+      return (n==0) ? 0.0 : (double)m_TotalTime/n;
+    }
+
+    /* Calls per second, without the time spent between the calls. */
+    double Throughput() const
+    { return (m_TotalTime==0) ? 0.0 : 1e9*m_Histogram.NbOfSamples()/m_TotalTime; }
+
+  private:
+    string m_Name;
+    LatencyHistogram m_Histogram;
+    long long m_TotalTime;
+    long long m_Start;
+  };
+
+  /* Gives access to the resolution of the analytical formulation,
+     which does not need the feet trajectories. */
+  class MorisawaSolver : public AnalyticalMorisawaCompact
+  {
+  public:
+    explicit MorisawaSolver(SimplePluginManager * lSPM):
+      AnalyticalMorisawaCompact(lSPM)
+    {
+      SetTSingleSupport(TSingle);
+      SetTDoubleSupport(TDouble);
+    }
+
+    /* Build the Z matrix and solve the trajectories of both axis
+       for a straight walk of lNbOfSteps steps. */
+    void Solve(unsigned int lNbOfSteps)
+    {
+      SetNumberOfStepsInAdvance(lNbOfSteps);
+      InitializeBasicVariables();
+
+      m_CTIPX.CoMZ.assign(m_NumberOfIntervals,CoMHeight);
+      m_CTIPX.ZMPZ.assign(m_NumberOfIntervals,0.0);
+      BuildingTheZMatrix(m_CTIPX.CoMZ,m_CTIPX.ZMPZ);
+      ResetTheResolutionOfThePolynomial();
+
+      AnalyticalZMPCOGTrajectory * lTrajectories[2] =
+	{ m_AnalyticalZMPCoGTrajectoryX, m_AnalyticalZMPCoGTrajectoryY };
+      CompactTrajectoryInstanceParameters * lCTIPs[2] =
+	{ &m_CTIPX, &m_CTIPY };
+      m_CTIPY.CoMZ = m_CTIPX.CoMZ;
+      m_CTIPY.ZMPZ = m_CTIPX.ZMPZ;
+
+      /* Support feet along the walk, the ZMP ends between the
+	 two last feet. */
+      m_CTIPX.ZMPProfil.assign(m_NumberOfIntervals,0.0);
+      m_CTIPY.ZMPProfil.assign(m_NumberOfIntervals,0.0);
+      for(unsigned int i=0;i<lNbOfSteps;i++)
+	{
+	  double y = (i%2==0) ? -0.5*FeetDistance : 0.5*FeetDistance;
+	  m_CTIPX.ZMPProfil[2*i+1] = m_CTIPX.ZMPProfil[2*i+2] = i*StepLength;
+	  m_CTIPY.ZMPProfil[2*i+1] = m_CTIPY.ZMPProfil[2*i+2] = y;
+	}
+      m_CTIPX.ZMPProfil[m_NumberOfIntervals-2] =
+	m_CTIPX.ZMPProfil[m_NumberOfIntervals-1] = (lNbOfSteps-1.5)*StepLength;
+      m_CTIPY.ZMPProfil[m_NumberOfIntervals-2] =
+	m_CTIPY.ZMPProfil[m_NumberOfIntervals-1] = 0.0;
+
+      for(unsigned int a=0;a<2;a++)
+	{
+	  AnalyticalZMPCOGTrajectory & aAZCT = *lTrajectories[a];
+	  CompactTrajectoryInstanceParameters & aCTIP = *lCTIPs[a];
+	  aAZCT.SetNumberOfIntervals(m_NumberOfIntervals);
+	  aAZCT.SetPolynomialDegrees(m_PolynomialDegrees);
+	  aAZCT.SetStartingTimeIntervalsAndHeightVariation(m_DeltaTj,m_Omegaj);
+	  for(int i=1;i<m_NumberOfIntervals-1;i++)
+	    aAZCT.Building3rdOrderPolynomial(i,aCTIP.ZMPProfil[i-1],
+					     aCTIP.ZMPProfil[i]);
+	  aCTIP.InitialCoM = aCTIP.ZMPProfil[0];
+	  aCTIP.InitialCoMSpeed = 0.0;
+	  aCTIP.FinalCoMPos = aCTIP.ZMPProfil[m_NumberOfIntervals-1];
+	  ComputeTrajectory(aCTIP,aAZCT);
+	}
+    }
+
+    /* Duration of the trajectories. */
+    double Duration() const
+    {
+      double r=0.0;
+      for(unsigned int i=0;i<m_DeltaTj.size();i++)
+	r += m_DeltaTj[i];
+      return r;
+    }
+
+    /* CoM and ZMP of both axis at time t. */
+    bool Sample(double t, double & CoMX, double & CoMY,
+		double & ZMPX, double & ZMPY)
+    {
+      return m_AnalyticalZMPCoGTrajectoryX->ComputeCOM(t,CoMX) &&
+	m_AnalyticalZMPCoGTrajectoryY->ComputeCOM(t,CoMY) &&
+	m_AnalyticalZMPCoGTrajectoryX->ComputeZMP(t,ZMPX) &&
+	m_AnalyticalZMPCoGTrajectoryY->ComputeZMP(t,ZMPY);
+    }
+  };
+
+  /* Updates and downdates of the Cholesky decomposition of the
+     active constraints of the ZMP QP. */
+  int BenchmarkOptCholesky(unsigned int NbOfRepetitions,
+			   BenchmarkCase & anUpdate,
+			   BenchmarkCase & aDowndate)
+  {
+    ZMPQPProblem aPb(NbOfSteps);
+    if (aPb.Initialize()<0)
+      return -1;
+    aPb.BuildIteration(ZMPQPProblem::SamplesPerStep);
+
+    const unsigned int n = 2*ZMPQPProblem::N;
+    vector<double> L(ZMPQPProblem::NbOfConstraints*ZMPQPProblem::NbOfConstraints);
+    OptCholesky anOptCholesky(ZMPQPProblem::NbOfConstraints,n,
+			      OptCholesky::MODE_FORTRAN);
+    anOptCholesky.SetA(&aPb.DPu[0],ZMPQPProblem::NbOfConstraints);
+    anOptCholesky.SetL(&L[0]);
+
+    /* The lower bounds along x and y are independent. */
+    vector<unsigned int> Rows;
+    for(unsigned int i=0;i<ZMPQPProblem::N;i++)
+      {
+	Rows.push_back(4*i);
+	Rows.push_back(4*i+1);
+      }
+
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      {
+	for(unsigned int i=0;i<n;i++)
+	  {
+	    anUpdate.Start();
+	    int lStatus = anOptCholesky.AddActiveConstraint(Rows[i]);
+	    anUpdate.Stop();
+	    if (lStatus<0)
+	      return -1;
+	  }
+	/* Remove from the middle, where the downdate is the longest. */
+	for(unsigned int i=0;i<n;i++)
+	  {
+	    aDowndate.Start();
+	    int lStatus = anOptCholesky.RemoveActiveConstraint(Rows[(i*7)%n]);
+	    aDowndate.Stop();
+	    if (lStatus<0)
+	      return -1;
+	  }
+      }
+    return 0;
+  }
+
+  /* Resolutions of the ZMP QP along a walk. */
+  int BenchmarkPLDP(unsigned int NbOfRepetitions, BenchmarkCase & aSolve)
+  {
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      {
+	ZMPQPProblem aPb(NbOfSteps);
+	if (aPb.Initialize()<0)
+	  return -1;
+	PLDPSolver aSolver(ZMPQPProblem::N,aPb.iPu,aPb.Px,aPb.lPu,aPb.iLQ);
+
+	for(unsigned int lk=0;lk<aPb.NbOfIterations();lk++)
+	  {
+	    aPb.BuildIteration(lk);
+	    aSolve.Start();
+	    int lStatus = aSolver.SolveProblem(aPb.D,ZMPQPProblem::NbOfConstraints,
+					       &aPb.DPu[0],&aPb.DPx[0],
+					       aPb.ZMPRef,aPb.XkYk,aPb.V,
+					       aPb.SimilarConstraints,
+					       (lk==0) ? 0 : 4,(lk==0));
+	    aSolve.Stop();
+	    if ((lStatus<0) || (aPb.NbOfViolations()>0))
+	      return -1;
+	    aPb.ApplyFirstJerk();
+	  }
+      }
+    return 0;
+  }
+
+  /* Weights and iterations of the preview control
+     on the ZMP reference of a straight walk. */
+  int BenchmarkPreviewControl(unsigned int NbOfRepetitions,
+			      BenchmarkCase & aWeights,
+			      BenchmarkCase & anIteration)
+  {
+    SimplePluginManager aSPM;
+    PreviewControl aPC(&aSPM,OptimalControllerSolver::MODE_WITH_INITIALPOS,
+		       false);
+    aPC.SetSamplingPeriod(SamplingPeriod);
+    aPC.SetPreviewControlTime(1.6);
+    aPC.SetHeightOfCoM(CoMHeight);
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      {
+	aWeights.Start();
+	aPC.ComputeOptimalWeights(OptimalControllerSolver::MODE_WITH_INITIALPOS);
+	aWeights.Stop();
+      }
+
+    /* Steps of the reference, repeated when it is consumed. */
+    unsigned int lSamplesPerStep = (unsigned int)((TSingle+TDouble)/SamplingPeriod+0.5);
+    deque<ZMPPosition> ZMPPositions;
+    for(unsigned int i=0;i<2*NbOfSteps*lSamplesPerStep;i++)
+      {
+	unsigned int lStep = i/lSamplesPerStep;
+	ZMPPosition aZMP;
+	aZMP.px = (lStep%NbOfSteps)*StepLength;
+	aZMP.py = (lStep%2==0) ? -0.5*FeetDistance : 0.5*FeetDistance;
+	aZMP.pz = 0.0;
+	aZMP.theta = 0.0;
+	aZMP.time = i*SamplingPeriod;
+	aZMP.stepType = 1;
+	ZMPPositions.push_back(aZMP);
+      }
+
+    MAL_MATRIX_DIM(x,double,3,1);
+    MAL_MATRIX_DIM(y,double,3,1);
+    MAL_MATRIX_FILL(x,0.0);
+    MAL_MATRIX_FILL(y,0.0);
+    double sxzmp=0.0, syzmp=0.0, zmpx2, zmpy2;
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      for(unsigned int i=0;i<NbOfSteps*lSamplesPerStep;i++)
+	{
+	  anIteration.Start();
+	  aPC.OneIterationOfPreview(x,y,sxzmp,syzmp,ZMPPositions,0,
+				    zmpx2,zmpy2,true);
+	  anIteration.Stop();
+	  ZMPPositions.push_back(ZMPPositions.front());
+	  ZMPPositions.pop_front();
+	}
+    return 0;
+  }
+
+  /* Polynomials of FootTrajectoryGenerationStandard for each step,
+     and the foot at each sample. */
+  int BenchmarkFootTrajectory(unsigned int NbOfRepetitions,
+			      BenchmarkCase & aSetup,
+			      BenchmarkCase & anInterpolation)
+  {
+    Polynome5 aPolynomeX(0,0), aPolynomeY(0,0);
+    Polynome4 aPolynomeZ(0,0);
+    Polynome3 aPolynomeOmega(0,0);
+    unsigned int lNbOfSamples = (unsigned int)(TSingle/SamplingPeriod+0.5);
+    double lSum=0.0;
+
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      for(unsigned int s=0;s<NbOfSteps;s++)
+	{
+	  double y = (s%2==0) ? 0.5*FeetDistance : -0.5*FeetDistance;
+	  aSetup.Start();
+	  aPolynomeX.SetParameters(TSingle,2*StepLength,0.0,0.0,0.0);
+	  aPolynomeY.SetParameters(TSingle,y,y,0.0,0.0);
+	  aPolynomeZ.SetParameters(TSingle,StepHeight);
+	  aPolynomeOmega.SetParameters(TSingle,0.0);
+	  aSetup.Stop();
+
+	  for(unsigned int i=0;i<=lNbOfSamples;i++)
+	    {
+	      double t = i*SamplingPeriod;
+	      anInterpolation.Start();
+	      lSum += aPolynomeX.Compute(t) + aPolynomeX.ComputeDerivative(t) +
+		aPolynomeX.ComputeSecDerivative(t);
+	      lSum += aPolynomeY.Compute(t) + aPolynomeY.ComputeDerivative(t) +
+		aPolynomeY.ComputeSecDerivative(t);
+	      lSum += aPolynomeZ.Compute(t) + aPolynomeZ.ComputeDerivative(t) +
+		aPolynomeZ.ComputeSecDerivative(t);
+	      lSum += aPolynomeOmega.Compute(t) + aPolynomeOmega.ComputeDerivative(t);
+	      anInterpolation.Stop();
+	    }
+	}
+    /* Keep the computations. */
+    return (lSum==lSum) ? 0 : -1;
+  }
+
+  /* Analytical trajectories of the CoM and the ZMP. */
+  int BenchmarkMorisawa(unsigned int NbOfRepetitions,
+			BenchmarkCase & aSolve,
+			BenchmarkCase & aSampling)
+  {
+    SimplePluginManager aSPM;
+    MorisawaSolver aMorisawa(&aSPM);
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      {
+	aSolve.Start();
+	aMorisawa.Solve(NbOfSteps);
+	aSolve.Stop();
+
+	double lDuration = aMorisawa.Duration();
+	for(double t=0.0;t<lDuration;t+=SamplingPeriod)
+	  {
+	    double CoMX, CoMY, ZMPX, ZMPY;
+	    aSampling.Start();
+	    bool lStatus = aMorisawa.Sample(t,CoMX,CoMY,ZMPX,ZMPY);
+	    aSampling.Stop();
+	    if (!lStatus)
+	      return -1;
+	  }
+      }
+    return 0;
+  }
+
+  /* Control loop of the pattern generator on the synthetic humanoid
+     with the algorithm anAlgorithm, for one walk per repetition.
+     The online walk of Herdt lasts 6 s. */
+  int BenchmarkControlLoop(unsigned int NbOfRepetitions,
+			   const string & anAlgorithm,
+			   BenchmarkCase & anIteration)
+  {
+    const unsigned int NbOfOnLineIterations = 1200;
+    const unsigned int MaxNbOfIterations = 4000;
+
+    dynamicsJRLJapan::ObjectFactory aFactory;
+    SyntheticHumanoidParameters lParameters;
+    MAL_VECTOR(lHalfSitting,double);
+    syntheticHumanoidHalfSitting(lParameters,lHalfSitting);
+
+    for(unsigned int r=0;r<NbOfRepetitions;r++)
+      {
+	CjrlHumanoidDynamicRobot * aHDR =
+	  createSyntheticHumanoid(aFactory,lParameters);
+	if (aHDR==0)
+	  return -1;
+	PatternGeneratorInterface * aPGI =
+	  patternGeneratorInterfaceFactory(aHDR);
+	aPGI->SetCurrentJointValues(lHalfSitting);
+
+	CommonInitialization(*aPGI);
+	bool lOnLine = (anAlgorithm=="Herdt");
+	string lCommands[5];
+	lCommands[0] = ":SetAlgoForZmpTrajectory " + anAlgorithm;
+	if (lOnLine)
+	  {
+	    lCommands[1] = ":singlesupporttime 0.7";
+	    lCommands[2] = ":doublesupporttime 0.1";
+	    lCommands[3] = ":HerdtOnline";
+	    lCommands[4] = ":setVelReference 0.2 0.0 0.0";
+	  }
+	else
+	  lCommands[1] = ":stepseq 0.0 -0.105 0.0 0.2 0.19 0.0 0.2 -0.19 0.0"
+	    " 0.2 0.19 0.0 0.2 -0.19 0.0 0.2 0.19 0.0 0.0 -0.19 0.0";
+	for(unsigned int i=0;i<5;i++)
+	  if (!lCommands[i].empty())
+	    {
+	      istringstream strm(lCommands[i]);
+	      aPGI->ParseCmd(strm);
+	    }
+
+	unsigned int lNbDofs = aHDR->numberDof();
+	MAL_VECTOR_DIM(CurrentConfiguration,double,lNbDofs);
+	MAL_VECTOR_DIM(CurrentVelocity,double,lNbDofs);
+	MAL_VECTOR_DIM(CurrentAcceleration,double,lNbDofs);
+	MAL_VECTOR_DIM(ZMPTarget,double,3);
+	COMPosition aCOMPosition;
+	FootAbsolutePosition aLeftFoot, aRightFoot;
+
+	bool ok = true;
+	unsigned int lNbOfIterations = lOnLine ?
+	  NbOfOnLineIterations : MaxNbOfIterations;
+	for(unsigned int i=0;(i<lNbOfIterations) && ok;i++)
+	  {
+	    anIteration.Start();
+	    ok = aPGI->RunOneStepOfTheControlLoop(CurrentConfiguration,
+						  CurrentVelocity,
+						  CurrentAcceleration,
+						  ZMPTarget,
+						  aCOMPosition,
+						  aLeftFoot,
+						  aRightFoot);
+	    anIteration.Stop();
+	  }
+
+	delete aPGI;
+	delete aHDR;
+	// The online walk never stops, the others must.
+	if (lOnLine ? !ok : ok)
+	  return -1;
+      }
+    return 0;
+  }
+
+  void DisplayCases(const vector<BenchmarkCase *> & Cases)
+  {
+    cout << setw(28) << left << "case" << right
+	 << setw(9) << "calls"
+	 << setw(11) << "mean(us)"
+	 << setw(11) << "p50(us)"
+	 << setw(11) << "p90(us)"
+	 << setw(11) << "p99(us)"
+	 << setw(11) << "max(us)"
+	 << setw(13) << "calls/s" << endl;
+    cout << fixed << setprecision(2);
+    for(unsigned int i=0;i<Cases.size();i++)
+      {
+	const LatencyHistogram & aH = Cases[i]->Histogram();
+	cout << setw(28) << left << Cases[i]->Name() << right
+	     << setw(9) << aH.NbOfSamples()
+	     << setw(11) << 1e-3*Cases[i]->Mean()
+	     << setw(11) << 1e-3*aH.Percentile(0.5)
+	     << setw(11) << 1e-3*aH.Percentile(0.9)
+	     << setw(11) << 1e-3*aH.Percentile(0.99)
+	     << setw(11) << 1e-3*aH.Maximum()
+	     << setw(13) << setprecision(0) << Cases[i]->Throughput()
+	     << setprecision(2) << endl;
+      }
+  }
+
+  bool WriteCases(const string & aFileName,
+		  const vector<BenchmarkCase *> & Cases)
+  {
+    ofstream aof(aFileName.c_str(),ofstream::out);
+    if (!aof.is_open())
+      return false;
+
+    aof << "{\"unit\":\"ns\",\"benchmarks\":[" << endl;
+    aof << fixed << setprecision(1);
+    for(unsigned int i=0;i<Cases.size();i++)
+      {
+	const LatencyHistogram & aH = Cases[i]->Histogram();
+	aof << "{\"name\":\"" << Cases[i]->Name() << "\""
+	    << ",\"calls\":" << aH.NbOfSamples()
+	    << ",\"mean\":" << Cases[i]->Mean()
+	    << ",\"p50\":" << aH.Percentile(0.5)
+	    << ",\"p90\":" << aH.Percentile(0.9)
+	    << ",\"p99\":" << aH.Percentile(0.99)
+	    << ",\"max\":" << aH.Maximum()
+	    << ",\"throughput\":" << Cases[i]->Throughput() << "}";
+	if (i+1<Cases.size())
+	  aof << ",";
+	aof << endl;
+      }
+    aof << "]}" << endl;
+    return true;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int NbOfRepetitions = 20;
+  string aFileName("BenchmarkGenerators.json");
+  if (argc>1)
+    NbOfRepetitions = atoi(argv[1]);
+  if (argc>2)
+    aFileName = argv[2];
+
+  BenchmarkCase aCholeskyUpdate("OptCholesky::Add"),
+    aCholeskyDowndate("OptCholesky::Remove"),
+    aPLDPSolve("PLDPSolver::SolveProblem"),
+    aPreviewWeights("PreviewControl::Weights"),
+    aPreviewIteration("PreviewControl::Iteration"),
+    aFootSetup("FootTrajectory::Setup"),
+    aFootInterpolation("FootTrajectory::Sample"),
+    aMorisawaSolve("AnalyticalMorisawa::Solve"),
+    aMorisawaSampling("AnalyticalMorisawa::Sample"),
+    aKajitaLoop("ControlLoop::Kajita"),
+    aMorisawaLoop("ControlLoop::Morisawa"),
+    aHerdtLoop("ControlLoop::Herdt");
+
+  /* Algorithms of :SetAlgoForZmpTrajectory. Dimitrov is not timed:
+     CreateZMPReferences does not call it (the branch is commented out). */
+  const unsigned int NbOfAlgorithms = 3;
+  const string Algorithms[NbOfAlgorithms] =
+    { "Kajita", "Morisawa", "Herdt" };
+  BenchmarkCase * aControlLoops[NbOfAlgorithms] =
+    { &aKajitaLoop, &aMorisawaLoop, &aHerdtLoop };
+
+  if (BenchmarkOptCholesky(NbOfRepetitions,aCholeskyUpdate,aCholeskyDowndate)<0)
+    {
+      cerr << "OptCholesky failed." << endl;
+      return -1;
+    }
+  if (BenchmarkPLDP(NbOfRepetitions,aPLDPSolve)<0)
+    {
+      cerr << "PLDPSolver failed." << endl;
+      return -1;
+    }
+  if (BenchmarkPreviewControl(NbOfRepetitions,aPreviewWeights,aPreviewIteration)<0)
+    {
+      cerr << "PreviewControl failed." << endl;
+      return -1;
+    }
+  if (BenchmarkFootTrajectory(NbOfRepetitions,aFootSetup,aFootInterpolation)<0)
+    {
+      cerr << "Foot trajectory failed." << endl;
+      return -1;
+    }
+  if (BenchmarkMorisawa(NbOfRepetitions,aMorisawaSolve,aMorisawaSampling)<0)
+    {
+      cerr << "AnalyticalMorisawaCompact failed." << endl;
+      return -1;
+    }
+
+  // A few walks are enough, each one gives more than a thousand calls.
+  unsigned int NbOfWalks = (NbOfRepetitions+9)/10;
+  for(unsigned int i=0;i<NbOfAlgorithms;i++)
+    if (BenchmarkControlLoop(NbOfWalks,Algorithms[i],*aControlLoops[i])<0)
+      {
+	cerr << "Control loop with " << Algorithms[i] << " failed." << endl;
+	return -1;
+      }
+
+  vector<BenchmarkCase *> Cases;
+  Cases.push_back(&aCholeskyUpdate);
+  Cases.push_back(&aCholeskyDowndate);
+  Cases.push_back(&aPLDPSolve);
+  Cases.push_back(&aPreviewWeights);
+  Cases.push_back(&aPreviewIteration);
+  Cases.push_back(&aFootSetup);
+  Cases.push_back(&aFootInterpolation);
+  Cases.push_back(&aMorisawaSolve);
+  Cases.push_back(&aMorisawaSampling);
+  for(unsigned int i=0;i<NbOfAlgorithms;i++)
+    Cases.push_back(aControlLoops[i]);
+
+  DisplayCases(Cases);
+  if (!WriteCases(aFileName,Cases))
+    {
+      cerr << "Unable to write " << aFileName << endl;
+      return -1;
+    }
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file BenchmarkPLDPSolver.cpp
+  \brief Run the PLDP solver on the problems built by
+  ZMPConstrainedQPFastFormulation for a straight walk.
+
+  The problems are given by ZMPQPProblem.
+  The program fails if a solution violates the constraints.
+
+  Usage: BenchmarkPLDPSolver [NbOfSteps] [TimeLimit]
+  A negative time limit lets the solver converge.
+*/
+
+#include <stdlib.h>
+
+#include <iostream>
+
+#include "Mathematics/PLDPSolver.hh"
+#include "ZMPQPProblem.hh"
+
+using namespace std;
+using namespace Optimization::Solver;
+using namespace PatternGeneratorJRL::TestSuite;
+
+int main(int argc, char *argv[])
+{
+  unsigned int NbOfSteps = 8;
+  double TimeLimit = -1.0;
+  if (argc>1)
+    NbOfSteps = atoi(argv[1]);
+  if (argc>2)
+    TimeLimit = atof(argv[2]);
+
+  ZMPQPProblem aPb(NbOfSteps);
+  if (aPb.Initialize()<0)
+    {
+      cerr << "Unable to factorize the cost function." << endl;
+      return -1;
+    }
+
+  PLDPSolver aSolver(ZMPQPProblem::N,aPb.iPu,aPb.Px,aPb.lPu,aPb.iLQ);
+  aSolver.SetLimitedComputationTime(TimeLimit);
+
+  unsigned int NbOfIterations = aPb.NbOfIterations();
+  unsigned int MaxIt=0, MaxActive=0, NbOfTimeLimits=0, NbOfViolations=0;
+  double SumIt=0.0, SumActivations=0.0, SumHotStart=0.0;
+  double SumTime=0.0, MaxTime=0.0;
+
+  for(unsigned int lk=0;lk<NbOfIterations;lk++)
+    {
+      aPb.BuildIteration(lk);
+
+      if (aSolver.SolveProblem(aPb.D,ZMPQPProblem::NbOfConstraints,
+			       &aPb.DPu[0],&aPb.DPx[0],
+			       aPb.ZMPRef,aPb.XkYk,aPb.V,aPb.SimilarConstraints,
+			       (lk==0) ? 0 : 4,(lk==0))<0)
+	{
+	  cerr << "Solver failed at iteration " << lk << endl;
+	  return -1;
+	}
+
+      const PLDPSolveStatistics_t & lStats = aSolver.GetStatistics();
+      SumIt += lStats.NbOfIterations;
+      SumActivations += lStats.NbOfActivations;
+      SumHotStart += lStats.NbOfHotStartConstraints;
+      SumTime += lStats.ComputationTime;
+      if (lStats.NbOfIterations>MaxIt)
+	MaxIt = lStats.NbOfIterations;
+      if (lStats.NbOfActiveConstraints>MaxActive)
+	MaxActive = lStats.NbOfActiveConstraints;
+      if (lStats.ComputationTime>MaxTime)
+	MaxTime = lStats.ComputationTime;
+      if (lStats.TimeLimitReached)
+	NbOfTimeLimits++;
+
+      NbOfViolations += aPb.NbOfViolations();
+      aPb.ApplyFirstJerk();
+    }
+
+  cout << "Number of solves:            " << NbOfIterations << endl;
+  cout << "Iterations (mean/max):       " << SumIt/NbOfIterations
+       << " / " << MaxIt << endl;
+  cout << "Activations (mean):          " << SumActivations/NbOfIterations << endl;
+  cout << "Hot start constraints (mean):" << SumHotStart/NbOfIterations << endl;
+  cout << "Active set size (max):       " << MaxActive << endl;
+  cout << "Time in us (mean/max):       " << 1e6*SumTime/NbOfIterations
+       << " / " << 1e6*MaxTime << endl;
+  cout << "Stopped by the time limit:   " << NbOfTimeLimits << endl;
+  cout << "Final CoM:                   " << aPb.XkYk[0] << " " << aPb.XkYk[3] << endl;
+
+  if (NbOfViolations>0)
+    {
+      cerr << NbOfViolations << " violated constraints." << endl;
+      return -1;
+    }
+  return 0;
+}
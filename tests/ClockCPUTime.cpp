@@ -21,7 +21,11 @@
  *  Research carried out within the scope of the 
  *  Joint Japanese-French Robotics Laboratory (JRL)
  */
+#include <math.h>
+
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include "ClockCPUTime.hh"
 
@@ -55,6 +59,11 @@ namespace PatternGeneratorJRL
       m_totalmodificationtime = 0.0;
       m_NbOfItToCompute = 0;
       m_nbofmodifs = 0;
+      m_beginCPU = 0;
+      m_IterationDurations.clear();
+      m_IterationDurations.reserve(200*620);
+      m_ModificationDurations.clear();
+      m_ModificationDurations.reserve(200*620);
     }
 
     void ClockCPUTime::startingDate()
@@ -65,15 +74,12 @@ namespace PatternGeneratorJRL
     void ClockCPUTime::startPlanning()
     {
       gettimeofday(&m_begin,0);
+      m_beginCPU = ThreadCPUTime();
     }
 
     void ClockCPUTime::endPlanning()
     {
-      struct timeval end;
-      
-      gettimeofday(&end,0);
-      double ltime = end.tv_sec-m_begin.tv_sec 
-	+ 0.000001 * (end.tv_usec - m_begin.tv_usec);
+      double ltime = 1e-9*(ThreadCPUTime()-m_beginCPU);
       m_totaltimeinplanning+=ltime;
 
     }
@@ -81,6 +87,7 @@ namespace PatternGeneratorJRL
     void ClockCPUTime::startOneIteration()
     {
       gettimeofday(&m_begin,0);
+      m_beginCPU = ThreadCPUTime();
     }
 
     double ClockCPUTime::getStartOneIteration()
@@ -90,11 +97,8 @@ namespace PatternGeneratorJRL
 
     void ClockCPUTime::stopOneIteration()
     {
-      struct timeval end;
-
-      gettimeofday(&end,0);
-      m_currenttime = end.tv_sec-m_begin.tv_sec 
-	+ 0.000001 * (end.tv_usec - m_begin.tv_usec);
+      m_currenttime = 1e-9*(ThreadCPUTime()-m_beginCPU);
+      m_IterationDurations.push_back(m_currenttime);
       if (m_maxtime<m_currenttime)
 	m_maxtime = m_currenttime;
       
@@ -108,15 +112,13 @@ namespace PatternGeneratorJRL
     void ClockCPUTime::startModification()
     {
       gettimeofday(&m_begin,0);
+      m_beginCPU = ThreadCPUTime();
     }
 
     void ClockCPUTime::stopModification()
     {
-      struct timeval end;
-
-      gettimeofday(&end,0);
-      m_modificationtime = end.tv_sec - m_begin.tv_sec 
-	+ 0.000001 * (end.tv_usec - m_begin.tv_usec);
+      m_modificationtime = 1e-9*(ThreadCPUTime()-m_beginCPU);
+      m_ModificationDurations.push_back(m_modificationtime);
 
       if (m_modificationtime> 0.0005)
 	m_nbofmodifs++;
@@ -180,6 +182,104 @@ namespace PatternGeneratorJRL
 	 << m_totaltimeinplanning << " (s) " << endl;
       
     }
+
+    void ClockCPUTime::timingStatistics(vector<double> someDurations,
+					double aStatistics[3])
+    {
+      aStatistics[0] = aStatistics[1] = aStatistics[2] = 0.0;
+      if (someDurations.empty())
+	return;
+
+      for(unsigned int i=0;i<someDurations.size();i++)
+	aStatistics[0] += someDurations[i];
+      aStatistics[0] /= someDurations.size();
+
+      vector<double>::iterator it99 = someDurations.begin() +
+	(unsigned int)floor(0.99*(someDurations.size()-1));
+      nth_element(someDurations.begin(),it99,someDurations.end());
+      aStatistics[1] = *it99;
+      aStatistics[2] = *max_element(someDurations.begin(),someDurations.end());
+    }
+
+    bool ClockCPUTime::writeTimingStatistics(const string &aFileName)
+    {
+      ofstream aof(aFileName.c_str(),ofstream::out);
+      if (!aof.is_open())
+	return false;
+
+      double lIterations[3], lModifications[3];
+      timingStatistics(m_IterationDurations,lIterations);
+      timingStatistics(m_ModificationDurations,lModifications);
+
+      aof << "# CPU time per call (s): mean p99 max" << endl;
+      aof.precision(6);
+      aof << scientific;
+      aof << "iteration " << lIterations[0] << " "
+	  << lIterations[1] << " " << lIterations[2] << endl;
+      aof << "modification " << lModifications[0] << " "
+	  << lModifications[1] << " " << lModifications[2] << endl;
+      return true;
+    }
+
+    bool ClockCPUTime::compareToBaseline(const string &aFileName,
+					 double aTolerance,
+					 ostream &os)
+    {
+      ifstream aif(aFileName.c_str(),ifstream::in);
+      if (!aif.is_open())
+	{
+	  os << "No timing baseline " << aFileName << endl;
+	  return false;
+	}
+
+      double lCurrent[2][3];
+      timingStatistics(m_IterationDurations,lCurrent[0]);
+      timingStatistics(m_ModificationDurations,lCurrent[1]);
+      const string lNames[2] = { "iteration", "modification" };
+      const string lStatistics[3] = { "mean", "p99", "max" };
+
+      // Durations below the resolution of the measurements
+      // are not compared relatively.
+      const double lResolution = 20e-6;
+
+      bool r = true;
+      unsigned int lNbOfBaselines = 0;
+      string lLine;
+      while (getline(aif,lLine))
+	{
+	  if ((lLine.empty()) || (lLine[0]=='#'))
+	    continue;
+	  istringstream iss(lLine);
+	  string lName;
+	  double lBaseline[3];
+	  iss >> lName >> lBaseline[0] >> lBaseline[1] >> lBaseline[2];
+	  if (iss.fail())
+	    continue;
+	  for(unsigned int i=0;i<2;i++)
+	    {
+	      if (lName!=lNames[i])
+		continue;
+	      lNbOfBaselines++;
+	      for(unsigned int j=0;j<3;j++)
+		{
+		  double lLimit = lBaseline[j]*(1.0+aTolerance) + lResolution;
+		  bool lExceeded = (j<2) && (lCurrent[i][j]>lLimit);
+		  os << lName << " " << lStatistics[j] << ": "
+		     << lCurrent[i][j] << " (s), baseline "
+		     << lBaseline[j] << " (s)"
+		     << (lExceeded ? " EXCEEDED" : "") << endl;
+		  if (lExceeded)
+		    r = false;
+		}
+	    }
+	}
+      if (lNbOfBaselines==0)
+	{
+	  os << "No timing in the baseline " << aFileName << endl;
+	  return false;
+	}
+      return r;
+    }
     
   }
 }
@@ -21,12 +21,16 @@
  *  Research carried out within the scope of the
  *  Joint Japanese-French Robotics Laboratory (JRL)
  */
-/* \file Class to measure CPU computation time  */
+/* \file Class to measure CPU computation time
+
+   The durations are measured in CPU time of the calling thread,
+   the time stamps of the profile are dates. */
 
 #ifndef _CLOCK_CPUTIME_PATTERN_GERENATOR_UTESTING_H_
 # define _CLOCK_CPUTIME_PATTERN_GERENATOR_UTESTING_H_
 
 # include "portability/gettimeofday.hh"
+# include "portability/monotonictime.hh"
 
 /* System includes */
 #ifdef UNIX
@@ -39,6 +43,7 @@
 
 #include <time.h>
 #include <ostream>
+#include <string>
 #include <vector>
 
 #include "CommonTools.hh"
@@ -92,8 +97,36 @@ namespace PatternGeneratorJRL {
       /*! \brief Reset all counters */
       void Reset();
 
+      /*! \name Timing baseline
+	Mean, 99th percentile and maximum of the durations of the
+	iterations and of the modifications, one line each.
+	@{ */
+      /*! \brief Write the statistics of the test in aFileName. */
+      bool writeTimingStatistics(const std::string &aFileName);
+
+      /*! \brief Compare the statistics with the ones of the baseline
+	aFileName. The mean and the 99th percentile must not exceed
+	the ones of the baseline by more than aTolerance (relative).
+	The maximum is only displayed.
+	\return false if the tolerance is exceeded or if there is
+	no baseline, true otherwise. */
+      bool compareToBaseline(const std::string &aFileName,
+			     double aTolerance,
+			     std::ostream &os);
+      /*! @} */
+
     private:
 
+      /*! \brief Mean, 99th percentile and maximum of someDurations. */
+      static void timingStatistics(std::vector<double> someDurations,
+				   double aStatistics[3]);
+
+      /*! \brief CPU time at which current computation started (ns). */
+      long long m_beginCPU;
+
+      /*! \brief Durations of all the iterations and modifications. */
+      std::vector<double> m_IterationDurations, m_ModificationDurations;
+
       /*! \brief Date at the measurement started,
 	i.e. the global reference */
       struct timeval m_startingtime;
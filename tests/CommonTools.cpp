@@ -122,9 +122,17 @@ namespace PatternGeneratorJRL {
 		    unsigned int &) // TestProfil)
     {
       std::cout << "argc:" << argc << std::endl;
-      if (argc!=6)
+      if (argc==1)
 	{
-	  cerr << " This program takes 5 arguments: " << endl;
+	  // No robot files: the tests use the synthetic humanoid.
+	  VRMLPath = VRMLFileName = SpecificitiesFileName = "";
+	  LinkJointRank = InitConfig = "";
+	  cout << "No robot model given, using a synthetic humanoid." << endl;
+	}
+      else if (argc!=6)
+	{
+	  cerr << " This program takes 5 arguments, or none"
+	       << " for a synthetic humanoid: " << endl;
 	  cerr << "./TestFootPrintPGInterface \
                          PATH_TO_VRML_FILE	   \
                          VRML_FILE_NAME		   \
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ReplayCommandStream.cpp
+  \brief Replay the commands recorded by a pattern generator.
+
+  A session is recorded with ":recordcommands file", or from the
+  creation of the pattern generator with the environment variable
+  JRL_WALKGEN_RECORD_COMMANDS=file. This program creates a new
+  pattern generator with the same robot, gives it each recorded
+  command before the same step of the control loop, and displays
+  the latencies of the steps and of their stages.
+
+  Usage: ReplayCommandStream file [PATH_TO_VRML_FILE VRML_FILE_NAME
+  SPECIFICITIES_XML LINK_JOINT_RANK INIT_CONFIG]
+
+  Without robot files the robot is the synthetic humanoid.
+  Without argument a walk of the synthetic humanoid is recorded
+  and replayed, and the two trajectories are compared.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/dynamics/dynamicsfactory.hh>
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <CommandStreamRecorder.hh>
+#include <StageProfiler.hh>
+#include <portability/monotonictime.hh>
+
+#include "CommonTools.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+namespace
+{
+  /* Values of the trajectories kept at each step:
+     CoM x y z, ZMP x y, left and right feet x y z theta. */
+  const unsigned int NbOfValuesPerStep = 13;
+
+  /* Robot of the replay, the synthetic humanoid
+     when aRobotFileName is empty. */
+  CjrlHumanoidDynamicRobot * CreateRobot(dynamicsJRLJapan::ObjectFactory & aFactory,
+					 const string & aRobotFileName,
+					 const string & aSpecificitiesFileName,
+					 const string & aLinkJointRank)
+  {
+    if (aRobotFileName.empty())
+      {
+	SyntheticHumanoidParameters lParameters;
+	return createSyntheticHumanoid(aFactory,lParameters);
+      }
+    CjrlHumanoidDynamicRobot * aHDR = aFactory.createHumanoidDynamicRobot();
+    dynamicsJRLJapan::parseOpenHRPVRMLFile(*aHDR,aRobotFileName,
+					   aLinkJointRank,
+					   aSpecificitiesFileName);
+    return aHDR;
+  }
+
+  /* State of the control loop, and the trajectories of the walk. */
+  class ControlLoop
+  {
+  public:
+    explicit ControlLoop(unsigned int aNbDofs)
+    {
+      MAL_VECTOR_RESIZE(m_Configuration,aNbDofs);
+      MAL_VECTOR_RESIZE(m_Velocity,aNbDofs);
+      MAL_VECTOR_RESIZE(m_Acceleration,aNbDofs);
+      MAL_VECTOR_RESIZE(m_ZMPTarget,3);
+      MAL_VECTOR_FILL(m_Configuration,0.0);
+      MAL_VECTOR_FILL(m_Velocity,0.0);
+      MAL_VECTOR_FILL(m_Acceleration,0.0);
+      MAL_VECTOR_FILL(m_ZMPTarget,0.0);
+    }
+
+    /* One step of the control loop of aPGI, timed in aLatency. */
+    bool Step(PatternGeneratorInterface & aPGI, LatencyHistogram & aLatency)
+    {
+      COMPosition aCOMPosition;
+      FootAbsolutePosition aLeftFoot, aRightFoot;
+      long long lStart = MonotonicTime();
+      bool ok = aPGI.RunOneStepOfTheControlLoop(m_Configuration,
+						m_Velocity,
+						m_Acceleration,
+						m_ZMPTarget,
+						aCOMPosition,
+						aLeftFoot,
+						aRightFoot);
+      aLatency.Record(MonotonicTime()-lStart);
+
+      double lValues[NbOfValuesPerStep] =
+	{ aCOMPosition.x[0], aCOMPosition.y[0], aCOMPosition.z[0],
+	  m_ZMPTarget(0), m_ZMPTarget(1),
+	  aLeftFoot.x, aLeftFoot.y, aLeftFoot.z, aLeftFoot.theta,
+	  aRightFoot.x, aRightFoot.y, aRightFoot.z, aRightFoot.theta };
+      Trajectory.insert(Trajectory.end(),lValues,lValues+NbOfValuesPerStep);
+      return ok;
+    }
+
+    vector<double> Trajectory;
+
+  private:
+    MAL_VECTOR(m_Configuration,double);
+    MAL_VECTOR(m_Velocity,double);
+    MAL_VECTOR(m_Acceleration,double);
+    MAL_VECTOR(m_ZMPTarget,double);
+  };
+
+  /* Give a recorded command to aPGI. */
+  void ApplyRecord(PatternGeneratorInterface & aPGI,
+		   const CommandStreamRecord & aRecord)
+  {
+    const vector<double> & v = aRecord.Values;
+    switch(aRecord.Type)
+      {
+      case RECORD_PARSE_CMD:
+	{
+	  istringstream strm(aRecord.Command);
+	  aPGI.ParseCmd(strm);
+	}
+	break;
+      case RECORD_JOINT_VALUES:
+	{
+	  MAL_VECTOR_DIM(lJointValues,double,v.size());
+	  for(unsigned int i=0;i<v.size();i++)
+	    lJointValues(i) = v[i];
+	  aPGI.SetCurrentJointValues(lJointValues);
+	}
+	break;
+      case RECORD_VELOCITY_REFERENCE:
+	if (v.size()==3)
+	  aPGI.setVelocityReference(v[0],v[1],v[2]);
+	break;
+      case RECORD_PERTURBATION_FORCE:
+	if (v.size()==2)
+	  aPGI.setCoMPerturbationForce(v[0],v[1]);
+	break;
+      case RECORD_ADD_ONLINE_STEP:
+	if (v.size()==3)
+	  aPGI.AddOnLineStep(v[0],v[1],v[2]);
+	break;
+      case RECORD_CHANGE_ONLINE_STEP:
+	if (v.size()==7)
+	  {
+	    FootAbsolutePosition aFAP;
+	    memset(&aFAP,0,sizeof(aFAP));
+	    aFAP.x = v[1];
+	    aFAP.y = v[2];
+	    aFAP.z = v[3];
+	    aFAP.theta = v[4];
+	    aFAP.omega = v[5];
+	    aFAP.omega2 = v[6];
+	    double newtime;
+	    try
+	      {
+		aPGI.ChangeOnLineStep(v[0],aFAP,newtime);
+	      }
+	    catch(...)
+	      {
+		cerr << "Step change of step " << aRecord.Tick
+		     << " not handled." << endl;
+	      }
+	  }
+	break;
+      default:
+	break;
+      }
+  }
+
+  /* Replay aFileName on a new pattern generator of aHDR.
+     \return the number of steps of the control loop, -1 if the
+     file is not a command stream. */
+  int Replay(const string & aFileName,
+	     CjrlHumanoidDynamicRobot * aHDR,
+	     LatencyHistogram & aLatency,
+	     vector<StageLatency> & aStageLatencies,
+	     vector<double> & aTrajectory)
+  {
+    CommandStreamReader aReader;
+    if (!aReader.Open(aFileName))
+      {
+	cerr << aFileName << " is not a command stream." << endl;
+	return -1;
+      }
+
+    // A recorder created from the environment would truncate
+    // the file being replayed.
+#ifdef WIN32
+    _putenv("JRL_WALKGEN_RECORD_COMMANDS=");
+#else
+    unsetenv("JRL_WALKGEN_RECORD_COMMANDS");
+#endif /* WIN32 */
+    PatternGeneratorInterface * aPGI = patternGeneratorInterfaceFactory(aHDR);
+    ControlLoop aControlLoop(aHDR->numberDof());
+
+    // The commands of a step are given before it. Without the last
+    // record (the recording did not end well), the replay stops
+    // after the last command.
+    CommandStreamRecord aRecord;
+    bool lNext = aReader.Next(aRecord);
+    unsigned int lTick = 0;
+    while (lNext)
+      {
+	while (lNext && (aRecord.Tick<=lTick) &&
+	       (aRecord.Type!=RECORD_END))
+	  {
+	    ApplyRecord(*aPGI,aRecord);
+	    lNext = aReader.Next(aRecord);
+	  }
+	if ((!lNext) ||
+	    ((aRecord.Type==RECORD_END) && (aRecord.Tick<=lTick)))
+	  break;
+
+	aControlLoop.Step(*aPGI,aLatency);
+	lTick++;
+      }
+
+    aPGI->GetStageLatencies(aStageLatencies);
+    aTrajectory.swap(aControlLoop.Trajectory);
+    delete aPGI;
+    return lTick;
+  }
+
+  void DisplayLatencies(const LatencyHistogram & aLatency,
+			const vector<StageLatency> & aStageLatencies)
+  {
+    cout << setw(24) << left << "stage" << right
+	 << setw(9) << "calls"
+	 << setw(11) << "p50(us)"
+	 << setw(11) << "p99(us)"
+	 << setw(11) << "max(us)" << endl;
+    cout << fixed << setprecision(2);
+    cout << setw(24) << left << "RunOneStep" << right
+	 << setw(9) << aLatency.NbOfSamples()
+	 << setw(11) << 1e-3*aLatency.Percentile(0.5)
+	 << setw(11) << 1e-3*aLatency.Percentile(0.99)
+	 << setw(11) << 1e-3*aLatency.Maximum() << endl;
+    for(unsigned int i=0;i<aStageLatencies.size();i++)
+      {
+	const StageLatency & aSL = aStageLatencies[i];
+	if (aSL.NbOfSamples==0)
+	  continue;
+	cout << setw(24) << left << aSL.Name << right
+	     << setw(9) << aSL.NbOfSamples
+	     << setw(11) << 1e6*aSL.Median
+	     << setw(11) << 1e6*aSL.Percentile99
+	     << setw(11) << 1e6*aSL.Maximum << endl;
+      }
+  }
+
+  /* Record a walk of the synthetic humanoid with commands of every
+     kind given to the control loop, replay it, and compare. */
+  int RecordAndReplay()
+  {
+    const string lFileName("ReplayCommandStream.bin");
+    const unsigned int NbOfSteps = 1600;
+
+    dynamicsJRLJapan::ObjectFactory aFactory;
+    SyntheticHumanoidParameters lParameters;
+    MAL_VECTOR(lHalfSitting,double);
+    syntheticHumanoidHalfSitting(lParameters,lHalfSitting);
+
+    CjrlHumanoidDynamicRobot * aHDR = createSyntheticHumanoid(aFactory,lParameters);
+    if (aHDR==0)
+      return -1;
+    PatternGeneratorInterface * aPGI = patternGeneratorInterfaceFactory(aHDR);
+    {
+      istringstream strm(":recordcommands " + lFileName);
+      aPGI->ParseCmd(strm);
+    }
+    aPGI->SetCurrentJointValues(lHalfSitting);
+    CommonInitialization(*aPGI);
+    const char * lCommands[5] =
+      { ":SetAlgoForZmpTrajectory Herdt",
+	":singlesupporttime 0.7",
+	":doublesupporttime 0.1",
+	":HerdtOnline",
+	":setVelReference 0.2 0.0 0.0" };
+    for(unsigned int i=0;i<5;i++)
+      {
+	istringstream strm(lCommands[i]);
+	aPGI->ParseCmd(strm);
+      }
+    CommandHandle lVelReference = aPGI->ResolveCommand(":setVelReference");
+
+    LatencyHistogram aRecordedLatency;
+    ControlLoop aControlLoop(aHDR->numberDof());
+    for(unsigned int i=0;i<NbOfSteps;i++)
+      {
+	if (i==300)
+	  aPGI->setVelocityReference(0.1,0.1,0.2);
+	else if (i==600)
+	  {
+	    VelocityReferenceArguments anArg;
+	    anArg.x = 0.2; anArg.y = 0.0; anArg.yaw = -0.2;
+	    aPGI->CallCommand(lVelReference,anArg);
+	  }
+	else if (i==900)
+	  aPGI->PostVelocityReference(0.0,-0.1,0.0);
+	else if (i==1200)
+	  {
+	    istringstream strm(":setVelReference 0.0 0.0 0.0");
+	    aPGI->ParseCmd(strm);
+	  }
+	if (!aControlLoop.Step(*aPGI,aRecordedLatency))
+	  break;
+      }
+    delete aPGI;
+    delete aHDR;
+
+    aHDR = createSyntheticHumanoid(aFactory,lParameters);
+    LatencyHistogram aLatency;
+    vector<StageLatency> aStageLatencies;
+    vector<double> aTrajectory;
+    int lNbOfSteps = Replay(lFileName,aHDR,aLatency,aStageLatencies,aTrajectory);
+    delete aHDR;
+    DisplayLatencies(aLatency,aStageLatencies);
+
+    if ((lNbOfSteps<0) ||
+	(aTrajectory.size()!=aControlLoop.Trajectory.size()))
+      {
+	cerr << "Replayed " << lNbOfSteps << " steps instead of "
+	     << aControlLoop.Trajectory.size()/NbOfValuesPerStep << endl;
+	return -1;
+      }
+    for(unsigned int i=0;i<aTrajectory.size();i++)
+      if (fabs(aTrajectory[i]-aControlLoop.Trajectory[i])>1e-9)
+	{
+	  cerr << "The replay differs at step " << i/NbOfValuesPerStep
+	       << ": " << aTrajectory[i] << " instead of "
+	       << aControlLoop.Trajectory[i] << endl;
+	  return -1;
+	}
+    cout << "Replayed " << lNbOfSteps << " steps." << endl;
+    return 0;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc==1)
+    return RecordAndReplay();
+
+  // The robot files follow the name of the recording.
+  string lPath, lFileName, lSpecificities, lLinkJointRank, lInitConfig;
+  unsigned int lProfile;
+  getOptions(argc-1,argv+1,lPath,lFileName,lSpecificities,
+	     lLinkJointRank,lInitConfig,lProfile);
+
+  dynamicsJRLJapan::ObjectFactory aFactory;
+  CjrlHumanoidDynamicRobot * aHDR =
+    CreateRobot(aFactory,lPath+lFileName,lSpecificities,lLinkJointRank);
+  if (aHDR==0)
+    return -1;
+
+  LatencyHistogram aLatency;
+  vector<StageLatency> aStageLatencies;
+  vector<double> aTrajectory;
+  int lNbOfSteps = Replay(argv[1],aHDR,aLatency,aStageLatencies,aTrajectory);
+  delete aHDR;
+  if (lNbOfSteps<0)
+    return -1;
+  cout << "Replayed " << lNbOfSteps << " steps." << endl;
+  DisplayLatencies(aLatency,aStageLatencies);
+  return 0;
+}
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestClosedFormLegs.cpp
+  \brief Check the closed form kinematics of the legs against the robot model.
+
+  The synthetic humanoid has no specialized inverse kinematics, so
+  ComAndFootRealizationByGeometry uses the closed form of the legs.
+  Along a motion of the CoM and of the feet:
+  - the forward kinematics of the model must put the ankles at the
+  position and orientation asked for,
+  - the analytical joint rates of the legs must match the finite
+  differences of the closed form angles,
+  - moving the legs along the analytical joint velocities must move
+  the ankles of the model at the velocity asked for.
+*/
+#include <math.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/dynamics/dynamicsfactory.hh>
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <patterngeneratorinterfaceprivate.hh>
+#include <SimplePluginManager.hh>
+#include <StepStackHandler.hh>
+#include <MotionGeneration/ComAndFootRealizationByGeometry.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const double Period = 1.6;
+
+  /* Sinusoidal motion of one coordinate. */
+  struct Motion_s
+  {
+    double Amplitude, Phase;
+  };
+
+  void Evaluate(const Motion_s & aMotion, double Offset, double Scale,
+		double t, double & x, double & dx, double & ddx)
+  {
+    const double w = 2*M_PI/Period;
+    double a = Scale*aMotion.Amplitude;
+    x = Offset + a*sin(w*t + aMotion.Phase);
+    dx = a*w*cos(w*t + aMotion.Phase);
+    ddx = -a*w*w*sin(w*t + aMotion.Phase);
+  }
+
+  /* x, y, z, roll, pitch, yaw of the CoM, angles in degrees. */
+  const Motion_s CoMMotion[6] = { { 0.03, 0.0 },
+				  { 0.05, 0.3 },
+				  { 0.01, 1.1 },
+				  { 0.0,  0.0 },
+				  { 3.0,  0.7 },
+				  { 10.0, 0.2 } };
+
+  /* x, y, z, theta, omega of the feet, angles in degrees. */
+  const Motion_s FootMotion[2][5] = { { { 0.04, 0.5 },
+					{ 0.01, 0.9 },
+					{ 0.02, 1.3 },
+					{ 15.0, 0.1 },
+					{ 8.0,  0.4 } },
+				      { { 0.05, 2.1 },
+					{ 0.015, 1.7 },
+					{ 0.03, 2.5 },
+					{ -12.0, 0.6 },
+					{ -6.0, 1.9 } } };
+
+  /* Postures at time t, the motion being scaled by Scale. */
+  void Postures(double t, double Scale,
+		const MAL_S3_VECTOR_TYPE(double) & lStartingCoM,
+		const FootAbsolutePosition InitFeet[2],
+		MAL_VECTOR_TYPE(double) & aCoM,
+		MAL_VECTOR_TYPE(double) & aCoMSpeed,
+		MAL_VECTOR_TYPE(double) & aCoMAcc,
+		MAL_VECTOR_TYPE(double) Feet[2])
+  {
+    MAL_VECTOR_RESIZE(aCoM,18);
+    MAL_VECTOR_RESIZE(aCoMSpeed,6);
+    MAL_VECTOR_RESIZE(aCoMAcc,6);
+    for(unsigned int i=0;i<6;i++)
+      {
+	// The knees are bent a little more than in the half sitting posture.
+	double lOffset = (i<2) ? lStartingCoM(i) :
+	  ((i==2) ? lStartingCoM(2) - 0.03 : 0.0);
+	Evaluate(CoMMotion[i],lOffset,Scale,t,aCoM(i),aCoM(6+i),aCoM(12+i));
+	aCoMSpeed(i) = aCoM(6+i);
+	aCoMAcc(i) = aCoM(12+i);
+      }
+
+    for(unsigned int lFoot=0;lFoot<2;lFoot++)
+      {
+	MAL_VECTOR_TYPE(double) & aFoot = Feet[lFoot];
+	MAL_VECTOR_RESIZE(aFoot,15);
+	double lOffsets[5] = { InitFeet[lFoot].x, InitFeet[lFoot].y,
+			       InitFeet[lFoot].z + 0.03, 0.0, 0.0 };
+	for(unsigned int i=0;i<5;i++)
+	  Evaluate(FootMotion[lFoot][i],lOffsets[i],Scale,t,
+		   aFoot(i),aFoot(5+i),aFoot(10+i));
+      }
+  }
+
+  /* Orientation of a foot, as in ComAndFootRealizationByGeometry. */
+  void FootOrientation(const MAL_VECTOR_TYPE(double) & aFoot, double R[3][3])
+  {
+    double c = cos(aFoot(3)*M_PI/180.0), s = sin(aFoot(3)*M_PI/180.0);
+    double co = cos(aFoot(4)*M_PI/180.0), so = sin(aFoot(4)*M_PI/180.0);
+    R[0][0] = c*co; R[0][1] = -s;  R[0][2] = c*so;
+    R[1][0] = s*co; R[1][1] = c;   R[1][2] = s*so;
+    R[2][0] = -so;  R[2][1] = 0.0; R[2][2] = co;
+  }
+
+  /* Position of the ankle asked for by a foot posture. */
+  void DesiredAnkle(const MAL_VECTOR_TYPE(double) & aFoot,
+		    const vector3d & lAnkle, double P[3])
+  {
+    double R[3][3];
+    FootOrientation(aFoot,R);
+    for(unsigned int i=0;i<3;i++)
+      P[i] = aFoot(i) + R[i][0]*lAnkle[0] + R[i][1]*lAnkle[1]
+	+ R[i][2]*lAnkle[2];
+  }
+
+  /* Pose of the ankles given by the forward kinematics of the model. */
+  void ModelAnkles(CjrlHumanoidDynamicRobot * aHDR,
+		   const MAL_VECTOR_TYPE(double) & aConfiguration,
+		   matrix4d Ankles[2])
+  {
+    aHDR->currentConfiguration(aConfiguration);
+    aHDR->computeForwardKinematics();
+    Ankles[0] = aHDR->leftAnkle()->currentTransformation();
+    Ankles[1] = aHDR->rightAnkle()->currentTransformation();
+  }
+
+  class TestClosedFormLegs
+  {
+  public:
+    TestClosedFormLegs(CjrlHumanoidDynamicRobot * aHDR,
+		       ComAndFootRealizationByGeometry * aCFR,
+		       const MAL_S3_VECTOR_TYPE(double) & lStartingCoM,
+		       const FootAbsolutePosition InitFeet[2]):
+      m_HDR(aHDR),
+      m_CFR(aCFR),
+      m_StartingCoM(lStartingCoM),
+      m_Configuration(aHDR->currentConfiguration()),
+      m_NbOfErrors(0)
+    {
+      m_InitFeet[0] = InitFeet[0];
+      m_InitFeet[1] = InitFeet[1];
+      aHDR->leftFoot()->getAnklePositionInLocalFrame(m_Ankles[0]);
+      aHDR->rightFoot()->getAnklePositionInLocalFrame(m_Ankles[1]);
+
+      CjrlJoint * Ankles[2] = { aHDR->leftAnkle(), aHDR->rightAnkle() };
+      for(unsigned int lLeg=0;lLeg<2;lLeg++)
+	{
+	  std::vector<CjrlJoint *> lChain =
+	    aHDR->jointsBetween(*aHDR->waist(),*Ankles[lLeg]);
+	  for(unsigned int i=1;i<lChain.size();i++)
+	    m_Legs[lLeg].push_back(lChain[i]->rankInConfiguration());
+	}
+    }
+
+    /* Closed form posture at time t, scaled by Scale. */
+    void Posture(double t, double Scale,
+		 MAL_VECTOR_TYPE(double) & q,
+		 MAL_VECTOR_TYPE(double) & dq,
+		 MAL_VECTOR_TYPE(double) & ddq,
+		 MAL_VECTOR_TYPE(double) Feet[2])
+    {
+      MAL_VECTOR(aCoM,double);
+      MAL_VECTOR(aCoMSpeed,double);
+      MAL_VECTOR(aCoMAcc,double);
+      Postures(t,Scale,m_StartingCoM,m_InitFeet,aCoM,aCoMSpeed,aCoMAcc,Feet);
+
+      // The feet are given to the realization as copies.
+      MAL_VECTOR_TYPE(double) lLeftFoot = Feet[0], lRightFoot = Feet[1];
+      q = m_Configuration;
+      MAL_VECTOR_RESIZE(dq,MAL_VECTOR_SIZE(q));
+      MAL_VECTOR_RESIZE(ddq,MAL_VECTOR_SIZE(q));
+      m_CFR->ComputePostureForGivenCoMAndFeetPosture(aCoM,aCoMSpeed,aCoMAcc,
+						     lLeftFoot,lRightFoot,
+						     q,dq,ddq,2,0);
+    }
+
+    void Check(const string & aName, double anError, double Tolerance)
+    {
+      if (anError>Tolerance)
+	{
+	  cerr << aName << ": error " << anError
+	       << " above " << Tolerance << endl;
+	  m_NbOfErrors++;
+	}
+    }
+
+    /* Check the sample at time t. */
+    void CheckSample(double t)
+    {
+      MAL_VECTOR(q,double);
+      MAL_VECTOR(dq,double);
+      MAL_VECTOR(ddq,double);
+      MAL_VECTOR(lNone,double);
+      MAL_VECTOR_TYPE(double) Feet[2];
+      Posture(t,1.0,q,dq,ddq,Feet);
+
+      /* Forward kinematics: pose of the ankles. */
+      matrix4d Ankles[2];
+      ModelAnkles(m_HDR,q,Ankles);
+      for(unsigned int lLeg=0;lLeg<2;lLeg++)
+	{
+	  double P[3], R[3][3], lError=0.0;
+	  DesiredAnkle(Feet[lLeg],m_Ankles[lLeg],P);
+	  for(unsigned int i=0;i<3;i++)
+	    lError = max(lError,fabs(MAL_S4x4_MATRIX_ACCESS_I_J(Ankles[lLeg],i,3)
+				     - P[i]));
+	  Check("Position of the ankle",lError,1e-9);
+
+	  // With respect to the flat foot of the reference posture.
+	  FootOrientation(Feet[lLeg],R);
+	  lError=0.0;
+	  for(unsigned int i=0;i<3;i++)
+	    for(unsigned int j=0;j<3;j++)
+	      {
+		double r=0.0;
+		for(unsigned int k=0;k<3;k++)
+		  r += MAL_S4x4_MATRIX_ACCESS_I_J(Ankles[lLeg],i,k)*
+		    MAL_S4x4_MATRIX_ACCESS_I_J(m_ReferenceAnkles[lLeg],j,k);
+		lError = max(lError,fabs(r-R[i][j]));
+	      }
+	  Check("Orientation of the ankle",lError,1e-9);
+	}
+
+      /* Joint rates against the finite differences of the angles. */
+      const double h1 = 1e-5, h2 = 1e-4;
+      MAL_VECTOR(qp,double);
+      MAL_VECTOR(qm,double);
+      MAL_VECTOR(qp2,double);
+      MAL_VECTOR(qm2,double);
+      MAL_VECTOR_TYPE(double) lFeetp[2], lFeetm[2];
+      Posture(t+h1,1.0,qp,lNone,lNone,lFeetp);
+      Posture(t-h1,1.0,qm,lNone,lNone,lFeetm);
+      {
+	MAL_VECTOR_TYPE(double) lFeet[2];
+	Posture(t+h2,1.0,qp2,lNone,lNone,lFeet);
+	Posture(t-h2,1.0,qm2,lNone,lNone,lFeet);
+      }
+      double lErrorV=0.0, lErrorA=0.0;
+      for(unsigned int lLeg=0;lLeg<2;lLeg++)
+	for(unsigned int i=0;i<m_Legs[lLeg].size();i++)
+	  {
+	    unsigned int j = m_Legs[lLeg][i];
+	    lErrorV = max(lErrorV,fabs((qp[j]-qm[j])/(2*h1) - dq[j]));
+	    lErrorA = max(lErrorA,fabs((qp2[j]-2*q[j]+qm2[j])/(h2*h2)
+				       - ddq[j]));
+	  }
+      Check("Joint velocities",lErrorV,1e-6);
+      Check("Joint accelerations",lErrorA,1e-4);
+
+      /* Moving the legs along the joint velocities, the waist
+	 along its motion, the ankles of the model follow the feet. */
+      MAL_VECTOR_TYPE(double) lqp = qp, lqm = qm;
+      for(unsigned int lLeg=0;lLeg<2;lLeg++)
+	for(unsigned int i=0;i<m_Legs[lLeg].size();i++)
+	  {
+	    unsigned int j = m_Legs[lLeg][i];
+	    lqp[j] = q[j] + h1*dq[j];
+	    lqm[j] = q[j] - h1*dq[j];
+	  }
+      matrix4d Anklesp[2], Anklesm[2];
+      ModelAnkles(m_HDR,lqp,Anklesp);
+      ModelAnkles(m_HDR,lqm,Anklesm);
+      for(unsigned int lLeg=0;lLeg<2;lLeg++)
+	{
+	  double Pp[3], Pm[3], lError=0.0;
+	  DesiredAnkle(lFeetp[lLeg],m_Ankles[lLeg],Pp);
+	  DesiredAnkle(lFeetm[lLeg],m_Ankles[lLeg],Pm);
+	  for(unsigned int i=0;i<3;i++)
+	    {
+	      double v = (MAL_S4x4_MATRIX_ACCESS_I_J(Anklesp[lLeg],i,3) -
+			  MAL_S4x4_MATRIX_ACCESS_I_J(Anklesm[lLeg],i,3))/(2*h1);
+	      lError = max(lError,fabs(v - (Pp[i]-Pm[i])/(2*h1)));
+	    }
+	  Check("Velocity of the ankle",lError,1e-6);
+	}
+    }
+
+    int Run()
+    {
+      /* Reference posture, feet flat and waist straight. */
+      MAL_VECTOR(q,double);
+      MAL_VECTOR(dq,double);
+      MAL_VECTOR(ddq,double);
+      MAL_VECTOR_TYPE(double) Feet[2];
+      Posture(0.0,0.0,q,dq,ddq,Feet);
+      ModelAnkles(m_HDR,q,m_ReferenceAnkles);
+
+      const unsigned int NbOfSamples = 16;
+      for(unsigned int k=0;k<NbOfSamples;k++)
+	CheckSample(k*Period/NbOfSamples);
+
+      if (m_NbOfErrors==0)
+	cout << "Closed form kinematics of the legs: "
+	     << NbOfSamples << " samples checked." << endl;
+      return (m_NbOfErrors==0) ? 0 : -1;
+    }
+
+  private:
+    CjrlHumanoidDynamicRobot * m_HDR;
+    ComAndFootRealizationByGeometry * m_CFR;
+    MAL_S3_VECTOR_TYPE(double) m_StartingCoM;
+    FootAbsolutePosition m_InitFeet[2];
+    MAL_VECTOR_TYPE(double) m_Configuration;
+    vector3d m_Ankles[2];
+    std::vector<unsigned int> m_Legs[2];
+    matrix4d m_ReferenceAnkles[2];
+    unsigned int m_NbOfErrors;
+  };
+}
+
+int main()
+{
+  dynamicsJRLJapan::ObjectFactory aFactory;
+  SyntheticHumanoidParameters lParameters;
+  MAL_VECTOR(lHalfSitting,double);
+  syntheticHumanoidHalfSitting(lParameters,lHalfSitting);
+
+  CjrlHumanoidDynamicRobot * aHDR =
+    createSyntheticHumanoid(aFactory,lParameters);
+  if (aHDR==0)
+    return -1;
+  PatternGeneratorInterface * aPGI = patternGeneratorInterfaceFactory(aHDR);
+  aPGI->SetCurrentJointValues(lHalfSitting);
+  PatternGeneratorInterfacePrivate * aPGIP =
+    dynamic_cast<PatternGeneratorInterfacePrivate *>(aPGI);
+
+  SimplePluginManager aSPM;
+  StepStackHandler aSSH(&aSPM);
+
+  ComAndFootRealizationByGeometry * aCFR =
+    new ComAndFootRealizationByGeometry(aPGIP);
+  aCFR->setHumanoidDynamicRobot(aHDR);
+  aCFR->SetHeightOfTheCoM(0.814);
+  aCFR->setSamplingPeriod(0.005);
+  aCFR->SetStepStackHandler(&aSSH);
+  aCFR->Initialization();
+
+  MAL_S3_VECTOR(lStartingCoM,double);
+  MAL_VECTOR(lWaistPose,double);
+  FootAbsolutePosition InitFeet[2];
+  aCFR->InitializationCoM(lHalfSitting,lStartingCoM,lWaistPose,
+			  InitFeet[0],InitFeet[1]);
+
+  istringstream strm("analytical");
+  string aMethod(":jointrates");
+  aCFR->CallMethod(aMethod,strm);
+
+  int r;
+  {
+    TestClosedFormLegs aTest(aHDR,aCFR,lStartingCoM,InitFeet);
+    r = aTest.Run();
+  }
+
+  delete aCFR;
+  delete aPGI;
+  delete aHDR;
+  return r;
+}
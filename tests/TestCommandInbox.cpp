@@ -0,0 +1,133 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestCommandInbox.cpp
+  \brief Several threads post commands while the main thread reads
+  them, check that no command is lost or duplicated, and that the
+  velocity reference is never read half written.
+*/
+
+#include <iostream>
+#include <vector>
+
+#include <CommandInbox.hh>
+#include <portability/thread.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+const unsigned int g_NbProducers = 4;
+const unsigned int g_NbCommands = 20000;
+
+struct Producer_s
+{
+  CommandInbox * Inbox;
+  unsigned int Id;
+};
+
+void Produce(void * anArgument)
+{
+  Producer_s * aProducer = (Producer_s *)anArgument;
+  CommandInbox::Command_s aCommand;
+  aCommand.Type = CommandInbox::PERTURBATION_FORCE;
+  for(unsigned int i=0;i<g_NbCommands;i++)
+    {
+      aCommand.Values[0] = aProducer->Id;
+      aCommand.Values[1] = i;
+      aCommand.Values[2] = -(double)i;
+      while(!aProducer->Inbox->Push(aCommand))
+	Thread::YieldCpu();
+      // The three values are always equal.
+      aProducer->Inbox->PostVelocityReference(i,i,i);
+    }
+}
+
+int main()
+{
+  CommandInbox anInbox(16);
+  Producer_s lProducers[g_NbProducers];
+  Thread lThreads[g_NbProducers];
+
+  for(unsigned int i=0;i<g_NbProducers;i++)
+    {
+      lProducers[i].Inbox = &anInbox;
+      lProducers[i].Id = i;
+      if (lThreads[i].Start(Produce,&lProducers[i])<0)
+	{
+	  cerr << "Unable to start a thread." << endl;
+	  return -1;
+	}
+    }
+
+  // The commands of one producer come in order.
+  vector<unsigned int> lNext(g_NbProducers,0);
+  unsigned int lNbReceived = 0;
+  CommandInbox::Command_s aCommand;
+  double x,y,yaw;
+  while(lNbReceived<g_NbProducers*g_NbCommands)
+    {
+      if (anInbox.PopVelocityReference(x,y,yaw) &&
+	  ((x!=y) || (x!=yaw)))
+	{
+	  cerr << "Torn velocity reference." << endl;
+	  return -1;
+	}
+
+      if (!anInbox.Pop(aCommand))
+	{
+	  Thread::YieldCpu();
+	  continue;
+	}
+      unsigned int lId = (unsigned int)aCommand.Values[0];
+      if ((lId>=g_NbProducers) ||
+	  (aCommand.Values[1]!=lNext[lId]) ||
+	  (aCommand.Values[2]!=-aCommand.Values[1]))
+	{
+	  cerr << "Wrong command from " << lId << endl;
+	  return -1;
+	}
+      lNext[lId]++;
+      lNbReceived++;
+    }
+
+  for(unsigned int i=0;i<g_NbProducers;i++)
+    lThreads[i].Join();
+
+  if (anInbox.Pop(aCommand))
+    {
+      cerr << "Extra command." << endl;
+      return -1;
+    }
+
+  // Only the last velocity reference is kept.
+  anInbox.PostVelocityReference(1.0,2.0,3.0);
+  anInbox.PostVelocityReference(4.0,5.0,6.0);
+  if ((!anInbox.PopVelocityReference(x,y,yaw)) ||
+      (x!=4.0) || (y!=5.0) || (yaw!=6.0) ||
+      (anInbox.PopVelocityReference(x,y,yaw)))
+    {
+      cerr << "Wrong coalescing of the velocity references." << endl;
+      return -1;
+    }
+  return 0;
+}
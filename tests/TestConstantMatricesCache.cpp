@@ -0,0 +1,115 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestConstantMatricesCache.cpp
+  \brief Store and reload matrices through the persistent cache,
+  and check that a wrong key or a corrupted file are rejected.
+*/
+
+#include <stdio.h>
+
+#include <iostream>
+#include <vector>
+
+#include "Mathematics/ConstantMatricesCache.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+void SetKey(ConstantMatricesCache & aCache, double T)
+{
+  aCache.AddToKey(T);
+  aCache.AddToKey(16);
+  aCache.AddToKey(0.814);
+}
+
+int main()
+{
+  const unsigned int n1=256, n2=96;
+  vector<double> A(n1), B(n2);
+  for(unsigned int i=0;i<n1;i++)
+    A[i] = 1.0/(i+1);
+  for(unsigned int i=0;i<n2;i++)
+    B[i] = -3.0*i;
+
+  ConstantMatricesCache aStoringCache(".","TestConstantMatricesCache");
+  SetKey(aStoringCache,0.1);
+  aStoringCache.AddArray(&A[0],n1);
+  aStoringCache.AddArray(&B[0],n2);
+  if (aStoringCache.Save()<0)
+    {
+      cerr << "Unable to write " << aStoringCache.FileName() << endl;
+      return -1;
+    }
+
+  // Reload with the same key.
+  vector<double> lA(n1,0.0), lB(n2,0.0);
+  ConstantMatricesCache aLoadingCache(".","TestConstantMatricesCache");
+  SetKey(aLoadingCache,0.1);
+  aLoadingCache.AddArray(&lA[0],n1);
+  aLoadingCache.AddArray(&lB[0],n2);
+  if ((aLoadingCache.Load()<0) || (lA!=A) || (lB!=B))
+    {
+      cerr << "The matrices were not reloaded." << endl;
+      return -1;
+    }
+
+  // Another key should not find the file.
+  ConstantMatricesCache aWrongKeyCache(".","TestConstantMatricesCache");
+  SetKey(aWrongKeyCache,0.02);
+  aWrongKeyCache.AddArray(&lA[0],n1);
+  aWrongKeyCache.AddArray(&lB[0],n2);
+  if (aWrongKeyCache.Load()==0)
+    {
+      cerr << "A file with a wrong key has been accepted." << endl;
+      return -1;
+    }
+
+  // Different sizes are rejected.
+  ConstantMatricesCache aWrongSizeCache(".","TestConstantMatricesCache");
+  SetKey(aWrongSizeCache,0.1);
+  aWrongSizeCache.AddArray(&lA[0],n1);
+  aWrongSizeCache.AddArray(&lB[0],n2-1);
+  if (aWrongSizeCache.Load()==0)
+    {
+      cerr << "A file with wrong sizes has been accepted." << endl;
+      return -1;
+    }
+
+  // Corrupt one value of the data.
+  FILE * fp = fopen(aStoringCache.FileName().c_str(),"r+b");
+  if (fp==0)
+    return -1;
+  fseek(fp,-8,SEEK_END);
+  double lValue = 42.0;
+  fwrite(&lValue,sizeof(double),1,fp);
+  fclose(fp);
+  if (aLoadingCache.Load()==0)
+    {
+      cerr << "A corrupted file has been accepted." << endl;
+      return -1;
+    }
+
+  remove(aStoringCache.FileName().c_str());
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestConstantsCacheReload.cpp
+  \brief Build the constant matrices of the fast formulation, store
+  them in the cache, reload them in a new instance and compare them
+  element by element with the ones built without the cache.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <string>
+
+#include <jrl/dynamics/dynamicsfactory.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <SimplePluginManager.hh>
+#include <Mathematics/ConstantMatricesCache.hh>
+#include <ZMPRefTrajectoryGeneration/ZMPConstrainedQPFastFormulation.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  void SetCacheDirectory(const char * aDirectory)
+  {
+#ifdef WIN32
+    string lVariable = string("JRL_WALKGEN_CACHE_DIR=") +
+      (aDirectory==0 ? "" : aDirectory);
+    _putenv(lVariable.c_str());
+#else
+    if (aDirectory==0)
+      unsetenv("JRL_WALKGEN_CACHE_DIR");
+    else
+      setenv("JRL_WALKGEN_CACHE_DIR",aDirectory,1);
+#endif /* WIN32 */
+  }
+
+  /* Returns the number of elements which differ. */
+  unsigned int Compare(const char * aName,
+		       const MAL_MATRIX_TYPE(double) & A,
+		       const MAL_MATRIX_TYPE(double) & B)
+  {
+    if ((MAL_MATRIX_NB_ROWS(A)!=MAL_MATRIX_NB_ROWS(B)) ||
+	(MAL_MATRIX_NB_COLS(A)!=MAL_MATRIX_NB_COLS(B)) ||
+	(MAL_MATRIX_NB_ROWS(A)==0))
+      {
+	cerr << aName << ": sizes differ or are empty." << endl;
+	return 1;
+      }
+
+    unsigned int lNbOfErrors = 0;
+    for(unsigned int i=0;i<MAL_MATRIX_NB_ROWS(A);i++)
+      for(unsigned int j=0;j<MAL_MATRIX_NB_COLS(A);j++)
+	if (A(i,j)!=B(i,j))
+	  {
+	    if (lNbOfErrors==0)
+	      cerr << aName << "(" << i << "," << j << "): "
+		   << A(i,j) << " != " << B(i,j) << endl;
+	    lNbOfErrors++;
+	  }
+    return lNbOfErrors;
+  }
+
+  unsigned int Compare(ZMPConstrainedQPFastFormulation & A,
+		       ZMPConstrainedQPFastFormulation & B)
+  {
+    return Compare("OptB",A.GetOptB(),B.GetOptB()) +
+      Compare("OptC",A.GetOptC(),B.GetOptC()) +
+      Compare("iLQ",A.GetiLQ(),B.GetiLQ()) +
+      Compare("iPu",A.GetiPu(),B.GetiPu());
+  }
+}
+
+int main()
+{
+  dynamicsJRLJapan::ObjectFactory aFactory;
+  SyntheticHumanoidParameters lParameters;
+  CjrlHumanoidDynamicRobot * aHDR =
+    createSyntheticHumanoid(aFactory,lParameters);
+  if (aHDR==0)
+    return -1;
+
+  SimplePluginManager aSPM;
+
+  // Reference: built without the cache.
+  SetCacheDirectory(0);
+  ZMPConstrainedQPFastFormulation * aReference =
+    new ZMPConstrainedQPFastFormulation(&aSPM,"",aHDR);
+
+  // Remove a file left by a previous run.
+  ConstantMatricesCache aCache(".","ZMPConstrainedQPFastFormulation");
+  aReference->PrepareConstantsCache(aCache);
+  string lFileName = aCache.FileName();
+  remove(lFileName.c_str());
+
+  // Built and stored.
+  SetCacheDirectory(".");
+  ZMPConstrainedQPFastFormulation * aStoring =
+    new ZMPConstrainedQPFastFormulation(&aSPM,"",aHDR);
+  FILE * fp = fopen(lFileName.c_str(),"rb");
+  if (fp==0)
+    {
+      cerr << "The cache file " << lFileName << " was not written." << endl;
+      return -1;
+    }
+  fclose(fp);
+
+  // Reloaded.
+  ZMPConstrainedQPFastFormulation * aLoading =
+    new ZMPConstrainedQPFastFormulation(&aSPM,"",aHDR);
+  SetCacheDirectory(0);
+
+  unsigned int lNbOfErrors = Compare(*aReference,*aStoring) +
+    Compare(*aReference,*aLoading);
+
+  delete aLoading;
+  delete aStoring;
+  delete aReference;
+  delete aHDR;
+  remove(lFileName.c_str());
+
+  if (lNbOfErrors!=0)
+    {
+      cerr << lNbOfErrors << " elements differ." << endl;
+      return -1;
+    }
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestFootConstraintsAsLinearSystem.cpp
+  \brief Compute the linear system of convex polygons with a number
+  of points below, at and above ComputeConvexHull::MaxNbPoints.
+*/
+#include <math.h>
+
+#include <iostream>
+#include <vector>
+
+#include <SimplePluginManager.hh>
+#include <Mathematics/FootConstraintsAsLinearSystem.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const double CenterX = 0.2, CenterY = -0.05, Radius = 0.1;
+
+  /* Value of the constraint i at (x,y), non negative inside. */
+  double Constraint(MAL_MATRIX(&A,double), MAL_MATRIX(&B,double),
+		    unsigned int i, double x, double y)
+  {
+    return A(i,0)*x + A(i,1)*y + B(i,0);
+  }
+
+  /* Returns 0 if the system of the regular polygon with n points
+     holds its center and rejects the points around it. */
+  int CheckPolygon(FootConstraintsAsLinearSystem & aFCALS, unsigned int n)
+  {
+    // Counter-clockwise, starting from the point with the smallest y.
+    vector<CH_Point> lPoints(n);
+    for(unsigned int i=0;i<n;i++)
+      {
+	double lAngle = -M_PI/2 + 2*M_PI*i/n;
+	lPoints[i].col = CenterX + Radius*cos(lAngle);
+	lPoints[i].row = CenterY + Radius*sin(lAngle);
+      }
+
+    MAL_MATRIX(A,double);
+    MAL_MATRIX(B,double);
+    MAL_VECTOR(C,double);
+    if (aFCALS.ComputeLinearSystem(lPoints,A,B,C)<0)
+      {
+	cerr << n << " points: the linear system was not computed." << endl;
+	return -1;
+      }
+    if ((MAL_MATRIX_NB_ROWS(A)!=n) || (MAL_MATRIX_NB_ROWS(B)!=n))
+      {
+	cerr << n << " points: " << MAL_MATRIX_NB_ROWS(A)
+	     << " constraints." << endl;
+	return -1;
+      }
+
+    // Same values as the allocation-free version.
+    vector<double> lA(2*n), lB(n), lC(2);
+    aFCALS.ComputeLinearSystem(&lPoints[0],n,&lA[0],&lB[0],&lC[0]);
+    for(unsigned int i=0;i<n;i++)
+      if ((A(i,0)!=lA[2*i]) || (A(i,1)!=lA[2*i+1]) || (B(i,0)!=lB[i]))
+	{
+	  cerr << n << " points: constraint " << i << " differs." << endl;
+	  return -1;
+	}
+
+    for(unsigned int i=0;i<n;i++)
+      if (Constraint(A,B,i,CenterX,CenterY)<0.0)
+	{
+	  cerr << n << " points: the center is outside." << endl;
+	  return -1;
+	}
+
+    // A point beyond each vertex violates a constraint.
+    for(unsigned int k=0;k<n;k++)
+      {
+	double x = CenterX + 1.1*(lPoints[k].col-CenterX);
+	double y = CenterY + 1.1*(lPoints[k].row-CenterY);
+	bool lOutside = false;
+	for(unsigned int i=0;i<n;i++)
+	  if (Constraint(A,B,i,x,y)<0.0)
+	    lOutside = true;
+	if (!lOutside)
+	  {
+	    cerr << n << " points: (" << x << "," << y
+		 << ") is not rejected." << endl;
+	    return -1;
+	  }
+      }
+    return 0;
+  }
+}
+
+int main()
+{
+  SimplePluginManager aSPM;
+  FootConstraintsAsLinearSystem aFCALS(&aSPM,0);
+
+  const unsigned int Max = ComputeConvexHull::MaxNbPoints;
+  const unsigned int lNbOfPoints[5] = { 4, 6, Max, Max+1, 3*Max };
+  for(unsigned int i=0;i<5;i++)
+    if (CheckPolygon(aFCALS,lNbOfPoints[i])<0)
+      return -1;
+  return 0;
+}
@@ -25,7 +25,13 @@
  * Olivier Stasse
  */
 
+#include <stdlib.h>
+#ifdef UNIX
+#include <unistd.h>
+#endif /* UNIX */
+
 #include <fstream>
+#include <vector>
 #include "Debug.hh"
 #include "TestObject.hh"
 
@@ -33,6 +39,10 @@ using namespace std;
 
 #define NB_OF_FIELDS 38
 
+#ifndef PERF_BASELINE_DIR
+#define PERF_BASELINE_DIR "."
+#endif
+
 #ifdef WIN32
 double trunc (double x)
 {
@@ -56,6 +66,61 @@ namespace PatternGeneratorJRL
     }
 
 
+    namespace
+    {
+      /* Resident set size of the process in kB, 0 when unknown. */
+      long ResidentSetSize()
+      {
+	long lRSS = 0;
+#ifdef UNIX
+	ifstream aif("/proc/self/statm",ifstream::in);
+	long lSize=0, lResident=0;
+	if (aif >> lSize >> lResident)
+	  lRSS = lResident*(sysconf(_SC_PAGESIZE)/1024);
+#endif /* UNIX */
+	return lRSS;
+      }
+
+      /* Uniform number in [0,1), the same on every platform. */
+      double SoakRandom(unsigned int &aState)
+      {
+	aState = aState*1103515245u + 12345u;
+	return (double)((aState>>16) & 0x7fff)/32768.0;
+      }
+
+      /* True when the samples after the first one never decrease,
+	 and still increase of more than aSlack in the second half. */
+      bool GrowsMonotonically(const vector<double> &aSamples, double aSlack)
+      {
+	unsigned int n = aSamples.size();
+	if (n<5)
+	  return false;
+	for(unsigned int i=2;i<n;i++)
+	  if (aSamples[i]<aSamples[i-1])
+	    return false;
+	return aSamples[n-1]-aSamples[(n+1)/2] > aSlack;
+      }
+
+      /* Mean of the samples in [aBegin,aEnd). */
+      double MeanOf(const vector<double> &aSamples,
+		    unsigned int aBegin, unsigned int aEnd)
+      {
+	double r=0.0;
+	for(unsigned int i=aBegin;i<aEnd;i++)
+	  r += aSamples[i];
+	return (aEnd>aBegin) ? r/(aEnd-aBegin) : 0.0;
+      }
+    }
+
+    TestObject::SoakParameters::SoakParameters():
+      Duration(60.0),
+      CommandPeriod(2.0),
+      SamplingPeriod(5.0),
+      Seed(1),
+      LiveAllocations(0)
+    {
+    }
+
     TestObject::TestObject(int argc, char *argv[],
 			   string &aTestName,
 			   int lPGIInterface)
@@ -86,13 +151,17 @@ namespace PatternGeneratorJRL
       // Instanciate and initialize.
       string RobotFileName = m_VRMLPath + m_VRMLFileName;
 
-      bool fileExist = false;
-      {
-	std::ifstream file (RobotFileName.c_str ());
-	fileExist = !file.fail ();
-      }
-      if (!fileExist)
-	throw std::string ("failed to open robot model");
+      // Without robot file the model is the synthetic humanoid.
+      if (!RobotFileName.empty())
+	{
+	  bool fileExist = false;
+	  {
+	    std::ifstream file (RobotFileName.c_str ());
+	    fileExist = !file.fail ();
+	  }
+	  if (!fileExist)
+	    throw std::string ("failed to open robot model");
+	}
 
       CreateAndInitializeHumanoidRobot(RobotFileName,
 				       m_SpecificitiesFileName,
@@ -152,19 +221,35 @@ namespace PatternGeneratorJRL
 	  if (aDebugHDR!=0) delete aDebugHDR;
 	  
 	  dynamicsJRLJapan::ObjectFactory aRobotDynamicsObjectConstructor;
-	  aHDR = aRobotDynamicsObjectConstructor.createHumanoidDynamicRobot();
-	  aDebugHDR = aRobotDynamicsObjectConstructor.createHumanoidDynamicRobot();
+	  if (RobotFileName.empty())
+	    {
+	      SyntheticHumanoidParameters lParameters;
+	      aHDR = createSyntheticHumanoid(aRobotDynamicsObjectConstructor,
+					     lParameters);
+	      aDebugHDR = createSyntheticHumanoid(aRobotDynamicsObjectConstructor,
+						  lParameters);
+	      if ((aHDR==0) || (aDebugHDR==0))
+		throw std::string ("failed to create the synthetic humanoid");
+	    }
+	  else
+	    {
+	      aHDR = aRobotDynamicsObjectConstructor.createHumanoidDynamicRobot();
+	      aDebugHDR = aRobotDynamicsObjectConstructor.createHumanoidDynamicRobot();
+	    }
 	}
 
 
       // Parsing the file.
-      dynamicsJRLJapan::parseOpenHRPVRMLFile(*aHDR,RobotFileName,
-					     LinkJointRank,
-					     SpecificitiesFileName);
+      if (!RobotFileName.empty())
+	{
+	  dynamicsJRLJapan::parseOpenHRPVRMLFile(*aHDR,RobotFileName,
+						 LinkJointRank,
+						 SpecificitiesFileName);
 
-      dynamicsJRLJapan::parseOpenHRPVRMLFile(*aDebugHDR,RobotFileName,
-					     LinkJointRank,
-					     SpecificitiesFileName);
+	  dynamicsJRLJapan::parseOpenHRPVRMLFile(*aDebugHDR,RobotFileName,
+						 LinkJointRank,
+						 SpecificitiesFileName);
+	}
 
   
       // Create Pattern Generator Interface
@@ -188,6 +273,14 @@ namespace PatternGeneratorJRL
 	  for(unsigned int i=0;i<lNbActuatedJoints;i++)
 	    aif >> dInitPos[i];
 	}
+      else if (RobotFileName.empty())
+	{
+	  SyntheticHumanoidParameters lParameters;
+	  MAL_VECTOR(lHalfSitting,double);
+	  syntheticHumanoidHalfSitting(lParameters,lHalfSitting);
+	  for(unsigned int i=0;i<lNbActuatedJoints;i++)
+	    dInitPos[i] = lHalfSitting(i)*180.0/M_PI;
+	}
       aif.close();
   
       bool DebugConfiguration = true;
@@ -197,7 +290,7 @@ namespace PatternGeneratorJRL
 	  aofq.open("TestConfiguration.dat",ofstream::out);
 	  if (aofq.is_open())
 	    {
-	      for(unsigned int k=0;k<30;k++)
+	      for(unsigned int k=0;(k<30) && (k<lNbActuatedJoints);k++)
 		{
 		  aofq << dInitPos[k] << " ";
 		}
@@ -600,8 +693,228 @@ namespace PatternGeneratorJRL
       m_clock.writeBuffer(lProfileOutput);
       m_clock.displayStatistics(os,m_OneStep);
 
-      // Compare debugging files
-      return compareDebugFiles();
+      bool lTimingOk = checkTimingBaseline(os);
+
+      // Compare debugging files, there is no reference
+      // for the synthetic humanoid.
+      if (m_VRMLFileName.empty())
+	return lTimingOk;
+      return compareDebugFiles() && lTimingOk;
+    }
+
+    bool TestObject::doSoakTest(ostream &os,
+				const SoakParameters &aParameters)
+    {
+      const double lTimeStep = 0.005;
+      unsigned long int lNbOfTicks =
+	(unsigned long int)(aParameters.Duration/lTimeStep);
+      unsigned long int lWindow =
+	(unsigned long int)(aParameters.SamplingPeriod/lTimeStep);
+      if (lWindow==0)
+	lWindow = 1;
+
+      /* Columns of the output file. */
+      enum { TIME, RSS, LIVE_ALLOCATIONS, ZMP_POSITIONS, COM_BUFFER,
+	     LEFT_FOOT_POSITIONS, RIGHT_FOOT_POSITIONS,
+	     FOOT_ABSOLUTE_POSITIONS, MEAN_LATENCY, MAX_LATENCY,
+	     NB_OF_COLUMNS };
+      const char * lTitles[NB_OF_COLUMNS] =
+	{ "time(s)", "rss(kB)", "live_allocations", "zmp_positions",
+	  "com_buffer", "left_foot_positions", "right_foot_positions",
+	  "foot_absolute_positions", "mean_latency(us)", "max_latency(us)" };
+      vector<double> lSamples[NB_OF_COLUMNS];
+
+      string lName = m_TestName;
+      if (m_VRMLFileName.empty())
+	lName += "Synthetic";
+      ofstream aof((lName + "Soak.dat").c_str(),ofstream::out);
+      aof << "#";
+      for(unsigned int i=0;i<NB_OF_COLUMNS;i++)
+	aof << " " << lTitles[i];
+      aof << endl;
+
+      chooseTestProfile();
+
+      unsigned int lSeed = aParameters.Seed;
+      unsigned long int lNextCommand =
+	(unsigned long int)(aParameters.CommandPeriod/lTimeStep);
+      unsigned long int lNbOfCommands=0, lNbOfRejectedSteps=0;
+
+      double lWindowMax[NB_OF_COLUMNS];
+      double lLatencySum = 0.0;
+      for(unsigned int i=0;i<NB_OF_COLUMNS;i++)
+	lWindowMax[i] = 0.0;
+
+      for(unsigned long int lTick=1;lTick<=lNbOfTicks;lTick++)
+	{
+	  if (lTick>=lNextCommand)
+	    {
+	      /* Stand still one time out of ten. */
+	      double vx=0.0, vy=0.0, vyaw=0.0;
+	      if (SoakRandom(lSeed)>=0.1)
+		{
+		  vx = -0.1 + 0.4*SoakRandom(lSeed);
+		  vy = -0.1 + 0.2*SoakRandom(lSeed);
+		  vyaw = -0.3 + 0.6*SoakRandom(lSeed);
+		}
+	      m_PGI->setVelocityReference(vx,vy,vyaw);
+
+	      /* Only taken into account by the algorithms
+		 handling on-line step changes. */
+	      if (SoakRandom(lSeed)<0.5)
+		{
+		  FootAbsolutePosition aFAP;
+		  memset(&aFAP,0,sizeof(aFAP));
+		  aFAP.x = 0.1*SoakRandom(lSeed);
+		  aFAP.theta = -5.0 + 10.0*SoakRandom(lSeed);
+		  double newtime;
+		  try
+		    {
+		      if (m_PGI->ChangeOnLineStep(0.805,aFAP,newtime)<0)
+			lNbOfRejectedSteps++;
+		    }
+		  catch(...)
+		    {
+		      lNbOfRejectedSteps++;
+		    }
+		}
+	      lNbOfCommands++;
+	      lNextCommand = lTick + (unsigned long int)
+		(aParameters.CommandPeriod*(0.5+SoakRandom(lSeed))/lTimeStep);
+	    }
+
+	  long long lStart = ThreadCPUTime();
+	  bool ok = m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+						      m_CurrentVelocity,
+						      m_CurrentAcceleration,
+						      m_OneStep.ZMPTarget,
+						      m_OneStep.finalCOMPosition,
+						      m_OneStep.LeftFootPosition,
+						      m_OneStep.RightFootPosition);
+	  double lLatency = 1e-3*(double)(ThreadCPUTime()-lStart);
+	  m_OneStep.NbOfIt++;
+	  if (!ok)
+	    {
+	      os << "The walk stopped after " << lTick*lTimeStep << " s" << endl;
+	      return false;
+	    }
+
+	  /* Buffers and heap blocks: maximum over the window. */
+	  BufferSizes lSizes;
+	  m_PGI->GetBufferSizes(lSizes);
+	  double lValues[NB_OF_COLUMNS];
+	  lValues[LIVE_ALLOCATIONS] = (aParameters.LiveAllocations!=0) ?
+	    (double)aParameters.LiveAllocations() : 0.0;
+	  lValues[ZMP_POSITIONS] = (double)lSizes.ZMPPositions;
+	  lValues[COM_BUFFER] = (double)lSizes.COMBuffer;
+	  lValues[LEFT_FOOT_POSITIONS] = (double)lSizes.LeftFootPositions;
+	  lValues[RIGHT_FOOT_POSITIONS] = (double)lSizes.RightFootPositions;
+	  lValues[FOOT_ABSOLUTE_POSITIONS] = (double)lSizes.FootAbsolutePositions;
+	  lValues[MAX_LATENCY] = lLatency;
+	  for(unsigned int i=LIVE_ALLOCATIONS;i<NB_OF_COLUMNS;i++)
+	    if ((i!=MEAN_LATENCY) && (lValues[i]>lWindowMax[i]))
+	      lWindowMax[i] = lValues[i];
+	  lLatencySum += lLatency;
+
+	  if (lTick%lWindow==0)
+	    {
+	      lWindowMax[TIME] = lTick*lTimeStep;
+	      lWindowMax[RSS] = (double)ResidentSetSize();
+	      lWindowMax[MEAN_LATENCY] = lLatencySum/lWindow;
+	      for(unsigned int i=0;i<NB_OF_COLUMNS;i++)
+		{
+		  lSamples[i].push_back(lWindowMax[i]);
+		  aof << lWindowMax[i] << " ";
+		  lWindowMax[i] = 0.0;
+		}
+	      aof << endl;
+	      lLatencySum = 0.0;
+	    }
+	}
+      aof.close();
+
+      os << "Soak test: " << lNbOfTicks*lTimeStep << " s, "
+	 << lNbOfCommands << " commands, "
+	 << lNbOfRejectedSteps << " step changes rejected, "
+	 << lSamples[TIME].size() << " windows" << endl;
+
+      /* The first window is the warm-up. The memory may grow of a few
+	 pages, the buffers and the heap blocks should not grow at all. */
+      bool lSoakOk = true;
+      for(unsigned int i=RSS;i<MEAN_LATENCY;i++)
+	{
+	  double lSlack = (i==RSS) ? 256.0 : 0.0;
+	  if (GrowsMonotonically(lSamples[i],lSlack))
+	    {
+	      os << "Monotonic growth of " << lTitles[i] << ": "
+		 << lSamples[i][1] << " -> " << lSamples[i].back() << endl;
+	      lSoakOk = false;
+	    }
+	}
+
+      /* The latency drifts when the last third of the windows is
+	 slower than the first third, after the warm-up. */
+      unsigned int n = lSamples[MEAN_LATENCY].size();
+      if (n>=4)
+	{
+	  unsigned int lThird = (n-1)/3;
+	  double lFirst = MeanOf(lSamples[MEAN_LATENCY],1,1+lThird);
+	  double lLast = MeanOf(lSamples[MEAN_LATENCY],n-lThird,n);
+	  os << "Mean latency: " << lFirst << " us -> " << lLast << " us" << endl;
+	  if (lLast > 1.5*lFirst + 20.0)
+	    {
+	      os << "Latency drift" << endl;
+	      lSoakOk = false;
+	    }
+	}
+      return lSoakOk;
+    }
+
+    bool TestObject::checkTimingBaseline(ostream &os)
+    {
+      string lName = m_TestName;
+      if (m_VRMLFileName.empty())
+	lName += "Synthetic";
+
+      // Statistics of this run, next to the other outputs.
+      string lStatistics = lName + "TimeStatistics.dat";
+      m_clock.writeTimingStatistics(lStatistics);
+
+      string lDirectory(PERF_BASELINE_DIR);
+      const char * lEnvDirectory = getenv("JRL_WALKGEN_PERF_BASELINE_DIR");
+      if (lEnvDirectory!=0)
+	lDirectory = lEnvDirectory;
+      string lBaseline = lDirectory + "/" + lName + ".perfref";
+
+      if (getenv("JRL_WALKGEN_PERF_REBASELINE")!=0)
+	{
+	  if (!m_clock.writeTimingStatistics(lBaseline))
+	    {
+	      cerr << "Unable to write " << lBaseline << endl;
+	      return false;
+	    }
+	  os << "New timing baseline " << lBaseline << endl;
+	  return true;
+	}
+
+      double lTolerance = 1.0;
+      const char * lEnvTolerance = getenv("JRL_WALKGEN_PERF_TOLERANCE");
+      if ((lEnvTolerance!=0) && (atof(lEnvTolerance)>0.0))
+	lTolerance = atof(lEnvTolerance);
+
+      if (m_clock.compareToBaseline(lBaseline,lTolerance,os))
+	return true;
+
+      // Without a baseline the timings are not checked:
+      // this has to be asked for explicitly.
+      ifstream aif(lBaseline.c_str(),ifstream::in);
+      if ((!aif.is_open()) &&
+	  (getenv("JRL_WALKGEN_PERF_MISSING_OK")!=0))
+	{
+	  os << "The timings are not checked." << endl;
+	  return true;
+	}
+      return false;
     }
 
   }
@@ -44,6 +44,7 @@
 #include <jrl/mal/matrixabstractlayer.hh>
 #include <jrl/dynamics/dynamicsfactory.hh>
 #include <jrl/walkgen/patterngeneratorinterface.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
 
 #include "CommonTools.hh"
 #include "ClockCPUTime.hh"
@@ -73,6 +74,30 @@ namespace PatternGeneratorJRL
       /*! \brief Perform test. */
       bool doTest(std::ostream &os);
 
+      /*! \brief Parameters of doSoakTest(). */
+      struct SoakParameters
+      {
+	/*! Simulated duration of the walk (s). */
+	double Duration;
+	/*! Mean time between two random commands (s). */
+	double CommandPeriod;
+	/*! Length of the windows in which the resources are sampled (s). */
+	double SamplingPeriod;
+	/*! Seed of the random commands, the same seed gives the same walk. */
+	unsigned int Seed;
+	/*! Number of live heap blocks, not sampled when 0. */
+	long (*LiveAllocations)();
+
+	SoakParameters();
+      };
+
+      /*! \brief Walk for a long time with random velocity references
+	and step changes, and check that the memory, the buffers of the
+	pattern generator and the latency of one step do not keep growing.
+	One line per window is written in TestNameSoak.dat.
+	The test profile should walk until it is stopped. */
+      bool doSoakTest(std::ostream &os, const SoakParameters &aParameters);
+
       /*! \brief Decide from which object the robot is build from. */
       virtual void SpecializedRobotConstructor(CjrlHumanoidDynamicRobot *& aHDR,
 					       CjrlHumanoidDynamicRobot *& aDebugHDR );
@@ -162,6 +187,16 @@ namespace PatternGeneratorJRL
       /*! \brief Compare debug files with references. */
       bool compareDebugFiles();
 
+      /*! \brief Compare the CPU time of the test with its baseline
+	TestName.perfref, or TestNameSynthetic.perfref for the
+	synthetic humanoid. The baseline is searched in the directory
+	JRL_WALKGEN_PERF_BASELINE_DIR (environment variable),
+	by default the tests source directory. The relative tolerance
+	is JRL_WALKGEN_PERF_TOLERANCE, by default 1.0 i.e. twice slower.
+	When JRL_WALKGEN_PERF_REBASELINE is set, the baseline is written
+	instead. */
+      bool checkTimingBaseline(std::ostream &os);
+
       /*! @} */
 
       /*! \brief Information related to one step of computation. */
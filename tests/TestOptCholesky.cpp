@@ -28,8 +28,11 @@
 
 #include <stdlib.h>
 
+#include <math.h>
+
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include "Mathematics/OptCholesky.hh"
 
@@ -84,12 +87,156 @@ double CheckCholeskyDecomposition(double *A, double *L, int n)
 	}
     }
 
-  delete LLT;
+  delete [] LLT;
   distance = sqrt(distance);
   
   return distance;
 }
 
+/* Distance between two lower triangular matrices of size n
+   stored with a stride of respectively strideL1 and strideL2. */
+double CompareLowerTriangular(double *L1, int strideL1,
+			      double *L2, int strideL2,
+			      int n)
+{
+  double distance=0.0;
+  for(int i=0;i<n;i++)
+    {
+      for(int j=0;j<=i;j++)
+	{
+	  double r=L1[i*strideL1+j] - L2[i*strideL2+j];
+	  distance += r*r;
+	}
+    }
+  return sqrt(distance);
+}
+
+/* Compute the cholesky decomposition of E E^t from scratch,
+   E being the rows of A given by Rows. */
+void FullRefactorization(double *A, int lCardU,
+			 vector<unsigned int> &Rows,
+			 double *Lref)
+{
+  int n = Rows.size();
+  double *E = new double[n*lCardU];
+  double *EET = new double[n*n];
+  for(int i=0;i<n;i++)
+    for(int k=0;k<lCardU;k++)
+      E[i*lCardU+k] = A[Rows[i]*lCardU+k];
+  MatrixMatrixT(E,EET,n,lCardU);
+
+  PatternGeneratorJRL::OptCholesky aRefCholesky(n,n,
+						PatternGeneratorJRL::OptCholesky::MODE_NORMAL);
+  aRefCholesky.SetA(EET,0);
+  aRefCholesky.SetL(Lref);
+  aRefCholesky.ComputeNormalCholeskyOnANormal();
+  delete [] EET;
+  delete [] E;
+}
+
+/* Check the update in Fortran mode, and the downdate 
+   against a full refactorization. */
+int CheckUpdateAndDowndate(double *A,
+			   unsigned int lNbOfConstraints,
+			   unsigned int lCardU)
+{
+  int return_value=0;
+
+  /* A stored by columns with a stride of lNbOfConstraints+1 
+     as done by ZMPConstrainedQPFastFormulation. */
+  double * AF = new double[(lNbOfConstraints+1)*lCardU];
+  for(unsigned int i=0;i<lNbOfConstraints;i++)
+    for(unsigned int j=0;j<lCardU;j++)
+      AF[i+j*(lNbOfConstraints+1)] = A[i*lCardU+j];
+
+  double * L = new double[lNbOfConstraints*lNbOfConstraints];
+  double * Lref = new double[lNbOfConstraints*lNbOfConstraints];
+
+  PatternGeneratorJRL::OptCholesky anOptCholesky(lNbOfConstraints,lCardU,
+						 PatternGeneratorJRL::OptCholesky::MODE_FORTRAN);
+  anOptCholesky.SetA(AF,lNbOfConstraints);
+  anOptCholesky.SetL(L);
+
+  /* Activate the constraints in a shuffled order. */
+  vector<unsigned int> ActiveSet;
+  for(unsigned int i=0;i<lNbOfConstraints;i++)
+    ActiveSet.push_back((i*5)%lNbOfConstraints);
+  anOptCholesky.AddActiveConstraints(ActiveSet);
+
+  FullRefactorization(A,lCardU,ActiveSet,Lref);
+  double r = CompareLowerTriangular(L,lNbOfConstraints,
+				    Lref,ActiveSet.size(),
+				    ActiveSet.size());
+  if (r>1e-6)
+    {
+      cout << "Optimized Cholesky update (Fortran mode) pb:" 
+	   << r << endl;
+      return_value = -1;
+    }
+
+  /* Remove constraints in the middle, at the beginning and at the end. */
+  unsigned int ToBeRemoved[3] = { ActiveSet[lNbOfConstraints/2], 
+				  ActiveSet[0],
+				  ActiveSet[lNbOfConstraints-1] };
+  for(unsigned int li=0;li<3;li++)
+    {
+      if (anOptCholesky.RemoveActiveConstraint(ToBeRemoved[li])<0)
+	{
+	  cout << "Unable to remove constraint " << ToBeRemoved[li] << endl;
+	  return_value = -1;
+	}
+      for(unsigned int lj=0;lj<ActiveSet.size();lj++)
+	if (ActiveSet[lj]==ToBeRemoved[li])
+	  {
+	    ActiveSet.erase(ActiveSet.begin()+lj);
+	    break;
+	  }
+
+      if ((int)ActiveSet.size()!=anOptCholesky.CurrentNumberOfRows())
+	{
+	  cout << "Wrong number of rows after downdate" << endl;
+	  return_value = -1;
+	}
+
+      FullRefactorization(A,lCardU,ActiveSet,Lref);
+      r = CompareLowerTriangular(L,lNbOfConstraints,
+				 Lref,ActiveSet.size(),
+				 ActiveSet.size());
+      if (r>1e-6)
+	{
+	  cout << "Cholesky downdate pb (" << li << "):" 
+	       << r << endl;
+	  return_value = -1;
+	}
+    }
+
+  /* Removing a non active constraint should fail. */
+  if (anOptCholesky.RemoveActiveConstraint(ToBeRemoved[0])!=-1)
+    {
+      cout << "Removing a non active constraint should fail." << endl;
+      return_value = -1;
+    }
+
+  /* Update after downdate. */
+  anOptCholesky.AddActiveConstraint(ToBeRemoved[1]);
+  ActiveSet.push_back(ToBeRemoved[1]);
+  FullRefactorization(A,lCardU,ActiveSet,Lref);
+  r = CompareLowerTriangular(L,lNbOfConstraints,
+			     Lref,ActiveSet.size(),
+			     ActiveSet.size());
+  if (r>1e-6)
+    {
+      cout << "Cholesky update after downdate pb:" 
+	   << r << endl;
+      return_value = -1;
+    }
+
+  delete [] Lref;
+  delete [] L;
+  delete [] AF;
+  return return_value;
+}
+
 int main()
 {
   PatternGeneratorJRL::OptCholesky *anOptCholesky;
@@ -179,6 +326,10 @@ int main()
     DisplayMatrix(iL,lNbOfConstraints,lNbOfConstraints,string("iL"),0);
 
   delete anOptCholesky;
+
+  if (CheckUpdateAndDowndate(A,lNbOfConstraints,lCardU)<0)
+    return_value = -1;
+
   delete [] L;
   delete [] A;
   return return_value;
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestParallelInstances.cpp
+  \brief Run several pattern generators concurrently, one per thread,
+  and check that their trajectories are bitwise identical to the ones
+  obtained when the same instances are run one after the other.
+  Each instance records its commands in its own output directory.
+*/
+#include <math.h>
+#include <string.h>
+#ifdef WIN32
+# include <direct.h>
+#else
+# include <sys/stat.h>
+# include <sys/types.h>
+#endif /* WIN32 */
+
+#include <vector>
+
+#include "Debug.hh"
+#include "CommandStreamRecorder.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+#include <portability/thread.hh>
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+/*! Number of generators running at the same time. */
+static const unsigned int g_NbInstances = 4;
+
+/*! Number of control loop iterations (6 s). */
+static const unsigned int g_NbSteps = 1200;
+
+/*! One robot model and one pattern generator. */
+class ParallelInstance: public TestObject
+{
+public:
+  ParallelInstance(int argc, char *argv[], string &aString,
+		   unsigned int anIndex, const string & aDirectory):
+    TestObject(argc,argv,aString),
+    m_Index(anIndex),
+    m_Started(false),
+    m_Directory(aDirectory)
+  {
+    m_TestProfile = 0;
+#ifdef WIN32
+    _mkdir(m_Directory.c_str());
+#else
+    mkdir(m_Directory.c_str(),0755);
+#endif /* WIN32 */
+  }
+
+  /*! Online walking, each instance with its own velocity. */
+  void startOnLineWalking()
+  {
+    CommonInitialization(*m_PGI);
+
+    ostringstream oss;
+    oss << ":setVelReference " << 0.1+0.05*m_Index << " 0.0 "
+	<< 0.02*m_Index;
+    const string lCommands[7] =
+      { ":outputdirectory " + m_Directory,
+	":recordcommands",
+	":SetAlgoForZmpTrajectory Herdt",
+	":singlesupporttime 0.7",
+	":doublesupporttime 0.1",
+	":HerdtOnline",
+	oss.str() };
+    for(unsigned int i=0;i<7;i++)
+      {
+	istringstream strm(lCommands[i]);
+	m_PGI->ParseCmd(strm);
+      }
+  }
+
+  /*! Run the whole walk and store the trajectories. */
+  void run()
+  {
+    unsigned int lNbDofs = MAL_VECTOR_SIZE(m_CurrentConfiguration);
+    m_Configurations.assign(g_NbSteps*lNbDofs,0.0);
+    m_Trajectories.assign(14*g_NbSteps,0.0);
+
+    ControlLoopBuffers lBuffers;
+    lBuffers.NbDofs = lNbDofs;
+    lBuffers.Configurations = &m_Configurations[0];
+    for(unsigned int j=0;j<3;j++)
+      lBuffers.ZMP[j] = &m_Trajectories[j*g_NbSteps];
+    for(unsigned int j=0;j<6;j++)
+      lBuffers.CoM[j] = &m_Trajectories[(3+j)*g_NbSteps];
+    for(unsigned int j=0;j<5;j++)
+      lBuffers.LeftFoot[j] = &m_Trajectories[(9+j)*g_NbSteps];
+
+    startOnLineWalking();
+    m_PGI->RunNStepsOfTheControlLoop(g_NbSteps,lBuffers);
+    istringstream strm(":recordcommands off");
+    m_PGI->ParseCmd(strm);
+    m_Started = true;
+  }
+
+  static void runInThread(void * anInstance)
+  {
+    ((ParallelInstance *)anInstance)->run();
+  }
+
+  /*! Returns true if both runs gave the same bits. */
+  bool sameAs(const ParallelInstance & anOther) const
+  {
+    return m_Started && anOther.m_Started &&
+      (m_Configurations.size()==anOther.m_Configurations.size()) &&
+      (memcmp(&m_Configurations[0],&anOther.m_Configurations[0],
+	      m_Configurations.size()*sizeof(double))==0) &&
+      (memcmp(&m_Trajectories[0],&anOther.m_Trajectories[0],
+	      m_Trajectories.size()*sizeof(double))==0);
+  }
+
+  /*! Returns true if the output directory of the instance holds
+    its commands, with its own velocity reference. */
+  bool checkOutputDirectory() const
+  {
+    CommandStreamReader aReader;
+    if (!aReader.Open(m_Directory+"/walkgen-commands.bin"))
+      {
+	cout << m_Directory << " does not hold the recorded commands." << endl;
+	return false;
+      }
+
+    unsigned int lNbOfReferences = 0;
+    CommandStreamRecord aRecord;
+    while(aReader.Next(aRecord))
+      {
+	if (aRecord.Type!=RECORD_PARSE_CMD)
+	  continue;
+	istringstream strm(aRecord.Command);
+	string lName;
+	double x=0.0,y=0.0,yaw=0.0;
+	strm >> lName >> x >> y >> yaw;
+	if (lName!=":setVelReference")
+	  continue;
+	if ((fabs(x-0.1-0.05*m_Index)>1e-9) || (fabs(y)>1e-9) ||
+	    (fabs(yaw-0.02*m_Index)>1e-9))
+	  {
+	    cout << m_Directory << " holds the commands of another instance."
+		 << endl;
+	    return false;
+	  }
+	lNbOfReferences++;
+      }
+    if (lNbOfReferences!=1)
+      {
+	cout << m_Directory << " holds " << lNbOfReferences
+	     << " velocity references instead of 1." << endl;
+	return false;
+      }
+    return true;
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+private:
+  unsigned int m_Index;
+  bool m_Started;
+  string m_Directory;
+  vector<double> m_Configurations;
+  /*! ZMP, CoM and left foot, one trajectory after the other. */
+  vector<double> m_Trajectories;
+};
+
+int PerformTests(int argc, char *argv[])
+{
+  string lName("TestParallelInstances");
+
+  // The models are parsed in the main thread: only the pattern
+  // generators are expected to be re-entrant.
+  vector<ParallelInstance *> lSerial, lParallel;
+  for(unsigned int i=0;i<g_NbInstances;i++)
+    {
+      ostringstream oss;
+      oss << lName << "-" << i;
+      lSerial.push_back(new ParallelInstance(argc,argv,lName,i,
+					     oss.str()+"-serial"));
+      lSerial.back()->init();
+      lParallel.push_back(new ParallelInstance(argc,argv,lName,i,
+					       oss.str()+"-parallel"));
+      lParallel.back()->init();
+    }
+
+  for(unsigned int i=0;i<g_NbInstances;i++)
+    lSerial[i]->run();
+
+  Thread lThreads[g_NbInstances];
+  for(unsigned int i=0;i<g_NbInstances;i++)
+    if (lThreads[i].Start(ParallelInstance::runInThread,lParallel[i])<0)
+      {
+	cerr << "Unable to start thread " << i << endl;
+	return -1;
+      }
+  for(unsigned int i=0;i<g_NbInstances;i++)
+    lThreads[i].Join();
+
+  int r=0;
+  for(unsigned int i=0;i<g_NbInstances;i++)
+    {
+      if (!lSerial[i]->sameAs(*lParallel[i]))
+	{
+	  cout << "Instance " << i << " differs from the serial run." << endl;
+	  r = -1;
+	}
+      // Distinct references should give distinct trajectories,
+      // otherwise the comparison above proves nothing.
+      if ((i>0) && (lSerial[i]->sameAs(*lSerial[0])))
+	{
+	  cout << "Instance " << i << " did not use its own reference." << endl;
+	  r = -1;
+	}
+      if ((!lSerial[i]->checkOutputDirectory()) ||
+	  (!lParallel[i]->checkOutputDirectory()))
+	r = -1;
+      delete lSerial[i];
+      delete lParallel[i];
+    }
+  if (r==0)
+    cout << "Passed: " << g_NbInstances
+	 << " instances run in parallel as in serial." << endl;
+  return r;
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      return PerformTests(argc,argv);
+    }
+  catch (const std::string& msg)
+    {
+      std::cerr << msg << std::endl;
+    }
+  return 1;
+}
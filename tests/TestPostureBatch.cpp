@@ -0,0 +1,333 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPostureBatch.cpp
+  \brief Check the batch posture computation of ComAndFootRealizationByGeometry.
+
+  The postures of a sequence of CoM and feet postures of the synthetic
+  humanoid are computed sample by sample with
+  ComputePostureForGivenCoMAndFeetPosture(), then with
+  ComputePosturesForGivenCoMAndFeetPostures() using one thread,
+  and using several threads over two consecutive batches.
+  The configurations, velocities and accelerations must be the same.
+*/
+#include <math.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/dynamics/dynamicsfactory.hh>
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+#include <jrl/walkgen/synthetichumanoid.hh>
+
+#include <patterngeneratorinterfaceprivate.hh>
+#include <SimplePluginManager.hh>
+#include <StepStackHandler.hh>
+#include <MotionGeneration/ComAndFootRealizationByGeometry.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  /* Sequence of CoM and feet postures, with their derivatives. */
+  struct PostureSequence_s
+  {
+    vector<MAL_VECTOR_TYPE(double) > CoMPositions, CoMSpeeds, CoMAccs;
+    vector<MAL_VECTOR_TYPE(double) > LeftFoot, RightFoot;
+  };
+
+  ComAndFootRealizationByGeometry *
+  CreateRealization(PatternGeneratorInterfacePrivate * aPGI,
+		    CjrlHumanoidDynamicRobot * aHDR,
+		    StepStackHandler * aSSH,
+		    MAL_VECTOR_TYPE(double) & lHalfSitting,
+		    unsigned int NbOfThreads,
+		    MAL_S3_VECTOR_TYPE(double) & lStartingCoM,
+		    FootAbsolutePosition & InitLeftFoot,
+		    FootAbsolutePosition & InitRightFoot)
+  {
+    ComAndFootRealizationByGeometry * aCFR =
+      new ComAndFootRealizationByGeometry(aPGI);
+    aCFR->setHumanoidDynamicRobot(aHDR);
+    aCFR->SetHeightOfTheCoM(0.814);
+    aCFR->setSamplingPeriod(0.005);
+    aCFR->SetStepStackHandler(aSSH);
+    aCFR->Initialization();
+
+    MAL_VECTOR(lWaistPose,double);
+    aCFR->InitializationCoM(lHalfSitting,lStartingCoM,lWaistPose,
+			    InitLeftFoot,InitRightFoot);
+
+    ostringstream oss;
+    oss << NbOfThreads;
+    istringstream strm(oss.str());
+    string aMethod(":posturethreads");
+    aCFR->CallMethod(aMethod,strm);
+    return aCFR;
+  }
+
+  /* The CoM sways and moves forward while the right foot
+     makes a step, the left foot stays on the ground. */
+  void CreateSequence(unsigned int NbOfSamples,
+		      const MAL_S3_VECTOR_TYPE(double) & lStartingCoM,
+		      const FootAbsolutePosition & InitLeftFoot,
+		      const FootAbsolutePosition & InitRightFoot,
+		      PostureSequence_s & aSequence)
+  {
+    const double dt = 0.005, T = NbOfSamples*dt;
+    const double w = 2*M_PI/T;
+
+    aSequence.CoMPositions.resize(NbOfSamples);
+    aSequence.CoMSpeeds.resize(NbOfSamples);
+    aSequence.CoMAccs.resize(NbOfSamples);
+    aSequence.LeftFoot.resize(NbOfSamples);
+    aSequence.RightFoot.resize(NbOfSamples);
+
+    for(unsigned int k=0;k<NbOfSamples;k++)
+      {
+	double t = k*dt;
+	MAL_VECTOR_TYPE(double) & aCoM = aSequence.CoMPositions[k];
+	MAL_VECTOR_RESIZE(aCoM,18);
+	MAL_VECTOR_FILL(aCoM,0.0);
+	aCoM(0) = lStartingCoM(0) + 0.02*(1-cos(w*t));
+	aCoM(1) = lStartingCoM(1) + 0.04*sin(w*t);
+	aCoM(2) = lStartingCoM(2);
+	aCoM(5) = 5.0*sin(w*t);
+	aCoM(6) = 0.02*w*sin(w*t);
+	aCoM(7) = 0.04*w*cos(w*t);
+	aCoM(11) = 5.0*w*cos(w*t);
+	aCoM(12) = 0.02*w*w*cos(w*t);
+	aCoM(13) = -0.04*w*w*sin(w*t);
+	aCoM(17) = -5.0*w*w*sin(w*t);
+
+	MAL_VECTOR_RESIZE(aSequence.CoMSpeeds[k],6);
+	MAL_VECTOR_RESIZE(aSequence.CoMAccs[k],6);
+	for(unsigned int i=0;i<6;i++)
+	  {
+	    aSequence.CoMSpeeds[k](i) = aCoM(6+i);
+	    aSequence.CoMAccs[k](i) = aCoM(12+i);
+	  }
+
+	MAL_VECTOR_TYPE(double) & aLeftFoot = aSequence.LeftFoot[k];
+	MAL_VECTOR_RESIZE(aLeftFoot,15);
+	MAL_VECTOR_FILL(aLeftFoot,0.0);
+	aLeftFoot(0) = InitLeftFoot.x;
+	aLeftFoot(1) = InitLeftFoot.y;
+	aLeftFoot(2) = InitLeftFoot.z;
+	aLeftFoot(3) = InitLeftFoot.theta;
+	aLeftFoot(4) = InitLeftFoot.omega;
+
+	MAL_VECTOR_TYPE(double) & aRightFoot = aSequence.RightFoot[k];
+	MAL_VECTOR_RESIZE(aRightFoot,15);
+	MAL_VECTOR_FILL(aRightFoot,0.0);
+	aRightFoot(0) = InitRightFoot.x + 0.05*(1-cos(w*t));
+	aRightFoot(1) = InitRightFoot.y;
+	aRightFoot(2) = InitRightFoot.z + 0.02*(1-cos(w*t));
+	aRightFoot(3) = InitRightFoot.theta + 10.0*sin(w*t);
+	aRightFoot(4) = InitRightFoot.omega;
+	aRightFoot(5) = 0.05*w*sin(w*t);
+	aRightFoot(7) = 0.02*w*sin(w*t);
+	aRightFoot(8) = 10.0*w*cos(w*t);
+	aRightFoot(10) = 0.05*w*w*cos(w*t);
+	aRightFoot(12) = 0.02*w*w*cos(w*t);
+	aRightFoot(13) = -10.0*w*w*sin(w*t);
+      }
+  }
+
+  double MaxDifference(const MAL_VECTOR_TYPE(double) & a,
+		       const MAL_VECTOR_TYPE(double) & b)
+  {
+    if (MAL_VECTOR_SIZE(a)!=MAL_VECTOR_SIZE(b))
+      return HUGE_VAL;
+    double r=0.0;
+    for(unsigned int i=0;i<MAL_VECTOR_SIZE(a);i++)
+      if (!(fabs(a[i]-b[i])<=r))
+	r = fabs(a[i]-b[i]);
+    return r;
+  }
+
+  /* Compare the states of a batch with the ones computed
+     sample by sample. */
+  bool SameStates(const string & aName,
+		  const vector<MAL_VECTOR_TYPE(double) > & RefQ,
+		  const vector<MAL_VECTOR_TYPE(double) > & RefdQ,
+		  const vector<MAL_VECTOR_TYPE(double) > & RefddQ,
+		  const vector<MAL_VECTOR_TYPE(double) > & Q,
+		  const vector<MAL_VECTOR_TYPE(double) > & dQ,
+		  const vector<MAL_VECTOR_TYPE(double) > & ddQ)
+  {
+    const double Tolerance = 1e-10;
+    if ((Q.size()!=RefQ.size()) ||
+	(dQ.size()!=RefQ.size()) ||
+	(ddQ.size()!=RefQ.size()))
+      {
+	cerr << aName << ": wrong number of samples." << endl;
+	return false;
+      }
+    for(unsigned int k=0;k<RefQ.size();k++)
+      {
+	double eq = MaxDifference(Q[k],RefQ[k]);
+	double edq = MaxDifference(dQ[k],RefdQ[k]);
+	double eddq = MaxDifference(ddQ[k],RefddQ[k]);
+	if ((eq>Tolerance) || (edq>Tolerance) || (eddq>Tolerance))
+	  {
+	    cerr << aName << ": sample " << k << " differs by "
+		 << eq << " " << edq << " " << eddq << endl;
+	    return false;
+	  }
+      }
+    cout << aName << ": " << RefQ.size() << " samples identical." << endl;
+    return true;
+  }
+}
+
+int main()
+{
+  const unsigned int NbOfSamples = 400;
+  const unsigned int NbOfThreads = 4;
+
+  dynamicsJRLJapan::ObjectFactory aFactory;
+  SyntheticHumanoidParameters lParameters;
+  MAL_VECTOR(lHalfSitting,double);
+  syntheticHumanoidHalfSitting(lParameters,lHalfSitting);
+
+  CjrlHumanoidDynamicRobot * aHDR =
+    createSyntheticHumanoid(aFactory,lParameters);
+  if (aHDR==0)
+    return -1;
+  PatternGeneratorInterface * aPGI = patternGeneratorInterfaceFactory(aHDR);
+  aPGI->SetCurrentJointValues(lHalfSitting);
+  PatternGeneratorInterfacePrivate * aPGIP =
+    dynamic_cast<PatternGeneratorInterfacePrivate *>(aPGI);
+
+  SimplePluginManager aSPM;
+  StepStackHandler aSSH(&aSPM);
+
+  MAL_S3_VECTOR(lStartingCoM,double);
+  FootAbsolutePosition InitLeftFoot, InitRightFoot;
+  ComAndFootRealizationByGeometry * CFRs[3];
+  unsigned int lThreads[3] = { 1, 1, NbOfThreads };
+  for(unsigned int i=0;i<3;i++)
+    CFRs[i] = CreateRealization(aPGIP,aHDR,&aSSH,lHalfSitting,lThreads[i],
+				lStartingCoM,InitLeftFoot,InitRightFoot);
+  MAL_VECTOR_TYPE(double) lInitialConfiguration = aHDR->currentConfiguration();
+  unsigned int lNbDofs = MAL_VECTOR_SIZE(lInitialConfiguration);
+
+  PostureSequence_s aSequence;
+  CreateSequence(NbOfSamples,lStartingCoM,InitLeftFoot,InitRightFoot,aSequence);
+
+  int r = 0;
+
+  // Sample by sample.
+  vector<MAL_VECTOR_TYPE(double) > RefQ(NbOfSamples), RefdQ(NbOfSamples),
+    RefddQ(NbOfSamples);
+  {
+    PostureSequence_s lSequence = aSequence;
+    MAL_VECTOR_TYPE(double) CurrentConfiguration = lInitialConfiguration;
+    MAL_VECTOR_DIM(CurrentVelocity,double,lNbDofs);
+    MAL_VECTOR_DIM(CurrentAcceleration,double,lNbDofs);
+    for(unsigned int k=0;k<NbOfSamples;k++)
+      {
+	CFRs[0]->ComputePostureForGivenCoMAndFeetPosture(lSequence.CoMPositions[k],
+							 lSequence.CoMSpeeds[k],
+							 lSequence.CoMAccs[k],
+							 lSequence.LeftFoot[k],
+							 lSequence.RightFoot[k],
+							 CurrentConfiguration,
+							 CurrentVelocity,
+							 CurrentAcceleration,
+							 k,0);
+	RefQ[k] = CurrentConfiguration;
+	RefdQ[k] = CurrentVelocity;
+	RefddQ[k] = CurrentAcceleration;
+      }
+  }
+
+  // One batch computed by the calling thread.
+  {
+    PostureSequence_s lSequence = aSequence;
+    MAL_VECTOR_TYPE(double) CurrentConfiguration = lInitialConfiguration;
+    vector<MAL_VECTOR_TYPE(double) > Q, dQ, ddQ;
+    CFRs[1]->ComputePosturesForGivenCoMAndFeetPostures(lSequence.CoMPositions,
+						       lSequence.CoMSpeeds,
+						       lSequence.CoMAccs,
+						       lSequence.LeftFoot,
+						       lSequence.RightFoot,
+						       CurrentConfiguration,
+						       Q,dQ,ddQ,
+						       0,0);
+    if ((!SameStates("1 thread",RefQ,RefdQ,RefddQ,Q,dQ,ddQ)) ||
+	(MaxDifference(CurrentConfiguration,RefQ.back())>0.0))
+      r = -1;
+  }
+
+  // Two consecutive batches computed by several threads.
+  {
+    PostureSequence_s lSequence = aSequence;
+    MAL_VECTOR_TYPE(double) CurrentConfiguration = lInitialConfiguration;
+    vector<MAL_VECTOR_TYPE(double) > Q, dQ, ddQ;
+    unsigned int lSplit = 3*NbOfSamples/8;
+    for(unsigned int lBatch=0;lBatch<2;lBatch++)
+      {
+	unsigned int lBegin = (lBatch==0) ? 0 : lSplit;
+	unsigned int lEnd = (lBatch==0) ? lSplit : NbOfSamples;
+	PostureSequence_s lPart;
+	lPart.CoMPositions.assign(lSequence.CoMPositions.begin()+lBegin,
+				  lSequence.CoMPositions.begin()+lEnd);
+	lPart.CoMSpeeds.assign(lSequence.CoMSpeeds.begin()+lBegin,
+			       lSequence.CoMSpeeds.begin()+lEnd);
+	lPart.CoMAccs.assign(lSequence.CoMAccs.begin()+lBegin,
+			     lSequence.CoMAccs.begin()+lEnd);
+	lPart.LeftFoot.assign(lSequence.LeftFoot.begin()+lBegin,
+			      lSequence.LeftFoot.begin()+lEnd);
+	lPart.RightFoot.assign(lSequence.RightFoot.begin()+lBegin,
+			       lSequence.RightFoot.begin()+lEnd);
+
+	vector<MAL_VECTOR_TYPE(double) > lQ, ldQ, lddQ;
+	CFRs[2]->ComputePosturesForGivenCoMAndFeetPostures(lPart.CoMPositions,
+							   lPart.CoMSpeeds,
+							   lPart.CoMAccs,
+							   lPart.LeftFoot,
+							   lPart.RightFoot,
+							   CurrentConfiguration,
+							   lQ,ldQ,lddQ,
+							   lBegin,0);
+	Q.insert(Q.end(),lQ.begin(),lQ.end());
+	dQ.insert(dQ.end(),ldQ.begin(),ldQ.end());
+	ddQ.insert(ddQ.end(),lddQ.begin(),lddQ.end());
+      }
+    ostringstream oss;
+    oss << NbOfThreads << " threads";
+    if (!SameStates(oss.str(),RefQ,RefdQ,RefddQ,Q,dQ,ddQ))
+      r = -1;
+  }
+
+  for(unsigned int i=0;i<3;i++)
+    delete CFRs[i];
+  delete aPGI;
+  delete aHDR;
+  return r;
+}
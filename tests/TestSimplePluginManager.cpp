@@ -0,0 +1,160 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestSimplePluginManager.cpp
+  \brief Check that the calls by name and by handle reach
+  the same plugins, that an excluded plugin is skipped, and that
+  plugins can be created while a method is called.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <SimplePluginManager.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+class CountingPlugin : public SimplePlugin
+{
+public:
+  double m_Value;
+  int m_NbCalls;
+
+  CountingPlugin(SimplePluginManager * lSPM):
+    SimplePlugin(lSPM),
+    m_Value(0.0),
+    m_NbCalls(0)
+  {
+    string aMethodName[2] = {":samplingperiod",":other"};
+    for(int i=0;i<2;i++)
+      RegisterMethod(aMethodName[i]);
+  }
+
+  void CallMethod(string &Method, istringstream &strm)
+  {
+    if (Method==":samplingperiod")
+      strm >> m_Value;
+    m_NbCalls++;
+  }
+};
+
+/*! Register many methods when ":create" is called,
+  as the pattern generator does when an algorithm is selected. */
+class CreatingPlugin : public SimplePlugin
+{
+public:
+  vector<CountingPlugin *> m_Created;
+  int m_NbCalls;
+
+  CreatingPlugin(SimplePluginManager * lSPM):
+    SimplePlugin(lSPM),
+    m_NbCalls(0)
+  {
+    string aMethodName(":create");
+    RegisterMethod(aMethodName);
+  }
+
+  ~CreatingPlugin()
+  {
+    for(unsigned int i=0;i<m_Created.size();i++)
+      delete m_Created[i];
+  }
+
+  void CallMethod(string &, istringstream &)
+  {
+    m_NbCalls++;
+    for(int i=0;i<64;i++)
+      {
+	m_Created.push_back(new CountingPlugin(getSimplePluginManager()));
+	ostringstream oss;
+	oss << ":created" << m_Created.size();
+	string aMethodName = oss.str();
+	m_Created.back()->RegisterMethod(aMethodName);
+      }
+  }
+};
+
+int main()
+{
+  SimplePluginManager aSPM;
+  CountingPlugin aFirstPlugin(&aSPM), aSecondPlugin(&aSPM);
+
+  int lHandle = aSPM.ResolveMethod(":samplingperiod");
+  if ((lHandle<0) || (aSPM.ResolveMethod(":unknown")>=0) ||
+      (aSPM.ResolveMethod(":other")==lHandle))
+    {
+      cerr << "Wrong handles." << endl;
+      return -1;
+    }
+
+  // By name.
+  string aMethod(":samplingperiod");
+  istringstream strm("0.005");
+  if ((!aSPM.CallMethod(aMethod,strm)) ||
+      (aFirstPlugin.m_Value!=0.005) || (aSecondPlugin.m_Value!=0.005))
+    {
+      cerr << "The call by name did not reach the plugins." << endl;
+      return -1;
+    }
+
+  // By handle, without the first plugin.
+  istringstream strm2("0.1");
+  if ((!aSPM.CallMethod(lHandle,strm2,&aFirstPlugin)) ||
+      (aFirstPlugin.m_Value!=0.005) || (aSecondPlugin.m_Value!=0.1))
+    {
+      cerr << "The call by handle did not reach the plugins." << endl;
+      return -1;
+    }
+
+  // The handle stays valid once a plugin is unregistered.
+  aSPM.UnregisterPlugin(&aSecondPlugin);
+  istringstream strm3("0.02");
+  if ((!aSPM.CallMethod(lHandle,strm3)) ||
+      (aFirstPlugin.m_Value!=0.02) || (aSecondPlugin.m_Value!=0.1) ||
+      (aFirstPlugin.m_NbCalls!=2) || (aSecondPlugin.m_NbCalls!=2))
+    {
+      cerr << "The call after unregistering a plugin failed." << endl;
+      return -1;
+    }
+
+  if (aSPM.CallMethod(-1,strm3) || aSPM.CallMethod(lHandle+2,strm3))
+    {
+      cerr << "An invalid handle has been accepted." << endl;
+      return -1;
+    }
+
+  // Both plugins are called although the table of methods grows
+  // during the first call.
+  CreatingPlugin aFirstCreator(&aSPM), aSecondCreator(&aSPM);
+  istringstream strm4("");
+  if ((!aSPM.CallMethod(aSPM.ResolveMethod(":create"),strm4)) ||
+      (aFirstCreator.m_NbCalls!=1) || (aSecondCreator.m_NbCalls!=1) ||
+      (aSPM.ResolveMethod(":created64")<0))
+    {
+      cerr << "The call creating plugins failed." << endl;
+      return -1;
+    }
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/* \file This file walks on-line for a long time with random commands,
+ * and checks that the memory, the buffers and the latency do not drift.
+ * The simulated duration in seconds is JRL_WALKGEN_SOAK_DURATION,
+ * by default one minute.
+ */
+#include <stdlib.h>
+
+#include "CommonTools.hh"
+#include "TestObject.hh"
+#include "AllocationCounter.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+enum Profiles_t {
+  PROFIL_SOAK_HERDT_ONLINE_WALKING,            // 1
+  PROFIL_SOAK_MORISAWA_ONLINE_WALKING          // 2
+};
+
+class TestSoak: public TestObject
+{
+public:
+  TestSoak(int argc, char *argv[], string &aString, int TestProfile):
+    TestObject(argc,argv,aString)
+  {
+    m_TestProfile = TestProfile;
+  };
+
+protected:
+
+  void startHerdtOnLineWalking(PatternGeneratorInterface &aPGI)
+  {
+    CommonInitialization(aPGI);
+
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":HerdtOnline 0.0 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+  }
+
+  void startMorisawaOnLineWalking(PatternGeneratorInterface &aPGI)
+  {
+    CommonInitialization(aPGI);
+
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Morisawa");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":onlinechangestepframe relative");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":SetAutoFirstStep false");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":StartOnLineStepSequencing 0.0 -0.095 0.0 0.0 0.19 0.0 0.0 -0.19 0.0 0.0 0.19 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+  }
+
+  void chooseTestProfile()
+  {
+    switch(m_TestProfile)
+      {
+      case PROFIL_SOAK_HERDT_ONLINE_WALKING:
+	startHerdtOnLineWalking(*m_PGI);
+	break;
+      case PROFIL_SOAK_MORISAWA_ONLINE_WALKING:
+	startMorisawaOnLineWalking(*m_PGI);
+	break;
+      default:
+	throw("No correct test profile");
+	break;
+      }
+  }
+
+  /* The commands are generated by doSoakTest. */
+  void generateEvent()
+  {
+  }
+};
+
+int PerformTests(int argc, char *argv[])
+{
+  TestObject::SoakParameters aParameters;
+  aParameters.LiveAllocations = NbOfLiveAllocations;
+  const char * lEnvDuration = getenv("JRL_WALKGEN_SOAK_DURATION");
+  if ((lEnvDuration!=0) && (atof(lEnvDuration)>0.0))
+    aParameters.Duration = atof(lEnvDuration);
+  // Keep a few windows after the warm-up for short runs.
+  if (aParameters.Duration<10*aParameters.SamplingPeriod)
+    aParameters.SamplingPeriod = aParameters.Duration/10.0;
+
+  #define NB_PROFILES 2
+  std::string TestNames[NB_PROFILES] = { "TestSoakHerdt2010",
+					 "TestSoakMorisawa2007" };
+  int TestProfiles[NB_PROFILES] = { PROFIL_SOAK_HERDT_ONLINE_WALKING,
+				    PROFIL_SOAK_MORISAWA_ONLINE_WALKING };
+
+  for (unsigned int i=0;i<NB_PROFILES;i++)
+    {
+      TestSoak aTestSoak(argc,argv,
+			 TestNames[i],
+			 TestProfiles[i]);
+      aTestSoak.init();
+      try
+	{
+	  if (!aTestSoak.doSoakTest(std::cout,aParameters))
+	    {
+	      cout << "Failed test " << i << endl;
+	      return -1;
+	    }
+	  else
+	    cout << "Passed test " << i << endl;
+	}
+      catch (const char * astr)
+	{ cerr << "Failed on following error " << astr << std::endl;
+	  return -1; }
+    }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      return PerformTests(argc,argv);
+    }
+  catch (const std::string& msg)
+    {
+      std::cerr << msg << std::endl;
+    }
+  return 1;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestStageProfiler.cpp
+  \brief Check the buckets and the percentiles of the latency
+  histograms, that the stages are only timed when a profiler
+  is installed, and the ring buffer of the traces.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <StageProfiler.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main()
+{
+  // Each duration is in a bucket whose bounds are within 6.25%.
+  unsigned int lPreviousBucket = 0;
+  for(long long v=0;v<(1LL<<42);v=v+1+v/7)
+    {
+      unsigned int lBucket = LatencyHistogram::Bucket(v);
+      if ((lBucket<lPreviousBucket) ||
+	  (lBucket>=LatencyHistogram::NB_BUCKETS))
+	{
+	  cerr << "Wrong bucket for " << v << endl;
+	  return -1;
+	}
+      lPreviousBucket = lBucket;
+      if (v<(1LL<<40))
+	{
+	  long long lUpper = LatencyHistogram::UpperBound(lBucket);
+	  if ((lUpper<v) || ((double)(lUpper-v)>0.0625*(double)v))
+	    {
+	      cerr << "Wrong bound " << lUpper << " for " << v << endl;
+	      return -1;
+	    }
+	}
+    }
+
+  // 1 to 1000 micro-seconds.
+  LatencyHistogram aHistogram;
+  if (aHistogram.Percentile(0.5)!=0)
+    return -1;
+  for(long long i=1;i<=1000;i++)
+    aHistogram.Record(1000*i);
+  long long lMedian = aHistogram.Percentile(0.5);
+  long long lP99 = aHistogram.Percentile(0.99);
+  if ((aHistogram.NbOfSamples()!=1000) ||
+      (aHistogram.Maximum()!=1000000) ||
+      (lMedian<500000) || (lMedian>500000*1.0625) ||
+      (lP99<990000) || (lP99>1000000) ||
+      (aHistogram.Percentile(1.0)!=1000000))
+    {
+      cerr << "Wrong percentiles: " << lMedian << " " << lP99 << endl;
+      return -1;
+    }
+
+  // Nothing is recorded without a profiler.
+  StageProfiler aProfiler;
+  {
+    StageTimer aTimer(StageProfiler::QP_SOLVE);
+  }
+  if (aProfiler.Histogram(StageProfiler::QP_SOLVE).NbOfSamples()!=0)
+    return -1;
+
+  {
+    ScopedStageProfiler aSSP(aProfiler);
+    StageTimer aTimer(StageProfiler::SUPPORT_PREVIEW);
+    aTimer.Start(StageProfiler::QP_SOLVE);
+    aTimer.Start(StageProfiler::INTERPOLATION);
+  }
+  if ((StageProfiler::Current()!=0) ||
+      (aProfiler.Histogram(StageProfiler::SUPPORT_PREVIEW).NbOfSamples()!=1) ||
+      (aProfiler.Histogram(StageProfiler::QP_SOLVE).NbOfSamples()!=1) ||
+      (aProfiler.Histogram(StageProfiler::INTERPOLATION).NbOfSamples()!=1) ||
+      (aProfiler.Histogram(StageProfiler::CONTROL_LOOP).NbOfSamples()!=0))
+    {
+      cerr << "Wrong stages." << endl;
+      return -1;
+    }
+
+  aProfiler.Reset();
+  if (aProfiler.Histogram(StageProfiler::QP_SOLVE).NbOfSamples()!=0)
+    return -1;
+
+  // The last events are kept, but the slot which may be
+  // written during a copy.
+  string lFileName("TestStageProfiler.json");
+  {
+    TraceRecorder aRecorder(8);
+    aProfiler.SetTraceRecorder(&aRecorder);
+    {
+      ScopedStageProfiler aSSP(aProfiler);
+      for(unsigned int i=0;i<5;i++)
+	{
+	  StageTimer aTimer(StageProfiler::CONTROL_LOOP);
+	  StageProfiler::Current()->Mark("NewStep");
+	  aTimer.Start(StageProfiler::QP_SOLVE);
+	}
+    }
+    aProfiler.SetTraceRecorder(0);
+
+    vector<TraceRecorder::Event_s> lEvents;
+    aRecorder.Snapshot(lEvents);
+    if ((lEvents.size()!=7) ||
+	(string(lEvents[0].Name)!="QPSolve") ||
+	(string(lEvents[4].Name)!="NewStep") || (lEvents[4].End>=0) ||
+	(string(lEvents[5].Name)!="ControlLoop") ||
+	(string(lEvents[6].Name)!="QPSolve") ||
+	(lEvents[6].End<lEvents[6].Begin) ||
+	(lEvents[6].Begin<lEvents[0].Begin))
+      {
+	cerr << "Wrong trace." << endl;
+	return -1;
+      }
+
+    // The file is written by another thread,
+    // which is joined by the destructor.
+    if (!aRecorder.Dump(lFileName))
+      return -1;
+  }
+
+  ifstream aif(lFileName.c_str());
+  string lLine, lLastLine;
+  unsigned int lNbOfLines = 0;
+  while (getline(aif,lLine))
+    {
+      lLastLine = lLine;
+      lNbOfLines++;
+    }
+  if ((lNbOfLines!=10) || (lLastLine!="]}"))
+    {
+      cerr << "Wrong trace file." << endl;
+      return -1;
+    }
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestTelemetry.cpp
+  \brief Log records from two threads in a small queue,
+  and check the text files given by the converter.
+  Then two threads log in the same channel, each one with its own
+  logger installed, and each file must keep the records of its thread.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <Telemetry.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+const unsigned int NB_RECORDS = 2000;
+
+struct Producer_s
+{
+  TelemetryLogger * Logger;
+  int Channel;
+  double Value;
+};
+
+static void Produce(void * aProducer)
+{
+  Producer_s * aP = (Producer_s *)aProducer;
+  // The logger of the thread, as a pattern generator installs it.
+  ScopedTelemetryLogger aSTL(*aP->Logger);
+  for(unsigned int i=0;i<NB_RECORDS;i++)
+    {
+      TelemetryRecord aRecord;
+      aRecord << i << aP->Value << -1.5;
+      // The queue is small, wait for the writer
+      // instead of losing the record.
+      while (!TelemetryLogger::Current().Log(aP->Channel,aRecord))
+	Thread::YieldCpu();
+    }
+}
+
+static bool CheckFile(const string & aFileName, double aValue)
+{
+  ifstream aif(aFileName.c_str());
+  string lLine;
+  unsigned int i=0;
+  while (getline(aif,lLine))
+    {
+      ostringstream oss;
+      oss << i << " " << aValue << " " << -1.5;
+      if (lLine!=oss.str())
+	{
+	  cerr << aFileName << ": " << lLine << " instead of "
+	       << oss.str() << endl;
+	  return false;
+	}
+      i++;
+    }
+  if (i!=NB_RECORDS)
+    {
+      cerr << aFileName << ": " << i << " records" << endl;
+      return false;
+    }
+  return true;
+}
+
+int main()
+{
+  {
+    TelemetryLogger aLogger(16);
+    TelemetryRecord aRecord;
+    if (aLogger.Log(0,aRecord))
+      return -1;
+    if (!aLogger.Open("TestTelemetry.bin"))
+      return -1;
+
+    Producer_s lProducers[2];
+    lProducers[0].Logger = lProducers[1].Logger = &aLogger;
+    lProducers[0].Channel = aLogger.Channel("TestTelemetryA.dat");
+    lProducers[0].Value = 0.25;
+    lProducers[1].Channel = aLogger.Channel("TestTelemetryB.dat");
+    lProducers[1].Value = 3.0;
+    if ((lProducers[0].Channel==lProducers[1].Channel) ||
+	(aLogger.Channel("TestTelemetryA.dat")!=lProducers[0].Channel))
+      return -1;
+
+    Thread lThreads[2];
+    for(unsigned int i=0;i<2;i++)
+      lThreads[i].Start(Produce,&lProducers[i]);
+    for(unsigned int i=0;i<2;i++)
+      lThreads[i].Join();
+    aLogger.Close();
+  }
+
+  if ((!TelemetryLogger::ConvertToText("TestTelemetry.bin","")) ||
+      (!CheckFile("TestTelemetryA.dat",0.25)) ||
+      (!CheckFile("TestTelemetryB.dat",3.0)))
+    return -1;
+
+  if (TelemetryLogger::ConvertToText("TestTelemetryA.dat",""))
+    return -1;
+
+  /* One logger per thread, the channel is shared. */
+  {
+    TelemetryLogger lLoggers[2];
+    Producer_s lProducers[2];
+    const char * lFileNames[2] = { "TestTelemetry1.bin", "TestTelemetry2.bin" };
+    for(unsigned int i=0;i<2;i++)
+      {
+	if (!lLoggers[i].Open(lFileNames[i]))
+	  return -1;
+	lProducers[i].Logger = &lLoggers[i];
+	lProducers[i].Channel = TelemetryLogger::Channel("TestTelemetryC.dat");
+	lProducers[i].Value = 0.5 + 6.5*i;
+      }
+
+    Thread lThreads[2];
+    for(unsigned int i=0;i<2;i++)
+      lThreads[i].Start(Produce,&lProducers[i]);
+    for(unsigned int i=0;i<2;i++)
+      lThreads[i].Join();
+    for(unsigned int i=0;i<2;i++)
+      lLoggers[i].Close();
+    if (TelemetryLogger::Installed()!=0)
+      return -1;
+  }
+
+  if ((!TelemetryLogger::ConvertToText("TestTelemetry1.bin","")) ||
+      (!CheckFile("TestTelemetryC.dat",0.5)) ||
+      (!TelemetryLogger::ConvertToText("TestTelemetry2.bin","")) ||
+      (!CheckFile("TestTelemetryC.dat",7.0)))
+    return -1;
+  return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestZMPRefFilter.cpp
+  \brief Compare the streaming filter of the ZMP reference with
+  the filtering of the whole trajectory, when the samples are given
+  at once or in chunks.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <iostream>
+#include <deque>
+#include <vector>
+
+#include "ZMPRefTrajectoryGeneration/ZMPRefFilter.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+/* Filtering of the whole trajectory as done
+   by ZMPDiscretization::FilterZMPRef. */
+void FilterWholeTrajectory(const vector<double> & Window,
+			   const deque<ZMPPosition> & ZMPPositionsX,
+			   deque<ZMPPosition> & ZMPPositionsY)
+{
+  ZMPPositionsY.resize(ZMPPositionsX.size());
+  unsigned int n = Window.size()-1;
+  for(unsigned int i=0;i<n+1;i++)
+    ZMPPositionsY[i] = ZMPPositionsX[i];
+
+  for(unsigned int i=n+1;i<ZMPPositionsX.size();i++)
+    {
+      double ltmp[2]={0,0};
+      for(unsigned int j=0;j<Window.size();j++)
+	{
+	  ltmp[0] += Window[j]*ZMPPositionsX[i-j].px;
+	  ltmp[1] += Window[j]*ZMPPositionsX[i-j].py;
+	}
+      ZMPPositionsY[i] = ZMPPositionsX[i];
+      ZMPPositionsY[i].px = ltmp[0];
+      ZMPPositionsY[i].py = ltmp[1];
+    }
+}
+
+/* Filtering of the new part of the trajectory as done
+   by ZMPDiscretization::FilterOutValues with a look ahead
+   of two samples. */
+void FilterOutValuesReference(const vector<double> & Window,
+			      const deque<ZMPPosition> & ZMPPositions,
+			      deque<ZMPPosition> & FinalZMPPositions,
+			      bool InitStep)
+{
+  unsigned int lshift=2;
+  for(unsigned int i=0;i<ZMPPositions.size();i++)
+    {
+      double ltmp[3]={0,0,0};
+
+      int o= FinalZMPPositions.size()-1-lshift;
+      for(unsigned int j=0;j<Window.size();j++)
+	{
+	  int r;
+	  r=i-j+lshift;
+	  const ZMPPosition * aZMP;
+	  if (r<0)
+	    {
+	      if (InitStep)
+		aZMP = &ZMPPositions[lshift];
+	      else if (-r<o)
+		aZMP = &FinalZMPPositions[o+r];
+	      else
+		aZMP = &FinalZMPPositions[0];
+	    }
+	  else
+	    {
+	      if (r>=(int)ZMPPositions.size())
+		r = ZMPPositions.size()-1;
+	      aZMP = &ZMPPositions[r];
+	    }
+	  ltmp[0] += Window[j]*aZMP->px;
+	  ltmp[1] += Window[j]*aZMP->py;
+	  ltmp[2] += Window[j]*aZMP->pz;
+	}
+      
+      ZMPPosition aZMPPos = ZMPPositions[i];
+      aZMPPos.px = ltmp[0];
+      aZMPPos.py = ltmp[1];
+      aZMPPos.pz = ltmp[2];
+      FinalZMPPositions.push_back(aZMPPos);
+    }
+}
+
+/* Extend the trajectory by chunks as ZMPDiscretization does 
+   when steps are added on-line, while the control loop consumes
+   the beginning of the trajectory. */
+int CheckFilterOutValues(const vector<double> & Window,
+			 const deque<ZMPPosition> & ZMPPositions,
+			 double Tolerance)
+{
+  ZMPRefFilter aFilter;
+  aFilter.SetWindow(Window,2);
+
+  deque<ZMPPosition> RefZMPPositions, FilteredZMPPositions;
+  unsigned int First=0, lChunk=640, lIteration=0;
+  while(First<ZMPPositions.size())
+    {
+      deque<ZMPPosition> NewZMPPositions;
+      for(unsigned int i=First;(i<First+lChunk) && (i<ZMPPositions.size());i++)
+	NewZMPPositions.push_back(ZMPPositions[i]);
+
+      bool InitStep = (First==0);
+      FilterOutValuesReference(Window,NewZMPPositions,RefZMPPositions,InitStep);
+      aFilter.FilterOutValues(NewZMPPositions,FilteredZMPPositions,InitStep);
+
+      if (FilteredZMPPositions.size()!=RefZMPPositions.size())
+	{
+	  cerr << "Wrong number of filtered values." << endl;
+	  return -1;
+	}
+
+      for(unsigned int i=0;i<RefZMPPositions.size();i++)
+	{
+	  if ((fabs(FilteredZMPPositions[i].px-RefZMPPositions[i].px)>Tolerance) ||
+	      (fabs(FilteredZMPPositions[i].py-RefZMPPositions[i].py)>Tolerance) ||
+	      (fabs(FilteredZMPPositions[i].pz-RefZMPPositions[i].pz)>Tolerance) ||
+	      (FilteredZMPPositions[i].theta!=RefZMPPositions[i].theta) ||
+	      (FilteredZMPPositions[i].time!=RefZMPPositions[i].time) ||
+	      (FilteredZMPPositions[i].stepType!=RefZMPPositions[i].stepType))
+	    {
+	      cerr << "Filtered value " << i << " differs after " 
+		   << First+lChunk << " samples: "
+		   << FilteredZMPPositions[i].px << " " << RefZMPPositions[i].px << " "
+		   << FilteredZMPPositions[i].py << " " << RefZMPPositions[i].py << endl;
+	      return -1;
+	    }
+	}
+
+      // The control loop consumes the beginning of the trajectory.
+      for(unsigned int i=0;(i<lChunk/2) && (RefZMPPositions.size()>20);i++)
+	{
+	  RefZMPPositions.pop_front();
+	  FilteredZMPPositions.pop_front();
+	}
+
+      // Changing the window forgets the filtered values,
+      // the filter then reads them in the trajectory.
+      if (lIteration==5)
+	aFilter.SetWindow(Window,2);
+
+      First += lChunk;
+      lChunk = lChunk%37+1;
+      lIteration++;
+    }
+  return 0;
+}
+
+int main()
+{
+  // Same window as ZMPDiscretization for a period of 5 ms.
+  unsigned int n=10;
+  vector<double> Window(n+1);
+  double sum=0.0;
+  for(unsigned int i=0;i<n+1;i++)
+    {
+      double tmp = sin((M_PI*i)/n);
+      Window[i] = tmp*tmp;
+      sum += Window[i];
+    }
+  for(unsigned int i=0;i<n+1;i++)
+    Window[i] /= sum;
+
+  // Piecewise linear ZMP trajectory with some noise.
+  deque<ZMPPosition> ZMPPositions(2000);
+  srand(0);
+  for(unsigned int i=0;i<ZMPPositions.size();i++)
+    {
+      ZMPPosition & aZMP = ZMPPositions[i];
+      aZMP.px = 0.1*((i/160)+ (i%160>80 ? (i%160-80)/80.0 : 0.0));
+      aZMP.py = ((i/160)%2 ? 0.095 : -0.095) + 1e-3*rand()/RAND_MAX;
+      aZMP.pz = (i<640) ? 1e-3*(640-i)/640.0 : 0.0;
+      aZMP.theta = 0.0;
+      aZMP.time = 0.005*i;
+      aZMP.stepType = 1;
+    }
+
+  deque<ZMPPosition> RefZMPPositions;
+  FilterWholeTrajectory(Window,ZMPPositions,RefZMPPositions);
+
+  // The sums are done in the same order, the results only differ
+  // if the compiler contracts the products and the sums differently.
+  const double Tolerance = 1e-14;
+
+  // The filter is fed by chunks of increasing sizes.
+  ZMPRefFilter aFilter;
+  aFilter.SetWindow(Window);
+  deque<ZMPPosition> FilteredZMPPositions;
+  unsigned int First=0, lChunk=1;
+  while(First<ZMPPositions.size())
+    {
+      deque<ZMPPosition> NewZMPPositions;
+      for(unsigned int i=First;(i<First+lChunk) && (i<ZMPPositions.size());i++)
+	NewZMPPositions.push_back(ZMPPositions[i]);
+      aFilter.Filter(NewZMPPositions,0,FilteredZMPPositions);
+      First += lChunk;
+      lChunk = lChunk%37+1;
+    }
+
+  if ((FilteredZMPPositions.size()!=RefZMPPositions.size()) ||
+      (aFilter.NbOfSamples()!=ZMPPositions.size()))
+    {
+      cerr << "Wrong number of samples." << endl;
+      return -1;
+    }
+
+  for(unsigned int i=0;i<RefZMPPositions.size();i++)
+    {
+      if ((fabs(FilteredZMPPositions[i].px-RefZMPPositions[i].px)>Tolerance) ||
+	  (fabs(FilteredZMPPositions[i].py-RefZMPPositions[i].py)>Tolerance) ||
+	  (FilteredZMPPositions[i].time!=RefZMPPositions[i].time))
+	{
+	  cerr << "Sample " << i << " differs: "
+	       << FilteredZMPPositions[i].px << " " << RefZMPPositions[i].px << " "
+	       << FilteredZMPPositions[i].py << " " << RefZMPPositions[i].py << endl;
+	  return -1;
+	}
+    }
+
+  // After a reset the filter starts again.
+  aFilter.Reset();
+  deque<ZMPPosition> SecondPass;
+  aFilter.Filter(ZMPPositions,0,SecondPass);
+  for(unsigned int i=0;i<RefZMPPositions.size();i++)
+    if ((fabs(SecondPass[i].px-RefZMPPositions[i].px)>Tolerance) ||
+	(fabs(SecondPass[i].py-RefZMPPositions[i].py)>Tolerance))
+      {
+	cerr << "Sample " << i << " differs after a reset." << endl;
+	return -1;
+      }
+
+  // Filtering of the trajectory extended on-line.
+  if (CheckFilterOutValues(Window,ZMPPositions,Tolerance)<0)
+    return -1;
+
+  return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ZMPQPProblem.cpp
+  \brief Problems of ZMPConstrainedQPFastFormulation for a straight walk.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "ZMPQPProblem.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL::TestSuite;
+
+const double ZMPQPProblem::T = 0.1;
+const double ZMPQPProblem::Zc = 0.80;
+const double ZMPQPProblem::Alpha = 200.0;
+const double ZMPQPProblem::Beta = 1000.0;
+
+namespace
+{
+  const double StepLength = 0.2;
+  const double FeetDistance = 0.19;
+  const double FootHalfLength = 0.07;
+  const double FootHalfWidth = 0.035;
+
+  /* In place cholesky decomposition of the n x n matrix A (lower part). */
+  int Cholesky(double *A, unsigned int n)
+  {
+    for(unsigned int j=0;j<n;j++)
+      {
+	double s = A[j*n+j];
+	for(unsigned int k=0;k<j;k++)
+	  s -= A[j*n+k]*A[j*n+k];
+	if (s<=0.0)
+	  return -1;
+	A[j*n+j] = sqrt(s);
+	for(unsigned int i=j+1;i<n;i++)
+	  {
+	    double t = A[i*n+j];
+	    for(unsigned int k=0;k<j;k++)
+	      t -= A[i*n+k]*A[j*n+k];
+	    A[i*n+j] = t/A[j*n+j];
+	  }
+	for(unsigned int k=j+1;k<n;k++)
+	  A[j*n+k] = 0.0;
+      }
+    return 0;
+  }
+
+  /* Inverse of the n x n matrix A by Gauss-Jordan elimination. */
+  int Inverse(const double *A, double *iA, unsigned int n)
+  {
+    vector<double> M(A,A+n*n);
+    for(unsigned int i=0;i<n*n;i++)
+      iA[i] = 0.0;
+    for(unsigned int i=0;i<n;i++)
+      iA[i*n+i] = 1.0;
+
+    for(unsigned int c=0;c<n;c++)
+      {
+	unsigned int p=c;
+	for(unsigned int r=c+1;r<n;r++)
+	  if (fabs(M[r*n+c])>fabs(M[p*n+c]))
+	    p = r;
+	if (M[p*n+c]==0.0)
+	  return -1;
+	for(unsigned int k=0;k<n;k++)
+	  {
+	    swap(M[c*n+k],M[p*n+k]);
+	    swap(iA[c*n+k],iA[p*n+k]);
+	  }
+	double lpivot = M[c*n+c];
+	for(unsigned int k=0;k<n;k++)
+	  {
+	    M[c*n+k] /= lpivot;
+	    iA[c*n+k] /= lpivot;
+	  }
+	for(unsigned int r=0;r<n;r++)
+	  {
+	    if ((r==c) || (M[r*n+c]==0.0))
+	      continue;
+	    double f = M[r*n+c];
+	    for(unsigned int k=0;k<n;k++)
+	      {
+		M[r*n+k] -= f*M[c*n+k];
+		iA[r*n+k] -= f*iA[c*n+k];
+	      }
+	  }
+      }
+    return 0;
+  }
+}
+
+ZMPQPProblem::ZMPQPProblem(unsigned int NbOfSteps):
+  DPu((NbOfConstraints+1)*2*N),
+  DPx(NbOfConstraints),
+  SimilarConstraints(8*N),
+  m_NbOfSteps(NbOfSteps)
+{
+  memset(XkYk,0,6*sizeof(double));
+  memset(V,0,2*N*sizeof(double));
+}
+
+int ZMPQPProblem::Initialize()
+{
+  /* Constant matrices, see InitializeMatrixPbConstants. */
+  for(unsigned int i=0;i<N;i++)
+    {
+      Px[i*3+0] = 1.0;
+      Px[i*3+1] = (i+1)*T;
+      Px[i*3+2] = (i+1)*(i+1)*T*T*0.5 - Zc/9.81;
+      for(unsigned int k=0;k<N;k++)
+	{
+	  double d = (double)i-(double)k;
+	  m_Pu[i*N+k] = (k<=i) ?
+	    (1 + 3*d + 3*d*d)*T*T*T/6.0 - T*Zc/9.81 : 0.0;
+	}
+    }
+
+  /* Q = Alpha I + Beta Pu'Pu = LQ LQ' */
+  double LQ[N*N];
+  for(unsigned int i=0;i<N;i++)
+    for(unsigned int j=0;j<N;j++)
+      {
+	double s = (i==j) ? Alpha : 0.0;
+	for(unsigned int k=0;k<N;k++)
+	  s += Beta*m_Pu[k*N+i]*m_Pu[k*N+j];
+	LQ[i*N+j] = s;
+      }
+  if ((Cholesky(LQ,N)<0) ||
+      (Inverse(LQ,m_iLQ1,N)<0))
+    return -1;
+
+  /* iLQ on both axis, and the solver's Pu = iLQ Pu'. */
+  memset(iLQ,0,4*N*N*sizeof(double));
+  for(unsigned int i=0;i<N;i++)
+    for(unsigned int j=0;j<N;j++)
+      {
+	iLQ[i*2*N+j] = iLQ[(i+N)*2*N+j+N] = m_iLQ1[i*N+j];
+	double s=0.0;
+	for(unsigned int k=0;k<N;k++)
+	  s += m_iLQ1[i*N+k]*m_Pu[j*N+k];
+	lPu[i*N+j] = s;
+      }
+  if (Inverse(lPu,iPu,N)<0)
+    return -1;
+  return 0;
+}
+
+void ZMPQPProblem::SupportPolygon(unsigned int k,
+				  double &cx, double &cy,
+				  double &hx, double &hy) const
+{
+  unsigned int lStep = k/SamplesPerStep;
+  if ((lStep==0) || (lStep>m_NbOfSteps))
+    {
+      /* Double support at the beginning and at the end. */
+      unsigned int lLastStep = (lStep==0) ? 0 : m_NbOfSteps;
+      cx = lLastStep*StepLength;
+      cy = 0.0;
+      hx = FootHalfLength;
+      hy = 0.5*FeetDistance + FootHalfWidth;
+      return;
+    }
+  cx = lStep*StepLength;
+  cy = (lStep%2==1) ? -0.5*FeetDistance : 0.5*FeetDistance;
+  hx = FootHalfLength;
+  hy = FootHalfWidth;
+}
+
+void ZMPQPProblem::BuildIteration(unsigned int lk)
+{
+  /* Constraints A V + b >= 0 and ZMP reference. */
+  for(unsigned int i=0;i<N;i++)
+    {
+      double cx,cy,hx,hy;
+      SupportPolygon(lk+i+1,cx,cy,hx,hy);
+      ZMPRef[i] = cx;
+      ZMPRef[i+N] = cy;
+
+      double zx=0.0, zy=0.0;
+      for(unsigned int j=0;j<3;j++)
+	{
+	  zx += Px[i*3+j]*XkYk[j];
+	  zy += Px[i*3+j]*XkYk[j+3];
+	}
+
+      /* Rows: x>=cx-hx, y>=cy-hy, x<=cx+hx, y<=cy+hy */
+      const double ax[4] = { 1.0, 0.0, -1.0, 0.0 };
+      const double ay[4] = { 0.0, 1.0, 0.0, -1.0 };
+      const double c[4] = { -(cx-hx), -(cy-hy), cx+hx, cy+hy };
+      const int lSimilar[4] = { 0, 0, -2, -2 };
+      for(unsigned int r=0;r<4;r++)
+	{
+	  unsigned int li = 4*i+r;
+	  for(unsigned int k=0;k<N;k++)
+	    {
+	      DPu[li+k*(NbOfConstraints+1)] = ax[r]*lPu[k*N+i];
+	      DPu[li+(k+N)*(NbOfConstraints+1)] = ay[r]*lPu[k*N+i];
+	    }
+	  DPx[li] = ax[r]*zx + ay[r]*zy + c[r];
+	  SimilarConstraints[li] = lSimilar[r];
+	}
+    }
+
+  /* D = iLQ Beta Pu' (Px xk - ZMPRef) */
+  for(unsigned int i=0;i<N;i++)
+    {
+      D[i] = D[i+N] = 0.0;
+      for(unsigned int k=0;k<N;k++)
+	{
+	  double lx = 0.0, ly = 0.0;
+	  for(unsigned int j=0;j<N;j++)
+	    {
+	      double lpx = Px[j*3]*XkYk[0]+Px[j*3+1]*XkYk[1]+Px[j*3+2]*XkYk[2];
+	      double lpy = Px[j*3]*XkYk[3]+Px[j*3+1]*XkYk[4]+Px[j*3+2]*XkYk[5];
+	      lx += m_Pu[j*N+k]*(lpx-ZMPRef[j]);
+	      ly += m_Pu[j*N+k]*(lpy-ZMPRef[j+N]);
+	    }
+	  D[i] += m_iLQ1[i*N+k]*Beta*lx;
+	  D[i+N] += m_iLQ1[i*N+k]*Beta*ly;
+	}
+    }
+}
+
+unsigned int ZMPQPProblem::NbOfViolations() const
+{
+  unsigned int r=0;
+  for(unsigned int li=0;li<NbOfConstraints;li++)
+    {
+      double s = DPx[li];
+      for(unsigned int j=0;j<2*N;j++)
+	s += DPu[li+j*(NbOfConstraints+1)]*V[j];
+      if (s<-1e-6)
+	r++;
+    }
+  return r;
+}
+
+void ZMPQPProblem::ApplyFirstJerk()
+{
+  /* U = iLQ' V */
+  double ux=0.0, uy=0.0;
+  for(unsigned int i=0;i<N;i++)
+    {
+      ux += m_iLQ1[i*N]*V[i];
+      uy += m_iLQ1[i*N]*V[i+N];
+    }
+  for(unsigned int a=0;a<2;a++)
+    {
+      double *x = XkYk+3*a;
+      double u = (a==0) ? ux : uy;
+      x[0] += T*x[1] + T*T*0.5*x[2] + T*T*T/6.0*u;
+      x[1] += T*x[2] + T*T*0.5*u;
+      x[2] += T*u;
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file ZMPQPProblem.hh
+  \brief Problems of ZMPConstrainedQPFastFormulation for a straight
+  walk, built without robot model.
+
+  The constant matrices (Px, Pu, iLQ, iPu) are built exactly as in
+  ZMPConstrainedQPFastFormulation::InitConstants, the support polygons
+  are rectangles following a sequence of steps. The 2D LIPM is
+  simulated with the first jerk of each solution.
+*/
+
+#ifndef _ZMP_QP_PROBLEM_UTESTING_H_
+#define _ZMP_QP_PROBLEM_UTESTING_H_
+
+#include <vector>
+
+namespace PatternGeneratorJRL
+{
+  namespace TestSuite
+  {
+    class ZMPQPProblem
+    {
+    public:
+      /*! Parameters of ZMPConstrainedQPFastFormulation. */
+      static const unsigned int N = 16;
+      static const double T;
+      static const double Zc;
+      static const double Alpha;
+      static const double Beta;
+
+      /*! Parameters of the walk. */
+      static const unsigned int SamplesPerStep = 8;
+
+      static const unsigned int NbOfConstraints = 4*N;
+
+      explicit ZMPQPProblem(unsigned int NbOfSteps);
+
+      /*! \brief Build the constant matrices.
+	\return -1 if the cost function can not be factorized. */
+      int Initialize();
+
+      /*! \brief Number of problems of the walk. */
+      unsigned int NbOfIterations() const
+      { return (m_NbOfSteps+2)*SamplesPerStep; }
+
+      /*! \brief Build the constraints, the ZMP reference and the
+	constant part of the cost for the iteration \a lk. */
+      void BuildIteration(unsigned int lk);
+
+      /*! \brief Number of constraints violated by V. */
+      unsigned int NbOfViolations() const;
+
+      /*! \brief Simulate the LIPM with the first jerk of V. */
+      void ApplyFirstJerk();
+
+      /*! \name Arguments of PLDPSolver.
+	@{ */
+      double Px[N*3], lPu[N*N], iPu[N*N], iLQ[4*N*N];
+      std::vector<double> DPu, DPx;
+      std::vector<int> SimilarConstraints;
+      double ZMPRef[2*N], D[2*N], V[2*N], XkYk[6];
+      /*! @} */
+
+    private:
+      /*! Support rectangle for the absolute sample k. */
+      void SupportPolygon(unsigned int k,
+			  double &cx, double &cy, double &hx, double &hy) const;
+
+      unsigned int m_NbOfSteps;
+      double m_Pu[N*N], m_iLQ1[N*N];
+    };
+  }
+}
+#endif /* _ZMP_QP_PROBLEM_UTESTING_H_ */